@@ -33,10 +33,10 @@ if not exist %VS_DEV_CMD% (
 )
 
 REM --- Configura variables del proyecto ---
-set SRC=src\SimpleSteamIdler.cpp
+set SRC=src\*.cpp
 set RESOURCES=resources\resources.rc
 set RESOURCE_OBJ=resources\resources.res
-set OBJ=SimpleSteamIdler.obj
+set OBJ=*.obj
 set OUT=SimpleSteamIdler.exe
 set INCLUDE=resources
 
@@ -53,7 +53,7 @@ if errorlevel 1 (
 )
 
 echo %light_blue_on%(3/5) Compilando código fuente...%color_off%
-cl.exe /EHsc /I"%INCLUDE%" /c %SRC% >nul 2>&1
+cl.exe /EHsc /std:c++17 /I"%INCLUDE%" /c %SRC% >nul 2>&1
 if errorlevel 1 (
     echo %red_on%Error compilando código fuente.%color_off%
     pause
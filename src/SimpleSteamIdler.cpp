@@ -1,5 +1,5 @@
 // SimpleSteamIdler.cpp
-// Builds with: cl /O2 /EHsc SimpleSteamIdler.cpp winhttp.lib
+// Builds with: cl /O2 /EHsc *.cpp winhttp.lib (see compile.bat)
 // (Use x64 Native Tools if you want an x64 exe and steam_api64.dll)
 //
 // Purpose:
@@ -10,6 +10,13 @@
 // - Displays game name using proper UTF-8 -> UTF-16 conversion so CMD shows characters
 //   like  correctly.
 // - Suppresses steam_api.dll internal messages while calling SteamAPI_Init().
+// - Looks the AppID up on the Store while steam_api loads and initializes, so startup
+//   takes as long as the slower of the two instead of both.
+// - Reads the local Steam libraries (appmanifest files) to name installed games and
+//   list them at the prompt without network access (see steam_library.h).
+// - With --supervise, idles many AppIDs at once (one worker process each, see supervisor.h).
+// - With --daemon, does the same without a console, driven over a named pipe (see daemon.h).
+// - With --probe, tells which of many AppIDs the account owns (see ownership_probe.h).
 //
 // Notes on style / safety:
 // - Avoids `while(true)` by using boolean loop conditions.
@@ -19,365 +26,116 @@
 #define NOMINMAX
 
 #include "../resources/resource.h"
+#include "app_catalog.h"
+#include "appdetails_cache.h"
+#include "daemon.h"
+#include "idle_session.h"
+#include "lean_idle.h"
+#include "metrics.h"
+#include "options.h"
+#include "ownership_probe.h"
+#include "phase_timings.h"
+#include "platform.h"
+#include "profile.h"
+#include "rotation.h"
+#include "session_ledger.h"
+#include "store.h"
+#include "steam_library.h"
+#include "store_validate.h"
+#include "supervisor.h"
+#include "util.h"
 
 #include <windows.h>
-#include <winhttp.h>
 #include <stdlib.h>
 
 #include <algorithm>
-#include <atomic>
-#include <cctype>
-#include <chrono>
 #include <cstdio>
-#include <fstream>
-#include <functional>
-#include <io.h>
+#include <cstdlib>
 #include <iostream>
-#include <limits>
+#include <memory>
 #include <string>
 #include <thread>
 #include <vector>
 
-#pragma comment(lib, "winhttp.lib")
 #pragma comment(lib, "user32.lib")
 
 using std::string;
 
-// --------------------------- Utility helpers ---------------------------
-
-// Redirect stdout/stderr to NUL while executing a callable.
-// This is used to suppress messages printed by steam_api.dll during initialization.
-static void suppress_console_output(const std::function<void()>& fn)
-{
-    // Duplicate file descriptors for stdout/stderr
-    int stdout_backup = _dup(_fileno(stdout));
-    int stderr_backup = _dup(_fileno(stderr));
-
-    // Open NUL and redirect stdout/stderr there
-    FILE* nul = nullptr;
-    freopen_s(&nul, "NUL", "w", stdout);
-    freopen_s(&nul, "NUL", "w", stderr);
-
-    // Execute the provided callable while output is suppressed
-    fn();
-
-    // Restore original stdout/stderr
-    _dup2(stdout_backup, _fileno(stdout));
-    _dup2(stderr_backup, _fileno(stderr));
-    _close(stdout_backup);
-    _close(stderr_backup);
-}
-
-// Convert UTF-8 string to wstring (UTF-16) using Win32 API.
-// Returns empty wstring on failure.
-static std::wstring utf8_to_wstring(const std::string& utf8)
+// A title typed at the AppID prompt: installed games and the app catalog are
+// searched (see app_catalog.h). The one app with exactly that name, or the
+// only match, is taken; several are listed to pick from. Returns the AppID,
+// or empty to prompt again.
+static string pick_app_by_title(const string& title, const SteamLibraryIndex& library, const AppCatalog& catalog)
 {
-    if (utf8.empty()) {
-        return std::wstring();
+    const size_t MAX_CHOICES = 9;
+    std::vector<TitleMatch> matches = match_title(title, &library, catalog, MAX_CHOICES);
+    if (matches.empty()) {
+        print_utf8_line(catalog.is_open() ? "No game matches \"" + title + "\"." :
+            "No installed game matches \"" + title + "\" (build an app catalog with --build-catalog to search "
+            "every Steam game).");
+        return string();
     }
-    int needed = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), NULL, 0);
-    if (needed <= 0) {
-        return std::wstring();
-    }
-    std::vector<wchar_t> buf(static_cast<size_t>(needed) + 1);
-    int converted = MultiByteToWideChar(CP_UTF8, 0, utf8.data(), static_cast<int>(utf8.size()), buf.data(), needed);
-    if (converted == 0) {
-        return std::wstring();
-    }
-    return std::wstring(buf.data(), converted);
-}
 
-// Print a UTF-8 string followed by newline to console robustly.
-// Tries WriteConsoleW (preferred). Falls back to std::cout (UTF-8 bytes).
-static void print_utf8_line(const std::string& utf8)
-{
-    std::wstring w = utf8_to_wstring(utf8);
-    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-    if (hOut != INVALID_HANDLE_VALUE && hOut != NULL) {
-        DWORD written = 0;
-        if (WriteConsoleW(hOut, w.c_str(), static_cast<DWORD>(w.size()), &written, NULL)) {
-            const wchar_t nl = L'\n';
-            WriteConsoleW(hOut, &nl, 1, &written, NULL);
-            return;
-        }
+    const TitleMatch* pick = matches.size() == 1 ? &matches[0] : nullptr;
+    if (!pick && std::count_if(matches.begin(), matches.end(), [](const TitleMatch& m) { return m.exact; }) == 1) {
+        pick = &*std::find_if(matches.begin(), matches.end(), [](const TitleMatch& m) { return m.exact; });
     }
-    // Fallback: print raw UTF-8 bytes (works if CP_UTF8 is set or output is redirected)
-    std::cout << utf8 << '\n';
-}
-
-// Print without newline (for prompts). Uses same robust approach as print_utf8_line.
-static void print_utf8(const std::string& utf8)
-{
-    std::wstring w = utf8_to_wstring(utf8);
-    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-    if (hOut != INVALID_HANDLE_VALUE && hOut != NULL) {
-        DWORD written = 0;
-        if (WriteConsoleW(hOut, w.c_str(), static_cast<DWORD>(w.size()), &written, NULL)) {
-            return;
+    if (!pick) {
+        print_utf8_line("Games matching \"" + title + "\":");
+        for (size_t i = 0; i < matches.size(); ++i) {
+            print_utf8_line("  " + std::to_string(i + 1) + ") " + matches[i].name + " (AppID " +
+                std::to_string(matches[i].appid) + ")");
         }
-    }
-    std::cout << utf8;
-}
-
-// Trim whitespace (space, tab, CR, LF) from both ends.
-static string trim(const string& s)
-{
-    size_t a = s.find_first_not_of(" \t\r\n");
-    if (a == string::npos) {
-        return "";
-    }
-    size_t b = s.find_last_not_of(" \t\r\n");
-    return s.substr(a, b - a + 1);
-}
-
-// Check whether the provided string contains only digits (0-9).
-static bool is_digits_only(const string& s)
-{
-    if (s.empty()) return false;
-    return std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); });
-}
-
-// Print a wide string (UTF-16) followed by newline.
-// This avoids encoding issues for literals containing non-ASCII characters.
-static void print_wline(const std::wstring& w)
-{
-    HANDLE hOut = GetStdHandle(STD_OUTPUT_HANDLE);
-    if (hOut != INVALID_HANDLE_VALUE && hOut != NULL) {
-        DWORD written = 0;
-        if (WriteConsoleW(hOut, w.c_str(), static_cast<DWORD>(w.size()), &written, NULL)) {
-            const wchar_t nl = L'\n';
-            WriteConsoleW(hOut, &nl, 1, &written, NULL);
-            return;
+        print_utf8("Pick 1-" + std::to_string(matches.size()) + " (ENTER to search again): ");
+        std::string line;
+        std::getline(std::cin, line);
+        line = trim(line);
+        size_t choice = is_digits_only(line) && line.size() < 3 ? std::strtoul(line.c_str(), nullptr, 10) : 0;
+        if (choice < 1 || choice > matches.size()) {
+            return string();
         }
+        pick = &matches[choice - 1];
     }
-
-    // Fallback: convert to UTF-8 and print
-    int needed = WideCharToMultiByte(CP_UTF8, 0, w.c_str(),
-        static_cast<int>(w.size()),
-        NULL, 0, NULL, NULL);
-
-    if (needed > 0) {
-        std::string buf(static_cast<size_t>(needed), 0);
-        WideCharToMultiByte(CP_UTF8, 0, w.c_str(),
-            static_cast<int>(w.size()),
-            &buf[0], needed, NULL, NULL);
-        std::cout << buf << '\n';
-    }
-    else {
-        std::wcout << w << std::endl;
-    }
-}
-
-// Cleans Steam variables
-static void clear_steam_env() {
-    SetEnvironmentVariableA("SteamAppId", NULL);
-    SetEnvironmentVariableA("SteamGameId", NULL);
+    print_utf8_line("Found \"" + pick->name + "\" (AppID " + std::to_string(pick->appid) + ").");
+    return std::to_string(pick->appid);
 }
 
-// --------------------------- HTTP / Store helpers ---------------------------
+// -------------------------------------------------------------------------
+// --------------------------- Main program flow ---------------------------
+// -------------------------------------------------------------------------
 
-// Perform a GET request to store.steampowered.com/api/appdetails?appids=<appid>
-// Returns true if fetch succeeded and writes response bytes (UTF-8) into outResp.
-static bool http_get_appdetails(const string& appid, string& outResp)
+int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
 {
-    outResp.clear();
-
-    // Build wide strings for WinHTTP functions
-    std::wstring host = L"store.steampowered.com";
-    std::wstring path = L"/api/appdetails?appids=" + std::wstring(appid.begin(), appid.end());
-
-    HINTERNET hSession = WinHttpOpen(
-        L"SimpleSteamIdler/1.0",
-        WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
-        WINHTTP_NO_PROXY_NAME,
-        WINHTTP_NO_PROXY_BYPASS, 0);
-
-    if (!hSession) {
-        return false;
-    }
-
-    HINTERNET hConnect = WinHttpConnect(hSession, host.c_str(), INTERNET_DEFAULT_HTTPS_PORT, 0);
-    if (!hConnect) {
-        WinHttpCloseHandle(hSession);
-        return false;
-    }
-
-    HINTERNET hRequest = WinHttpOpenRequest(
-        hConnect,
-        L"GET",
-        path.c_str(),
-        NULL,
-        WINHTTP_NO_REFERER,
-        WINHTTP_DEFAULT_ACCEPT_TYPES,
-        WINHTTP_FLAG_SECURE);
-
-    if (!hRequest) {
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        return false;
+    // Created first so every phase is measured from (nearly) process start.
+    PhaseTimings startup;
+    platform_init();
+
+    Options opts;
+    string options_error;
+    bool options_ok = parse_options(__argc, __argv, opts, options_error);
+
+    // Workers are started by the supervisor without a console; handle them
+    // before any console setup.
+    if (options_ok && opts.mode == RunMode::Worker) {
+        return run_worker(opts.appid, opts.control_in, opts.control_out, worker_options(opts));
     }
 
-    BOOL sent = WinHttpSendRequest(
-        hRequest,
-        WINHTTP_NO_ADDITIONAL_HEADERS, 0,
-        WINHTTP_NO_REQUEST_DATA, 0,
-        0, 0);
-
-    if (!sent) {
-        WinHttpCloseHandle(hRequest);
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        return false;
+    // The daemon has no console at all; --ctl borrows the caller's console
+    // (or its redirected output) for the reply.
+    MetricsServer metrics;
+    if (options_ok && opts.mode == RunMode::Daemon) {
+        serve_metrics(metrics, opts.metrics_port);
+        return run_daemon(opts.endpoint, worker_options(opts));
     }
-
-    if (!WinHttpReceiveResponse(hRequest, NULL)) {
-        WinHttpCloseHandle(hRequest);
-        WinHttpCloseHandle(hConnect);
-        WinHttpCloseHandle(hSession);
-        return false;
-    }
-
-    // Read response in chunks
-    DWORD dwSize = 0;
-    do {
-        DWORD dwDownloaded = 0;
-        if (!WinHttpQueryDataAvailable(hRequest, &dwSize)) {
-            break;
-        }
-        if (dwSize == 0) {
-            break;
-        }
-
-        std::string buffer;
-        buffer.resize(dwSize);
-
-        if (!WinHttpReadData(hRequest, &buffer[0], dwSize, &dwDownloaded)) {
-            break;
-        }
-        outResp.append(buffer.data(), dwDownloaded);
-    } while (dwSize > 0);
-
-    WinHttpCloseHandle(hRequest);
-    WinHttpCloseHandle(hConnect);
-    WinHttpCloseHandle(hSession);
-
-    return !outResp.empty();
-}
-
-// Quick JSON sniff: return true if the appdetails response contains "success": true for given appid.
-static bool resp_indicates_success(const string& resp, const string& appid)
-{
-    if (resp.empty() || appid.empty()) return false;
-    string key = "\"" + appid + "\"";
-    size_t pos = resp.find(key);
-    if (pos == string::npos) return false;
-
-    size_t successPos = resp.find("\"success\"", pos);
-    if (successPos == string::npos) return false;
-
-    size_t colonPos = resp.find(':', successPos);
-    if (colonPos == string::npos) return false;
-
-    size_t checkEnd = (resp.size() < colonPos + 50) ? resp.size() : (colonPos + 50);
-    string snippet = resp.substr(colonPos, checkEnd - colonPos);
-    return (snippet.find("true") != string::npos);
-}
-
-// Extract the game name from the appdetails JSON response (basic, not full JSON parser).
-// Returns empty string on failure.
-static string extract_game_name(const string& resp, const string& appid)
-{
-    if (resp.empty() || appid.empty()) return "";
-
-    string key = "\"" + appid + "\"";
-    size_t pos = resp.find(key);
-    if (pos == string::npos) return "";
-
-    size_t successPos = resp.find("\"success\"", pos);
-    if (successPos == string::npos) return "";
-
-    size_t colonPos = resp.find(':', successPos);
-    if (colonPos == string::npos) return "";
-
-    size_t checkEnd = (resp.size() < colonPos + 200) ? resp.size() : (colonPos + 200);
-    string snippet = resp.substr(colonPos, checkEnd - colonPos);
-    if (snippet.find("true") == string::npos) return "";
-
-    size_t dataPos = resp.find("\"data\"", successPos);
-    if (dataPos == string::npos) return "";
-
-    size_t namePos = resp.find("\"name\"", dataPos);
-    if (namePos == string::npos) return "";
-
-    size_t colonAfterName = resp.find(':', namePos);
-    if (colonAfterName == string::npos) return "";
-
-    size_t startQuote = resp.find('"', colonAfterName + 1);
-    if (startQuote == string::npos) return "";
-
-    // Extract the quoted string (handle basic escapes)
-    size_t i = startQuote + 1;
-    std::string name;
-    for (; i < resp.size(); ++i) {
-        char c = resp[i];
-        if (c == '"' && resp[i - 1] != '\\') {
-            break;
-        }
-        if (c == '\\' && i + 1 < resp.size()) {
-            char next = resp[i + 1];
-            if (next == '"' || next == '\\' || next == '/') {
-                name.push_back(next);
-                ++i;
-                continue;
-            }
-            else if (next == 'n') {
-                name.push_back('\n');
-                ++i;
-                continue;
-            }
-            else if (next == 't') {
-                name.push_back('\t');
-                ++i;
-                continue;
-            }
-            // other escapes: skip the backslash and take the next char
-        }
-        else {
-            name.push_back(c);
+    if (options_ok && opts.mode == RunMode::Control) {
+        if (!GetStdHandle(STD_OUTPUT_HANDLE) && AttachConsole(ATTACH_PARENT_PROCESS)) {
+            freopen("CONOUT$", "w", stdout);
+            freopen("CONOUT$", "w", stderr);
         }
+        return run_control_command(opts.endpoint, opts.command);
     }
 
-    return name;
-}
-
-// --------------------------- File helpers ---------------------------
-
-// Read the single-line steam_appid.txt file if present, trim and return contents.
-// Returns empty string if file not present or empty.
-static string read_appid_from_file(const char* filename = "steam_appid.txt")
-{
-    std::ifstream ifs(filename);
-    if (!ifs) return "";
-    string tmp;
-    std::getline(ifs, tmp);
-    return trim(tmp);
-}
-
-// Save AppID to steam_appid.txt (overwrite).
-static void save_appid_to_file(const string& appid, const char* filename = "steam_appid.txt")
-{
-    std::ofstream ofs(filename, std::ios::trunc);
-    if (ofs) {
-        ofs << appid << '\n';
-    }
-}
-
-// -------------------------------------------------------------------------
-// --------------------------- Main program flow ---------------------------
-// -------------------------------------------------------------------------
-
-int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
-{
+    PhaseTimings::Clock::time_point console_start = PhaseTimings::Clock::now();
     AllocConsole();
     freopen("CONOUT$", "w", stdout);
     freopen("CONOUT$", "w", stderr);
@@ -406,17 +164,129 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
     // in some fallback/redirection scenarios.
     SetConsoleOutputCP(CP_UTF8);
     SetConsoleCP(CP_UTF8);
+    startup.add("console", console_start, PhaseTimings::Clock::now());
+
+    if (!options_ok) {
+        print_utf8_line("Error: " + options_error);
+        return 1;
+    }
+
+    if (opts.mode == RunMode::Supervise || opts.mode == RunMode::Rotate || opts.mode == RunMode::Profile ||
+        opts.mode == RunMode::Interactive) {
+        serve_metrics(metrics, opts.metrics_port);
+    }
+
+    if (opts.mode == RunMode::Supervise) {
+        return run_supervisor(opts.appids, worker_options(opts));
+    }
+
+    if (opts.mode == RunMode::Rotate) {
+        return run_rotation(opts.rotation, worker_options(opts));
+    }
+
+    if (opts.mode == RunMode::Profile) {
+        return run_profile(opts.profile, worker_options(opts));
+    }
+
+    if (opts.mode == RunMode::ListInstalled) {
+        int rc = run_list_installed(opts.steam_dir);
+        print_utf8("Press ENTER to exit.");
+        std::string dummy;
+        std::getline(std::cin, dummy);
+        return rc;
+    }
+
+    if (opts.mode == RunMode::LedgerReport) {
+        int rc = run_ledger_report(opts.ledger_path);
+        print_utf8("Press ENTER to exit.");
+        std::string dummy;
+        std::getline(std::cin, dummy);
+        return rc;
+    }
+
+    if (opts.mode == RunMode::BuildCatalog || opts.mode == RunMode::FindApp) {
+        int rc = opts.mode == RunMode::BuildCatalog ? run_build_catalog(opts.catalog_source, opts.catalog_path) :
+            run_find_app(opts.catalog_path, opts.query);
+        print_utf8("Press ENTER to exit.");
+        std::string dummy;
+        std::getline(std::cin, dummy);
+        return rc;
+    }
+
+    if (opts.mode == RunMode::Validate) {
+        AppDetailsCache cache;
+        std::unique_ptr<HttpClient> http = make_store_client(opts.store_endpoint, opts.http_timeouts);
+        int rc = run_validate(opts.appids, opts.validate, *http, cache.open() ? &cache : nullptr);
+        print_utf8("Press ENTER to exit.");
+        std::string dummy;
+        std::getline(std::cin, dummy);
+        return rc;
+    }
+
+    if (opts.mode == RunMode::Probe) {
+        AppDetailsCache cache;
+        std::unique_ptr<HttpClient> http = make_store_client(opts.store_endpoint, opts.http_timeouts);
+        int rc = run_probe(opts.appids, opts.probe, opts.validate, *http, cache.open() ? &cache : nullptr);
+        print_utf8("Press ENTER to exit.");
+        std::string dummy;
+        std::getline(std::cin, dummy);
+        return rc;
+    }
+
+    // --timings: startup phases of this run (see phase_timings.h).
+    PhaseTimings* timings = opts.timings ? &startup : nullptr;
+    startup.set("mode", "interactive");
+    startup.set("result", "exit");
+    TimingsReport timings_report(timings, opts.timings_path, opts.timings_log);
 
     // Candidate appid: priority argv[1] > steam_appid.txt > user input
     string candidate_appid;
 
-    if (__argc > 1 && __argv[1] && __argv[1][0] != '\0') {
-        candidate_appid = trim(std::string(__argv[1]));
+    if (!opts.appid.empty()) {
+        candidate_appid = opts.appid;
     }
     else {
         candidate_appid = read_appid_from_file();
     }
 
+    // Store answers are cached on disk; --refresh bypasses the cached entry.
+    AppDetailsCache store_cache;
+    AppDetailsCache* store_cache_ptr = nullptr;
+    {
+        ScopedPhase phase(timings, "cache.open");
+        store_cache_ptr = store_cache.open() ? &store_cache : nullptr;
+    }
+
+    // Idle time per AppID, appended to sessions.ledger (see session_ledger.h).
+    SessionLedger ledger;
+    SessionLedger* ledger_ptr = !opts.ledger_path.empty() && ledger.open(opts.ledger_path, opts.ledger_heartbeat_s) ?
+        &ledger : nullptr;
+
+    // Installed games from the local Steam libraries (see steam_library.h):
+    // names and suggestions without waiting for the network.
+    SteamLibraryIndex library;
+    {
+        ScopedPhase phase(timings, "library.scan");
+        library.load(opts.steam_dir);
+    }
+    startup.set("installed", std::to_string(library.apps().size()));
+
+    // Every Steam app by name, if an app catalog was built (see
+    // app_catalog.h): titles at the prompt, and names without the Store.
+    AppCatalog catalog;
+    {
+        ScopedPhase phase(timings, "catalog.open");
+        catalog.open(opts.catalog_path);
+    }
+    startup.set("catalog", std::to_string(catalog.size()));
+
+    // One HTTP session for every Store lookup of this run (see http_client.h).
+    std::unique_ptr<HttpClient> store_http;
+    {
+        ScopedPhase phase(timings, "http.session");
+        store_http = make_store_client(opts.store_endpoint, opts.http_timeouts);
+    }
+
     // Loop condition flag: we attempt to obtain a valid AppID and ensure Steam init works
     bool have_valid_setup = false;
 
@@ -430,7 +300,16 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
 
         // ---- Step 1: Acquire AppID from user if candidate is empty ----
         if (candidate_appid.empty()) {
-            print_utf8("Enter Steam AppID (or Q to quit): ");
+            if (library.apps().empty() && !catalog.is_open()) {
+                print_utf8("Enter Steam AppID (or Q to quit): ");
+            }
+            else if (library.apps().empty()) {
+                print_utf8("Enter Steam AppID or game title (or Q to quit): ");
+            }
+            else {
+                print_utf8("Enter Steam AppID or game title (L to list the " + std::to_string(library.apps().size()) +
+                    " installed games, Q to quit): ");
+            }
             std::string line;
             std::getline(std::cin, line);
             candidate_appid = trim(line);
@@ -439,69 +318,55 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
                 print_utf8_line("Exiting.");
                 return 0;
             }
+            if (candidate_appid.size() == 1 &&
+                (candidate_appid[0] == 'L' || candidate_appid[0] == 'l') && !library.apps().empty()) {
+                print_installed_apps(library);
+                candidate_appid.clear();
+                continue; // prompt again
+            }
         }
 
-        // ---- Step 2: Validate numeric format ----
+        // ---- Step 2: Validate numeric format, or look the title up ----
+        if (!is_digits_only(candidate_appid) && (catalog.is_open() || !library.apps().empty())) {
+            candidate_appid = pick_app_by_title(candidate_appid, library, catalog);
+            if (candidate_appid.empty()) {
+                continue; // prompt again
+            }
+        }
         if (!is_digits_only(candidate_appid)) {
             print_utf8_line("Error: AppID must contain digits only.");
             candidate_appid.clear();
             continue; // prompt again
         }
 
-        // ---- Step 3: Query Steam Store to check existence ----
-        print_utf8_line("Checking Steam Store for AppID...");
-        string store_response;
-        bool fetched = http_get_appdetails(candidate_appid, store_response);
-
-        if (!fetched) {
-            print_utf8_line("Warning: Could not contact Steam Store (network issue?).");
-            print_utf8("Retry? (Y to retry, N to continue without Store check, Q to quit): ");
-            std::string choice;
-            std::getline(std::cin, choice);
-            if (!choice.empty() && (choice[0] == 'Q' || choice[0] == 'q')) {
-                print_utf8_line("Exiting.");
-                return 0;
-            }
-            if (!choice.empty() && (choice[0] == 'Y' || choice[0] == 'y')) {
-                candidate_appid.clear();
-                continue; // re-prompt or re-check
-            }
-            // If N or anything else, proceed without store validation (Steam API will still fail if invalid)
-        }
-        else {
-            // If fetched, check success flag in the JSON
-            bool exists = resp_indicates_success(store_response, candidate_appid);
-            if (!exists) {
-                print_utf8_line("AppID not found or store reports no data for this AppID.");
-                candidate_appid.clear();
-                continue; // ask again
-            }
-        }
-
-        // Extract name if present (optional, helpful UX)
-        string gamename = extract_game_name(store_response, candidate_appid);
-
-        // ---- Step 4: Try to load steam_api DLL and initialize Steam API ----
-
-        // Ensure Steam uses the correct AppID for this attempt.
-        // Steam reads AppID from:
-        //   - steam_appid.txt
-        //   - SteamAppId environment variable
-        // We explicitly set both to avoid stale state from previous attempts.
-
-        save_appid_to_file(candidate_appid);
-
-        // Clear any previous environment variable and set the new one
-        SetEnvironmentVariableA("SteamAppId", candidate_appid.c_str());
-        SetEnvironmentVariableA("SteamGameId", candidate_appid.c_str());
-
-        // Load the steam_api DLL (prefer 64-bit name first)
-        HMODULE hSteam = LoadLibraryA("steam_api64.dll");
-        if (!hSteam) {
-            hSteam = LoadLibraryA("steam_api.dll");
-        }
-
-        if (!hSteam) {
+        // ---- Step 3: Look the AppID up on the Store while Steam starts ----
+        // IdleSession runs the Store lookup in the background next to the
+        // steam_api load and SteamAPI_Init (see idle_session.h).
+
+        // Steam reads the AppID from steam_appid.txt or the SteamAppId
+        // environment variable; the session sets the variable, and the file
+        // is only rewritten once an AppID actually starts idling.
+        startup.set("appid", candidate_appid);
+
+        IdleSessionConfig session_config;
+        session_config.store_http = store_http.get();
+        session_config.cache = store_cache_ptr;
+        session_config.ledger = ledger_ptr;
+        session_config.refresh_store = opts.refresh_store;
+        session_config.pump = opts.pump;
+        session_config.timings = timings;
+        session_config.watchdog = opts.watchdog;
+        session_config.on_steam_change = [](bool connected, const std::string& detail) {
+            print_utf8_line(connected ? std::string("Steam is back; idling again.") :
+                "Steam connection lost (" + detail + "); reconnecting when the client returns.");
+        };
+        IdleSession session(session_config);
+
+        // ---- Step 4: Load steam_api (first attempt only) and initialize Steam API ----
+        IdleStartResult start_result = session.start(candidate_appid);
+        startup.set("result", idle_start_result_name(start_result));
+
+        if (start_result == IdleStartResult::NoLibrary) {
             print_utf8_line("Error: Could not find steam_api64.dll or steam_api.dll in the current folder.");
             print_utf8("Place the appropriate DLL and press ENTER to retry, or Q to quit: ");
             std::string resp_line;
@@ -511,75 +376,33 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
             }
             // Try again (user may have placed DLL)
             candidate_appid.clear();
-            if (hSteam) {
-                clear_steam_env();
-                FreeLibrary(hSteam);
-            }
             continue;
         }
 
-        // Get function pointers dynamically (we don't link to Steam SDK)
-        typedef bool(__cdecl* SteamAPI_Init_t)();
-        typedef void(__cdecl* SteamAPI_Shutdown_t)();
-        typedef void(__cdecl* SteamAPI_RunCallbacks_t)();
-        typedef bool(__cdecl* SteamAPI_IsSteamRunning_t)();
-        typedef void* (__cdecl* SteamAPI_SteamUser_t)();
-        typedef bool(__cdecl* SteamAPI_ISteamUser_BLoggedOn_t)(void*);
-
-        SteamAPI_Init_t SteamAPI_Init = reinterpret_cast<SteamAPI_Init_t>(GetProcAddress(hSteam, "SteamAPI_Init"));
-        SteamAPI_Shutdown_t SteamAPI_Shutdown = reinterpret_cast<SteamAPI_Shutdown_t>(GetProcAddress(hSteam, "SteamAPI_Shutdown"));
-        SteamAPI_RunCallbacks_t SteamAPI_RunCallbacks = reinterpret_cast<SteamAPI_RunCallbacks_t>(GetProcAddress(hSteam, "SteamAPI_RunCallbacks"));
-
-        if (!SteamAPI_Init) {
-            print_utf8_line("Error: steam_api DLL loaded but SteamAPI_Init not found (incompatible DLL?).");
-            clear_steam_env();
-            FreeLibrary(hSteam);
+        if (start_result == IdleStartResult::BadLibrary) {
+            print_utf8_line("Error: steam_api DLL cannot start Steam (incompatible DLL?): " + session.start_detail() + ".");
             candidate_appid.clear();
             continue;
         }
 
-        // Call SteamAPI_Init while suppressing any noisy internal output
-        bool init_ok = false;
-        suppress_console_output([&]() {
-            init_ok = SteamAPI_Init();
-            });
-
-        if (!init_ok) {
-            bool steam_running = false;
-            bool logged_on = false;
-
-            auto SteamAPI_IsSteamRunning =
-                reinterpret_cast<SteamAPI_IsSteamRunning_t>(
-                    GetProcAddress(hSteam, "SteamAPI_IsSteamRunning"));
-
-            auto SteamAPI_SteamUser =
-                reinterpret_cast<SteamAPI_SteamUser_t>(
-                    GetProcAddress(hSteam, "SteamAPI_SteamUser"));
-
-            auto SteamAPI_ISteamUser_BLoggedOn =
-                reinterpret_cast<SteamAPI_ISteamUser_BLoggedOn_t>(
-                    GetProcAddress(hSteam, "SteamAPI_ISteamUser_BLoggedOn"));
-
-            if (SteamAPI_IsSteamRunning) {
-                steam_running = SteamAPI_IsSteamRunning();
-            }
-
-            if (steam_running && SteamAPI_SteamUser && SteamAPI_ISteamUser_BLoggedOn) {
-                void* user = SteamAPI_SteamUser();
-                if (user) {
-                    logged_on = SteamAPI_ISteamUser_BLoggedOn(user);
-                }
-            }
-
-            if (!steam_running) {
+        if (start_result != IdleStartResult::Idling) {
+            if (start_result == IdleStartResult::SteamNotRunning) {
                 print_wline(L"Steam client is not running with a valid user session.");
                 print_wline(L"Please start Steam and log in before trying again.");
             }
             else {
-                print_wline(L"The AppID appears valid but the game is not owned by the logged-in account.");
+                // We are about to prompt anyway, so wait for the Store to tell
+                // "not owned" apart from "does not exist".
+                StoreLookup store = session.store_result();
+                if (store.fetched && !store.success) {
+                    print_utf8_line("AppID not found or store reports no data for this AppID.");
+                }
+                else {
+                    print_wline(L"The AppID appears valid but the game is not owned by the logged-in account.");
 
-                std::string out = "Cannot execute game \"" + gamename + "\" (AppID " + candidate_appid + ") - Not owned by this Steam account.";
-                print_utf8_line(out);
+                    std::string out = "Cannot execute game \"" + store.name + "\" (AppID " + candidate_appid + ") - Not owned by this Steam account.";
+                    print_utf8_line(out);
+                }
             }
 
             print_utf8("Enter a different AppID to try again, or Q to quit: ");
@@ -589,60 +412,116 @@ int WINAPI WinMain(HINSTANCE hInst, HINSTANCE, LPSTR, int)
             line = trim(line);
 
             if (!line.empty() && (line[0] == 'Q' || line[0] == 'q')) {
-                clear_steam_env();
-                FreeLibrary(hSteam);
                 print_utf8_line("Exiting.");
                 return 0;
             }
 
             candidate_appid = line;
-            clear_steam_env();
-            FreeLibrary(hSteam);
             continue;
         }
 
-        // If we are here, SteamAPI_Init succeeded.
-        // Save the AppID persistently, show friendly message (with UTF handling).
+        // If we are here, SteamAPI_Init succeeded and the callback pump runs.
         save_appid_to_file(candidate_appid);
 
-        if (!gamename.empty()) {
-            std::string out = "Executing game \"" + gamename + "\" (AppID " + candidate_appid + ")...";
+        // ---- Step 5: Join the Store lookup ----
+        // Give a slow Store a moment; if it still has not answered, report
+        // idling now and print the name from a helper thread later. An
+        // installed game already has its name from the local manifest, any
+        // other one from the app catalog when there is one.
+        const InstalledApp* installed = library.find(candidate_appid);
+        std::string local_name = installed ? installed->name : std::string();
+        if (local_name.empty()) {
+            local_name = catalog.name_of(static_cast<uint32_t>(std::strtoul(candidate_appid.c_str(), nullptr, 10)));
+        }
+        bool store_ready = session.wait_store(std::chrono::milliseconds(0));
+        if (!store_ready && local_name.empty()) {
+            ScopedPhase phase(timings, "store.join");
+            print_utf8_line("Checking Steam Store for AppID...");
+            store_ready = session.wait_store(IdleSession::STORE_JOIN_WAIT);
+        }
+
+        std::thread late_name_thread;
+        if (store_ready) {
+            StoreLookup store = session.store_result();
+            if (!store.fetched) {
+                print_utf8_line("Warning: Could not contact Steam Store (network issue?).");
+            }
+            startup.set("store", !store.fetched ? "unreachable" : store.from_cache ? "cache" : "network");
+
+            if (store.success && !store.name.empty()) {
+                std::string out = "Executing game \"" + store.name + "\" (AppID " + candidate_appid + ")...";
+                print_utf8_line(out);
+            }
+            else if (!local_name.empty()) {
+                std::string out = "Executing game \"" + local_name + "\" (AppID " + candidate_appid + ")...";
+                print_utf8_line(out);
+            }
+            else {
+                std::string out = "Executing AppID " + candidate_appid + " (name not found)...";
+                print_utf8_line(out);
+            }
+        }
+        else if (!local_name.empty()) {
+            std::string out = "Executing game \"" + local_name + "\" (AppID " + candidate_appid + ")...";
             print_utf8_line(out);
+            startup.set("store", "local");
         }
         else {
-            std::string out = "Executing AppID " + candidate_appid + " (name not found)...";
+            std::string out = "Executing AppID " + candidate_appid + " (Steam Store has not answered yet)...";
             print_utf8_line(out);
-        }
+            startup.set("store", "pending");
 
-        // Start callback thread and wait for user to press ENTER to stop.
-        std::atomic<bool> running{ true };
-        std::thread callback_thread([&]() {
-            while (running.load()) {
-                if (SteamAPI_RunCallbacks) {
-                    SteamAPI_RunCallbacks();
+            late_name_thread = std::thread([&session, appid = candidate_appid]() {
+                StoreLookup store = session.store_result();
+                if (store.success && !store.name.empty()) {
+                    print_utf8_line("AppID " + appid + " is \"" + store.name + "\".");
                 }
-                std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-            }
             });
+        }
 
-        print_utf8_line("Press ENTER to stop the simulation and exit.");
-        // Wait for user input (this will pause the main thread)
-        std::string dummy;
-        std::getline(std::cin, dummy);
-
-        // Stop callback thread and cleanup Steam API
-        running.store(false);
-        if (callback_thread.joinable()) {
-            callback_thread.join();
+        // ---- Step 6 (--lean): drop what startup needed and trim ----
+        // The Store lookup uses the HTTP client and the cache, so it has to
+        // be over first. With --lean-detach the console goes too.
+        std::string lean_line;
+        if (opts.lean) {
+            ScopedPhase phase(timings, "lean");
+            if (opts.lean_detach) {
+                print_utf8_line("Releasing the console; run taskkill /PID " + std::to_string(platform_current_pid()) +
+                    " (without /F) to stop idling.");
+            }
+            LeanReport lean = enter_lean_idle([&]() {
+                session.store_result();
+                if (late_name_thread.joinable()) {
+                    late_name_thread.join();
+                }
+                store_http.reset();
+                store_cache.close();
+                library = SteamLibraryIndex();
+                catalog.close();
+            }, opts.lean_detach);
+            record_lean_report(startup, lean);
+            lean_line = "Lean idle: " + describe_lean_report(lean) + ".";
         }
 
-        if (SteamAPI_Shutdown) {
-            SteamAPI_Shutdown();
+        // Idling from here on: the startup record is complete.
+        timings_report.write();
+
+        if (!lean_line.empty()) {
+            print_utf8_line(lean_line);
+        }
+        if (!opts.lean_detach) {
+            print_utf8_line("Press ENTER to stop the simulation and exit.");
         }
+        // Wait for user input, or taskkill once detached (this will pause the main thread)
+        wait_for_stop_request();
 
-        clear_steam_env();
-        FreeLibrary(hSteam);
+        // Stop the pump (wakes it immediately) and cleanup Steam API
+        if (late_name_thread.joinable()) {
+            late_name_thread.join();
+        }
+        session.stop();
 
+        print_utf8_line("Callback pump: " + describe_pump_stats(session.pump_stats()) + ".");
         print_utf8_line("Simulation stopped. Exiting.");
         have_valid_setup = true;
     } // end main attempts loop
@@ -0,0 +1,541 @@
+// app_catalog.cpp
+// Offline app catalog: build, map and search. See app_catalog.h.
+
+#include "app_catalog.h"
+#include "json_reader.h"
+#include "platform.h"
+#include "steam_library.h"
+#include "text.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+using std::string;
+using std::string_view;
+
+static const char CATALOG_MAGIC[8] = { 'S', 'S', 'I', 'A', 'P', 'P', 'S', '1' };
+
+namespace {
+
+struct CatalogHeader {
+    char magic[8];
+    uint32_t count;
+    uint32_t entries_offset;
+    uint32_t by_id_offset;
+    uint32_t names_offset;
+    uint32_t names_size;
+    uint32_t folded_offset;
+    uint32_t folded_size;
+    uint32_t reserved[7];
+};
+static_assert(sizeof(CatalogHeader) == 64, "catalog header is 64 bytes");
+
+} // namespace
+
+struct AppCatalog::Entry {
+    uint32_t appid;
+    uint32_t name_offset;     // into the names section
+    uint32_t folded_offset;   // into the folded section
+    uint16_t name_length;
+    uint16_t folded_length;
+};
+static_assert(sizeof(AppCatalog::Entry) == 16, "catalog entries are 16 bytes");
+
+// --------------------------- Folding ---------------------------
+
+// U+00C0..U+00FF and U+0100..U+017F to ASCII letters. '#' stands for "ae" /
+// "ij", '%' for "ss" / "oe", '$' for "th"; '*' keeps the character (x, /).
+static const char LATIN1_FOLD[] =
+    "aaaaaa#ceeeeiiiidnooooo*ouuuuy$%"
+    "aaaaaa#ceeeeiiiidnooooo*ouuuuy$y";
+static const char LATIN_EXT_A_FOLD[] =
+    "aaaaaaccccccccddddeeeeeeeeeegggggggghhhhiiiiiiiiii##jjkkkllllllllll"
+    "nnnnnnnnnoooooo%%rrrrrrssssssssttttttuuuuuuuuuuuuwwyyyzzzzzzs";
+static_assert(sizeof(LATIN1_FOLD) == 64 + 1, "one letter per code point");
+static_assert(sizeof(LATIN_EXT_A_FOLD) == 128 + 1, "one letter per code point");
+
+// Next code point of [p, end); malformed bytes come back as U+FFFD, one byte
+// at a time.
+static char32_t next_code_point(const unsigned char*& p, const unsigned char* end)
+{
+    unsigned c = *p++;
+    if (c < 0x80) return c;
+    size_t len = c >= 0xf0 ? 3 : c >= 0xe0 ? 2 : c >= 0xc0 ? 1 : 0;
+    if (len == 0 || static_cast<size_t>(end - p) < len) return 0xfffd;
+    char32_t cp = c & (0x3f >> len);
+    for (size_t k = 0; k < len; ++k) {
+        if ((p[k] & 0xc0) != 0x80) return 0xfffd;
+        cp = (cp << 6) | (p[k] & 0x3f);
+    }
+    p += len;
+    return cp;
+}
+
+static void append_utf8(string& out, char32_t c)
+{
+    if (c < 0x800) {
+        out += static_cast<char>(0xc0 | (c >> 6));
+    }
+    else if (c < 0x10000) {
+        out += static_cast<char>(0xe0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+    }
+    else {
+        out += static_cast<char>(0xf0 | (c >> 18));
+        out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+    }
+    out += static_cast<char>(0x80 | (c & 0x3f));
+}
+
+string fold_for_search(string_view utf8)
+{
+    string out;
+    out.reserve(utf8.size());
+    bool after_space = true;   // no leading and no repeated spaces
+    auto separator = [&]() {
+        if (!after_space) out += ' ';
+        after_space = true;
+    };
+    auto letter = [&](char c) {
+        out += c;
+        after_space = false;
+    };
+
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(utf8.data());
+    const unsigned char* end = p + utf8.size();
+    while (p < end) {
+        char32_t c = next_code_point(p, end);
+        if (c >= 0xff01 && c <= 0xff5e) {
+            c -= 0xfee0;   // fullwidth ASCII
+        }
+        if (c < 0x80) {
+            if (c >= 'A' && c <= 'Z') letter(static_cast<char>(c + 32));
+            else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) letter(static_cast<char>(c));
+            else separator();
+            continue;
+        }
+        if (c == 0xa9 || c == 0xae || c == 0x2122 || (c >= 0x300 && c <= 0x36f)) {
+            continue;   // (c), (R), TM and combining accents
+        }
+        if (c < 0xc0 || (c >= 0x2000 && c <= 0x206f) || (c >= 0x3000 && c <= 0x3003)) {
+            separator();   // Latin-1 and general punctuation, ideographic space
+            continue;
+        }
+        char mapped = 0;
+        if (c <= 0xff) mapped = LATIN1_FOLD[c - 0xc0];
+        else if (c <= 0x17f) mapped = LATIN_EXT_A_FOLD[c - 0x100];
+        if (mapped == '#') {
+            out += (c == 0x132 || c == 0x133) ? "ij" : "ae";
+            after_space = false;
+        }
+        else if (mapped == '%') {
+            out += (c == 0x152 || c == 0x153) ? "oe" : "ss";
+            after_space = false;
+        }
+        else if (mapped == '$') {
+            out += "th";
+            after_space = false;
+        }
+        else if (mapped && mapped != '*') {
+            letter(mapped);
+        }
+        else {
+            // Greek and Cyrillic capitals to lower case; anything else as is.
+            if (c >= 0x391 && c <= 0x3a9) c += 0x20;
+            else if (c >= 0x410 && c <= 0x42f) c += 0x20;
+            else if (c >= 0x400 && c <= 0x40f) c += 0x50;
+            append_utf8(out, c);
+            after_space = false;
+        }
+    }
+    if (!out.empty() && out.back() == ' ') {
+        out.pop_back();
+    }
+    return out;
+}
+
+// --------------------------- Build ---------------------------
+
+namespace {
+
+struct CatalogItem {
+    uint32_t appid = 0;
+    string name;
+    string folded;
+};
+
+} // namespace
+
+// Every object with a numeric "appid" and a string "name", at any depth.
+static void read_app_list(string_view json, std::vector<CatalogItem>& out)
+{
+    struct Pending {
+        CatalogItem item;
+        bool has_appid = false;
+    };
+    std::vector<Pending> open;   // one per open object
+    string_view key;
+    JsonReader reader(json);
+    for (JsonToken t = reader.next(); t != JsonToken::End && t != JsonToken::Error; t = reader.next()) {
+        switch (t) {
+        case JsonToken::ObjectBegin:
+            open.emplace_back();
+            key = string_view();
+            break;
+        case JsonToken::ObjectEnd:
+            if (!open.empty()) {
+                if (open.back().has_appid && !open.back().item.name.empty()) {
+                    out.push_back(std::move(open.back().item));
+                }
+                open.pop_back();
+            }
+            break;
+        case JsonToken::Key:
+            key = reader.text();
+            continue;
+        case JsonToken::Number:
+            if (key == "appid" && !open.empty()) {
+                uint64_t v = 0;
+                for (char c : reader.text()) {
+                    if (c < '0' || c > '9' || v > 0xffffffffull) break;
+                    v = v * 10 + static_cast<uint64_t>(c - '0');
+                }
+                open.back().item.appid = static_cast<uint32_t>(v);
+                open.back().has_appid = v > 0 && v <= 0xffffffffull;
+            }
+            break;
+        case JsonToken::String:
+            if (key == "name" && !open.empty()) {
+                reader.decode(open.back().item.name);
+                open.back().item.name = trim(open.back().item.name);
+            }
+            break;
+        default:
+            break;
+        }
+        key = string_view();
+    }
+}
+
+template <typename T>
+static void append_pod(string& out, const T& value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+bool build_app_catalog(string_view json, const string& path, CatalogBuildStats& stats, string& error)
+{
+    stats = CatalogBuildStats();
+    std::vector<CatalogItem> items;
+    read_app_list(json, items);
+    stats.apps_read = items.size();
+
+    // Repeated AppIDs: the first one in the file wins.
+    std::stable_sort(items.begin(), items.end(),
+        [](const CatalogItem& a, const CatalogItem& b) { return a.appid < b.appid; });
+    items.erase(std::unique(items.begin(), items.end(),
+        [](const CatalogItem& a, const CatalogItem& b) { return a.appid == b.appid; }), items.end());
+    if (items.empty()) {
+        error = "no apps (objects with \"appid\" and \"name\") in the input";
+        return false;
+    }
+
+    for (auto& item : items) {
+        if (item.name.size() > 0xffff) item.name.resize(0xffff);
+        item.folded = fold_for_search(item.name);
+        if (item.folded.size() > 0xffff) item.folded.resize(0xffff);
+    }
+    // items is in AppID order now: that order is the by_id section.
+    std::vector<uint32_t> order(items.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<uint32_t>(i);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        int cmp = items[a].folded.compare(items[b].folded);
+        return cmp != 0 ? cmp < 0 : items[a].appid < items[b].appid;
+    });
+    std::vector<uint32_t> entry_of(items.size());   // AppID-order index -> entry index
+    for (size_t e = 0; e < order.size(); ++e) entry_of[order[e]] = static_cast<uint32_t>(e);
+
+    size_t names_size = 0, folded_size = 0;
+    for (const auto& item : items) {
+        names_size += item.name.size();
+        folded_size += item.folded.size() + 1;
+    }
+    uint64_t total = sizeof(CatalogHeader) + items.size() * (sizeof(AppCatalog::Entry) + 4) + names_size + folded_size;
+    if (total > 0xffffffffull) {
+        error = "the catalog would be larger than 4 GB";
+        return false;
+    }
+
+    CatalogHeader header = {};
+    std::memcpy(header.magic, CATALOG_MAGIC, sizeof(header.magic));
+    header.count = static_cast<uint32_t>(items.size());
+    header.entries_offset = sizeof(CatalogHeader);
+    header.by_id_offset = header.entries_offset + header.count * static_cast<uint32_t>(sizeof(AppCatalog::Entry));
+    header.names_offset = header.by_id_offset + header.count * 4;
+    header.names_size = static_cast<uint32_t>(names_size);
+    header.folded_offset = header.names_offset + header.names_size;
+    header.folded_size = static_cast<uint32_t>(folded_size);
+
+    string data;
+    data.reserve(static_cast<size_t>(total));
+    append_pod(data, header);
+    uint32_t name_at = 0, folded_at = 0;
+    for (uint32_t i : order) {
+        const CatalogItem& item = items[i];
+        AppCatalog::Entry e;
+        e.appid = item.appid;
+        e.name_offset = name_at;
+        e.folded_offset = folded_at;
+        e.name_length = static_cast<uint16_t>(item.name.size());
+        e.folded_length = static_cast<uint16_t>(item.folded.size());
+        append_pod(data, e);
+        name_at += e.name_length;
+        folded_at += e.folded_length + 1u;
+    }
+    for (uint32_t e : entry_of) {
+        append_pod(data, e);
+    }
+    for (uint32_t i : order) {
+        data += items[i].name;
+    }
+    for (uint32_t i : order) {
+        data += items[i].folded;
+        data += '\n';
+    }
+
+    if (!platform_write_file_atomic(path, data)) {
+        error = "cannot write " + path;
+        return false;
+    }
+    stats.apps_indexed = items.size();
+    stats.file_size = data.size();
+    return true;
+}
+
+// --------------------------- Lookups ---------------------------
+
+bool AppCatalog::open(const string& path)
+{
+    close();
+    if (!file_.open_ro(path) || file_.size() < sizeof(CatalogHeader)) {
+        file_.close();
+        return false;
+    }
+    CatalogHeader h;
+    std::memcpy(&h, file_.data(), sizeof(h));
+    uint64_t size = file_.size();
+    bool valid = std::memcmp(h.magic, CATALOG_MAGIC, sizeof(h.magic)) == 0 && h.count > 0 &&
+        h.entries_offset % 4 == 0 && h.by_id_offset % 4 == 0 &&
+        h.entries_offset + uint64_t(h.count) * sizeof(Entry) <= size &&
+        h.by_id_offset + uint64_t(h.count) * 4 <= size &&
+        h.names_offset + uint64_t(h.names_size) <= size &&
+        h.folded_offset + uint64_t(h.folded_size) <= size;
+    if (!valid) {
+        file_.close();
+        return false;
+    }
+    const unsigned char* base = file_.data();
+    count_ = h.count;
+    entries_ = base + h.entries_offset;
+    by_id_ = base + h.by_id_offset;
+    names_ = reinterpret_cast<const char*>(base + h.names_offset);
+    names_size_ = h.names_size;
+    folded_ = reinterpret_cast<const char*>(base + h.folded_offset);
+    folded_size_ = h.folded_size;
+    return true;
+}
+
+void AppCatalog::close()
+{
+    file_.close();
+    count_ = 0;
+    entries_ = by_id_ = nullptr;
+    names_ = folded_ = nullptr;
+    names_size_ = folded_size_ = 0;
+}
+
+const AppCatalog::Entry& AppCatalog::entry(size_t i) const
+{
+    return reinterpret_cast<const Entry*>(entries_)[i];
+}
+
+// Sections are bounds-checked on open; entries are checked here, so a
+// damaged file yields empty names rather than reads past the mapping.
+string_view AppCatalog::name(const Entry& e) const
+{
+    if (uint64_t(e.name_offset) + e.name_length > names_size_) return string_view();
+    return string_view(names_ + e.name_offset, e.name_length);
+}
+
+string_view AppCatalog::folded(const Entry& e) const
+{
+    if (uint64_t(e.folded_offset) + e.folded_length > folded_size_) return string_view();
+    return string_view(folded_ + e.folded_offset, e.folded_length);
+}
+
+// First entry whose folded name is not less than key.
+size_t AppCatalog::lower_bound(string_view key) const
+{
+    size_t lo = 0, hi = count_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (folded(entry(mid)) < key) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+size_t AppCatalog::find(string_view query, MatchKind kind, std::vector<Match>& out, size_t limit) const
+{
+    size_t before = out.size();
+    string key = fold_for_search(query);
+    if (count_ == 0 || key.empty()) {
+        return 0;
+    }
+
+    if (kind != MatchKind::Substring) {
+        for (size_t i = lower_bound(key); i < count_ && out.size() < limit; ++i) {
+            const Entry& e = entry(i);
+            string_view f = folded(e);
+            if (f.compare(0, key.size(), key) != 0 || (kind == MatchKind::Exact && f.size() != key.size())) {
+                break;
+            }
+            out.push_back(Match{ e.appid, name(e), kind });
+        }
+        return out.size() - before;
+    }
+
+    // One pass over the folded section; each hit is mapped back to its entry
+    // (folded offsets grow with the entry index) and the scan resumes after
+    // that entry's line.
+    string_view all(folded_, folded_size_);
+    size_t pos = 0;
+    while (out.size() < limit && (pos = all.find(key, pos)) != string_view::npos) {
+        size_t lo = 0, hi = count_;
+        while (hi - lo > 1) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (entry(mid).folded_offset <= pos) lo = mid;
+            else hi = mid;
+        }
+        const Entry& e = entry(lo);
+        out.push_back(Match{ e.appid, name(e), kind });
+        pos = size_t(e.folded_offset) + e.folded_length + 1;
+    }
+    return out.size() - before;
+}
+
+std::vector<AppCatalog::Match> AppCatalog::search(string_view query, size_t limit) const
+{
+    std::vector<Match> out;
+    string key = fold_for_search(query);
+    find(query, MatchKind::Exact, out, limit);
+
+    // Prefix matches include the exact ones, substring matches both.
+    std::vector<Match> more;
+    find(query, MatchKind::Prefix, more, limit + out.size());
+    for (const auto& m : more) {
+        if (out.size() >= limit) break;
+        if (fold_for_search(m.name) != key) out.push_back(m);
+    }
+    more.clear();
+    find(query, MatchKind::Substring, more, limit + out.size());
+    for (const auto& m : more) {
+        if (out.size() >= limit) break;
+        if (fold_for_search(m.name).compare(0, key.size(), key) != 0) out.push_back(m);
+    }
+    return out;
+}
+
+string_view AppCatalog::name_of(uint32_t appid) const
+{
+    size_t lo = 0, hi = count_;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        uint32_t index;
+        std::memcpy(&index, by_id_ + mid * 4, sizeof(index));
+        if (index >= count_) return string_view();
+        const Entry& e = entry(index);
+        if (e.appid == appid) return name(e);
+        if (e.appid < appid) lo = mid + 1;
+        else hi = mid;
+    }
+    return string_view();
+}
+
+std::vector<TitleMatch> match_title(string_view title, const SteamLibraryIndex* library, const AppCatalog& catalog,
+    size_t limit)
+{
+    std::vector<TitleMatch> out;
+    string key = fold_for_search(title);
+    if (key.empty()) {
+        return out;
+    }
+    auto listed = [&out](uint32_t appid) {
+        return std::any_of(out.begin(), out.end(), [appid](const TitleMatch& m) { return m.appid == appid; });
+    };
+    if (library) {
+        for (const InstalledApp& app : library->apps()) {
+            if (out.size() >= limit) break;
+            string folded = fold_for_search(app.name);
+            if (folded.find(key) != string::npos) {
+                out.push_back(TitleMatch{ app.appid, app.name, folded == key });
+            }
+        }
+    }
+    for (const auto& m : catalog.search(title, limit)) {
+        if (out.size() >= limit) break;
+        if (!listed(m.appid)) {
+            out.push_back(TitleMatch{ m.appid, string(m.name), m.kind == AppCatalog::MatchKind::Exact });
+        }
+    }
+    return out;
+}
+
+// --------------------------- Command line ---------------------------
+
+int run_find_app(const string& catalog_path, const string& query)
+{
+    AppCatalog catalog;
+    if (!catalog.open(catalog_path)) {
+        print_utf8_line("No app catalog at " + catalog_path + "; build one with --build-catalog <app list JSON>.");
+        return 1;
+    }
+    std::vector<AppCatalog::Match> matches = catalog.search(query, 25);
+    if (matches.empty()) {
+        print_utf8_line("No app matches \"" + query + "\".");
+        return 1;
+    }
+    TextBatch out;
+    for (const auto& m : matches) {
+        out.line("  " + std::to_string(m.appid) + "  " + string(m.name));
+    }
+    return 0;
+}
+
+int run_build_catalog(const string& json_path, const string& catalog_path)
+{
+    MappedFile in;
+    if (!in.open_ro(json_path)) {
+        print_utf8_line("Error: cannot read " + json_path + ".");
+        return 1;
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    CatalogBuildStats stats;
+    string error;
+    bool ok = build_app_catalog(string_view(reinterpret_cast<const char*>(in.data()), in.size()), catalog_path,
+        stats, error);
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (!ok) {
+        print_utf8_line("Error: " + json_path + ": " + error + ".");
+        return 1;
+    }
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "Indexed %zu of %zu app(s) into %s (%.1f MB) in %.0f ms.", stats.apps_indexed,
+        stats.apps_read, catalog_path.c_str(), stats.file_size / 1048576.0, ms);
+    print_utf8_line(buf);
+    return 0;
+}
@@ -0,0 +1,117 @@
+// app_catalog.h
+// Offline catalog of every Steam app, searchable by name, so a game can be
+// picked by title without knowing its AppID or asking the network.
+//
+// The source is a full app list export (ISteamApps/GetAppList or
+// IStoreService/GetAppList JSON: objects with "appid" and "name", hundreds of
+// thousands of them). build_app_catalog() compiles it once into an index file
+// (apps.catalog) that AppCatalog maps read-only, so opening it costs a header
+// check and nothing else. Layout, native byte order:
+//
+//   header   magic, counts and the offsets of the four sections below
+//   entries  16 bytes per app, sorted by folded name (then AppID):
+//            appid, name offset, folded offset, name length, folded length
+//   by_id    entry indices sorted by AppID (name_of)
+//   names    the original UTF-8 names
+//   folded   the folded names, in entry order, each followed by '\n'
+//
+// Names are compared in folded form (fold_for_search): lower case, accents
+// and ligatures reduced to ASCII letters (Pokémon -> pokemon, Straße ->
+// strasse), trademark signs dropped, and punctuation and spaces collapsed to
+// one space, so "counter strike" finds "Counter-Strike". Exact and prefix
+// matches are binary searches over the entries; substring matches are one
+// scan over the folded section, a few MB for the full catalog.
+
+#pragma once
+
+#include "mapped_file.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class SteamLibraryIndex;
+
+// The search form of a name or query (see above).
+std::string fold_for_search(std::string_view utf8);
+
+struct CatalogBuildStats {
+    size_t apps_read = 0;       // objects with an AppID and a name in the input
+    size_t apps_indexed = 0;    // after dropping duplicates and empty names
+    size_t file_size = 0;       // bytes written
+};
+
+// Parse an app list export and write the index to path (atomically, see
+// platform_write_file_atomic). Empty names and repeated AppIDs (the first one
+// wins) are left out. False with error if the input has no apps or the file
+// cannot be written.
+bool build_app_catalog(std::string_view json, const std::string& path, CatalogBuildStats& stats, std::string& error);
+
+class AppCatalog {
+public:
+    enum class MatchKind { Exact, Prefix, Substring };
+
+    struct Match {
+        uint32_t appid = 0;
+        std::string_view name;   // points into the mapped file
+        MatchKind kind = MatchKind::Exact;
+    };
+
+    // Map an index built by build_app_catalog(). False if it is missing or
+    // not a valid index (the catalog then stays empty).
+    bool open(const std::string& path = "apps.catalog");
+    void close();
+
+    bool is_open() const { return count_ > 0; }
+    size_t size() const { return count_; }
+
+    // Append to out the apps whose folded name equals / starts with /
+    // contains the folded query, in folded-name order, until out holds
+    // limit matches. Returns how many were appended.
+    size_t find(std::string_view query, MatchKind kind, std::vector<Match>& out, size_t limit) const;
+
+    // Best matches first: exact, then prefix, then substring matches (each
+    // app once), at most limit in all.
+    std::vector<Match> search(std::string_view query, size_t limit) const;
+
+    // Name of an AppID, empty if the catalog does not list it.
+    std::string_view name_of(uint32_t appid) const;
+
+    // One 16-byte record of the entries section (defined in app_catalog.cpp).
+    struct Entry;
+
+private:
+    const Entry& entry(size_t i) const;
+    std::string_view name(const Entry& e) const;
+    std::string_view folded(const Entry& e) const;
+    size_t lower_bound(std::string_view key) const;
+
+    MappedFile file_;
+    size_t count_ = 0;
+    const unsigned char* entries_ = nullptr;
+    const unsigned char* by_id_ = nullptr;
+    const char* names_ = nullptr;
+    size_t names_size_ = 0;
+    const char* folded_ = nullptr;
+    size_t folded_size_ = 0;
+};
+
+// A title typed by the user, resolved to candidates: installed games whose
+// folded name contains it (library may be null), then catalog.search(), each
+// AppID once, at most limit. exact marks names equal to the title once folded.
+struct TitleMatch {
+    uint32_t appid = 0;
+    std::string name;
+    bool exact = false;
+};
+std::vector<TitleMatch> match_title(std::string_view title, const SteamLibraryIndex* library,
+    const AppCatalog& catalog, size_t limit);
+
+// --find: print the catalog's matches for a title, best first.
+int run_find_app(const std::string& catalog_path, const std::string& query);
+
+// --build-catalog: compile an app list export into catalog_path and report
+// the counts, size and time taken.
+int run_build_catalog(const std::string& json_path, const std::string& catalog_path);
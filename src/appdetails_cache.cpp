@@ -0,0 +1,185 @@
+// appdetails_cache.cpp
+// Memory-mapped appdetails cache. See appdetails_cache.h.
+
+#include "appdetails_cache.h"
+
+#include <cstring>
+
+static const char CACHE_MAGIC[4] = { 'S', 'S', 'I', 'A' };
+static const uint32_t CACHE_VERSION = 1;
+static const uint32_t SLOT_COUNT = 8192;   // power of two; 1 MiB of records
+static const uint32_t PROBE_WINDOW = 16;
+static const size_t NAME_CAPACITY = 108;
+
+static const uint8_t FLAG_SUCCESS = 0x01;
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t record_size;
+    uint8_t reserved[48];
+};
+static_assert(sizeof(CacheHeader) == 64, "cache header layout");
+
+// appid 0 marks an empty slot (no Steam app uses 0).
+// check guards against torn reads: another process may be rewriting the record.
+struct AppDetailsCache::Record {
+    uint32_t appid;
+    uint32_t check;
+    int64_t fetched_at;
+    uint8_t flags;
+    uint8_t name_len;
+    uint8_t reserved[2];
+    char name[NAME_CAPACITY];
+};
+
+// FNV-1a over the record payload (everything but check itself).
+static uint32_t record_check(uint32_t appid, int64_t fetched_at, uint8_t flags, uint8_t name_len, const char* name)
+{
+    uint32_t h = 2166136261u;
+    auto mix = [&h](const void* p, size_t n) {
+        const unsigned char* b = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= b[i];
+            h *= 16777619u;
+        }
+    };
+    mix(&appid, sizeof(appid));
+    mix(&fetched_at, sizeof(fetched_at));
+    mix(&flags, sizeof(flags));
+    mix(&name_len, sizeof(name_len));
+    mix(name, name_len);
+    return h;
+}
+
+static uint32_t appid_hash(uint32_t appid)
+{
+    // Murmur3 finalizer: AppIDs are mostly multiples of 10, spread them out.
+    appid ^= appid >> 16;
+    appid *= 0x85ebca6bu;
+    appid ^= appid >> 13;
+    appid *= 0xc2b2ae35u;
+    appid ^= appid >> 16;
+    return appid;
+}
+
+bool AppDetailsCache::open(const std::string& path)
+{
+    const size_t file_size = sizeof(CacheHeader) + static_cast<size_t>(SLOT_COUNT) * sizeof(Record);
+    slot_count_ = 0;
+    if (!file_.open_rw(path, file_size) || file_.size() < file_size) {
+        file_.close();
+        return false;
+    }
+
+    CacheHeader* header = reinterpret_cast<CacheHeader*>(file_.data());
+    bool valid = std::memcmp(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+        header->version == CACHE_VERSION &&
+        header->slot_count == SLOT_COUNT &&
+        header->record_size == sizeof(Record);
+
+    if (!valid) {
+        // New file or older layout: start over.
+        std::memset(file_.data(), 0, file_size);
+        std::memcpy(header->magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        header->version = CACHE_VERSION;
+        header->slot_count = SLOT_COUNT;
+        header->record_size = sizeof(Record);
+    }
+
+    slot_count_ = SLOT_COUNT;
+    return true;
+}
+
+AppDetailsCache::Record* AppDetailsCache::slot(uint32_t index) const
+{
+    static_assert(sizeof(Record) == 128, "cache record layout");
+    unsigned char* base = file_.data() + sizeof(CacheHeader);
+    return reinterpret_cast<Record*>(base) + (index & (slot_count_ - 1));
+}
+
+bool AppDetailsCache::lookup(uint32_t appid, int64_t now, CachedAppDetails& out) const
+{
+    if (slot_count_ == 0 || appid == 0) {
+        return false;
+    }
+
+    uint32_t start = appid_hash(appid);
+    for (uint32_t i = 0; i < PROBE_WINDOW; ++i) {
+        const Record* r = slot(start + i);
+        if (r->appid == 0) {
+            return false;
+        }
+        if (r->appid != appid) {
+            continue;
+        }
+
+        // Copy before validating so a concurrent writer cannot change the
+        // fields between the check and the use.
+        Record copy;
+        std::memcpy(&copy, r, sizeof(copy));
+        if (copy.appid != appid || copy.name_len > NAME_CAPACITY ||
+            copy.check != record_check(copy.appid, copy.fetched_at, copy.flags, copy.name_len, copy.name)) {
+            return false;
+        }
+
+        bool success = (copy.flags & FLAG_SUCCESS) != 0;
+        int64_t ttl = success ? POSITIVE_TTL : NEGATIVE_TTL;
+        if (now < copy.fetched_at || now - copy.fetched_at > ttl) {
+            return false;
+        }
+
+        out.success = success;
+        out.name.assign(copy.name, copy.name_len);
+        out.fetched_at = copy.fetched_at;
+        return true;
+    }
+    return false;
+}
+
+void AppDetailsCache::store(uint32_t appid, bool success, const std::string& name, int64_t now)
+{
+    if (slot_count_ == 0 || appid == 0) {
+        return;
+    }
+
+    // Pick the slot already holding appid, else the first empty one, else the
+    // stalest record in the probe window.
+    uint32_t start = appid_hash(appid);
+    Record* target = nullptr;
+    Record* stalest = nullptr;
+    for (uint32_t i = 0; i < PROBE_WINDOW; ++i) {
+        Record* r = slot(start + i);
+        if (r->appid == appid || r->appid == 0) {
+            target = r;
+            break;
+        }
+        if (!stalest || r->fetched_at < stalest->fetched_at) {
+            stalest = r;
+        }
+    }
+    if (!target) {
+        target = stalest;
+    }
+
+    // Truncate without splitting a UTF-8 sequence.
+    size_t len = name.size();
+    if (len > NAME_CAPACITY) {
+        len = NAME_CAPACITY;
+        while (len > 0 && (static_cast<unsigned char>(name[len]) & 0xC0) == 0x80) {
+            --len;
+        }
+    }
+
+    Record rec;
+    std::memset(&rec, 0, sizeof(rec));
+    rec.appid = appid;
+    rec.fetched_at = now;
+    rec.flags = success ? FLAG_SUCCESS : 0;
+    rec.name_len = static_cast<uint8_t>(len);
+    std::memcpy(rec.name, name.data(), len);
+    rec.check = record_check(rec.appid, rec.fetched_at, rec.flags, rec.name_len, rec.name);
+
+    std::memcpy(target, &rec, sizeof(rec));
+}
@@ -0,0 +1,53 @@
+// appdetails_cache.h
+// Persistent cache of Store appdetails results, keyed by AppID.
+//
+// The cache is a fixed-size memory-mapped file (appdetails.cache): a small header
+// followed by 128-byte records in an open-addressed table. A lookup hashes the
+// AppID and checks at most PROBE_WINDOW consecutive records - no parsing, no
+// allocation besides copying the name out. When every record in a window is
+// taken, the stalest one is overwritten, so the file never grows.
+//
+// Both "found" and "not found" answers are cached; negative entries expire
+// sooner so a newly published AppID is picked up quickly. Network failures are
+// never cached.
+
+#pragma once
+
+#include "mapped_file.h"
+
+#include <cstdint>
+#include <string>
+
+struct CachedAppDetails {
+    bool success = false;    // Store reported "success": true
+    std::string name;        // game name (may be empty)
+    int64_t fetched_at = 0;  // unix seconds
+};
+
+class AppDetailsCache {
+public:
+    static const int64_t POSITIVE_TTL = 7 * 24 * 3600; // 7 days
+    static const int64_t NEGATIVE_TTL = 24 * 3600;     // 1 day
+
+    // Open (creating if needed) the cache file. Returns false if the file cannot
+    // be mapped; the cache then behaves as always-miss.
+    bool open(const std::string& path = "appdetails.cache");
+
+    // Unmap the file; the cache behaves as always-miss until opened again.
+    void close() { file_.close(); slot_count_ = 0; }
+
+    // Return true and fill out if a fresh entry exists for appid.
+    bool lookup(uint32_t appid, int64_t now, CachedAppDetails& out) const;
+
+    // Insert or replace the entry for appid. Names longer than the record can
+    // hold are truncated on a UTF-8 character boundary.
+    void store(uint32_t appid, bool success, const std::string& name, int64_t now);
+
+private:
+    struct Record;
+
+    Record* slot(uint32_t index) const;
+
+    MappedFile file_;
+    uint32_t slot_count_ = 0;
+};
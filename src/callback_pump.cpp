@@ -0,0 +1,130 @@
+// callback_pump.cpp
+// Adaptive callback pump. See callback_pump.h.
+
+#include "callback_pump.h"
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using std::string;
+
+CallbackPump::CallbackPump(std::function<void()> callback, const PumpOptions& opts, std::function<bool()> before)
+    : callback_(std::move(callback)), before_(std::move(before)), opts_(opts)
+{
+    opts_.fast_tick_ms = std::max(1u, opts_.fast_tick_ms);
+    opts_.idle_tick_ms = std::max(opts_.fast_tick_ms, opts_.idle_tick_ms);
+}
+
+CallbackPump::~CallbackPump()
+{
+    stop();
+}
+
+void CallbackPump::start()
+{
+    if (thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = false;
+        stats_ = PumpStats();
+    }
+    thread_ = std::thread(&CallbackPump::run, this);
+}
+
+void CallbackPump::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_requested_ = true;
+    }
+    wake_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+PumpStats CallbackPump::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+static std::uint64_t elapsed_us(std::chrono::steady_clock::duration d)
+{
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+    return us > 0 ? static_cast<std::uint64_t>(us) : 0;
+}
+
+void CallbackPump::run()
+{
+    const Clock::time_point started = Clock::now();
+    const auto fast_period = std::chrono::milliseconds(opts_.fast_period_ms);
+    unsigned interval_ms = opts_.fast_tick_ms;
+    Clock::time_point deadline = started;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_requested_) {
+        Clock::time_point woke = Clock::now();
+        std::uint64_t drift = elapsed_us(woke - deadline);
+
+        lock.unlock();
+        bool run_callback = !before_ || before_();
+        Clock::time_point called = Clock::now();
+        if (run_callback && callback_) {
+            callback_();
+        }
+        Clock::time_point done = Clock::now();
+        lock.lock();
+
+        std::uint64_t took = elapsed_us(done - called);
+        metrics_pump_tick(took, drift);
+        ++stats_.ticks;
+        stats_.callback_total_us += took;
+        stats_.callback_max_us = std::max(stats_.callback_max_us, took);
+        stats_.drift_total_us += drift;
+        stats_.drift_max_us = std::max(stats_.drift_max_us, drift);
+
+        // Fast during the settle period, then double up to the idle rate.
+        if (done - started >= fast_period && interval_ms < opts_.idle_tick_ms) {
+            interval_ms = std::min(interval_ms * 2, opts_.idle_tick_ms);
+        }
+        stats_.interval_ms = interval_ms;
+
+        // Fixed-rate schedule; if a tick overran, restart from now rather
+        // than firing a burst of catch-up ticks.
+        deadline += std::chrono::milliseconds(interval_ms);
+        if (deadline < done) {
+            deadline = done + std::chrono::milliseconds(interval_ms);
+        }
+        wake_.wait_until(lock, deadline, [this]() { return stop_requested_; });
+    }
+}
+
+string describe_pump_stats(const PumpStats& stats)
+{
+    if (stats.ticks == 0) {
+        return "no ticks";
+    }
+    char buf[160];
+    std::snprintf(buf, sizeof(buf),
+        "%llu ticks, RunCallbacks avg %llu us (max %llu us), drift avg %.1f ms (max %.1f ms)",
+        static_cast<unsigned long long>(stats.ticks),
+        static_cast<unsigned long long>(stats.callback_total_us / stats.ticks),
+        static_cast<unsigned long long>(stats.callback_max_us),
+        stats.drift_total_us / 1000.0 / stats.ticks,
+        stats.drift_max_us / 1000.0);
+    return buf;
+}
+
+void merge_pump_stats(PumpStats& a, const PumpStats& b)
+{
+    a.ticks += b.ticks;
+    a.callback_total_us += b.callback_total_us;
+    a.callback_max_us = std::max(a.callback_max_us, b.callback_max_us);
+    a.drift_total_us += b.drift_total_us;
+    a.drift_max_us = std::max(a.drift_max_us, b.drift_max_us);
+    a.interval_ms = std::max(a.interval_ms, b.interval_ms);
+}
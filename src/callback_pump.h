@@ -0,0 +1,81 @@
+// callback_pump.h
+// Background thread that calls SteamAPI_RunCallbacks on an adaptive tick.
+//
+// The pump sleeps on a condition variable rather than a plain sleep, so stop()
+// wakes it immediately instead of waiting out the current tick. Right after
+// start() it ticks fast (Steam delivers most callbacks just after init), then
+// doubles the interval on every tick until it reaches the idle rate.
+//
+// Every tick records how long the callback took and how late the thread woke
+// up compared to its deadline (drift), so the cost of the pump can be checked
+// across many worker processes. Housekeeping that shares the thread (health
+// checks, ledger heartbeats) goes in the optional "before" function, which is
+// not timed: the callback figures are RunCallbacks alone.
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct PumpOptions {
+    unsigned fast_tick_ms = 100;     // interval right after start()
+    unsigned idle_tick_ms = 1000;    // interval once settled
+    unsigned fast_period_ms = 5000;  // how long to stay at fast_tick_ms
+};
+
+struct PumpStats {
+    std::uint64_t ticks = 0;
+    std::uint64_t callback_total_us = 0;  // time spent inside the callback
+    std::uint64_t callback_max_us = 0;
+    std::uint64_t drift_total_us = 0;     // wake-up time minus deadline
+    std::uint64_t drift_max_us = 0;
+    unsigned interval_ms = 0;             // current tick interval
+};
+
+class CallbackPump {
+public:
+    // callback runs every tick and is timed. before, when set, runs first,
+    // untimed; when it returns false the callback is skipped for that tick
+    // (counted with no callback time).
+    CallbackPump(std::function<void()> callback, const PumpOptions& opts,
+        std::function<bool()> before = std::function<bool()>());
+    ~CallbackPump();
+
+    CallbackPump(const CallbackPump&) = delete;
+    CallbackPump& operator=(const CallbackPump&) = delete;
+
+    // Start the pump thread (the first tick runs immediately).
+    void start();
+
+    // Wake the thread and wait for it to exit. Safe to call more than once.
+    void stop();
+
+    // Copy of the counters so far.
+    PumpStats stats() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    void run();
+
+    std::function<void()> callback_;
+    std::function<bool()> before_;
+    PumpOptions opts_;
+    std::thread thread_;
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_requested_ = false;
+    PumpStats stats_;
+};
+
+// One-line summary, e.g.
+// "1234 ticks, RunCallbacks avg 12 us (max 850 us), drift avg 0.4 ms (max 3.1 ms)".
+std::string describe_pump_stats(const PumpStats& stats);
+
+// Fold b into a (ticks and totals add up, maxima are kept).
+void merge_pump_stats(PumpStats& a, const PumpStats& b);
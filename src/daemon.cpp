@@ -0,0 +1,348 @@
+// daemon.cpp
+// Daemon mode and its command-line client. See daemon.h.
+
+#include "daemon.h"
+#include "platform.h"
+#include "supervisor.h"
+#include "util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+// Accept / read wait: how quickly the daemon notices a stop request, and how
+// often it polls its workers.
+static const unsigned WAIT_SLICE_MS = 250;
+
+// Concurrent control connections; orchestrators need one or two.
+static const size_t MAX_CONNECTIONS = 16;
+
+// Longest accepted command line.
+static const size_t MAX_COMMAND = 1024;
+
+// How long --ctl waits for the answer (stop may wait for a slow SteamAPI_Shutdown).
+static const unsigned CLIENT_TIMEOUT_MS = 30000;
+
+// --------------------------- Replies ---------------------------
+
+static long long seconds_since(Clock::time_point t)
+{
+    return std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - t).count();
+}
+
+static string error_reply(const string& error, const string& appid = string())
+{
+    string out = "{\"ok\":false";
+    if (!appid.empty()) {
+        out += ",\"appid\":";
+        append_json_string(out, appid);
+    }
+    out += ",\"error\":";
+    append_json_string(out, error);
+    out += '}';
+    return out;
+}
+
+static void append_worker(string& out, const WorkerStatus& w)
+{
+    out += "{\"appid\":";
+    append_json_string(out, w.appid);
+    out += ",\"state\":";
+    append_json_string(out, worker_state_name(w.state));
+    out += ",\"pid\":" + std::to_string(w.pid);
+    out += ",\"restarts\":" + std::to_string(w.restarts);
+    out += ",\"state_s\":" + std::to_string(seconds_since(w.since));
+    if (w.start_ms >= 0) {
+        out += ",\"start_ms\":" + std::to_string(static_cast<long long>(w.start_ms + 0.5));
+        out += w.warm_start ? ",\"warm_start\":true" : ",\"warm_start\":false";
+    }
+    if (w.last_exit_code != -1) {
+        out += ",\"last_exit\":" + std::to_string(w.last_exit_code) + ",\"exit_reason\":";
+        append_json_string(out, worker_exit_reason(w.last_exit_code));
+    }
+    out += '}';
+}
+
+// --------------------------- Commands ---------------------------
+
+struct DaemonState {
+    Supervisor* supervisor = nullptr;
+    Clock::time_point started;
+    std::atomic<bool> stop{ false };
+};
+
+static string command_start(DaemonState& state, const string& appid)
+{
+    if (!is_digits_only(appid)) {
+        return error_reply("AppID must contain digits only", appid);
+    }
+    switch (state.supervisor->add(appid)) {
+    case Supervisor::AddResult::AlreadyAdded:
+        return error_reply("already started", appid);
+    case Supervisor::AddResult::Full:
+        return error_reply("Steam allows at most " + std::to_string(Supervisor::MAX_WORKERS) +
+            " games at once", appid);
+    case Supervisor::AddResult::Added:
+        break;
+    }
+    for (const auto& w : state.supervisor->snapshot()) {
+        if (w.appid == appid) {
+            string out = "{\"ok\":true,\"appid\":";
+            append_json_string(out, appid);
+            out += ",\"state\":";
+            append_json_string(out, worker_state_name(w.state));
+            out += ",\"pid\":" + std::to_string(w.pid) + '}';
+            return out;
+        }
+    }
+    return error_reply("stopped while starting", appid);
+}
+
+static string command_stop(DaemonState& state, const string& appid)
+{
+    if (!state.supervisor->remove(appid)) {
+        return error_reply("not started", appid);
+    }
+    string out = "{\"ok\":true,\"appid\":";
+    append_json_string(out, appid);
+    out += '}';
+    return out;
+}
+
+static string command_list(DaemonState& state)
+{
+    string out = "{\"ok\":true,\"apps\":[";
+    std::vector<WorkerStatus> workers = state.supervisor->snapshot();
+    for (size_t i = 0; i < workers.size(); ++i) {
+        if (i) out += ',';
+        append_worker(out, workers[i]);
+    }
+    out += "]}";
+    return out;
+}
+
+static string command_status(DaemonState& state)
+{
+    std::vector<WorkerStatus> workers = state.supervisor->snapshot();
+    int running = 0, starting = 0, backing_off = 0, failed = 0, restarts = 0;
+    for (const auto& w : workers) {
+        switch (w.state) {
+        case WorkerState::Running: ++running; break;
+        case WorkerState::Starting: ++starting; break;
+        case WorkerState::BackingOff: ++backing_off; break;
+        case WorkerState::Failed: ++failed; break;
+        }
+        restarts += w.restarts;
+    }
+    PumpStats pump = state.supervisor->pump_totals();
+
+    string out = "{\"ok\":true,\"pid\":" + std::to_string(platform_current_pid());
+    out += ",\"uptime_s\":" + std::to_string(seconds_since(state.started));
+    out += ",\"apps\":" + std::to_string(workers.size());
+    out += ",\"running\":" + std::to_string(running);
+    out += ",\"starting\":" + std::to_string(starting);
+    out += ",\"backing_off\":" + std::to_string(backing_off);
+    out += ",\"failed\":" + std::to_string(failed);
+    out += ",\"restarts\":" + std::to_string(restarts);
+    out += ",\"standby\":" + std::to_string(state.supervisor->standby_count());
+    out += ",\"pump\":{\"ticks\":" + std::to_string(pump.ticks);
+    out += ",\"callback_total_us\":" + std::to_string(pump.callback_total_us);
+    out += ",\"callback_max_us\":" + std::to_string(pump.callback_max_us);
+    out += ",\"drift_total_us\":" + std::to_string(pump.drift_total_us);
+    out += ",\"drift_max_us\":" + std::to_string(pump.drift_max_us) + "}}";
+    return out;
+}
+
+// One command line in, one JSON line out (without the newline).
+static string handle_command(DaemonState& state, const string& line)
+{
+    size_t space = line.find(' ');
+    string verb = line.substr(0, space);
+    string arg = space == string::npos ? string() : trim(line.substr(space + 1));
+
+    if (verb == "start" || verb == "stop") {
+        if (arg.empty()) {
+            return error_reply(verb + " needs an AppID");
+        }
+        return verb == "start" ? command_start(state, arg) : command_stop(state, arg);
+    }
+    if (verb == "list") {
+        return command_list(state);
+    }
+    if (verb == "status") {
+        return command_status(state);
+    }
+    if (verb == "shutdown") {
+        state.stop = true;
+        return "{\"ok\":true}";
+    }
+    return error_reply("unknown command \"" + verb + "\" (start, stop, list, status, shutdown)");
+}
+
+// --------------------------- Connections ---------------------------
+
+struct Connection {
+    platform_handle conn = PLATFORM_NO_HANDLE;
+    std::thread thread;
+    std::atomic<bool> done{ false };
+};
+
+static void serve_connection(DaemonState& state, Connection& c)
+{
+    string pending;
+    char buf[512];
+    while (!state.stop) {
+        long got = platform_read_local(c.conn, buf, sizeof(buf), WAIT_SLICE_MS);
+        if (got < 0) {
+            break;
+        }
+        pending.append(buf, static_cast<size_t>(got));
+
+        bool open = true;
+        size_t nl;
+        while (open && (nl = pending.find('\n')) != string::npos) {
+            string line = trim(pending.substr(0, nl));
+            pending.erase(0, nl + 1);
+            if (line.empty()) {
+                continue;
+            }
+            string reply = handle_command(state, line) + '\n';
+            open = platform_write_local(c.conn, reply.data(), reply.size());
+        }
+        if (open && pending.size() > MAX_COMMAND) {
+            string reply = error_reply("command too long") + '\n';
+            platform_write_local(c.conn, reply.data(), reply.size());
+            open = false;
+        }
+        if (!open) {
+            break;
+        }
+    }
+    platform_close(c.conn);
+    c.done = true;
+}
+
+// Join connection threads that have finished (all of them when everything is).
+static void reap_connections(std::vector<std::unique_ptr<Connection>>& connections, bool everything)
+{
+    for (auto it = connections.begin(); it != connections.end();) {
+        if (everything || (*it)->done) {
+            (*it)->thread.join();
+            it = connections.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+// --------------------------- Daemon ---------------------------
+
+int run_daemon(const string& endpoint, const WorkerOptions& opts)
+{
+    string exe_path = platform_executable_path();
+    if (exe_path.empty()) {
+        print_utf8_line("Error: could not determine the executable path.");
+        return 1;
+    }
+
+    LocalListener listener;
+    string error;
+    if (!platform_listen_local(endpoint, listener, error)) {
+        print_utf8_line("Error: " + error);
+        return 1;
+    }
+
+    Supervisor supervisor(exe_path, [](const string& line) { print_utf8_line(line); },
+        worker_arguments(opts));
+    supervisor.keep_standby(opts.standby);
+
+    DaemonState state;
+    state.supervisor = &supervisor;
+    state.started = Clock::now();
+    print_utf8_line("Daemon listening on " + endpoint + " (pid " + std::to_string(platform_current_pid()) + ").");
+
+    // The accept wait doubles as the worker poll interval.
+    std::vector<std::unique_ptr<Connection>> connections;
+    while (!state.stop) {
+        platform_handle client = PLATFORM_NO_HANDLE;
+        int accepted = platform_accept_local(listener, WAIT_SLICE_MS, client);
+        if (accepted < 0) {
+            print_utf8_line("Error: the control endpoint stopped accepting connections.");
+            state.stop = true;
+            break;
+        }
+        reap_connections(connections, false);
+        if (accepted > 0) {
+            if (connections.size() >= MAX_CONNECTIONS) {
+                string reply = error_reply("too many connections") + '\n';
+                platform_write_local(client, reply.data(), reply.size());
+                platform_close(client);
+            }
+            else {
+                std::unique_ptr<Connection> c(new Connection());
+                c->conn = client;
+                Connection* raw = c.get();
+                c->thread = std::thread([&state, raw]() { serve_connection(state, *raw); });
+                connections.push_back(std::move(c));
+            }
+        }
+        supervisor.poll();
+        if (poll_stop_request()) {
+            state.stop = true;
+        }
+    }
+
+    platform_close_listener(listener);
+    reap_connections(connections, true);
+
+    print_utf8_line("Stopping workers...");
+    supervisor.stop_all();
+    print_utf8_line("Callback pumps: " + describe_pump_stats(supervisor.pump_totals()) + ".");
+    print_utf8_line("Daemon stopped.");
+    return 0;
+}
+
+// --------------------------- Client ---------------------------
+
+int run_control_command(const string& endpoint, const string& command)
+{
+    platform_handle conn = PLATFORM_NO_HANDLE;
+    if (!platform_connect_local(endpoint, conn)) {
+        std::fprintf(stderr, "Error: no daemon is listening on %s.\n", endpoint.c_str());
+        return 1;
+    }
+
+    string request = trim(command) + '\n';
+    string reply;
+    bool ok = platform_write_local(conn, request.data(), request.size());
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(CLIENT_TIMEOUT_MS);
+    char buf[4096];
+    while (ok && reply.find('\n') == string::npos && Clock::now() < deadline) {
+        long got = platform_read_local(conn, buf, sizeof(buf), WAIT_SLICE_MS);
+        if (got < 0) {
+            break;
+        }
+        reply.append(buf, static_cast<size_t>(got));
+    }
+    platform_close(conn);
+
+    size_t nl = reply.find('\n');
+    if (nl == string::npos) {
+        std::fprintf(stderr, "Error: no answer from the daemon.\n");
+        return 1;
+    }
+    reply.erase(nl);
+    std::printf("%s\n", reply.c_str());
+    std::fflush(stdout);
+    return reply.compare(0, 11, "{\"ok\":true,") == 0 || reply == "{\"ok\":true}" ? 0 : 1;
+}
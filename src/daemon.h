@@ -0,0 +1,36 @@
+// daemon.h
+// Daemon mode: no console, no prompts. A Supervisor (one worker process per
+// AppID, see supervisor.h) driven over a local control endpoint, so one
+// orchestrator can start and stop many idle sessions without screen-scraping.
+//
+// The endpoint is a named pipe on Windows and a Unix domain socket elsewhere
+// (platform_default_control_endpoint(), or --endpoint). Clients send one
+// command per line and get exactly one compact JSON object per line back:
+//
+//   start <appid>   {"ok":true,"appid":"440","state":"starting","pid":4242}
+//   stop <appid>    {"ok":true,"appid":"440"}
+//   list            {"ok":true,"apps":[{"appid":"440","state":"running","pid":4242,
+//                    "restarts":0,"state_s":37,"start_ms":41,"warm_start":true}, ...]}
+//   status          {"ok":true,"pid":4100,"uptime_s":3600,"apps":3,"running":2,
+//                    "starting":0,"backing_off":0,"failed":1,"restarts":4,"standby":2,
+//                    "pump":{...}}
+//   shutdown        {"ok":true}, then every worker is stopped and the daemon exits
+//
+// Failures are {"ok":false,"error":"..."} (plus "appid" when there is one).
+// A worker that stopped has "last_exit" and "exit_reason" in list entries.
+// The daemon also stops on SIGINT / SIGTERM / SIGHUP where those exist.
+
+#pragma once
+
+#include "supervisor.h"
+
+#include <string>
+
+// --daemon: serve the control endpoint until "shutdown" (or a stop signal).
+// opts are passed on to every worker; opts.standby workers are kept ready
+// so "start" after "stop" (switching games) does not wait for a new process. Returns a process exit code.
+int run_daemon(const std::string& endpoint, const WorkerOptions& opts);
+
+// --ctl <command>: send one command to a running daemon and print its reply.
+// Returns 0 if the daemon answered "ok":true, 1 otherwise.
+int run_control_command(const std::string& endpoint, const std::string& command);
@@ -0,0 +1,453 @@
+// dashboard.cpp
+// Live worker table with diff-based redraw. See dashboard.h.
+
+#include "dashboard.h"
+#include "platform.h"
+#include "text.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+const std::chrono::seconds Dashboard::SNAPSHOT_INTERVAL(30);
+
+// Plain snapshots are not tied to a terminal; this wide is enough for long
+// names and errors.
+static const unsigned PLAIN_COLS = 110;
+
+// A running worker whose pump has not been seen ticking for this long gets its
+// "last tick" highlighted. Workers report every few seconds under the
+// dashboard (see worker_options in options.cpp).
+static const std::chrono::seconds STALE_TICK(15);
+
+// Fixed column widths; name and error share what is left of the row.
+static const unsigned APPID_COLS = 8;
+static const unsigned STATE_COLS = 12;
+static const unsigned UPTIME_COLS = 10;
+static const unsigned TICK_COLS = 10;
+
+// --------------------------- Cell widths ---------------------------
+
+unsigned char_width(char32_t c)
+{
+    if (c == 0x200b || (c >= 0x200c && c <= 0x200f) || (c >= 0x0300 && c <= 0x036f) ||
+        (c >= 0x1ab0 && c <= 0x1aff) || (c >= 0x20d0 && c <= 0x20ff) || (c >= 0xfe00 && c <= 0xfe0f) ||
+        (c >= 0xfe20 && c <= 0xfe2f) || (c >= 0xe0100 && c <= 0xe01ef)) {
+        return 0;
+    }
+    if ((c >= 0x1100 && c <= 0x115f) || c == 0x2329 || c == 0x232a ||
+        (c >= 0x2e80 && c <= 0xa4cf && c != 0x303f) || (c >= 0xac00 && c <= 0xd7a3) ||
+        (c >= 0xf900 && c <= 0xfaff) || (c >= 0xfe30 && c <= 0xfe4f) || (c >= 0xff00 && c <= 0xff60) ||
+        (c >= 0xffe0 && c <= 0xffe6) || (c >= 0x1f300 && c <= 0x1f64f) || (c >= 0x1f900 && c <= 0x1f9ff) ||
+        (c >= 0x20000 && c <= 0x3fffd)) {
+        return 2;
+    }
+    return 1;
+}
+
+// --------------------------- ScreenBuffer ---------------------------
+
+void ScreenBuffer::reset(unsigned rows, unsigned cols)
+{
+    rows_ = rows;
+    cols_ = cols;
+    cells_.assign(static_cast<size_t>(rows) * cols, Cell());
+}
+
+unsigned ScreenBuffer::put(unsigned row, unsigned col, const string& utf8, Attr attr, unsigned max_cols)
+{
+    if (row >= rows_ || col >= cols_) {
+        return 0;
+    }
+    unsigned end = col + std::min(max_cols, cols_ - col);
+
+    thread_local std::u16string units;
+    units.clear();
+    append_utf8_as_utf16(utf8.data(), utf8.size(), units);
+
+    unsigned x = col;
+    for (size_t i = 0; i < units.size() && x < end; ++i) {
+        char32_t c = units[i];
+        if (c >= 0xd800 && c <= 0xdbff && i + 1 < units.size()) {
+            c = 0x10000 + ((c - 0xd800) << 10) + (units[++i] - 0xdc00);
+        }
+        if (c < 0x20 || c == 0x7f) {
+            c = U' ';
+        }
+        unsigned w = char_width(c);
+        if (w == 0) {
+            continue;   // a cell holds one character; marks are dropped
+        }
+        if (x + w > end) {
+            break;
+        }
+        Cell* cell = &cells_[static_cast<size_t>(row) * cols_ + x];
+        cell[0].ch = c;
+        cell[0].attr = attr;
+        if (w == 2) {
+            cell[1].ch = 0;
+            cell[1].attr = attr;
+        }
+        x += w;
+    }
+    return x - col;
+}
+
+static void append_code_point(string& out, char32_t c)
+{
+    if (c < 0x80) {
+        out += static_cast<char>(c);
+    }
+    else if (c < 0x800) {
+        out += static_cast<char>(0xc0 | (c >> 6));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+    else if (c < 0x10000) {
+        out += static_cast<char>(0xe0 | (c >> 12));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+    else {
+        out += static_cast<char>(0xf0 | (c >> 18));
+        out += static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+        out += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        out += static_cast<char>(0x80 | (c & 0x3f));
+    }
+}
+
+static const char* sgr(uint8_t attr)
+{
+    switch (attr) {
+    case ScreenBuffer::Bold: return "\x1b[0;1m";
+    case ScreenBuffer::Dim: return "\x1b[0;2m";
+    case ScreenBuffer::Green: return "\x1b[0;32m";
+    case ScreenBuffer::Yellow: return "\x1b[0;33m";
+    case ScreenBuffer::Red: return "\x1b[0;31m";
+    default: return "\x1b[0m";
+    }
+}
+
+void ScreenBuffer::diff(const ScreenBuffer& shown, string& out) const
+{
+    // Unchanged cells cheaper to rewrite than to skip with a new cursor move.
+    const unsigned MERGE_GAP = 6;
+
+    uint8_t attr = Plain;
+    char move[32];
+    for (unsigned r = 0; r < rows_; ++r) {
+        unsigned c = 0;
+        while (c < cols_) {
+            if (at(r, c) == shown.at(r, c)) {
+                ++c;
+                continue;
+            }
+            // A run of changes: from the start of the character at c to the
+            // last change followed by MERGE_GAP unchanged cells.
+            unsigned start = c;
+            while (start > 0 && (at(r, start).ch == 0 || shown.at(r, start).ch == 0)) {
+                --start;
+            }
+            unsigned end = c + 1, same = 0;
+            for (unsigned x = end; x < cols_ && same < MERGE_GAP; ++x) {
+                if (at(r, x) == shown.at(r, x)) {
+                    ++same;
+                }
+                else {
+                    same = 0;
+                    end = x + 1;
+                }
+            }
+            while (end < cols_ && (at(r, end).ch == 0 || shown.at(r, end).ch == 0)) {
+                ++end;
+            }
+
+            std::snprintf(move, sizeof(move), "\x1b[%u;%uH", r + 1, start + 1);
+            out += move;
+            for (unsigned x = start; x < end; ++x) {
+                const Cell& cell = at(r, x);
+                if (cell.ch == 0) {
+                    continue;
+                }
+                if (cell.attr != attr) {
+                    out += sgr(cell.attr);
+                    attr = cell.attr;
+                }
+                append_code_point(out, cell.ch);
+            }
+            c = end;
+        }
+    }
+    if (attr != Plain) {
+        out += sgr(Plain);
+    }
+}
+
+void ScreenBuffer::append_text(string& out) const
+{
+    for (unsigned r = 0; r < rows_; ++r) {
+        size_t line_start = out.size();
+        size_t keep = line_start;
+        for (unsigned c = 0; c < cols_; ++c) {
+            char32_t ch = at(r, c).ch;
+            if (ch == 0) {
+                continue;
+            }
+            append_code_point(out, ch);
+            if (ch != U' ') {
+                keep = out.size();
+            }
+        }
+        out.resize(keep);
+        out += '\n';
+    }
+}
+
+int ScreenBuffer::last_used_row() const
+{
+    for (unsigned r = rows_; r-- > 0;) {
+        for (unsigned c = 0; c < cols_; ++c) {
+            if (at(r, c).ch != U' ') {
+                return static_cast<int>(r);
+            }
+        }
+    }
+    return -1;
+}
+
+// --------------------------- Dashboard ---------------------------
+
+// "0:04:09", "27:13:50"; "3d 04:13" from a day on.
+static string describe_uptime(Clock::duration d)
+{
+    long long s = std::chrono::duration_cast<std::chrono::seconds>(d).count();
+    char buf[32];
+    if (s >= 86400) {
+        std::snprintf(buf, sizeof(buf), "%lldd %02lld:%02lld", s / 86400, s / 3600 % 24, s / 60 % 60);
+    }
+    else {
+        std::snprintf(buf, sizeof(buf), "%lld:%02lld:%02lld", s / 3600, s / 60 % 60, s % 60);
+    }
+    return buf;
+}
+
+// "2s ago", "5m ago", "3h ago".
+static string describe_age(Clock::duration d)
+{
+    long long s = std::chrono::duration_cast<std::chrono::seconds>(d).count();
+    if (s < 100) return std::to_string(s) + "s ago";
+    if (s < 6000) return std::to_string(s / 60) + "m ago";
+    return std::to_string(s / 3600) + "h ago";
+}
+
+static ScreenBuffer::Attr state_attr(WorkerState state)
+{
+    switch (state) {
+    case WorkerState::Running: return ScreenBuffer::Green;
+    case WorkerState::Failed: return ScreenBuffer::Red;
+    default: return ScreenBuffer::Yellow;
+    }
+}
+
+Dashboard::Dashboard(const string& title, const string& steam_dir)
+    : title_(title)
+{
+    live_ = platform_enable_ansi_output();
+    library_.load(steam_dir);
+    cache_.open();
+    next_frame_ = Clock::now();
+}
+
+Dashboard::~Dashboard()
+{
+    finish();
+}
+
+void Dashboard::event(const string& line)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!live_ || finished_) {
+        lock.unlock();
+        print_utf8_line(line);
+        return;
+    }
+    char stamp[16] = "";
+    std::time_t now = std::time(nullptr);
+    if (const std::tm* local = std::localtime(&now)) {
+        std::strftime(stamp, sizeof(stamp), "%H:%M:%S ", local);
+    }
+    events_.push_back(stamp + line);
+    if (events_.size() > MAX_EVENTS) {
+        events_.pop_front();
+    }
+}
+
+const string& Dashboard::name_of(const string& appid)
+{
+    auto it = names_.find(appid);
+    if (it != names_.end()) {
+        return it->second;
+    }
+    string name;
+    if (const InstalledApp* app = library_.find(appid)) {
+        name = app->name;
+    }
+    else {
+        CachedAppDetails cached;
+        uint32_t id = static_cast<uint32_t>(std::strtoul(appid.c_str(), nullptr, 10));
+        if (cache_.lookup(id, static_cast<int64_t>(std::time(nullptr)), cached) && cached.success) {
+            name = cached.name;
+        }
+    }
+    return names_.emplace(appid, name).first->second;
+}
+
+void Dashboard::compose(ScreenBuffer& screen, const std::vector<WorkerStatus>& workers, const string& status,
+    bool with_events)
+{
+    const unsigned width = screen.cols();
+    const unsigned fixed = APPID_COLS + STATE_COLS + UPTIME_COLS + TICK_COLS + 5;
+    const unsigned rest = width > fixed ? width - fixed : 0;
+    const unsigned name_cols = std::min(40u, std::max(8u, rest * 3 / 5));
+    const unsigned error_cols = rest > name_cols ? rest - name_cols : 0;
+    const unsigned name_x = APPID_COLS + 1;
+    const unsigned state_x = name_x + name_cols + 1;
+    const unsigned uptime_x = state_x + STATE_COLS + 1;
+    const unsigned tick_x = uptime_x + UPTIME_COLS + 1;
+    const unsigned error_x = tick_x + TICK_COLS + 1;
+
+    std::vector<string> events;
+    if (with_events) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events.assign(events_.begin(), events_.end());
+    }
+
+    screen.put(0, 0, title_, ScreenBuffer::Bold);
+    screen.put(1, 0, status);
+    screen.put(3, 0, "AppID", ScreenBuffer::Bold, APPID_COLS);
+    screen.put(3, name_x, "Name", ScreenBuffer::Bold, name_cols);
+    screen.put(3, state_x, "State", ScreenBuffer::Bold, STATE_COLS);
+    screen.put(3, uptime_x, "Uptime", ScreenBuffer::Bold, UPTIME_COLS);
+    screen.put(3, tick_x, "Last tick", ScreenBuffer::Bold, TICK_COLS);
+    screen.put(3, error_x, "Error", ScreenBuffer::Bold, error_cols);
+
+    // Rows left for workers once the events block (blank line, heading,
+    // events, blank line, stop hint) has its share.
+    unsigned below = with_events ? static_cast<unsigned>(4 + events.size()) : 0;
+    unsigned avail = screen.rows() > 4 + below ? screen.rows() - 4 - below : 0;
+    size_t shown = std::min(workers.size(), static_cast<size_t>(avail));
+    if (shown < workers.size() && shown > 0) {
+        --shown;   // keep a row for "... and N more"
+    }
+
+    Clock::time_point now = Clock::now();
+    unsigned row = 4;
+    for (size_t i = 0; i < shown; ++i, ++row) {
+        const WorkerStatus& w = workers[i];
+        bool running = w.state == WorkerState::Running;
+        screen.put(row, 0, w.appid, ScreenBuffer::Plain, APPID_COLS);
+        screen.put(row, name_x, name_of(w.appid), ScreenBuffer::Plain, name_cols);
+        screen.put(row, state_x, worker_state_name(w.state), state_attr(w.state), STATE_COLS);
+        screen.put(row, uptime_x, running ? describe_uptime(now - w.since) : "-", ScreenBuffer::Plain, UPTIME_COLS);
+        if (running) {
+            Clock::duration age = now - w.last_tick;
+            screen.put(row, tick_x, describe_age(age), age >= STALE_TICK ? ScreenBuffer::Yellow : ScreenBuffer::Plain,
+                TICK_COLS);
+        }
+        else {
+            screen.put(row, tick_x, "-", ScreenBuffer::Plain, TICK_COLS);
+        }
+        screen.put(row, error_x, w.error, ScreenBuffer::Red, error_cols);
+    }
+    if (shown < workers.size()) {
+        screen.put(row++, 0, "... and " + std::to_string(workers.size() - shown) + " more", ScreenBuffer::Dim);
+    }
+
+    if (with_events) {
+        screen.put(++row, 0, "Recent events", ScreenBuffer::Bold);
+        ++row;
+        for (const auto& e : events) {
+            screen.put(row++, 0, e, ScreenBuffer::Dim);
+        }
+        screen.put(++row, 0, string(stop_request_hint()) + " to stop.");
+    }
+}
+
+void Dashboard::update(const std::vector<WorkerStatus>& workers, const string& status)
+{
+    Clock::time_point now = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) return;
+    }
+    if (now < next_frame_) {
+        return;
+    }
+
+    frame_.clear();
+    if (!live_) {
+        next_frame_ = now + SNAPSHOT_INTERVAL;
+        next_.reset(static_cast<unsigned>(4 + workers.size()), PLAIN_COLS);
+        compose(next_, workers, status, false);
+        next_.append_text(frame_);
+        console_write_utf8(frame_.data(), frame_.size());
+        return;
+    }
+
+    next_frame_ = now + std::chrono::milliseconds(1000 / FRAME_RATE);
+
+    // One row and column short of the terminal, so nothing is ever written
+    // to its last row or column and it never scrolls or wraps under us.
+    unsigned rows = 24, cols = 80;
+    platform_terminal_size(rows, cols);
+    rows = std::max(rows, 2u) - 1;
+    cols = std::max(cols, 2u) - 1;
+    if (first_frame_ || rows != shown_.rows() || cols != shown_.cols()) {
+        frame_ += "\x1b[?25l\x1b[H\x1b[2J";   // hide the cursor, clear the screen
+        shown_.reset(rows, cols);
+        first_frame_ = false;
+    }
+
+    next_.reset(rows, cols);
+    compose(next_, workers, status, true);
+    next_.diff(shown_, frame_);
+    if (frame_.empty()) {
+        return;
+    }
+    // Keep the cursor under the table, where a key the user types shows up.
+    park_row_ = static_cast<unsigned>(next_.last_used_row() + 2);
+    char move[32];
+    std::snprintf(move, sizeof(move), "\x1b[%u;1H", park_row_);
+    frame_ += move;
+    console_write_utf8(frame_.data(), frame_.size());
+    std::swap(shown_, next_);
+}
+
+void Dashboard::finish()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (finished_) return;
+        finished_ = true;
+    }
+    if (live_ && !first_frame_) {
+        // Under the last frame, with whatever was typed there erased.
+        char seq[48];
+        std::snprintf(seq, sizeof(seq), "\x1b[%u;1H\x1b[J\x1b[?25h", park_row_);
+        console_write_utf8(seq, std::strlen(seq));
+    }
+}
+
+std::function<void(const string&)> dashboard_event_sink(Dashboard* board)
+{
+    return [board](const string& line) {
+        if (board) board->event(line);
+        else print_utf8_line(line);
+    };
+}
@@ -0,0 +1,139 @@
+// dashboard.h
+// Live status table for the console supervisor and rotation (--dashboard).
+//
+// One row per worker: AppID, game name, state, uptime, how long ago its
+// callback pump was last seen ticking and the last error. Names come from the
+// local Steam libraries (steam_library.h) and the appdetails cache only; the
+// dashboard never asks the Store.
+//
+// On a terminal that takes ANSI sequences (platform_enable_ansi_output) the
+// table is redrawn in place, at most FRAME_RATE times a second. Each frame is
+// composed into a ScreenBuffer and compared with the one on screen: only the
+// runs of cells that changed are written, one cursor move each, and the whole
+// frame goes out in a single console_write_utf8() call (text.h). Supervisor
+// events scroll through a short "recent events" block under the table.
+//
+// Anywhere else (a pipe, a log file, TERM=dumb) events are printed as lines
+// when they happen and the table as a plain-text snapshot every
+// SNAPSHOT_INTERVAL.
+
+#pragma once
+
+#include "appdetails_cache.h"
+#include "steam_library.h"
+#include "supervisor.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Terminal columns a code point takes: 0 (combining marks, zero-width
+// characters), 2 (East Asian wide and emoji) or 1.
+unsigned char_width(char32_t c);
+
+// Text screen of rows x cols cells, each one character plus an attribute.
+class ScreenBuffer {
+public:
+    enum Attr : uint8_t { Plain, Bold, Dim, Green, Yellow, Red };
+
+    // Resize and blank every cell.
+    void reset(unsigned rows, unsigned cols);
+
+    unsigned rows() const { return rows_; }
+    unsigned cols() const { return cols_; }
+
+    // Write UTF-8 text from (row, col), clipped to max_cols columns and the
+    // row's end. A wide character that does not fit entirely is left out.
+    // Returns the columns used.
+    unsigned put(unsigned row, unsigned col, const std::string& utf8, Attr attr = Plain, unsigned max_cols = ~0u);
+
+    // Append to out what turns the screen showing `shown` (same size) into
+    // this buffer: for each run of changed cells a cursor move (ESC [ r ; c H)
+    // and the run's text, with SGR attributes as needed. Runs closer than a
+    // cursor move's cost are merged. Appends nothing when they are equal.
+    void diff(const ScreenBuffer& shown, std::string& out) const;
+
+    // Append every row as a plain text line (trailing blanks dropped).
+    void append_text(std::string& out) const;
+
+    // Index of the last row with anything on it, or -1 if all blank.
+    int last_used_row() const;
+
+private:
+    struct Cell {
+        char32_t ch = U' ';    // 0: right half of the wide character before it
+        uint8_t attr = Plain;
+
+        bool operator==(const Cell& o) const { return ch == o.ch && attr == o.attr; }
+        bool operator!=(const Cell& o) const { return !(*this == o); }
+    };
+
+    const Cell& at(unsigned row, unsigned col) const { return cells_[static_cast<size_t>(row) * cols_ + col]; }
+
+    unsigned rows_ = 0;
+    unsigned cols_ = 0;
+    std::vector<Cell> cells_;
+};
+
+class Dashboard {
+public:
+    static const unsigned FRAME_RATE = 4;                    // redraws per second at most
+    static const std::chrono::seconds SNAPSHOT_INTERVAL;    // plain output
+    static const size_t MAX_EVENTS = 8;                      // recent events shown
+
+    // title: top line ("Supervising 3 game(s)"). steam_dir: Steam folder for
+    // names, empty to detect it. Decides between live and plain output.
+    Dashboard(const std::string& title, const std::string& steam_dir);
+    ~Dashboard();
+
+    Dashboard(const Dashboard&) = delete;
+    Dashboard& operator=(const Dashboard&) = delete;
+
+    // True when redrawing in place, false for plain snapshots.
+    bool live() const { return live_; }
+
+    // A supervisor event line. Safe to call from any thread.
+    void event(const std::string& line);
+
+    // Show a supervisor snapshot: redraw if a frame is due (live) or print
+    // the table if a snapshot is due (plain). status is the line under the
+    // title, e.g. summarize_workers(workers).
+    void update(const std::vector<WorkerStatus>& workers, const std::string& status);
+
+    // Stop redrawing: leave the last frame on screen, put the cursor under
+    // it and show it again. Later events and output scroll as usual. Also
+    // done by the destructor.
+    void finish();
+
+private:
+    const std::string& name_of(const std::string& appid);
+    void compose(ScreenBuffer& screen, const std::vector<WorkerStatus>& workers, const std::string& status,
+        bool with_events);
+
+    std::string title_;
+    bool live_ = false;
+    bool first_frame_ = true;
+    std::chrono::steady_clock::time_point next_frame_;
+
+    SteamLibraryIndex library_;
+    AppDetailsCache cache_;
+    std::map<std::string, std::string> names_;   // AppID -> name ("" when unknown)
+
+    ScreenBuffer shown_;    // what the terminal shows
+    ScreenBuffer next_;     // the frame being composed
+    std::string frame_;     // escape sequences and text of the last frame
+    unsigned park_row_ = 1; // where the cursor waits between frames (1-based)
+
+    std::mutex mutex_;
+    bool finished_ = false;
+    std::deque<std::string> events_;   // newest last, at most MAX_EVENTS
+};
+
+// Where supervisor events go under --dashboard: the table's event list when
+// there is a board, straight to the console otherwise (board may be null).
+std::function<void(const std::string&)> dashboard_event_sink(Dashboard* board);
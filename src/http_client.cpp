@@ -0,0 +1,322 @@
+// http_client.cpp
+// Transport selection and the plain HTTP/1.1 keep-alive transport.
+// See http_client.h. The WinHTTP transport lives in http_client_winhttp.cpp.
+
+#include "http_client.h"
+#include "net.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+// Longest status/header line we accept before calling the response malformed.
+static const size_t MAX_LINE = 64 * 1024;
+
+namespace {
+
+// Buffered reader over a connected socket.
+class SocketReader {
+public:
+    explicit SocketReader(net_socket s) : s_(s) {}
+
+    // Read one line, stripping the trailing CRLF (or LF).
+    bool read_line(string& line)
+    {
+        line.clear();
+        for (;;) {
+            const char* start = buf_ + pos_;
+            const char* nl = static_cast<const char*>(std::memchr(start, '\n', len_ - pos_));
+            if (nl) {
+                line.append(start, nl - start);
+                pos_ += (nl - start) + 1;
+                if (!line.empty() && line.back() == '\r') {
+                    line.pop_back();
+                }
+                return true;
+            }
+            line.append(start, len_ - pos_);
+            pos_ = len_;
+            if (line.size() > MAX_LINE || !fill()) {
+                return false;
+            }
+        }
+    }
+
+    // Append exactly n bytes to out. Bytes not already buffered are received
+    // straight into out's storage.
+    bool read_exact(size_t n, string& out)
+    {
+        size_t buffered = std::min(n, len_ - pos_);
+        out.append(buf_ + pos_, buffered);
+        pos_ += buffered;
+        n -= buffered;
+
+        size_t at = out.size();
+        out.resize(at + n);
+        while (n > 0) {
+            long got = net_recv(s_, &out[at], n);
+            if (got <= 0) {
+                out.resize(at);
+                return false;
+            }
+            at += static_cast<size_t>(got);
+            n -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    // Append everything until the peer closes the connection.
+    bool read_to_close(string& out)
+    {
+        out.append(buf_ + pos_, len_ - pos_);
+        pos_ = len_;
+        for (;;) {
+            size_t at = out.size();
+            out.resize(at + sizeof(buf_));
+            long got = net_recv(s_, &out[at], sizeof(buf_));
+            out.resize(at + (got > 0 ? static_cast<size_t>(got) : 0));
+            if (got == 0) return true;
+            if (got < 0) return false;
+        }
+    }
+
+private:
+    bool fill()
+    {
+        long got = net_recv(s_, buf_, sizeof(buf_));
+        if (got <= 0) {
+            return false;
+        }
+        pos_ = 0;
+        len_ = static_cast<size_t>(got);
+        return true;
+    }
+
+    net_socket s_;
+    char buf_[16 * 1024];
+    size_t pos_ = 0;
+    size_t len_ = 0;
+};
+
+class PlainHttpClient : public HttpClient {
+public:
+    PlainHttpClient(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts)
+        : endpoint_(endpoint), timeouts_(timeouts)
+    {
+    }
+
+    ~PlainHttpClient() override
+    {
+        for (net_socket s : idle_) {
+            net_close(s);
+        }
+    }
+
+    bool get(const string& path, HttpResponse& out) override
+    {
+        // A pooled connection may have been closed by the server while idle;
+        // in that case retry once on a fresh connection.
+        for (int attempt = 0; attempt < 2; ++attempt) {
+            Clock::time_point start = Clock::now();
+            bool reused = false;
+            net_socket s = take_idle();
+            if (s != NET_INVALID_SOCKET) {
+                reused = true;
+            }
+            else {
+                s = net_connect(endpoint_.host, endpoint_.port, timeouts_.connect_ms);
+                if (s == NET_INVALID_SOCKET) {
+                    return false;
+                }
+                net_set_timeouts(s, timeouts_.send_ms, timeouts_.receive_ms);
+            }
+
+            bool keep_alive = false;
+            if (request(s, path, start, out, keep_alive)) {
+                if (keep_alive) {
+                    give_back(s);
+                }
+                else {
+                    net_close(s);
+                }
+                return true;
+            }
+            net_close(s);
+            if (!reused) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+private:
+    // start: when this attempt began (before connecting, for send_us).
+    bool request(net_socket s, const string& path, Clock::time_point start, HttpResponse& out, bool& keep_alive)
+    {
+        out.status = 0;
+        out.body.clear();
+        out.send_us = out.wait_us = out.read_us = 0;
+
+        string req = "GET " + endpoint_.base_path + path + " HTTP/1.1\r\n"
+            "Host: " + endpoint_.host + ":" + std::to_string(endpoint_.port) + "\r\n"
+            "User-Agent: SimpleSteamIdler/1.0\r\n"
+            "Accept: application/json\r\n"
+            "Connection: keep-alive\r\n\r\n";
+        if (!net_send_all(s, req.data(), req.size())) {
+            return false;
+        }
+        Clock::time_point sent = Clock::now();
+        out.send_us = http_elapsed_us(start, sent);
+
+        SocketReader reader(s);
+        string line;
+        if (!reader.read_line(line) || line.compare(0, 5, "HTTP/") != 0) {
+            return false;
+        }
+        size_t sp = line.find(' ');
+        if (sp == string::npos) {
+            return false;
+        }
+        unsigned long status = std::strtoul(line.c_str() + sp + 1, nullptr, 10);
+        keep_alive = line.compare(0, 8, "HTTP/1.0") != 0;
+
+        bool chunked = false;
+        bool have_length = false;
+        size_t content_length = 0;
+        for (;;) {
+            if (!reader.read_line(line)) {
+                return false;
+            }
+            if (line.empty()) {
+                break;
+            }
+            size_t colon = line.find(':');
+            if (colon == string::npos) {
+                continue;
+            }
+            string name = line.substr(0, colon);
+            std::transform(name.begin(), name.end(), name.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            string value = line.substr(colon + 1);
+            value.erase(0, value.find_first_not_of(" \t"));
+            std::transform(value.begin(), value.end(), value.begin(),
+                [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+            if (name == "content-length") {
+                have_length = true;
+                content_length = static_cast<size_t>(std::strtoull(value.c_str(), nullptr, 10));
+            }
+            else if (name == "transfer-encoding") {
+                chunked = value.find("chunked") != string::npos;
+            }
+            else if (name == "connection") {
+                if (value.find("close") != string::npos) keep_alive = false;
+                else if (value.find("keep-alive") != string::npos) keep_alive = true;
+            }
+        }
+
+        Clock::time_point headers_done = Clock::now();
+        out.wait_us = http_elapsed_us(sent, headers_done);
+
+        if (status == 204 || status == 304 || (status >= 100 && status < 200)) {
+            // No body.
+        }
+        else if (chunked) {
+            for (;;) {
+                if (!reader.read_line(line)) {
+                    return false;
+                }
+                size_t chunk = static_cast<size_t>(std::strtoull(line.c_str(), nullptr, 16));
+                if (chunk == 0) {
+                    // Skip trailers up to the terminating empty line.
+                    do {
+                        if (!reader.read_line(line)) return false;
+                    } while (!line.empty());
+                    break;
+                }
+                if (!reader.read_exact(chunk, out.body) || !reader.read_line(line)) {
+                    return false;
+                }
+            }
+        }
+        else if (have_length) {
+            out.body.reserve(content_length);
+            if (!reader.read_exact(content_length, out.body)) {
+                return false;
+            }
+        }
+        else {
+            keep_alive = false;
+            if (!reader.read_to_close(out.body)) {
+                return false;
+            }
+        }
+
+        out.read_us = http_elapsed_us(headers_done, Clock::now());
+        out.status = status;
+        return true;
+    }
+
+    net_socket take_idle()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (idle_.empty()) {
+            return NET_INVALID_SOCKET;
+        }
+        net_socket s = idle_.back();
+        idle_.pop_back();
+        return s;
+    }
+
+    void give_back(net_socket s)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(s);
+    }
+
+    HttpEndpoint endpoint_;
+    HttpTimeouts timeouts_;
+    std::mutex mutex_;
+    std::vector<net_socket> idle_;  // keep-alive connections ready for reuse
+};
+
+// Stand-in for https:// endpoints when no TLS transport was compiled in:
+// every request fails like an unreachable Store, so callers fall back to
+// the cache or go on without the game name.
+class UnavailableHttpClient : public HttpClient {
+public:
+    bool get(const string&, HttpResponse& out) override
+    {
+        out.status = 0;
+        out.body.clear();
+        return false;
+    }
+};
+
+} // namespace
+
+std::unique_ptr<HttpClient> make_plain_http_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts)
+{
+    return std::unique_ptr<HttpClient>(new PlainHttpClient(endpoint, timeouts));
+}
+
+std::unique_ptr<HttpClient> make_http_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts)
+{
+#if defined(_WIN32)
+    return make_winhttp_client(endpoint, timeouts);
+#elif defined(SSI_HAVE_CURL)
+    return make_curl_http_client(endpoint, timeouts);
+#else
+    if (endpoint.secure) {
+        return std::unique_ptr<HttpClient>(new UnavailableHttpClient());
+    }
+    return make_plain_http_client(endpoint, timeouts);
+#endif
+}
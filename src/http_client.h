@@ -0,0 +1,74 @@
+// http_client.h
+// Long-lived HTTP client used for every Store request.
+//
+// A client is bound to one endpoint (scheme, host, port) and keeps its
+// session and connections open between requests, so only the first lookup
+// pays for DNS, TCP and TLS setup. Transports are pluggable:
+// - WinHTTP (https or http) on Windows: one session + connection handle,
+//   gzip/deflate decompression, explicit resolve/connect/send/receive timeouts.
+// - libcurl (https or http) elsewhere, when the build found it (SSI_HAVE_CURL).
+// - Plain HTTP/1.1 over sockets with keep-alive, for local stand-ins of the
+//   Store (no TLS, no compression).
+//
+// get() may be called from several threads at once.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+struct HttpEndpoint {
+    bool secure = true;
+    std::string host = "store.steampowered.com";
+    uint16_t port = 443;
+    std::string base_path;   // put in front of every request path: "" or e.g. "/mirror"
+};
+
+// Deadlines in milliseconds. WinHTTP's defaults (infinite resolve, 60s connect,
+// 30s send/receive) can stall a lookup for a minute on a bad network.
+struct HttpTimeouts {
+    int connect_ms = 5000;   // also used for name resolution
+    int send_ms = 5000;
+    int receive_ms = 10000;
+};
+
+struct HttpResponse {
+    unsigned long status = 0;  // HTTP status code, 0 if no response
+    std::string body;          // decoded body; capacity is reused across calls
+
+    // Where the time went, in microseconds (for --timings).
+    uint32_t send_us = 0;      // connecting if needed, then sending the request
+    uint32_t wait_us = 0;      // until the status line and headers arrived
+    uint32_t read_us = 0;      // reading the body
+};
+
+// Microseconds between two steady_clock points, for the HttpResponse timings.
+inline uint32_t http_elapsed_us(std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(to - from).count());
+}
+
+class HttpClient {
+public:
+    virtual ~HttpClient() = default;
+
+    // GET path (including the query string). Returns true if an HTTP response
+    // was received, whatever its status; false on transport failure/timeout.
+    virtual bool get(const std::string& path, HttpResponse& out) = 0;
+};
+
+// WinHTTP on Windows, libcurl elsewhere when available, otherwise plain sockets
+// for http:// and a client that always fails for https://.
+std::unique_ptr<HttpClient> make_http_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts);
+
+// Plain HTTP/1.1 transport (endpoint.secure is ignored).
+std::unique_ptr<HttpClient> make_plain_http_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts);
+
+#ifdef _WIN32
+std::unique_ptr<HttpClient> make_winhttp_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts);
+#endif
+#ifdef SSI_HAVE_CURL
+std::unique_ptr<HttpClient> make_curl_http_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts);
+#endif
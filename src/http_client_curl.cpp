@@ -0,0 +1,135 @@
+// http_client_curl.cpp
+// libcurl transport: HTTPS for the headless build (WinHTTP covers Windows).
+// Compiled when CMake finds libcurl (SSI_HAVE_CURL). See http_client.h.
+
+#ifdef SSI_HAVE_CURL
+
+#include "http_client.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+using std::string;
+
+namespace {
+
+class CurlHttpClient : public HttpClient {
+public:
+    CurlHttpClient(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts)
+        : timeouts_(timeouts)
+    {
+        static std::once_flag global_init;
+        std::call_once(global_init, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+        base_url_ = string(endpoint.secure ? "https://" : "http://") + endpoint.host + ":" +
+            std::to_string(endpoint.port) + endpoint.base_path;
+    }
+
+    ~CurlHttpClient() override
+    {
+        for (CURL* h : idle_) {
+            curl_easy_cleanup(h);
+        }
+    }
+
+    bool get(const string& path, HttpResponse& out) override
+    {
+        out.status = 0;
+        out.body.clear();
+        out.send_us = out.wait_us = out.read_us = 0;
+
+        // Each easy handle keeps its own connection alive; handles are pooled
+        // so concurrent callers never share one.
+        CURL* h = take_idle();
+        if (!h) {
+            return false;
+        }
+
+        string url = base_url_ + path;
+        curl_easy_setopt(h, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(h, CURLOPT_WRITEDATA, &out.body);
+        CURLcode rc = curl_easy_perform(h);
+
+        if (rc == CURLE_OK) {
+            long status = 0;
+            curl_easy_getinfo(h, CURLINFO_RESPONSE_CODE, &status);
+            out.status = static_cast<unsigned long>(status);
+
+            curl_off_t pretransfer = 0, first_byte = 0, total = 0;
+            curl_easy_getinfo(h, CURLINFO_PRETRANSFER_TIME_T, &pretransfer);
+            curl_easy_getinfo(h, CURLINFO_STARTTRANSFER_TIME_T, &first_byte);
+            curl_easy_getinfo(h, CURLINFO_TOTAL_TIME_T, &total);
+            out.send_us = static_cast<uint32_t>(pretransfer);
+            out.wait_us = static_cast<uint32_t>(std::max<curl_off_t>(first_byte - pretransfer, 0));
+            out.read_us = static_cast<uint32_t>(std::max<curl_off_t>(total - first_byte, 0));
+        }
+
+        give_back(h);
+        return rc == CURLE_OK && out.status != 0;
+    }
+
+private:
+    static size_t on_data(char* data, size_t size, size_t count, void* user)
+    {
+        static_cast<string*>(user)->append(data, size * count);
+        return size * count;
+    }
+
+    CURL* make_handle()
+    {
+        CURL* h = curl_easy_init();
+        if (!h) {
+            return nullptr;
+        }
+        curl_easy_setopt(h, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(h, CURLOPT_USERAGENT, "SimpleSteamIdler/1.0");
+        curl_easy_setopt(h, CURLOPT_ACCEPT_ENCODING, "");   // whatever libcurl can decode
+        curl_easy_setopt(h, CURLOPT_CONNECTTIMEOUT_MS, static_cast<long>(timeouts_.connect_ms));
+        // No per-read timeout in libcurl: abort when nothing arrives for receive_ms.
+        curl_easy_setopt(h, CURLOPT_LOW_SPEED_LIMIT, 1L);
+        curl_easy_setopt(h, CURLOPT_LOW_SPEED_TIME, std::max(1L, static_cast<long>(timeouts_.receive_ms / 1000)));
+        // No send timeout either: bound the whole request by connect + send +
+        // receive instead, so a request that stalls while sending still ends.
+        curl_easy_setopt(h, CURLOPT_TIMEOUT_MS, static_cast<long>(timeouts_.connect_ms) +
+                                                static_cast<long>(timeouts_.send_ms) +
+                                                static_cast<long>(timeouts_.receive_ms));
+        curl_easy_setopt(h, CURLOPT_WRITEFUNCTION, &CurlHttpClient::on_data);
+        return h;
+    }
+
+    CURL* take_idle()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idle_.empty()) {
+                CURL* h = idle_.back();
+                idle_.pop_back();
+                return h;
+            }
+        }
+        return make_handle();
+    }
+
+    void give_back(CURL* h)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        idle_.push_back(h);
+    }
+
+    string base_url_;
+    HttpTimeouts timeouts_;
+    std::mutex mutex_;
+    std::vector<CURL*> idle_;   // handles (with their live connections) ready for reuse
+};
+
+} // namespace
+
+std::unique_ptr<HttpClient> make_curl_http_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts)
+{
+    return std::unique_ptr<HttpClient>(new CurlHttpClient(endpoint, timeouts));
+}
+
+#endif // SSI_HAVE_CURL
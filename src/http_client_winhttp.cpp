@@ -0,0 +1,153 @@
+// http_client_winhttp.cpp
+// WinHTTP transport: one session + connection handle reused for every request.
+// See http_client.h.
+
+#define NOMINMAX
+
+#include "http_client.h"
+#include "util.h"
+
+#include <windows.h>
+#include <winhttp.h>
+
+#include <algorithm>
+
+#pragma comment(lib, "winhttp.lib")
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+class WinHttpClient : public HttpClient {
+public:
+    WinHttpClient(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts)
+        : secure_(endpoint.secure), base_path_(endpoint.base_path)
+    {
+        session_ = WinHttpOpen(
+            L"SimpleSteamIdler/1.0",
+            WINHTTP_ACCESS_TYPE_DEFAULT_PROXY,
+            WINHTTP_NO_PROXY_NAME,
+            WINHTTP_NO_PROXY_BYPASS, 0);
+        if (!session_) {
+            return;
+        }
+
+        WinHttpSetTimeouts(session_, timeouts.connect_ms, timeouts.connect_ms,
+            timeouts.send_ms, timeouts.receive_ms);
+
+        // Ask for gzip/deflate and let WinHTTP decode it (Windows 8.1+; older
+        // systems simply keep receiving identity-encoded bodies).
+        DWORD decompression = WINHTTP_DECOMPRESSION_FLAG_ALL;
+        WinHttpSetOption(session_, WINHTTP_OPTION_DECOMPRESSION, &decompression, sizeof(decompression));
+
+        std::wstring host = utf8_to_wstring(endpoint.host);
+        connect_ = WinHttpConnect(session_, host.c_str(), endpoint.port, 0);
+    }
+
+    ~WinHttpClient() override
+    {
+        if (connect_) WinHttpCloseHandle(connect_);
+        if (session_) WinHttpCloseHandle(session_);
+    }
+
+    bool get(const string& path, HttpResponse& out) override
+    {
+        out.status = 0;
+        out.body.clear();
+        out.send_us = out.wait_us = out.read_us = 0;
+        if (!connect_) {
+            return false;
+        }
+
+        // Request handles are per call; the session keeps the underlying
+        // connection alive between them.
+        string full_path = base_path_ + path;
+        std::wstring wpath(full_path.begin(), full_path.end());
+        HINTERNET request = WinHttpOpenRequest(
+            connect_,
+            L"GET",
+            wpath.c_str(),
+            NULL,
+            WINHTTP_NO_REFERER,
+            WINHTTP_DEFAULT_ACCEPT_TYPES,
+            secure_ ? WINHTTP_FLAG_SECURE : 0);
+        if (!request) {
+            return false;
+        }
+
+        // WinHTTP connects lazily, so send_us includes any connection setup.
+        Clock::time_point start = Clock::now();
+        bool ok = WinHttpSendRequest(request, WINHTTP_NO_ADDITIONAL_HEADERS, 0,
+            WINHTTP_NO_REQUEST_DATA, 0, 0, 0) != FALSE;
+        Clock::time_point sent = Clock::now();
+        out.send_us = http_elapsed_us(start, sent);
+        ok = ok && WinHttpReceiveResponse(request, NULL);
+        Clock::time_point headers_done = Clock::now();
+        out.wait_us = ok ? http_elapsed_us(sent, headers_done) : 0;
+
+        if (ok) {
+            DWORD status = 0;
+            DWORD size = sizeof(status);
+            WinHttpQueryHeaders(request, WINHTTP_QUERY_STATUS_CODE | WINHTTP_QUERY_FLAG_NUMBER,
+                WINHTTP_HEADER_NAME_BY_INDEX, &status, &size, WINHTTP_NO_HEADER_INDEX);
+            out.status = status;
+
+            // Pre-size from Content-Length when present (the compressed size
+            // with gzip, still a useful lower bound).
+            DWORD length = 0;
+            size = sizeof(length);
+            if (WinHttpQueryHeaders(request, WINHTTP_QUERY_CONTENT_LENGTH | WINHTTP_QUERY_FLAG_NUMBER,
+                    WINHTTP_HEADER_NAME_BY_INDEX, &length, &size, WINHTTP_NO_HEADER_INDEX)) {
+                out.body.reserve(length);
+            }
+
+            ok = read_body(request, out.body);
+            out.read_us = http_elapsed_us(headers_done, Clock::now());
+        }
+
+        WinHttpCloseHandle(request);
+        return ok && out.status != 0;
+    }
+
+private:
+    // Read straight into the tail of body instead of a per-chunk temporary.
+    static bool read_body(HINTERNET request, string& body)
+    {
+        for (;;) {
+            DWORD available = 0;
+            if (!WinHttpQueryDataAvailable(request, &available)) {
+                return false;
+            }
+            if (available == 0) {
+                return true;
+            }
+
+            size_t at = body.size();
+            if (body.capacity() < at + available) {
+                body.reserve(std::max(body.capacity() * 2, at + available));
+            }
+            body.resize(at + available);
+
+            DWORD got = 0;
+            if (!WinHttpReadData(request, &body[at], available, &got)) {
+                body.resize(at);
+                return false;
+            }
+            body.resize(at + got);
+        }
+    }
+
+    bool secure_;
+    string base_path_;
+    HINTERNET session_ = NULL;
+    HINTERNET connect_ = NULL;
+};
+
+} // namespace
+
+std::unique_ptr<HttpClient> make_winhttp_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts)
+{
+    return std::unique_ptr<HttpClient>(new WinHttpClient(endpoint, timeouts));
+}
@@ -0,0 +1,156 @@
+// idle_session.cpp
+// Idling one AppID in this process. See idle_session.h.
+
+#include "idle_session.h"
+#include "metrics.h"
+#include "phase_timings.h"
+#include "session_ledger.h"
+
+#include <cstdlib>
+
+using std::string;
+
+constexpr std::chrono::milliseconds IdleSession::STORE_JOIN_WAIT;
+
+IdleSession::IdleSession(const IdleSessionConfig& config)
+    : config_(config)
+{
+}
+
+IdleSession::~IdleSession()
+{
+    stop();
+}
+
+IdleStartResult IdleSession::start(const string& appid)
+{
+    stop();
+
+    // The Store only supplies the game name and an "AppID exists" check;
+    // SteamAPI_Init does not need either, so both run at the same time.
+    // A fresh cached answer (see appdetails_cache.h) skips the network entirely.
+    if (config_.store_http) {
+        IdleSessionConfig c = config_;
+        store_ = std::async(std::launch::async, [c, appid]() {
+            return store_lookup(*c.store_http, appid, c.cache, c.refresh_store, c.timings);
+        }).share();
+    }
+    else {
+        store_ = std::shared_future<StoreLookup>();
+    }
+
+    IdleStartResult result = start_steam(appid);
+    metrics_init_result(result);
+    if (result == IdleStartResult::Idling) {
+        metrics_session_started(appid);
+    }
+    return result;
+}
+
+IdleStartResult IdleSession::start_steam(const string& appid)
+{
+    // Steam reads the AppID from SteamAppId / steam_appid.txt; the
+    // environment variable works for several processes in one folder.
+    set_steam_env(appid);
+    detail_.clear();
+
+    // Loaded once per process; a retry with another AppID only re-runs init.
+    api_ = steam_api_load(config_.timings);
+    if (!api_) {
+        clear_steam_env();
+        return IdleStartResult::NoLibrary;
+    }
+    if (!api_->has_init()) {
+        detail_ = "missing " + describe_missing_exports(*api_);
+        clear_steam_env();
+        return IdleStartResult::BadLibrary;
+    }
+
+    SteamInitResult init = steam_api_init(*api_, config_.timings, &detail_);
+    if (init != SteamInitResult::Ok) {
+        clear_steam_env();
+        return idle_start_result_for(init);
+    }
+
+    // The watchdog ends the ledger session while Steam is gone and begins a
+    // new one on reconnect, so waiting for the client is not idle time.
+    SessionLedger* ledger = config_.ledger;
+    uint32_t ledger_appid = static_cast<uint32_t>(std::strtoul(appid.c_str(), nullptr, 10));
+    if (ledger) {
+        ledger->begin(ledger_appid);
+    }
+
+    SteamWatchdog::Listener listener = config_.on_steam_change;
+    watchdog_.reset(new SteamWatchdog(*api_, config_.watchdog,
+        [appid, listener, ledger, ledger_appid](bool connected, const string& detail) {
+        if (connected) {
+            metrics_session_started(appid);
+            if (ledger) ledger->begin(ledger_appid);
+        }
+        else {
+            metrics_session_stopped();
+            if (ledger) ledger->end(LEDGER_STOP_STEAM_LOST);
+        }
+        if (listener) {
+            listener(connected, detail);
+        }
+    }));
+
+    SteamAPI_RunCallbacks_t run_callbacks = api_->RunCallbacks;
+    SteamWatchdog* watchdog = watchdog_.get();
+    // Only RunCallbacks is timed; the health check and the ledger heartbeat
+    // (an fdatasync) run untimed before it.
+    pump_.reset(new CallbackPump([run_callbacks]() {
+        if (run_callbacks) run_callbacks();
+    }, config_.pump, [watchdog, ledger]() {
+        SteamWatchdog::Clock::time_point now = SteamWatchdog::Clock::now();
+        if (!watchdog->tick(now)) {
+            return false;
+        }
+        if (ledger) ledger->tick(now);
+        return true;
+    }));
+    pump_->start();
+    idling_ = true;
+    return IdleStartResult::Idling;
+}
+
+bool IdleSession::wait_store(std::chrono::milliseconds timeout) const
+{
+    return store_.valid() && store_.wait_for(timeout) == std::future_status::ready;
+}
+
+StoreLookup IdleSession::store_result() const
+{
+    return store_.valid() ? store_.get() : StoreLookup();
+}
+
+void IdleSession::stop()
+{
+    if (pump_) {
+        pump_->stop();
+    }
+    if (idling_) {
+        // The library itself stays loaded for the next start(). A session the
+        // watchdog lost has been shut down already.
+        if (watchdog_->connected() && api_->Shutdown) {
+            api_->Shutdown();
+        }
+        clear_steam_env();
+        idling_ = false;
+        metrics_session_stopped();
+        if (config_.ledger) {
+            config_.ledger->end(LEDGER_STOP_REQUESTED);
+        }
+    }
+}
+
+bool IdleSession::steam_connected() const
+{
+    return idling_ && watchdog_->connected();
+}
+
+PumpStats IdleSession::pump_stats() const
+{
+    return pump_ ? pump_->stats() : PumpStats();
+}
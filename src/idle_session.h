@@ -0,0 +1,94 @@
+// idle_session.h
+// Idling one AppID in this process: the portable core behind the Windows
+// console front-end, the headless front-end and the supervisor's workers.
+//
+// start() points Steam at the AppID, starts the Store lookup in the
+// background (when a Store client is configured), loads steam_api (the first
+// time only, see steam_api.h), calls SteamAPI_Init and, on success, starts the
+// callback pump. The Store answer
+// only supplies the game name, so it is joined separately and callers decide
+// how long to wait for it. While idling, a watchdog on the pump thread
+// re-initialises Steam after client restarts and log-offs (steam_watchdog.h),
+// and the session ledger, when there is one, gets its start, heartbeat and
+// stop records (session_ledger.h).
+
+#pragma once
+
+#include "callback_pump.h"
+#include "steam_api.h"
+#include "steam_watchdog.h"
+#include "store.h"
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+
+class AppDetailsCache;
+class HttpClient;
+class PhaseTimings;
+class SessionLedger;
+
+struct IdleSessionConfig {
+    HttpClient* store_http = nullptr;   // null: no Store lookup at all
+    AppDetailsCache* cache = nullptr;   // may be null
+    bool refresh_store = false;
+    PumpOptions pump;
+    PhaseTimings* timings = nullptr;    // may be null
+    SessionLedger* ledger = nullptr;    // may be null
+    WatchdogOptions watchdog;
+    // Called on the pump thread when the watchdog loses the Steam session
+    // (false, reason) and when it is back (true). May be empty.
+    SteamWatchdog::Listener on_steam_change;
+};
+
+class IdleSession {
+public:
+    // How long a finished SteamAPI_Init usually waits for a Store answer still
+    // in flight before idling is reported without the game name.
+    static constexpr std::chrono::milliseconds STORE_JOIN_WAIT{ 1500 };
+
+    explicit IdleSession(const IdleSessionConfig& config);
+    ~IdleSession();
+
+    IdleSession(const IdleSession&) = delete;
+    IdleSession& operator=(const IdleSession&) = delete;
+
+    // Run the startup sequence for appid. On anything but Idling the
+    // environment is cleared again before returning; the library stays loaded.
+    IdleStartResult start(const std::string& appid);
+
+    // Why the last start() failed, when known: the missing exports for
+    // BadLibrary, SteamAPI_InitFlat's message otherwise. Often empty.
+    const std::string& start_detail() const { return detail_; }
+
+    // Wait up to timeout for the Store answer. False if it is still pending
+    // or no lookup was started.
+    bool wait_store(std::chrono::milliseconds timeout) const;
+
+    // The Store answer; blocks until it arrives. Empty if no lookup was started.
+    // May be called from several threads.
+    StoreLookup store_result() const;
+
+    // Stop the pump and shut Steam down. Safe to call more than once.
+    void stop();
+
+    // True from a successful start() until stop(), reconnects included.
+    bool idling() const { return idling_; }
+
+    // Idling and Steam initialised, i.e. not waiting for the client to return.
+    bool steam_connected() const;
+    PumpStats pump_stats() const;
+
+private:
+    // Library load, SteamAPI_Init and the pump; start() adds the metrics.
+    IdleStartResult start_steam(const std::string& appid);
+
+    IdleSessionConfig config_;
+    const SteamApi* api_ = nullptr;
+    std::string detail_;
+    std::shared_future<StoreLookup> store_;
+    std::unique_ptr<SteamWatchdog> watchdog_;
+    std::unique_ptr<CallbackPump> pump_;
+    bool idling_ = false;
+};
@@ -0,0 +1,565 @@
+// json_reader.cpp
+// Single-pass JSON tokenizer and appdetails reader. See json_reader.h.
+
+#include "json_reader.h"
+
+#include <cstring>
+
+// Parser states between tokens.
+enum ReaderState {
+    STATE_VALUE,        // a value must follow
+    STATE_FIRST_VALUE,  // just after '[': a value or ']'
+    STATE_KEY,          // just after ',' in an object: a member name
+    STATE_FIRST_KEY,    // just after '{': a member name or '}'
+    STATE_AFTER_VALUE,  // a value ended: ',' or a closing bracket (or end of input)
+    STATE_DONE,         // top-level value complete
+};
+
+JsonReader::JsonReader(std::string_view input)
+    : in_(input)
+{
+}
+
+JsonToken JsonReader::fail()
+{
+    error_ = true;
+    text_ = std::string_view();
+    return JsonToken::Error;
+}
+
+void JsonReader::skip_ws()
+{
+    while (pos_ < in_.size()) {
+        char c = in_[pos_];
+        if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+            break;
+        }
+        ++pos_;
+    }
+}
+
+JsonToken JsonReader::next()
+{
+    if (error_) {
+        return JsonToken::Error;
+    }
+
+    skip_ws();
+
+    if (state_ == STATE_AFTER_VALUE) {
+        if (stack_.empty()) {
+            state_ = STATE_DONE;
+        }
+        else {
+            if (pos_ >= in_.size()) {
+                return fail();
+            }
+            char c = in_[pos_];
+            if (c == ',') {
+                ++pos_;
+                skip_ws();
+                state_ = stack_.back() ? STATE_KEY : STATE_VALUE;
+            }
+            else if (c == '}' && stack_.back()) {
+                ++pos_;
+                stack_.pop_back();
+                return JsonToken::ObjectEnd;
+            }
+            else if (c == ']' && !stack_.back()) {
+                ++pos_;
+                stack_.pop_back();
+                return JsonToken::ArrayEnd;
+            }
+            else {
+                return fail();
+            }
+        }
+    }
+
+    if (state_ == STATE_DONE) {
+        return (pos_ >= in_.size()) ? JsonToken::End : fail();
+    }
+
+    if (pos_ >= in_.size()) {
+        return fail();
+    }
+    char c = in_[pos_];
+
+    if (state_ == STATE_KEY || state_ == STATE_FIRST_KEY) {
+        if (c == '}' && state_ == STATE_FIRST_KEY) {
+            ++pos_;
+            stack_.pop_back();
+            state_ = STATE_AFTER_VALUE;
+            return JsonToken::ObjectEnd;
+        }
+        if (c != '"' || scan_string(JsonToken::Key) == JsonToken::Error) {
+            return fail();
+        }
+        skip_ws();
+        if (pos_ >= in_.size() || in_[pos_] != ':') {
+            return fail();
+        }
+        ++pos_;
+        state_ = STATE_VALUE;
+        return JsonToken::Key;
+    }
+
+    if (c == ']' && state_ == STATE_FIRST_VALUE) {
+        ++pos_;
+        stack_.pop_back();
+        state_ = STATE_AFTER_VALUE;
+        return JsonToken::ArrayEnd;
+    }
+
+    JsonToken t;
+    switch (c) {
+    case '{':
+        ++pos_;
+        stack_.push_back(true);
+        state_ = STATE_FIRST_KEY;
+        return JsonToken::ObjectBegin;
+    case '[':
+        ++pos_;
+        stack_.push_back(false);
+        state_ = STATE_FIRST_VALUE;
+        return JsonToken::ArrayBegin;
+    case '"':
+        t = scan_string(JsonToken::String);
+        break;
+    case 't':
+        t = scan_literal("true", JsonToken::True);
+        break;
+    case 'f':
+        t = scan_literal("false", JsonToken::False);
+        break;
+    case 'n':
+        t = scan_literal("null", JsonToken::Null);
+        break;
+    default:
+        t = scan_number();
+        break;
+    }
+
+    if (t != JsonToken::Error) {
+        state_ = STATE_AFTER_VALUE;
+    }
+    return t;
+}
+
+JsonToken JsonReader::scan_string(JsonToken kind)
+{
+    // pos_ is on the opening quote. Find the closing quote with memchr and
+    // only look closer when a backslash shows up before it.
+    const char* base = in_.data();
+    size_t n = in_.size();
+    size_t start = pos_ + 1;
+    size_t i = start;
+    text_has_escapes_ = false;
+
+    for (;;) {
+        if (i >= n) {
+            return fail();
+        }
+        const char* quote = static_cast<const char*>(std::memchr(base + i, '"', n - i));
+        if (!quote) {
+            return fail();
+        }
+        size_t qi = static_cast<size_t>(quote - base);
+        const char* bs = static_cast<const char*>(std::memchr(base + i, '\\', qi - i));
+        if (!bs) {
+            i = qi;
+            break;
+        }
+        // Skip the escape and the character it protects (which may be a quote).
+        text_has_escapes_ = true;
+        i = static_cast<size_t>(bs - base) + 2;
+    }
+
+    text_ = in_.substr(start, i - start);
+    pos_ = i + 1;
+    return kind;
+}
+
+JsonToken JsonReader::scan_literal(const char* word, JsonToken kind)
+{
+    size_t len = std::strlen(word);
+    if (in_.compare(pos_, len, word) != 0) {
+        return fail();
+    }
+    text_ = in_.substr(pos_, len);
+    pos_ += len;
+    return kind;
+}
+
+JsonToken JsonReader::scan_number()
+{
+    size_t start = pos_;
+    while (pos_ < in_.size()) {
+        char c = in_[pos_];
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            ++pos_;
+        }
+        else {
+            break;
+        }
+    }
+    if (pos_ == start) {
+        return fail();
+    }
+    text_ = in_.substr(start, pos_ - start);
+    return JsonToken::Number;
+}
+
+void JsonReader::decode(std::string& out) const
+{
+    if (!text_has_escapes_) {
+        out.assign(text_.data(), text_.size());
+        return;
+    }
+    json_unescape(text_, out);
+}
+
+bool JsonReader::skip_value()
+{
+    JsonToken t = next();
+    if (t == JsonToken::ObjectBegin || t == JsonToken::ArrayBegin) {
+        return skip_container();
+    }
+    return t != JsonToken::Error && t != JsonToken::End &&
+        t != JsonToken::ObjectEnd && t != JsonToken::ArrayEnd;
+}
+
+bool JsonReader::skip_container()
+{
+    size_t target = stack_.size() - 1;
+    while (stack_.size() > target) {
+        JsonToken t = next();
+        if (t == JsonToken::Error || t == JsonToken::End) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// --------------------------- String decoding ---------------------------
+
+static void append_utf8(std::string& out, uint32_t cp)
+{
+    if (cp < 0x80) {
+        out.push_back(static_cast<char>(cp));
+    }
+    else if (cp < 0x800) {
+        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else if (cp < 0x10000) {
+        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+    else {
+        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+    }
+}
+
+// Parse 4 hex digits at raw[i]. Returns -1 if they are not all hex.
+static long parse_hex4(std::string_view raw, size_t i)
+{
+    if (i + 4 > raw.size()) {
+        return -1;
+    }
+    long v = 0;
+    for (size_t k = 0; k < 4; ++k) {
+        char c = raw[i + k];
+        v <<= 4;
+        if (c >= '0' && c <= '9') v |= c - '0';
+        else if (c >= 'a' && c <= 'f') v |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') v |= c - 'A' + 10;
+        else return -1;
+    }
+    return v;
+}
+
+void json_unescape(std::string_view raw, std::string& out)
+{
+    const uint32_t REPLACEMENT = 0xFFFD;
+    out.clear();
+    out.reserve(raw.size());
+
+    size_t i = 0;
+    while (i < raw.size()) {
+        // Copy the run up to the next backslash in one go.
+        const char* bs = static_cast<const char*>(std::memchr(raw.data() + i, '\\', raw.size() - i));
+        size_t run_end = bs ? static_cast<size_t>(bs - raw.data()) : raw.size();
+        out.append(raw.data() + i, run_end - i);
+        i = run_end;
+        if (i >= raw.size()) {
+            break;
+        }
+
+        // raw[i] is a backslash.
+        if (i + 1 >= raw.size()) {
+            append_utf8(out, REPLACEMENT);
+            break;
+        }
+        char e = raw[i + 1];
+        i += 2;
+        switch (e) {
+        case '"': out.push_back('"'); break;
+        case '\\': out.push_back('\\'); break;
+        case '/': out.push_back('/'); break;
+        case 'b': out.push_back('\b'); break;
+        case 'f': out.push_back('\f'); break;
+        case 'n': out.push_back('\n'); break;
+        case 'r': out.push_back('\r'); break;
+        case 't': out.push_back('\t'); break;
+        case 'u': {
+            long cp = parse_hex4(raw, i);
+            if (cp < 0) {
+                append_utf8(out, REPLACEMENT);
+                break;
+            }
+            i += 4;
+            if (cp >= 0xD800 && cp <= 0xDBFF) {
+                // High surrogate: only valid when followed by \uDC00-\uDFFF.
+                long low = (i + 1 < raw.size() && raw[i] == '\\' && raw[i + 1] == 'u') ? parse_hex4(raw, i + 2) : -1;
+                if (low >= 0xDC00 && low <= 0xDFFF) {
+                    i += 6;
+                    append_utf8(out, 0x10000 + ((static_cast<uint32_t>(cp) - 0xD800) << 10) + (static_cast<uint32_t>(low) - 0xDC00));
+                }
+                else {
+                    append_utf8(out, REPLACEMENT);
+                }
+            }
+            else if (cp >= 0xDC00 && cp <= 0xDFFF) {
+                append_utf8(out, REPLACEMENT);
+            }
+            else {
+                append_utf8(out, static_cast<uint32_t>(cp));
+            }
+            break;
+        }
+        default:
+            append_utf8(out, REPLACEMENT);
+            break;
+        }
+    }
+}
+
+// --------------------------- appdetails ---------------------------
+
+static bool parse_u32(std::string_view s, uint32_t& out)
+{
+    if (s.empty() || s.size() > 10) {
+        return false;
+    }
+    uint64_t v = 0;
+    for (char c : s) {
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+    }
+    if (v > 0xFFFFFFFFull) {
+        return false;
+    }
+    out = static_cast<uint32_t>(v);
+    return true;
+}
+
+// Members of "data" read into an AppDetailsEntry, as bits.
+enum : unsigned { DATA_NAME = 1, DATA_TYPE = 2, DATA_IS_FREE = 4, DATA_STEAM_APPID = 8, DATA_ALL = 15 };
+
+// Read the members of "data" we care about; reader is just past its '{'.
+// With stop_early, returns as soon as all of them were read, leaving the
+// rest of the object unread, and sets *stopped.
+static bool read_app_data(JsonReader& r, AppDetailsEntry& e, bool stop_early, bool* stopped)
+{
+    unsigned seen = 0;
+    for (;;) {
+        if (stop_early && seen == DATA_ALL) {
+            *stopped = true;
+            return true;
+        }
+        JsonToken t = r.next();
+        if (t == JsonToken::ObjectEnd) {
+            return true;
+        }
+        if (t != JsonToken::Key) {
+            return false;
+        }
+
+        std::string_view key = r.text();
+        if (key == "name" || key == "type") {
+            seen |= key == "name" ? DATA_NAME : DATA_TYPE;
+            t = r.next();
+            if (t == JsonToken::String) {
+                r.decode(key == "name" ? e.name : e.type);
+            }
+            else if (t == JsonToken::ObjectBegin || t == JsonToken::ArrayBegin) {
+                if (!r.skip_container()) return false;
+            }
+            else if (t == JsonToken::Error) {
+                return false;
+            }
+        }
+        else if (key == "is_free") {
+            seen |= DATA_IS_FREE;
+            t = r.next();
+            e.is_free = (t == JsonToken::True);
+            if (t == JsonToken::ObjectBegin || t == JsonToken::ArrayBegin) {
+                if (!r.skip_container()) return false;
+            }
+            else if (t == JsonToken::Error) {
+                return false;
+            }
+        }
+        else if (key == "steam_appid") {
+            seen |= DATA_STEAM_APPID;
+            t = r.next();
+            if (t == JsonToken::Number) {
+                parse_u32(r.text(), e.steam_appid);
+            }
+            else if (t == JsonToken::ObjectBegin || t == JsonToken::ArrayBegin) {
+                if (!r.skip_container()) return false;
+            }
+            else if (t == JsonToken::Error) {
+                return false;
+            }
+        }
+        else if (!r.skip_value()) {
+            return false;
+        }
+    }
+}
+
+// Read one "<appid>": {...} value; reader is just past its '{'. With
+// stop_early, returns once "success" and the members of "data" are in, without
+// reading the rest (descriptions, screenshots...), and sets *stopped; the
+// reader is then left inside the entry.
+static bool read_app_entry(JsonReader& r, AppDetailsEntry& e, bool stop_early = false, bool* stopped = nullptr)
+{
+    bool seen_success = false;
+    for (;;) {
+        JsonToken t = r.next();
+        if (t == JsonToken::ObjectEnd) {
+            return true;
+        }
+        if (t != JsonToken::Key) {
+            return false;
+        }
+
+        std::string_view key = r.text();
+        if (key == "success") {
+            seen_success = true;
+            t = r.next();
+            e.success = (t == JsonToken::True);
+            if (t == JsonToken::ObjectBegin || t == JsonToken::ArrayBegin) {
+                if (!r.skip_container()) return false;
+            }
+            else if (t == JsonToken::Error) {
+                return false;
+            }
+        }
+        else if (key == "data") {
+            t = r.next();
+            if (t == JsonToken::ObjectBegin) {
+                bool data_done = false;
+                if (!read_app_data(r, e, stop_early, &data_done)) return false;
+                if (data_done) {
+                    if (seen_success) {
+                        *stopped = true;
+                        return true;
+                    }
+                    // "success" comes later: finish the object the usual way.
+                    if (!r.skip_container()) return false;
+                }
+            }
+            else if (t == JsonToken::ArrayBegin) {
+                // Unsuccessful entries sometimes carry "data": [].
+                if (!r.skip_container()) return false;
+            }
+            else if (t == JsonToken::Error) {
+                return false;
+            }
+        }
+        else if (!r.skip_value()) {
+            return false;
+        }
+    }
+}
+
+bool parse_appdetails(std::string_view json, std::vector<AppDetailsEntry>& out)
+{
+    JsonReader r(json);
+    if (r.next() != JsonToken::ObjectBegin) {
+        return false;
+    }
+
+    for (;;) {
+        JsonToken t = r.next();
+        if (t == JsonToken::ObjectEnd) {
+            return true;
+        }
+        if (t != JsonToken::Key) {
+            return false;
+        }
+
+        AppDetailsEntry e;
+        if (!parse_u32(r.text(), e.appid)) {
+            if (!r.skip_value()) return false;
+            continue;
+        }
+
+        t = r.next();
+        if (t == JsonToken::ObjectBegin) {
+            if (!read_app_entry(r, e)) {
+                return false;
+            }
+            out.push_back(std::move(e));
+        }
+        else if (t == JsonToken::ArrayBegin) {
+            if (!r.skip_container()) return false;
+        }
+        else if (t == JsonToken::Error) {
+            return false;
+        }
+    }
+}
+
+bool find_appdetails(std::string_view json, uint32_t appid, AppDetailsEntry& out)
+{
+    // The interactive lookup reads one app from a one-app response: skip the
+    // other entries unread and stop once this one's fields are in.
+    JsonReader r(json);
+    if (r.next() != JsonToken::ObjectBegin) {
+        return false;
+    }
+
+    for (;;) {
+        JsonToken t = r.next();
+        if (t != JsonToken::Key) {
+            return false;
+        }
+
+        uint32_t key = 0;
+        if (!parse_u32(r.text(), key) || key != appid) {
+            if (!r.skip_value()) return false;
+            continue;
+        }
+
+        t = r.next();
+        if (t != JsonToken::ObjectBegin) {
+            return false;
+        }
+        AppDetailsEntry e;
+        e.appid = appid;
+        bool stopped = false;
+        if (!read_app_entry(r, e, true, &stopped)) {
+            return false;
+        }
+        out = std::move(e);
+        return true;
+    }
+}
@@ -0,0 +1,98 @@
+// json_reader.h
+// Single-pass, zero-copy JSON tokenizer and the appdetails response reader
+// built on it.
+//
+// JsonReader walks the input once, left to right, and hands out tokens whose
+// text is a view into the input. Strings are only decoded (escapes, \uXXXX,
+// surrogate pairs -> UTF-8) when the caller asks for them, so skipping the
+// large description fields of an appdetails payload costs a scan and nothing
+// else.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class JsonToken {
+    ObjectBegin,
+    ObjectEnd,
+    ArrayBegin,
+    ArrayEnd,
+    Key,        // object member name; text() is the raw (undecoded) name
+    String,     // text() is the raw (undecoded) string
+    Number,     // text() is the number literal
+    True,
+    False,
+    Null,
+    End,        // end of input after a complete value
+    Error,      // malformed input; every later call returns Error too
+};
+
+class JsonReader {
+public:
+    explicit JsonReader(std::string_view input);
+
+    // Advance to the next token.
+    JsonToken next();
+
+    // Raw text of the current Key / String / Number token (quotes excluded).
+    std::string_view text() const { return text_; }
+
+    // Decode the current Key / String token into out (replacing its contents).
+    void decode(std::string& out) const;
+
+    // Skip the value that starts at the next token (scalar or whole
+    // container). Call right after reading a Key. Returns false on Error.
+    bool skip_value();
+
+    // Skip the rest of the container whose Begin token was just returned.
+    bool skip_container();
+
+    // Nesting depth of the current position (0 outside any container).
+    size_t depth() const { return stack_.size(); }
+
+private:
+    JsonToken fail();
+    JsonToken scan_string(JsonToken kind);
+    JsonToken scan_literal(const char* word, JsonToken kind);
+    JsonToken scan_number();
+    void skip_ws();
+
+    std::string_view in_;
+    size_t pos_ = 0;
+    std::string_view text_;
+    bool text_has_escapes_ = false;
+
+    // One entry per open container: true for objects, false for arrays.
+    std::vector<bool> stack_;
+    int state_ = 0;              // ReaderState, see json_reader.cpp
+    bool error_ = false;
+};
+
+// Decode a raw JSON string body (as returned by JsonReader::text()) to UTF-8.
+// Invalid escapes and unpaired surrogates become U+FFFD.
+void json_unescape(std::string_view raw, std::string& out);
+
+// One app from an appdetails response.
+struct AppDetailsEntry {
+    uint32_t appid = 0;       // key of the entry
+    bool success = false;     // "success": true
+    std::string name;         // data.name
+    std::string type;         // data.type ("game", "dlc", "demo", ...)
+    bool is_free = false;     // data.is_free
+    uint32_t steam_appid = 0; // data.steam_appid (differs from appid for redirects)
+};
+
+// Read every "<appid>": {...} entry of an appdetails response, single or
+// batched. Entries whose key is not a number are ignored. Returns false if
+// the input is not a JSON object (e.g. the Store's bare "null"); entries read
+// before a syntax error are kept.
+bool parse_appdetails(std::string_view json, std::vector<AppDetailsEntry>& out);
+
+// The entry for appid, or false if the response has none. Other entries are
+// skipped without being read, and reading stops as soon as the entry's
+// success, name, type, is_free and steam_appid are in, so the large fields
+// after them are never scanned.
+bool find_appdetails(std::string_view json, uint32_t appid, AppDetailsEntry& out);
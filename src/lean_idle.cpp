@@ -0,0 +1,45 @@
+// lean_idle.cpp
+// Minimal-footprint idling. See lean_idle.h.
+
+#include "lean_idle.h"
+#include "phase_timings.h"
+
+#include <cstdio>
+
+using std::string;
+
+LeanReport enter_lean_idle(const std::function<void()>& release, bool release_console)
+{
+    LeanReport report;
+    platform_memory_usage(report.before);
+    if (release) {
+        release();
+    }
+    if (release_console) {
+        platform_release_console();
+    }
+    platform_trim_memory();
+    platform_memory_usage(report.after);
+    return report;
+}
+
+static string mib(std::uint64_t bytes)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1f MiB", bytes / (1024.0 * 1024.0));
+    return buf;
+}
+
+string describe_lean_report(const LeanReport& report)
+{
+    return "private " + mib(report.before.private_bytes) + " -> " + mib(report.after.private_bytes) +
+        ", working set " + mib(report.before.working_set) + " -> " + mib(report.after.working_set);
+}
+
+void record_lean_report(PhaseTimings& timings, const LeanReport& report)
+{
+    timings.set("lean_private_kb_before", std::to_string(report.before.private_bytes / 1024));
+    timings.set("lean_private_kb_after", std::to_string(report.after.private_bytes / 1024));
+    timings.set("lean_ws_kb_before", std::to_string(report.before.working_set / 1024));
+    timings.set("lean_ws_kb_after", std::to_string(report.after.working_set / 1024));
+}
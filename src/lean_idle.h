@@ -0,0 +1,31 @@
+// lean_idle.h
+// --lean: once SteamAPI_Init has succeeded the process only needs its callback
+// pump. Going lean drops what the startup path needed (the Store HTTP client
+// and its buffers, the cache mapping, the library index; optionally the
+// console), hands free heap back to the system and empties the working set.
+// Private bytes and working set are measured on both sides so per-instance
+// memory can be tracked from one release to the next.
+
+#pragma once
+
+#include "platform.h"
+
+#include <functional>
+#include <string>
+
+class PhaseTimings;
+
+struct LeanReport {
+    MemoryUsage before;
+    MemoryUsage after;
+};
+
+// Measure, run release (the caller frees its startup state there), release the
+// console if asked, trim memory and measure again.
+LeanReport enter_lean_idle(const std::function<void()>& release, bool release_console);
+
+// e.g. "private 3.2 MiB -> 2.5 MiB, working set 11.0 MiB -> 1.4 MiB".
+std::string describe_lean_report(const LeanReport& report);
+
+// Add the numbers to a --timings record (lean_private_kb_before, ...).
+void record_lean_report(PhaseTimings& timings, const LeanReport& report);
@@ -0,0 +1,272 @@
+// main_headless.cpp
+// Headless front-end (Linux and other POSIX systems): the same modes as the
+// Windows console program, without prompts, console windows or colours, so it
+// can run under systemd, in containers or by the dozen from a script.
+//
+//   simplesteamidler [options] [appid]   idle one AppID until SIGINT/SIGTERM
+//   simplesteamidler --daemon            serve the control socket (see daemon.h)
+//
+// The AppID comes from the command line or steam_appid.txt; a title on the
+// command line is looked up in the app catalog (app_catalog.h). Nothing is
+// asked interactively: a missing library, a logged-off client or a game that
+// is not owned ends the process with the matching WorkerExitCode (see
+// supervisor.h), so wrappers can tell permanent failures from ones worth
+// retrying.
+// libsteam_api.so is looked up in the working directory first, then on the
+// library search path (LD_LIBRARY_PATH).
+
+#ifndef _WIN32
+
+#include "app_catalog.h"
+#include "appdetails_cache.h"
+#include "daemon.h"
+#include "idle_session.h"
+#include "lean_idle.h"
+#include "metrics.h"
+#include "options.h"
+#include "ownership_probe.h"
+#include "phase_timings.h"
+#include "platform.h"
+#include "profile.h"
+#include "rotation.h"
+#include "session_ledger.h"
+#include "steam_library.h"
+#include "store.h"
+#include "store_validate.h"
+#include "supervisor.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+using std::string;
+
+static int exit_code_for(IdleStartResult result)
+{
+    switch (result) {
+    case IdleStartResult::Idling: return WORKER_EXIT_STOPPED;
+    case IdleStartResult::NoLibrary: return WORKER_EXIT_NO_DLL;
+    case IdleStartResult::BadLibrary: return WORKER_EXIT_BAD_DLL;
+    case IdleStartResult::SteamNotRunning: return WORKER_EXIT_STEAM_NOT_RUNNING;
+    case IdleStartResult::NotOwned: return WORKER_EXIT_NOT_OWNED;
+    }
+    return WORKER_EXIT_BAD_ARGS;
+}
+
+static int run_headless(const Options& opts, PhaseTimings& startup)
+{
+    PhaseTimings* timings = opts.timings ? &startup : nullptr;
+    startup.set("mode", "headless");
+    startup.set("result", "exit");
+    TimingsReport timings_report(timings, opts.timings_path, opts.timings_log);
+
+    // Every Steam app by name, if a catalog was built (see app_catalog.h).
+    AppCatalog catalog;
+    {
+        ScopedPhase phase(timings, "catalog.open");
+        catalog.open(opts.catalog_path);
+    }
+
+    string appid = !opts.appid.empty() ? opts.appid : read_appid_from_file();
+    if (!opts.appid.empty() && !is_digits_only(appid)) {
+        // A title instead: fine if the catalog has exactly one app by that
+        // name, or only one match at all.
+        std::vector<TitleMatch> matches = match_title(appid, nullptr, catalog, 10);
+        size_t exact = std::count_if(matches.begin(), matches.end(), [](const TitleMatch& m) { return m.exact; });
+        if (matches.size() == 1 || exact == 1) {
+            const TitleMatch& m = matches.size() == 1 ? matches[0] :
+                *std::find_if(matches.begin(), matches.end(), [](const TitleMatch& t) { return t.exact; });
+            print_utf8_line("\"" + appid + "\" is \"" + m.name + "\" (AppID " + std::to_string(m.appid) + ").");
+            appid = std::to_string(m.appid);
+        }
+        else if (!matches.empty()) {
+            std::fprintf(stderr, "Error: \"%s\" matches several apps; give one of their AppIDs:\n", appid.c_str());
+            for (const auto& m : matches) {
+                std::fprintf(stderr, "  %u  %s\n", m.appid, m.name.c_str());
+            }
+            return WORKER_EXIT_BAD_ARGS;
+        }
+        else if (!catalog.is_open()) {
+            std::fprintf(stderr, "Error: no app catalog (%s) to look \"%s\" up in; see --build-catalog.\n",
+                opts.catalog_path.c_str(), appid.c_str());
+            return WORKER_EXIT_BAD_ARGS;
+        }
+    }
+    if (!is_digits_only(appid)) {
+        std::fprintf(stderr, "Error: give an AppID (digits only) on the command line or in steam_appid.txt.\n");
+        return WORKER_EXIT_BAD_ARGS;
+    }
+    startup.set("appid", appid);
+
+    AppDetailsCache store_cache;
+    AppDetailsCache* store_cache_ptr = nullptr;
+    {
+        ScopedPhase phase(timings, "cache.open");
+        store_cache_ptr = store_cache.open() ? &store_cache : nullptr;
+    }
+    SteamLibraryIndex library;
+    {
+        ScopedPhase phase(timings, "library.scan");
+        library.load(opts.steam_dir);
+    }
+    startup.set("installed", std::to_string(library.apps().size()));
+
+    std::unique_ptr<HttpClient> store_http;
+    {
+        ScopedPhase phase(timings, "http.session");
+        store_http = make_store_client(opts.store_endpoint, opts.http_timeouts);
+    }
+
+    SessionLedger ledger;
+    IdleSessionConfig config;
+    config.store_http = store_http.get();
+    config.cache = store_cache_ptr;
+    config.ledger = !opts.ledger_path.empty() && ledger.open(opts.ledger_path, opts.ledger_heartbeat_s) ? &ledger : nullptr;
+    config.refresh_store = opts.refresh_store;
+    config.pump = opts.pump;
+    config.timings = timings;
+    config.watchdog = opts.watchdog;
+    config.on_steam_change = [](bool connected, const string& detail) {
+        print_utf8_line(connected ? string("Steam is back; idling again.") :
+            "Steam connection lost (" + detail + "); reconnecting when the client returns.");
+    };
+    IdleSession session(config);
+
+    IdleStartResult result = session.start(appid);
+    startup.set("result", idle_start_result_name(result));
+    // SteamAPI_InitFlat's own explanation, when the library has one.
+    string detail = session.start_detail().empty() ? string() : " [" + session.start_detail() + "]";
+    switch (result) {
+    case IdleStartResult::Idling:
+        break;
+    case IdleStartResult::NoLibrary:
+        print_utf8_line("Error: could not load libsteam_api.so (working directory or library path).");
+        return exit_code_for(result);
+    case IdleStartResult::BadLibrary:
+        print_utf8_line("Error: libsteam_api.so cannot start Steam (incompatible library?): " + session.start_detail() + ".");
+        return exit_code_for(result);
+    case IdleStartResult::SteamNotRunning:
+        print_utf8_line("Error: Steam client is not running with a valid user session." + detail);
+        return exit_code_for(result);
+    case IdleStartResult::NotOwned:
+        print_utf8_line("Error: AppID " + appid + " is not owned by the logged-in account (or does not exist)." + detail);
+        return exit_code_for(result);
+    }
+
+    // Same join policy as the Windows front-end: an installed game is named
+    // from its manifest (or the app catalog) right away, others get a short
+    // wait for the Store.
+    const InstalledApp* installed = library.find(appid);
+    string name = installed ? installed->name : string();
+    if (name.empty()) {
+        name = catalog.name_of(static_cast<uint32_t>(std::strtoul(appid.c_str(), nullptr, 10)));
+    }
+    {
+        ScopedPhase phase(timings, "store.join");
+        if (session.wait_store(name.empty() ? IdleSession::STORE_JOIN_WAIT : std::chrono::milliseconds(0))) {
+            StoreLookup store = session.store_result();
+            startup.set("store", !store.fetched ? "unreachable" : store.from_cache ? "cache" : "network");
+            if (store.success && !store.name.empty()) {
+                name = store.name;
+            }
+        }
+        else {
+            startup.set("store", name.empty() ? "pending" : "local");
+        }
+    }
+
+    if (!name.empty()) {
+        print_utf8_line("Idling \"" + name + "\" (AppID " + appid + "), pid " +
+            std::to_string(platform_current_pid()) + ".");
+    }
+    else {
+        print_utf8_line("Idling AppID " + appid + ", pid " + std::to_string(platform_current_pid()) + ".");
+    }
+
+    // --lean: drop the Store client, cache and library index once the lookup
+    // is over, then trim; --lean-detach also lets go of the terminal.
+    if (opts.lean) {
+        ScopedPhase phase(timings, "lean");
+        LeanReport lean = enter_lean_idle([&]() {
+            session.store_result();
+            store_http.reset();
+            store_cache.close();
+            library = SteamLibraryIndex();
+            catalog.close();
+        }, opts.lean_detach);
+        record_lean_report(startup, lean);
+        print_utf8_line("Lean idle: " + describe_lean_report(lean) + ".");
+    }
+    timings_report.write();
+    if (!opts.lean_detach) {
+        print_utf8_line(string(stop_request_hint()) + " to stop.");
+    }
+
+    wait_for_stop_request();
+    session.stop();
+
+    print_utf8_line("Callback pump: " + describe_pump_stats(session.pump_stats()) + ".");
+    print_utf8_line("Stopped.");
+    return WORKER_EXIT_STOPPED;
+}
+
+int main(int argc, char** argv)
+{
+    // Created first so every phase is measured from (nearly) process start.
+    PhaseTimings startup;
+    platform_init();
+
+    Options opts;
+    string options_error;
+    if (!parse_options(argc, argv, opts, options_error)) {
+        std::fprintf(stderr, "Error: %s\n", options_error.c_str());
+        return WORKER_EXIT_BAD_ARGS;
+    }
+
+    MetricsServer metrics;
+    if (opts.mode == RunMode::Interactive || opts.mode == RunMode::Supervise || opts.mode == RunMode::Rotate ||
+        opts.mode == RunMode::Profile || opts.mode == RunMode::Daemon) {
+        serve_metrics(metrics, opts.metrics_port);
+    }
+
+    switch (opts.mode) {
+    case RunMode::Worker:
+        return run_worker(opts.appid, opts.control_in, opts.control_out, worker_options(opts));
+    case RunMode::Supervise:
+        return run_supervisor(opts.appids, worker_options(opts));
+    case RunMode::Rotate:
+        return run_rotation(opts.rotation, worker_options(opts));
+    case RunMode::Profile:
+        return run_profile(opts.profile, worker_options(opts));
+    case RunMode::ListInstalled:
+        return run_list_installed(opts.steam_dir);
+    case RunMode::BuildCatalog:
+        return run_build_catalog(opts.catalog_source, opts.catalog_path);
+    case RunMode::FindApp:
+        return run_find_app(opts.catalog_path, opts.query);
+    case RunMode::LedgerReport:
+        return run_ledger_report(opts.ledger_path);
+    case RunMode::Daemon:
+        return run_daemon(opts.endpoint, worker_options(opts));
+    case RunMode::Control:
+        return run_control_command(opts.endpoint, opts.command);
+    case RunMode::Validate: {
+        AppDetailsCache cache;
+        std::unique_ptr<HttpClient> http = make_store_client(opts.store_endpoint, opts.http_timeouts);
+        return run_validate(opts.appids, opts.validate, *http, cache.open() ? &cache : nullptr);
+    }
+    case RunMode::Probe: {
+        AppDetailsCache cache;
+        std::unique_ptr<HttpClient> http = make_store_client(opts.store_endpoint, opts.http_timeouts);
+        return run_probe(opts.appids, opts.probe, opts.validate, *http, cache.open() ? &cache : nullptr);
+    }
+    case RunMode::Interactive:
+        break;
+    }
+    return run_headless(opts, startup);
+}
+
+#endif // !_WIN32
@@ -0,0 +1,159 @@
+// mapped_file.cpp
+// Memory-mapped file. See mapped_file.h.
+
+#define NOMINMAX
+
+#include "mapped_file.h"
+#include "util.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open_rw(const std::string& path, size_t min_size)
+{
+    return map(path, min_size, true);
+}
+
+bool MappedFile::open_ro(const std::string& path)
+{
+    return map(path, 0, false);
+}
+
+#ifdef _WIN32
+
+bool MappedFile::map(const std::string& path, size_t min_size, bool writable)
+{
+    close();
+
+    std::wstring wpath = utf8_to_wstring(path);
+    HANDLE file = CreateFileW(wpath.c_str(),
+        writable ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL,
+        writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size = {};
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+
+    size_t map_size = static_cast<size_t>(size.QuadPart);
+    if (writable && map_size < min_size) {
+        // CreateFileMapping grows the file to the requested size (zero-filled).
+        map_size = min_size;
+    }
+    if (map_size == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    ULONGLONG map_size64 = static_cast<ULONGLONG>(map_size);
+    HANDLE mapping = CreateFileMappingW(file, NULL, writable ? PAGE_READWRITE : PAGE_READONLY,
+        static_cast<DWORD>(map_size64 >> 32), static_cast<DWORD>(map_size64 & 0xFFFFFFFFu), NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* view = MapViewOfFile(mapping, writable ? (FILE_MAP_READ | FILE_MAP_WRITE) : FILE_MAP_READ, 0, 0, map_size);
+    if (!view) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    file_ = file;
+    mapping_ = mapping;
+    data_ = view;
+    size_ = map_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_) {
+        UnmapViewOfFile(data_);
+        data_ = nullptr;
+    }
+    if (mapping_) {
+        CloseHandle(mapping_);
+        mapping_ = nullptr;
+    }
+    if (file_) {
+        CloseHandle(file_);
+        file_ = nullptr;
+    }
+    size_ = 0;
+}
+
+#else
+
+bool MappedFile::map(const std::string& path, size_t min_size, bool writable)
+{
+    close();
+
+    int fd = ::open(path.c_str(), writable ? (O_RDWR | O_CREAT | O_CLOEXEC) : (O_RDONLY | O_CLOEXEC), 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t map_size = static_cast<size_t>(st.st_size);
+    if (writable && map_size < min_size) {
+        // Unlike CreateFileMapping, mmap does not grow the file: extend it first.
+        if (ftruncate(fd, static_cast<off_t>(min_size)) != 0) {
+            ::close(fd);
+            return false;
+        }
+        map_size = min_size;
+    }
+    if (map_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, map_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        ::close(fd);
+        return false;
+    }
+
+    fd_ = fd;
+    data_ = view;
+    size_ = map_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (data_) {
+        munmap(data_, size_);
+        data_ = nullptr;
+    }
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    size_ = 0;
+}
+
+#endif // _WIN32
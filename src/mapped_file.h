@@ -0,0 +1,41 @@
+// mapped_file.h
+// Minimal read/write memory-mapped file (Win32 file mappings or POSIX mmap).
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Open (creating if needed) and map the whole file for reading and writing.
+    // If the file is smaller than min_size it is zero-extended to min_size first.
+    bool open_rw(const std::string& path, size_t min_size);
+
+    // Map an existing file read-only. Fails on missing or empty files.
+    bool open_ro(const std::string& path);
+
+    void close();
+
+    bool is_open() const { return data_ != nullptr; }
+    unsigned char* data() const { return static_cast<unsigned char*>(data_); }
+    size_t size() const { return size_; }
+
+private:
+    bool map(const std::string& path, size_t min_size, bool writable);
+
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    void* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,362 @@
+// metrics.cpp
+// Prometheus metrics and their loopback endpoint. See metrics.h.
+
+#include "metrics.h"
+#include "steam_api.h"
+#include "util.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+// Histogram bucket upper bounds, in microseconds.
+static const std::uint64_t CALLBACK_BOUNDS_US[] = { 10, 25, 50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000, 250000 };
+static const std::uint64_t DRIFT_BOUNDS_US[] = { 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000 };
+static const std::uint64_t LOOKUP_BOUNDS_US[] = { 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000 };
+
+// Fixed-bucket histogram of microsecond values. Buckets are stored
+// per-interval and summed into Prometheus' cumulative form when scraped.
+template <size_t N>
+class Histogram {
+public:
+    explicit Histogram(const std::uint64_t (&bounds)[N]) : bounds_(bounds) {}
+
+    void observe(std::uint64_t us)
+    {
+        size_t i = 0;
+        while (i < N && us > bounds_[i]) {
+            ++i;
+        }
+        counts_[i].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_us_.fetch_add(us, std::memory_order_relaxed);
+    }
+
+    void append(string& out, const char* name, const char* help) const
+    {
+        append_metric_header(out, name, "histogram", help);
+        string bucket = string(name) + "_bucket";
+        std::uint64_t cumulative = 0;
+        char le[32];
+        for (size_t i = 0; i < N; ++i) {
+            cumulative += counts_[i].load(std::memory_order_relaxed);
+            std::snprintf(le, sizeof(le), "%g", bounds_[i] / 1e6);
+            append_metric_sample(out, bucket.c_str(), "le", le, static_cast<double>(cumulative));
+        }
+        cumulative += counts_[N].load(std::memory_order_relaxed);
+        append_metric_sample(out, bucket.c_str(), "le", "+Inf", static_cast<double>(cumulative));
+        append_metric_sample(out, (string(name) + "_sum").c_str(), nullptr, string(),
+            sum_us_.load(std::memory_order_relaxed) / 1e6);
+        append_metric_sample(out, (string(name) + "_count").c_str(), nullptr, string(),
+            static_cast<double>(count_.load(std::memory_order_relaxed)));
+    }
+
+private:
+    const std::uint64_t (&bounds_)[N];
+    std::atomic<std::uint64_t> counts_[N + 1] = {};
+    std::atomic<std::uint64_t> count_{ 0 };
+    std::atomic<std::uint64_t> sum_us_{ 0 };
+};
+
+// Steady-clock nanoseconds, for timestamps kept in atomics.
+static std::int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+}
+
+static const IdleStartResult INIT_FAILURES[] = {
+    IdleStartResult::NoLibrary,
+    IdleStartResult::BadLibrary,
+    IdleStartResult::SteamNotRunning,
+    IdleStartResult::NotOwned,
+};
+static const size_t INIT_FAILURE_COUNT = sizeof(INIT_FAILURES) / sizeof(INIT_FAILURES[0]);
+
+// Set during static initialisation, i.e. at process start.
+static const std::int64_t PROCESS_STARTED_NS = now_ns();
+
+struct Registry {
+    std::atomic<std::uint64_t> pump_ticks{ 0 };
+    std::atomic<std::int64_t> pump_last_tick_ns{ 0 };
+    Histogram<sizeof(CALLBACK_BOUNDS_US) / sizeof(CALLBACK_BOUNDS_US[0])> pump_callback{ CALLBACK_BOUNDS_US };
+    Histogram<sizeof(DRIFT_BOUNDS_US) / sizeof(DRIFT_BOUNDS_US[0])> pump_drift{ DRIFT_BOUNDS_US };
+
+    Histogram<sizeof(LOOKUP_BOUNDS_US) / sizeof(LOOKUP_BOUNDS_US[0])> store_lookup{ LOOKUP_BOUNDS_US };
+    std::atomic<std::uint64_t> store_cache_hits{ 0 };
+    std::atomic<std::uint64_t> store_cache_misses{ 0 };
+    std::atomic<std::uint64_t> store_failures{ 0 };
+
+    std::atomic<std::uint64_t> init_attempts{ 0 };
+    std::atomic<std::uint64_t> init_failures[INIT_FAILURE_COUNT] = {};
+    std::atomic<std::uint64_t> steam_losses{ 0 };
+
+    // 0 when no session is idling.
+    std::atomic<std::uint32_t> session_appid{ 0 };
+    std::atomic<std::int64_t> session_started_ns{ 0 };
+
+    std::mutex provider_mutex;
+    std::function<void(string&)> provider;
+};
+
+static Registry& registry()
+{
+    static Registry r;
+    return r;
+}
+
+// --------------------------- Recording ---------------------------
+
+void metrics_pump_tick(std::uint64_t callback_us, std::uint64_t drift_us)
+{
+    Registry& r = registry();
+    r.pump_ticks.fetch_add(1, std::memory_order_relaxed);
+    r.pump_last_tick_ns.store(now_ns(), std::memory_order_relaxed);
+    r.pump_callback.observe(callback_us);
+    r.pump_drift.observe(drift_us);
+}
+
+void metrics_store_cache(bool hit)
+{
+    Registry& r = registry();
+    (hit ? r.store_cache_hits : r.store_cache_misses).fetch_add(1, std::memory_order_relaxed);
+}
+
+void metrics_store_lookup(std::uint64_t us, bool answered)
+{
+    Registry& r = registry();
+    r.store_lookup.observe(us);
+    if (!answered) {
+        r.store_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void metrics_init_result(IdleStartResult result)
+{
+    Registry& r = registry();
+    r.init_attempts.fetch_add(1, std::memory_order_relaxed);
+    for (size_t i = 0; i < INIT_FAILURE_COUNT; ++i) {
+        if (INIT_FAILURES[i] == result) {
+            r.init_failures[i].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void metrics_steam_lost()
+{
+    registry().steam_losses.fetch_add(1, std::memory_order_relaxed);
+}
+
+void metrics_session_started(const string& appid)
+{
+    Registry& r = registry();
+    r.session_started_ns.store(now_ns(), std::memory_order_relaxed);
+    r.session_appid.store(static_cast<std::uint32_t>(std::strtoul(appid.c_str(), nullptr, 10)),
+        std::memory_order_release);
+}
+
+void metrics_session_stopped()
+{
+    registry().session_appid.store(0, std::memory_order_release);
+}
+
+void metrics_set_provider(std::function<void(string&)> provider)
+{
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.provider_mutex);
+    r.provider = std::move(provider);
+}
+
+// --------------------------- Exposition ---------------------------
+
+void append_metric_header(string& out, const char* name, const char* type, const char* help)
+{
+    out += "# HELP ";
+    out += name;
+    out += ' ';
+    out += help;
+    out += "\n# TYPE ";
+    out += name;
+    out += ' ';
+    out += type;
+    out += '\n';
+}
+
+void append_metric_sample(string& out, const char* name, const char* label, const string& label_value,
+    double value)
+{
+    out += name;
+    if (label) {
+        out += '{';
+        out += label;
+        out += "=\"";
+        for (char c : label_value) {
+            if (c == '"' || c == '\\') out += '\\';
+            if (c == '\n') { out += "\\n"; continue; }
+            out += c;
+        }
+        out += "\"}";
+    }
+    // Counters print as integers, durations with microsecond-ish precision.
+    char buf[48];
+    if (value > -9e15 && value < 9e15 && value == static_cast<double>(static_cast<long long>(value))) {
+        std::snprintf(buf, sizeof(buf), " %lld\n", static_cast<long long>(value));
+    }
+    else {
+        std::snprintf(buf, sizeof(buf), " %.9g\n", value);
+    }
+    out += buf;
+}
+
+static double seconds_since_ns(std::int64_t then_ns)
+{
+    return (now_ns() - then_ns) / 1e9;
+}
+
+string metrics_text()
+{
+    Registry& r = registry();
+    string out;
+    out.reserve(4096);
+
+    append_metric_header(out, "ssi_process_uptime_seconds", "gauge", "Seconds since this process started.");
+    append_metric_sample(out, "ssi_process_uptime_seconds", nullptr, string(), seconds_since_ns(PROCESS_STARTED_NS));
+
+    std::uint32_t appid = r.session_appid.load(std::memory_order_acquire);
+    if (appid != 0) {
+        append_metric_header(out, "ssi_session_uptime_seconds", "gauge", "Seconds the AppID has been idling.");
+        append_metric_sample(out, "ssi_session_uptime_seconds", "appid", std::to_string(appid),
+            seconds_since_ns(r.session_started_ns.load(std::memory_order_relaxed)));
+    }
+
+    append_metric_header(out, "ssi_pump_ticks_total", "counter", "SteamAPI_RunCallbacks calls.");
+    append_metric_sample(out, "ssi_pump_ticks_total", nullptr, string(),
+        static_cast<double>(r.pump_ticks.load(std::memory_order_relaxed)));
+    std::int64_t last_tick = r.pump_last_tick_ns.load(std::memory_order_relaxed);
+    if (last_tick != 0) {
+        append_metric_header(out, "ssi_pump_last_tick_age_seconds", "gauge",
+            "Seconds since the callback pump last ran.");
+        append_metric_sample(out, "ssi_pump_last_tick_age_seconds", nullptr, string(), seconds_since_ns(last_tick));
+    }
+    r.pump_callback.append(out, "ssi_pump_callback_seconds", "Time spent in SteamAPI_RunCallbacks per tick.");
+    r.pump_drift.append(out, "ssi_pump_drift_seconds", "How late the callback pump woke up per tick.");
+
+    r.store_lookup.append(out, "ssi_store_lookup_seconds", "Steam Store appdetails requests over the network.");
+    append_metric_header(out, "ssi_store_cache_hits_total", "counter", "Store answers served from appdetails.cache.");
+    append_metric_sample(out, "ssi_store_cache_hits_total", nullptr, string(),
+        static_cast<double>(r.store_cache_hits.load(std::memory_order_relaxed)));
+    append_metric_header(out, "ssi_store_cache_misses_total", "counter", "Store lookups the cache could not answer.");
+    append_metric_sample(out, "ssi_store_cache_misses_total", nullptr, string(),
+        static_cast<double>(r.store_cache_misses.load(std::memory_order_relaxed)));
+    append_metric_header(out, "ssi_store_lookup_failures_total", "counter", "Store requests that got no answer.");
+    append_metric_sample(out, "ssi_store_lookup_failures_total", nullptr, string(),
+        static_cast<double>(r.store_failures.load(std::memory_order_relaxed)));
+
+    append_metric_header(out, "ssi_init_attempts_total", "counter", "SteamAPI_Init attempts.");
+    append_metric_sample(out, "ssi_init_attempts_total", nullptr, string(),
+        static_cast<double>(r.init_attempts.load(std::memory_order_relaxed)));
+    append_metric_header(out, "ssi_init_failures_total", "counter", "Failed SteamAPI_Init attempts by reason.");
+    for (size_t i = 0; i < INIT_FAILURE_COUNT; ++i) {
+        append_metric_sample(out, "ssi_init_failures_total", "reason", idle_start_result_name(INIT_FAILURES[i]),
+            static_cast<double>(r.init_failures[i].load(std::memory_order_relaxed)));
+    }
+
+    append_metric_header(out, "ssi_steam_losses_total", "counter",
+        "Idling sessions lost to a Steam client restart or log-off.");
+    append_metric_sample(out, "ssi_steam_losses_total", nullptr, string(),
+        static_cast<double>(r.steam_losses.load(std::memory_order_relaxed)));
+
+    std::lock_guard<std::mutex> lock(r.provider_mutex);
+    if (r.provider) {
+        r.provider(out);
+    }
+    return out;
+}
+
+// --------------------------- Endpoint ---------------------------
+
+// How long a scrape may take to send its request line before it is dropped.
+static const int REQUEST_TIMEOUT_MS = 2000;
+
+MetricsServer::~MetricsServer()
+{
+    stop();
+}
+
+bool MetricsServer::start(std::uint16_t port, string& error)
+{
+    if (thread_.joinable()) {
+        return true;
+    }
+    listener_ = net_listen_loopback(port);
+    if (listener_ == NET_INVALID_SOCKET) {
+        error = "cannot listen on 127.0.0.1:" + std::to_string(port);
+        return false;
+    }
+    stop_ = false;
+    thread_ = std::thread(&MetricsServer::run, this);
+    return true;
+}
+
+void MetricsServer::stop()
+{
+    stop_ = true;
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    net_close(listener_);
+    listener_ = NET_INVALID_SOCKET;
+}
+
+// Scrapes are rare and quick: one connection at a time, then close.
+void MetricsServer::run()
+{
+    while (!stop_) {
+        net_socket s = net_accept(listener_, 250);
+        if (s == NET_INVALID_SOCKET) {
+            continue;
+        }
+        net_set_timeouts(s, REQUEST_TIMEOUT_MS, REQUEST_TIMEOUT_MS);
+
+        string request;
+        char buf[1024];
+        long got;
+        while (request.find("\r\n\r\n") == string::npos && request.size() < 8192 &&
+            (got = net_recv(s, buf, sizeof(buf))) > 0) {
+            request.append(buf, static_cast<size_t>(got));
+        }
+
+        string status = "200 OK", body;
+        if (request.compare(0, 13, "GET /metrics ") == 0 || request.compare(0, 14, "GET /metrics?") == 0) {
+            body = metrics_text();
+        }
+        else {
+            status = "404 Not Found";
+            body = "Metrics are at /metrics.\n";
+        }
+        string response = "HTTP/1.1 " + status + "\r\n"
+            "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+            "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            "Connection: close\r\n\r\n" + body;
+        net_send_all(s, response.data(), response.size());
+        net_close(s);
+    }
+}
+
+void serve_metrics(MetricsServer& server, std::uint16_t port)
+{
+    if (port == 0) {
+        return;
+    }
+    string error;
+    if (server.start(port, error)) {
+        print_utf8_line("Metrics: http://127.0.0.1:" + std::to_string(port) + "/metrics");
+    }
+    else {
+        print_utf8_line("Warning: no metrics endpoint, " + error + ".");
+    }
+}
@@ -0,0 +1,100 @@
+// metrics.h
+// Runtime metrics in the Prometheus text format, served on an opt-in,
+// loopback-only HTTP endpoint (--metrics-port):
+//
+//   curl http://127.0.0.1:9464/metrics
+//
+// Everything recorded is a fixed, process-wide set of atomics: a counter is
+// one relaxed fetch_add and a histogram observation three, with no lock and no
+// allocation, so the callback pump records every tick for free. Text is only
+// built when the endpoint is scraped.
+//
+// Series (seconds for durations):
+//   ssi_process_uptime_seconds
+//   ssi_session_uptime_seconds{appid}           idling AppID of this process
+//   ssi_pump_ticks_total, ssi_pump_last_tick_age_seconds
+//   ssi_pump_callback_seconds, ssi_pump_drift_seconds          (histograms)
+//   ssi_store_lookup_seconds (histogram of network lookups), ssi_store_cache_hits_total,
+//   ssi_store_cache_misses_total, ssi_store_lookup_failures_total
+//   ssi_init_attempts_total, ssi_init_failures_total{reason}
+//   ssi_steam_losses_total (see steam_watchdog.h)
+// plus what a provider adds, e.g. one ssi_worker_* series per supervised
+// worker (see supervisor.h).
+
+#pragma once
+
+#include "net.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+enum class IdleStartResult;
+
+// --------------------------- Recording ---------------------------
+
+// One callback pump tick: time inside SteamAPI_RunCallbacks and wake-up lateness.
+void metrics_pump_tick(std::uint64_t callback_us, std::uint64_t drift_us);
+
+// An appdetails answer from the on-disk cache (hit) or not (miss).
+void metrics_store_cache(bool hit);
+
+// A network Store lookup and whether it got an answer.
+void metrics_store_lookup(std::uint64_t us, bool answered);
+
+// Outcome of one SteamAPI_Init attempt (Idling counts as an attempt only).
+void metrics_init_result(IdleStartResult result);
+
+// The Steam client went away under an idling session.
+void metrics_steam_lost();
+
+// The AppID this process idles, from SteamAPI_Init success until stop.
+void metrics_session_started(const std::string& appid);
+void metrics_session_stopped();
+
+// Extra series appended at scrape time (called with the exposition text so
+// far). One provider at a time; null removes it. Setting it waits for a
+// scrape in progress, so an owner can clear it before it goes away.
+void metrics_set_provider(std::function<void(std::string&)> provider);
+
+// The whole exposition, as served on /metrics.
+std::string metrics_text();
+
+// --------------------------- Exposition helpers ---------------------------
+
+// "# HELP name help\n# TYPE name type\n".
+void append_metric_header(std::string& out, const char* name, const char* type, const char* help);
+
+// name{label="value"} number\n (label may be null for none).
+void append_metric_sample(std::string& out, const char* name, const char* label, const std::string& label_value,
+    double value);
+
+// --------------------------- Endpoint ---------------------------
+
+class MetricsServer {
+public:
+    MetricsServer() = default;
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    // Serve GET /metrics on 127.0.0.1:port from a background thread.
+    bool start(std::uint16_t port, std::string& error);
+
+    // Stop serving and join the thread. Safe to call more than once.
+    void stop();
+
+private:
+    void run();
+
+    net_socket listener_ = NET_INVALID_SOCKET;
+    std::atomic<bool> stop_{ false };
+    std::thread thread_;
+};
+
+// --metrics-port: start server on port (nothing when port is 0) and print
+// where it listens, or a warning when it cannot. Idling goes on either way.
+void serve_metrics(MetricsServer& server, std::uint16_t port);
@@ -0,0 +1,277 @@
+// net.cpp
+// TCP socket helpers. See net.h.
+
+#include "net.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include <cstring>
+#include <mutex>
+
+#ifdef _WIN32
+typedef SOCKET native_socket;
+#define NATIVE_INVALID INVALID_SOCKET
+#else
+typedef int native_socket;
+#define NATIVE_INVALID (-1)
+#endif
+
+static native_socket to_native(net_socket s)
+{
+    return static_cast<native_socket>(s);
+}
+
+static void set_nonblocking(native_socket s, bool enable)
+{
+#ifdef _WIN32
+    u_long mode = enable ? 1 : 0;
+    ioctlsocket(s, FIONBIO, &mode);
+#else
+    int flags = fcntl(s, F_GETFL, 0);
+    fcntl(s, F_SETFL, enable ? (flags | O_NONBLOCK) : (flags & ~O_NONBLOCK));
+#endif
+}
+
+static void close_native(native_socket s)
+{
+#ifdef _WIN32
+    closesocket(s);
+#else
+    ::close(s);
+#endif
+}
+
+bool net_init()
+{
+#ifdef _WIN32
+    static std::once_flag once;
+    static bool ok = false;
+    std::call_once(once, []() {
+        WSADATA wsa;
+        ok = (WSAStartup(MAKEWORD(2, 2), &wsa) == 0);
+        });
+    return ok;
+#else
+    return true;
+#endif
+}
+
+// Connect one resolved address with a deadline (non-blocking connect + poll).
+static native_socket connect_addr(const addrinfo* ai, int timeout_ms)
+{
+    native_socket s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (s == NATIVE_INVALID) {
+        return NATIVE_INVALID;
+    }
+
+    set_nonblocking(s, true);
+    int rc = connect(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen));
+    bool connected = (rc == 0);
+
+    if (!connected) {
+#ifdef _WIN32
+        bool pending = (WSAGetLastError() == WSAEWOULDBLOCK);
+        WSAPOLLFD pfd = {};
+        pfd.fd = s;
+        pfd.events = POLLOUT;
+        if (pending && WSAPoll(&pfd, 1, timeout_ms) == 1) {
+#else
+        bool pending = (errno == EINPROGRESS);
+        pollfd pfd = {};
+        pfd.fd = s;
+        pfd.events = POLLOUT;
+        if (pending && poll(&pfd, 1, timeout_ms) == 1) {
+#endif
+            int err = 0;
+            socklen_t len = sizeof(err);
+            getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&err), &len);
+            connected = (err == 0);
+        }
+    }
+
+    if (!connected) {
+        close_native(s);
+        return NATIVE_INVALID;
+    }
+
+    set_nonblocking(s, false);
+
+    // Requests are small and latency-bound: don't wait to coalesce them.
+    int one = 1;
+    setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+    return s;
+}
+
+net_socket net_connect(const std::string& host, uint16_t port, int timeout_ms)
+{
+    if (!net_init()) {
+        return NET_INVALID_SOCKET;
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+
+    addrinfo* result = nullptr;
+    std::string service = std::to_string(port);
+    if (getaddrinfo(host.c_str(), service.c_str(), &hints, &result) != 0 || !result) {
+        return NET_INVALID_SOCKET;
+    }
+
+    native_socket s = NATIVE_INVALID;
+    for (const addrinfo* ai = result; ai && s == NATIVE_INVALID; ai = ai->ai_next) {
+        s = connect_addr(ai, timeout_ms);
+    }
+    freeaddrinfo(result);
+
+    return (s == NATIVE_INVALID) ? NET_INVALID_SOCKET : static_cast<net_socket>(s);
+}
+
+bool net_set_timeouts(net_socket s, int send_ms, int recv_ms)
+{
+    native_socket ns = to_native(s);
+#ifdef _WIN32
+    DWORD snd = static_cast<DWORD>(send_ms);
+    DWORD rcv = static_cast<DWORD>(recv_ms);
+    return setsockopt(ns, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&snd), sizeof(snd)) == 0 &&
+        setsockopt(ns, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&rcv), sizeof(rcv)) == 0;
+#else
+    timeval snd = { send_ms / 1000, (send_ms % 1000) * 1000 };
+    timeval rcv = { recv_ms / 1000, (recv_ms % 1000) * 1000 };
+    return setsockopt(ns, SOL_SOCKET, SO_SNDTIMEO, &snd, sizeof(snd)) == 0 &&
+        setsockopt(ns, SOL_SOCKET, SO_RCVTIMEO, &rcv, sizeof(rcv)) == 0;
+#endif
+}
+
+bool net_send_all(net_socket s, const char* data, size_t len)
+{
+    native_socket ns = to_native(s);
+    while (len > 0) {
+#ifdef _WIN32
+        int n = send(ns, data, static_cast<int>(len), 0);
+#else
+        ssize_t n = send(ns, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+#endif
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+long net_recv(net_socket s, char* buf, size_t len)
+{
+    native_socket ns = to_native(s);
+#ifdef _WIN32
+    int n = recv(ns, buf, static_cast<int>(len), 0);
+    return (n == SOCKET_ERROR) ? -1 : n;
+#else
+    for (;;) {
+        ssize_t n = recv(ns, buf, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        return (n < 0) ? -1 : static_cast<long>(n);
+    }
+#endif
+}
+
+void net_close(net_socket s)
+{
+    if (s != NET_INVALID_SOCKET) {
+        close_native(to_native(s));
+    }
+}
+
+// Keep sockets out of worker processes (they inherit handles on Windows and
+// descriptors without FD_CLOEXEC elsewhere), or a worker would hold the port.
+static void set_no_inherit(native_socket s)
+{
+#ifdef _WIN32
+    SetHandleInformation(reinterpret_cast<HANDLE>(s), HANDLE_FLAG_INHERIT, 0);
+#else
+    fcntl(s, F_SETFD, FD_CLOEXEC);
+#endif
+}
+
+net_socket net_listen_loopback(uint16_t port)
+{
+    if (!net_init()) {
+        return NET_INVALID_SOCKET;
+    }
+    native_socket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (s == NATIVE_INVALID) {
+        return NET_INVALID_SOCKET;
+    }
+    set_no_inherit(s);
+
+    int one = 1;
+#ifdef _WIN32
+    // No other process may bind the same port on top of ours.
+    setsockopt(s, SOL_SOCKET, SO_EXCLUSIVEADDRUSE, reinterpret_cast<const char*>(&one), sizeof(one));
+#else
+    // Restarting must not wait for old connections in TIME_WAIT.
+    setsockopt(s, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+#endif
+
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    if (bind(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, 16) != 0) {
+        close_native(s);
+        return NET_INVALID_SOCKET;
+    }
+    return static_cast<net_socket>(s);
+}
+
+uint16_t net_local_port(net_socket s)
+{
+    sockaddr_in addr = {};
+    socklen_t len = sizeof(addr);
+    if (getsockname(to_native(s), reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        return 0;
+    }
+    return ntohs(addr.sin_port);
+}
+
+net_socket net_accept(net_socket listener, int timeout_ms)
+{
+    native_socket ls = to_native(listener);
+#ifdef _WIN32
+    WSAPOLLFD pfd = {};
+    pfd.fd = ls;
+    pfd.events = POLLIN;
+    if (WSAPoll(&pfd, 1, timeout_ms) != 1) {
+#else
+    pollfd pfd = {};
+    pfd.fd = ls;
+    pfd.events = POLLIN;
+    if (poll(&pfd, 1, timeout_ms) != 1) {
+#endif
+        return NET_INVALID_SOCKET;
+    }
+    native_socket s = accept(ls, nullptr, nullptr);
+    if (s == NATIVE_INVALID) {
+        return NET_INVALID_SOCKET;
+    }
+    set_no_inherit(s);
+    return static_cast<net_socket>(s);
+}
@@ -0,0 +1,42 @@
+// net.h
+// Thin blocking TCP socket helpers (Winsock / BSD sockets).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// SOCKET on Windows, file descriptor elsewhere.
+typedef std::intptr_t net_socket;
+const net_socket NET_INVALID_SOCKET = -1;
+
+// Initialise the socket library (WSAStartup on Windows). Safe to call repeatedly.
+bool net_init();
+
+// Resolve host and connect, giving up after timeout_ms.
+// Returns NET_INVALID_SOCKET on failure.
+net_socket net_connect(const std::string& host, uint16_t port, int timeout_ms);
+
+// Per-call send/receive deadlines; 0 means no timeout.
+bool net_set_timeouts(net_socket s, int send_ms, int recv_ms);
+
+// Send the whole buffer. Returns false on error or timeout.
+bool net_send_all(net_socket s, const char* data, size_t len);
+
+// Receive up to len bytes. Returns the byte count, 0 when the peer closed the
+// connection, or -1 on error / timeout.
+long net_recv(net_socket s, char* buf, size_t len);
+
+void net_close(net_socket s);
+
+// Listen on 127.0.0.1:port only. The socket is not inherited by child
+// processes. Returns NET_INVALID_SOCKET on failure (e.g. port in use).
+net_socket net_listen_loopback(uint16_t port);
+
+// The port a socket is bound to (e.g. after net_listen_loopback(0)); 0 on error.
+uint16_t net_local_port(net_socket s);
+
+// Wait up to timeout_ms for a connection on a listening socket.
+// Returns NET_INVALID_SOCKET on timeout or error.
+net_socket net_accept(net_socket listener, int timeout_ms);
@@ -0,0 +1,400 @@
+// options.cpp
+// Command-line parsing. See options.h.
+
+#include "options.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+
+using std::string;
+
+// Read an AppID list file: one or more AppIDs per line, '#' starts a comment.
+static bool read_appid_list_file(const string& path, std::vector<string>& out)
+{
+    std::ifstream ifs(path);
+    if (!ifs) return false;
+    string line;
+    while (std::getline(ifs, line)) {
+        size_t hash = line.find('#');
+        if (hash != string::npos) {
+            line.erase(hash);
+        }
+        for (const auto& id : split_appid_list(line)) {
+            out.push_back(id);
+        }
+    }
+    return true;
+}
+
+// True if s looks like a list of AppIDs ("440" or "440,570,730").
+static bool is_appid_list(const string& s)
+{
+    return !s.empty() && s.find_first_not_of("0123456789,") == string::npos;
+}
+
+// Consume the AppID arguments following argv[i] (AppIDs, comma-separated lists
+// or list files) up to the next "--" option. Leaves i on the last consumed one.
+static bool collect_appids(int argc, char** argv, int& i, std::vector<string>& out, string& error)
+{
+    while (i + 1 < argc) {
+        string item = trim(argv[i + 1] ? argv[i + 1] : "");
+        if (item.compare(0, 2, "--") == 0) {
+            break;
+        }
+        ++i;
+        if (item.empty()) continue;
+        if (is_appid_list(item)) {
+            for (const auto& id : split_appid_list(item)) {
+                out.push_back(id);
+            }
+        }
+        else if (!read_appid_list_file(item, out)) {
+            error = "Cannot read AppID list file \"" + item + "\".";
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool parse_number(const char* s, double& out)
+{
+    if (!s || !*s) return false;
+    char* end = nullptr;
+    out = std::strtod(s, &end);
+    return end && *end == '\0' && out >= 0.0;
+}
+
+bool parse_options(int argc, char** argv, Options& opts, string& error)
+{
+    opts = Options();
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i] ? argv[i] : "";
+
+        if (arg == "--supervise" || arg == "--validate" || arg == "--probe") {
+            opts.mode = arg == "--supervise" ? RunMode::Supervise :
+                arg == "--validate" ? RunMode::Validate : RunMode::Probe;
+            if (!collect_appids(argc, argv, i, opts.appids, error)) {
+                return false;
+            }
+            if (opts.appids.empty()) {
+                error = arg + " needs at least one AppID or AppID list file.";
+                return false;
+            }
+        }
+        else if (arg == "--rotate" || arg == "--profile" || arg == "--progress" || arg == "--appid-dir") {
+            if (i + 1 >= argc || !argv[i + 1] || !*argv[i + 1]) {
+                error = arg + " needs a file path.";
+                return false;
+            }
+            if (arg == "--rotate") {
+                opts.mode = RunMode::Rotate;
+                opts.rotation.queue_path = argv[++i];
+            }
+            else if (arg == "--profile") {
+                opts.mode = RunMode::Profile;
+                opts.profile.path = argv[++i];
+            }
+            else if (arg == "--appid-dir") {
+                opts.appid_dir = argv[++i];
+            }
+            else {
+                opts.rotation.progress_path = opts.profile.progress_path = argv[++i];
+            }
+        }
+        else if (arg == "--concurrent") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 1.0 ||
+                value > static_cast<double>(Supervisor::MAX_WORKERS)) {
+                error = "--concurrent needs a game count (1-" + std::to_string(Supervisor::MAX_WORKERS) + ").";
+                return false;
+            }
+            ++i;
+            opts.rotation.concurrent = opts.profile.concurrent = static_cast<size_t>(value);
+        }
+        else if (arg == "--slice" || arg == "--clock-scale") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value <= 0.0) {
+                error = arg + (arg == "--slice" ? " needs a time in minutes." : " needs a positive factor.");
+                return false;
+            }
+            ++i;
+            if (arg == "--slice") opts.rotation.slice_s = value * 60.0;
+            else opts.rotation.clock_scale = opts.profile.clock_scale = value;
+        }
+        else if (arg == "--batch" || arg == "--parallel" || arg == "--rate" || arg == "--burst") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || (arg != "--rate" && value < 1.0)) {
+                error = arg + " needs a positive number.";
+                return false;
+            }
+            ++i;
+            if (arg == "--batch") opts.validate.batch_size = static_cast<size_t>(value);
+            else if (arg == "--parallel") opts.validate.parallel = opts.probe.parallel = static_cast<unsigned>(value);
+            else if (arg == "--rate") opts.validate.rate = value;
+            else opts.validate.burst = value;
+        }
+        else if (arg == "--connect-timeout" || arg == "--send-timeout" || arg == "--receive-timeout") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 1.0) {
+                error = arg + " needs a time in milliseconds.";
+                return false;
+            }
+            ++i;
+            int ms = static_cast<int>(value);
+            if (arg == "--connect-timeout") opts.http_timeouts.connect_ms = ms;
+            else if (arg == "--send-timeout") opts.http_timeouts.send_ms = ms;
+            else opts.http_timeouts.receive_ms = ms;
+        }
+        else if (arg == "--store-url") {
+            if (i + 1 >= argc || !argv[i + 1] || !parse_store_url(argv[i + 1], opts.store_endpoint)) {
+                error = "--store-url needs a base URL such as http://127.0.0.1:27080.";
+                return false;
+            }
+            ++i;
+        }
+        else if (arg == "--tick" || arg == "--fast-tick") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 1.0) {
+                error = arg + " needs a time in milliseconds.";
+                return false;
+            }
+            ++i;
+            if (arg == "--tick") opts.pump.idle_tick_ms = static_cast<unsigned>(value);
+            else opts.pump.fast_tick_ms = static_cast<unsigned>(value);
+        }
+        else if (arg == "--standby") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 0.0 ||
+                value > static_cast<double>(Supervisor::MAX_WORKERS)) {
+                error = "--standby needs a worker count (0-" + std::to_string(Supervisor::MAX_WORKERS) + ").";
+                return false;
+            }
+            ++i;
+            opts.standby = static_cast<size_t>(value);
+        }
+        else if (arg == "--health-interval") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 0.0) {
+                error = "--health-interval needs a time in milliseconds (0 turns the checks off).";
+                return false;
+            }
+            ++i;
+            opts.watchdog.check_ms = static_cast<unsigned>(value);
+        }
+        else if (arg == "--lean" || arg == "--lean-detach") {
+            opts.lean = true;
+            opts.lean_detach = opts.lean_detach || arg == "--lean-detach";
+        }
+        else if (arg == "--metrics-port") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 1.0 || value > 65535.0) {
+                error = "--metrics-port needs a TCP port number (1-65535).";
+                return false;
+            }
+            ++i;
+            opts.metrics_port = static_cast<uint16_t>(value);
+        }
+        else if (arg == "--timings") {
+            opts.timings = true;
+        }
+        else if (arg == "--timings-file" || arg == "--timings-log") {
+            if (i + 1 >= argc || !argv[i + 1] || !*argv[i + 1]) {
+                error = arg + " needs a file path.";
+                return false;
+            }
+            opts.timings = true;
+            if (arg == "--timings-file") opts.timings_path = argv[++i];
+            else opts.timings_log = argv[++i];
+        }
+        else if (arg == "--steam-dir") {
+            if (i + 1 >= argc || !argv[i + 1] || !*argv[i + 1]) {
+                error = "--steam-dir needs a folder path.";
+                return false;
+            }
+            opts.steam_dir = argv[++i];
+        }
+        else if (arg == "--catalog" || arg == "--build-catalog") {
+            if (i + 1 >= argc || !argv[i + 1] || !*argv[i + 1]) {
+                error = arg == "--catalog" ? "--catalog needs a file path." :
+                    "--build-catalog needs the path of an app list JSON export.";
+                return false;
+            }
+            if (arg == "--catalog") {
+                opts.catalog_path = argv[++i];
+            }
+            else {
+                opts.mode = RunMode::BuildCatalog;
+                opts.catalog_source = argv[++i];
+            }
+        }
+        else if (arg == "--find") {
+            // Everything up to the next option is the title: --find half life
+            opts.mode = RunMode::FindApp;
+            while (i + 1 < argc && argv[i + 1] && string(argv[i + 1]).compare(0, 2, "--") != 0) {
+                if (!opts.query.empty()) opts.query += ' ';
+                opts.query += trim(argv[++i]);
+            }
+            if (opts.query.empty()) {
+                error = "--find needs a title.";
+                return false;
+            }
+        }
+        else if (arg == "--ledger" || arg == "--ledger-report") {
+            bool report = arg == "--ledger-report";
+            if (report) {
+                opts.mode = RunMode::LedgerReport;
+            }
+            // The report's path is optional: --ledger-report [path]
+            if (i + 1 < argc && argv[i + 1] && *argv[i + 1] && string(argv[i + 1]).compare(0, 2, "--") != 0) {
+                opts.ledger_path = argv[++i];
+            }
+            else if (!report) {
+                error = "--ledger needs a file path.";
+                return false;
+            }
+        }
+        else if (arg == "--no-ledger") {
+            opts.ledger_path.clear();
+        }
+        else if (arg == "--pump-report") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 1.0) {
+                error = "--pump-report needs a time in seconds.";
+                return false;
+            }
+            ++i;
+            opts.pump_report_s = static_cast<unsigned>(value);
+        }
+        else if (arg == "--probe-timeout") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 1.0) {
+                error = "--probe-timeout needs a time in milliseconds.";
+                return false;
+            }
+            ++i;
+            opts.probe.timeout_ms = static_cast<unsigned>(value);
+        }
+        else if (arg == "--format") {
+            string format = i + 1 < argc && argv[i + 1] ? argv[i + 1] : "";
+            if (format != "csv" && format != "json") {
+                error = "--format needs csv or json.";
+                return false;
+            }
+            ++i;
+            opts.probe.json = format == "json";
+        }
+        else if (arg == "--out") {
+            if (i + 1 >= argc || !argv[i + 1] || !*argv[i + 1]) {
+                error = "--out needs a file path.";
+                return false;
+            }
+            opts.probe.out_path = argv[++i];
+        }
+        else if (arg == "--no-store") {
+            opts.probe.store = false;
+        }
+        else if (arg == "--init-only") {
+            opts.init_only = true;
+        }
+        else if (arg == "--dashboard") {
+            opts.dashboard = true;
+        }
+        else if (arg == "--heartbeat") {
+            double value = 0.0;
+            if (i + 1 >= argc || !parse_number(argv[i + 1], value) || value < 1.0) {
+                error = "--heartbeat needs a time in seconds.";
+                return false;
+            }
+            ++i;
+            opts.ledger_heartbeat_s = static_cast<unsigned>(value);
+        }
+        else if (arg == "--list-installed") {
+            opts.mode = RunMode::ListInstalled;
+        }
+        else if (arg == "--daemon") {
+            opts.mode = RunMode::Daemon;
+        }
+        else if (arg == "--endpoint") {
+            if (i + 1 >= argc || !argv[i + 1] || !*argv[i + 1]) {
+                error = "--endpoint needs a pipe name or socket path.";
+                return false;
+            }
+            opts.endpoint = argv[++i];
+        }
+        else if (arg == "--ctl") {
+            // Everything up to the next option is the command: --ctl start 440
+            opts.mode = RunMode::Control;
+            while (i + 1 < argc && argv[i + 1] && string(argv[i + 1]).compare(0, 2, "--") != 0) {
+                if (!opts.command.empty()) opts.command += ' ';
+                opts.command += trim(argv[++i]);
+            }
+            if (opts.command.empty()) {
+                error = "--ctl needs a command (start <appid>, stop <appid>, list, status, shutdown).";
+                return false;
+            }
+        }
+        else if (arg == "--refresh") {
+            opts.refresh_store = true;
+        }
+        else if (arg == "--worker") {
+            if (i + 1 >= argc) {
+                error = "--worker needs an AppID.";
+                return false;
+            }
+            opts.mode = RunMode::Worker;
+            opts.appid = trim(argv[++i]);
+        }
+        else if (arg == "--control") {
+            if (i + 2 >= argc ||
+                !platform_parse_handle(argv[i + 1], opts.control_in) ||
+                !platform_parse_handle(argv[i + 2], opts.control_out)) {
+                error = "--control needs two handle values.";
+                return false;
+            }
+            i += 2;
+        }
+        else if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+            error = "Unknown option \"" + arg + "\".";
+            return false;
+        }
+        else if (opts.appid.empty()) {
+            // Positional AppID for the interactive mode
+            opts.appid = trim(arg);
+        }
+    }
+
+    opts.validate.refresh = opts.refresh_store;
+
+    if ((opts.mode == RunMode::Daemon || opts.mode == RunMode::Control) && opts.endpoint.empty()) {
+        opts.endpoint = platform_default_control_endpoint();
+    }
+    if (opts.mode == RunMode::Worker && (!opts.control_in || !opts.control_out)) {
+        error = "--worker requires --control <in> <out>.";
+        return false;
+    }
+    return true;
+}
+
+WorkerOptions worker_options(const Options& opts)
+{
+    WorkerOptions w;
+    w.pump = opts.pump;
+    w.watchdog = opts.watchdog;
+    w.lean = opts.lean;
+    w.ledger_path = opts.ledger_path;
+    w.ledger_heartbeat_s = opts.ledger_heartbeat_s;
+    w.pump_report_s = opts.pump_report_s;
+    w.init_only = opts.init_only;
+    w.standby = opts.standby;
+    w.dashboard = opts.dashboard;
+    w.steam_dir = opts.steam_dir;
+    w.appid_dir = opts.appid_dir;
+    if (opts.dashboard) {
+        // The "Last tick" column needs fresher pump reports than the totals do.
+        w.pump_report_s = std::min(w.pump_report_s, 5u);
+    }
+    return w;
+}
@@ -0,0 +1,191 @@
+// options.h
+// Command-line parsing for every run mode.
+//
+//   SimpleSteamIdler [--refresh] [appid]          interactive (default)
+//   SimpleSteamIdler --supervise <appids|file>... one worker per AppID
+//                    [--standby N]               plus N spare workers kept ready
+//                    [--dashboard]               live worker table (dashboard.h)
+//   SimpleSteamIdler --rotate <queue file>        time-sliced rotation (rotation.h)
+//                    [--concurrent K] [--slice MIN] [--progress <file>]
+//                    [--clock-scale X]           idle-clock speed-up for testing
+//                    [--dashboard]               live worker table
+//   SimpleSteamIdler --profile <file>             per-game settings, edits applied live (profile.h)
+//                    [--concurrent K] [--progress <file>] [--appid-dir <dir>]
+//                    [--clock-scale X] [--dashboard]
+//   SimpleSteamIdler --validate <appids|file>... [--batch N] [--parallel N]
+//                    [--rate R] [--burst B]      bulk Store check
+//   SimpleSteamIdler --probe <appids|file>...    bulk ownership probe (ownership_probe.h)
+//                    [--parallel N] [--probe-timeout MS] [--format csv|json]
+//                    [--out <file>] [--no-store]
+//   SimpleSteamIdler --list-installed             games in the local Steam libraries
+//   SimpleSteamIdler --build-catalog <app list JSON>
+//                                                 index every Steam app by name (app_catalog.h)
+//   SimpleSteamIdler --find <title...>            look a title up in the catalog
+//   SimpleSteamIdler --ledger-report [path]       idle time per AppID (session_ledger.h)
+//   SimpleSteamIdler --daemon [--endpoint <name>] no console, controlled over IPC
+//                    [--standby N]               with N spare workers kept ready
+//   SimpleSteamIdler --ctl <command...> [--endpoint <name>]
+//                                                 send one command to the daemon
+//   SimpleSteamIdler --worker <appid|standby> --control <in> <out>   (internal)
+//                    [--pump-report S]           pump stats every S seconds
+//                    [--init-only]               exit once SteamAPI_Init succeeded
+//                    [--appid-dir <dir>]         run in <dir>/<appid> with a steam_appid.txt
+//
+// --steam-dir <path> overrides the detected Steam folder (see steam_library.h),
+// which the interactive mode scans for names and suggestions. --catalog <path>
+// replaces apps.catalog, the index the interactive prompt, --find and
+// --build-catalog use to turn titles into AppIDs.
+//
+// Store requests in every mode honour --connect-timeout, --send-timeout and
+// --receive-timeout (milliseconds), and go to --store-url <base URL> instead of
+// https://store.steampowered.com when it is given (see store.h). Idling modes
+// honour --tick and --fast-tick (callback pump intervals in milliseconds, see
+// callback_pump.h), --health-interval (Steam client checks in milliseconds, 0
+// for none, see steam_watchdog.h) and --lean (release startup state and trim
+// memory once idling, see lean_idle.h); --lean-detach also lets go of the
+// console. --metrics-port <port> serves Prometheus metrics on 127.0.0.1 (see
+// metrics.h). Idle sessions are recorded in sessions.ledger, or --ledger
+// <path> (--no-ledger for none), with a heartbeat every --heartbeat seconds
+// (see session_ledger.h).
+//
+// The interactive mode also takes --timings (startup phase record on stderr),
+// --timings-file <path> (record to a file instead) and --timings-log <path>
+// (append every record to a rolling log), see phase_timings.h.
+//
+// The headless build (simplesteamidler, main_headless.cpp) parses the same
+// options; its "interactive" mode idles without prompting.
+
+#pragma once
+
+#include "callback_pump.h"
+#include "http_client.h"
+#include "ownership_probe.h"
+#include "platform.h"
+#include "profile.h"
+#include "rotation.h"
+#include "steam_watchdog.h"
+#include "store.h"
+#include "store_validate.h"
+#include "supervisor.h"
+
+#include <string>
+#include <vector>
+
+enum class RunMode {
+    Interactive,
+    Supervise,
+    Rotate,
+    Profile,
+    Validate,
+    Probe,
+    ListInstalled,
+    BuildCatalog,
+    FindApp,
+    LedgerReport,
+    Daemon,
+    Control,
+    Worker,
+};
+
+struct Options {
+    RunMode mode = RunMode::Interactive;
+
+    // Interactive: AppID given on the command line (may be empty).
+    // Worker: the AppID to idle.
+    std::string appid;
+
+    // Idling modes: session ledger file, empty for none. LedgerReport: the
+    // ledger to read.
+    std::string ledger_path = "sessions.ledger";
+    unsigned ledger_heartbeat_s = 60;
+
+    // Supervise / Validate / Probe: AppIDs, in order. Arguments may be comma-separated
+    // lists or paths to files with one AppID per line ('#' starts a comment).
+    std::vector<std::string> appids;
+
+    // Daemon / Control: pipe name or socket path (see daemon.h); empty means
+    // platform_default_control_endpoint().
+    std::string endpoint;
+
+    // Control: the command line sent to the daemon ("start 440").
+    std::string command;
+
+    // Steam install folder for the local library scan (see steam_library.h);
+    // empty means detect it.
+    std::string steam_dir;
+
+    // Interactive / FindApp / BuildCatalog: the app catalog (see
+    // app_catalog.h). BuildCatalog: the app list export to index. FindApp: the
+    // title to look up.
+    std::string catalog_path = "apps.catalog";
+    std::string catalog_source;
+    std::string query;
+
+    // Ignore cached Store answers and fetch fresh ones (see appdetails_cache.h).
+    bool refresh_store = false;
+
+    // Where Store requests go, and their deadlines.
+    HttpEndpoint store_endpoint;
+    HttpTimeouts http_timeouts;
+
+    // Interactive / Supervise / Worker: SteamAPI_RunCallbacks tick.
+    PumpOptions pump;
+
+    // Interactive / Supervise / Daemon / Worker: Steam health checks and
+    // reconnects while idling (see steam_watchdog.h).
+    WatchdogOptions watchdog;
+
+    // Interactive / Supervise / Daemon / Worker: go lean once idling. Detach
+    // (interactive only) also releases the console.
+    bool lean = false;
+    bool lean_detach = false;
+
+    // Rotate: queue file, slots, slice length and progress file.
+    RotationOptions rotation;
+
+    // Profile: profile file, slots and progress file.
+    ProfileOptions profile;
+
+    // Supervise / Rotate / Profile / Daemon: give every worker a folder of its
+    // own with a generated steam_appid.txt (profile mode always does).
+    std::string appid_dir;
+
+    // Supervise / Rotate / Daemon: standby workers kept ready for new AppIDs.
+    size_t standby = 0;
+
+    // Supervise / Rotate / Profile: live worker table instead of event lines
+    // (see dashboard.h).
+    bool dashboard = false;
+
+    // Worker: seconds between pump reports to the supervisor.
+    unsigned pump_report_s = 60;
+
+    // Interactive / Supervise / Rotate / Profile / Daemon: serve /metrics on
+    // 127.0.0.1:port (see metrics.h); 0 means off.
+    uint16_t metrics_port = 0;
+
+    // Interactive: startup phase timings. An empty timings_path means stderr;
+    // timings_log, when set, collects one line per run.
+    bool timings = false;
+    std::string timings_path;
+    std::string timings_log;
+
+    // Validate: batching and rate limiting. Probe: the same for its Store check.
+    ValidateOptions validate;
+
+    // Probe: parallelism, timeout and where the results go.
+    ProbeOptions probe;
+
+    // Worker: exit once SteamAPI_Init succeeded (probe workers).
+    bool init_only = false;
+
+    // Worker: inherited pipe handles (see supervisor.h).
+    platform_handle control_in = PLATFORM_NO_HANDLE;
+    platform_handle control_out = PLATFORM_NO_HANDLE;
+};
+
+// Parse argv into opts. Returns false and fills error on invalid usage.
+bool parse_options(int argc, char** argv, Options& opts, std::string& error);
+
+// The worker-related part of opts, for the supervisor, daemon and workers.
+WorkerOptions worker_options(const Options& opts);
@@ -0,0 +1,364 @@
+// ownership_probe.cpp
+// Bulk ownership probe. See ownership_probe.h.
+
+#include "ownership_probe.h"
+#include "platform.h"
+#include "supervisor.h"
+#include "text.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <thread>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+// Sleep between polls of the running probes when none of them finished.
+static const std::chrono::milliseconds POLL_INTERVAL(2);
+
+// After a kill, how long to wait for the process to be reaped.
+static const unsigned KILL_WAIT_MS = 2000;
+
+const char* probe_result_name(ProbeResult result)
+{
+    switch (result) {
+    case ProbeResult::Ok: return "ok";
+    case ProbeResult::InvalidFormat: return "invalid_format";
+    case ProbeResult::NotOnStore: return "not_on_store";
+    case ProbeResult::NotOwned: return "not_owned";
+    case ProbeResult::SteamNotRunning: return "steam_not_running";
+    case ProbeResult::Timeout: return "timeout";
+    case ProbeResult::Error: return "error";
+    }
+    return "error";
+}
+
+ProbeResult probe_result_for_exit(bool ready, int exit_code, string& detail)
+{
+    // Once SteamAPI_Init succeeded the answer is in, however the worker ended.
+    if (ready) {
+        return ProbeResult::Ok;
+    }
+    switch (exit_code) {
+    case WORKER_EXIT_NOT_OWNED: return ProbeResult::NotOwned;
+    case WORKER_EXIT_STEAM_NOT_RUNNING: return ProbeResult::SteamNotRunning;
+    default:
+        detail = string(worker_exit_reason(exit_code)) + " (code " + std::to_string(exit_code) + ")";
+        return ProbeResult::Error;
+    }
+}
+
+// --------------------------- Probes ---------------------------
+
+namespace {
+
+struct RunningProbe {
+    ProbeOutcome* outcome = nullptr;
+    ChildProcess child;
+    Clock::time_point started;
+    string pending;       // partial status line
+    bool ready = false;   // the worker reported "ready"
+};
+
+} // namespace
+
+static double ms_since(Clock::time_point t)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t).count();
+}
+
+// Pick up the worker's status lines; only "ready" matters here.
+static void read_probe_status(RunningProbe& p)
+{
+    char buf[128];
+    long got;
+    while ((got = platform_read_nonblocking(p.child.status_read, buf, sizeof(buf))) > 0) {
+        p.pending.append(buf, static_cast<size_t>(got));
+    }
+    size_t nl;
+    while ((nl = p.pending.find('\n')) != string::npos) {
+        if (trim(p.pending.substr(0, nl)) == "ready") {
+            p.ready = true;
+        }
+        p.pending.erase(0, nl + 1);
+    }
+}
+
+static void close_probe(RunningProbe& p)
+{
+    platform_close(p.child.control_write);
+    platform_close(p.child.status_read);
+}
+
+// Run one worker per outcome in todo, at most opts.parallel at a time. False
+// if a stop request cut the run short (the rest are marked as not probed).
+static bool run_probes(const string& exe, const std::vector<ProbeOutcome*>& todo, const ProbeOptions& opts)
+{
+    const std::vector<string> worker_args = { "--init-only", "--no-ledger", "--health-interval", "0" };
+    const std::chrono::milliseconds timeout(opts.timeout_ms);
+    const size_t parallel = std::max(1u, opts.parallel);
+
+    std::vector<RunningProbe> running;
+    running.reserve(parallel);
+    size_t next = 0;
+    bool stopped = false;
+    while (next < todo.size() || !running.empty()) {
+        if (!stopped && poll_stop_request()) {
+            stopped = true;
+            for (auto& p : running) {
+                platform_kill_child(p.child);
+            }
+        }
+
+        while (!stopped && running.size() < parallel && next < todo.size()) {
+            RunningProbe p;
+            p.outcome = todo[next++];
+            p.started = Clock::now();
+            std::vector<string> args = { "--worker", p.outcome->appid };
+            args.insert(args.end(), worker_args.begin(), worker_args.end());
+            if (!platform_spawn_worker(exe, args, p.child)) {
+                p.outcome->result = ProbeResult::Error;
+                p.outcome->detail = "could not start a worker";
+                continue;
+            }
+            running.push_back(std::move(p));
+        }
+        if (stopped) {
+            for (; next < todo.size(); ++next) {
+                todo[next]->result = ProbeResult::Error;
+                todo[next]->detail = "not probed (stopped)";
+            }
+        }
+
+        bool finished_any = false;
+        for (size_t i = 0; i < running.size();) {
+            RunningProbe& p = running[i];
+            ProbeOutcome& o = *p.outcome;
+            int exit_code = -1;
+            read_probe_status(p);
+            if (platform_wait_child(p.child, 0, exit_code)) {
+                read_probe_status(p);   // whatever it wrote just before exiting
+                o.ms = ms_since(p.started);
+                if (stopped && !p.ready) {
+                    o.result = ProbeResult::Error;
+                    o.detail = "not probed (stopped)";
+                }
+                else {
+                    o.result = probe_result_for_exit(p.ready, exit_code, o.detail);
+                }
+            }
+            else if (Clock::now() - p.started >= timeout) {
+                platform_kill_child(p.child);
+                platform_wait_child(p.child, KILL_WAIT_MS, exit_code);
+                read_probe_status(p);
+                o.ms = ms_since(p.started);
+                if (p.ready) {
+                    // Answered, then slow to shut down: the answer stands.
+                    o.result = probe_result_for_exit(true, exit_code, o.detail);
+                }
+                else {
+                    o.result = ProbeResult::Timeout;
+                    o.detail = "no answer in " + std::to_string(opts.timeout_ms) + " ms";
+                }
+            }
+            else {
+                ++i;
+                continue;
+            }
+            close_probe(p);
+            running.erase(running.begin() + i);
+            finished_any = true;
+        }
+        if (!finished_any) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+    }
+    return !stopped;
+}
+
+// --------------------------- Output ---------------------------
+
+// CSV field, quoted when it has to be (RFC 4180).
+static void append_csv_field(string& out, const string& s)
+{
+    if (s.find_first_of(",\"\r\n") == string::npos) {
+        out += s;
+        return;
+    }
+    out += '"';
+    for (char c : s) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    out += '"';
+}
+
+static string format_ms(double ms)
+{
+    if (ms < 0) return string();
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1f", ms);
+    return buf;
+}
+
+string format_probe_results(const std::vector<ProbeOutcome>& outcomes, bool json)
+{
+    string out;
+    out.reserve(outcomes.size() * 48);
+    if (!json) {
+        out += "appid,result,detail,ms\n";
+        for (const auto& o : outcomes) {
+            append_csv_field(out, o.appid);
+            out += ',';
+            out += probe_result_name(o.result);
+            out += ',';
+            append_csv_field(out, o.detail);
+            out += ',';
+            out += format_ms(o.ms);
+            out += '\n';
+        }
+        return out;
+    }
+
+    out += "[\n";
+    for (size_t i = 0; i < outcomes.size(); ++i) {
+        const ProbeOutcome& o = outcomes[i];
+        out += "  {\"appid\":";
+        append_json_string(out, o.appid);
+        out += ",\"result\":\"";
+        out += probe_result_name(o.result);
+        out += "\",\"detail\":";
+        append_json_string(out, o.detail);
+        out += ",\"ms\":";
+        out += o.ms < 0 ? "null" : format_ms(o.ms);
+        out += i + 1 < outcomes.size() ? "},\n" : "}\n";
+    }
+    out += "]\n";
+    return out;
+}
+
+// --------------------------- --probe ---------------------------
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    size_t i = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+int run_probe(const std::vector<string>& appids, const ProbeOptions& opts, const ValidateOptions& store_opts,
+    HttpClient& http, AppDetailsCache* cache)
+{
+    // Summary lines stay out of the results when those go to stdout.
+    bool to_stdout = opts.out_path.empty();
+    auto say = [to_stdout](const string& line) {
+        if (to_stdout) std::fprintf(stderr, "%s\n", line.c_str());
+        else print_utf8_line(line);
+    };
+
+    string exe_path = platform_executable_path();
+    if (exe_path.empty()) {
+        say("Error: could not determine the executable path.");
+        return 1;
+    }
+
+    // Input order, duplicates dropped; invalid ones are answered right away.
+    std::vector<ProbeOutcome> outcomes;
+    std::vector<ProbeOutcome*> todo;
+    {
+        std::map<string, bool> seen;
+        for (const auto& id : appids) {
+            if (!seen.emplace(id, true).second) continue;
+            ProbeOutcome o;
+            o.appid = id;
+            o.result = ProbeResult::InvalidFormat;
+            outcomes.push_back(o);
+        }
+        for (auto& o : outcomes) {
+            if (is_digits_only(o.appid)) todo.push_back(&o);
+        }
+    }
+
+    say("Probing " + std::to_string(todo.size()) + " AppID(s), " + std::to_string(std::max(1u, opts.parallel)) +
+        " at a time...");
+    Clock::time_point t0 = Clock::now();
+    bool complete = run_probes(exe_path, todo, opts);
+    double probe_s = std::chrono::duration<double>(Clock::now() - t0).count();
+
+    // "Not owned" is also what Steam says about AppIDs that do not exist.
+    size_t store_checked = 0;
+    double store_s = 0;
+    if (opts.store && complete) {
+        std::vector<string> not_owned;
+        for (const auto* o : todo) {
+            if (o->result == ProbeResult::NotOwned) not_owned.push_back(o->appid);
+        }
+        if (!not_owned.empty()) {
+            Clock::time_point s0 = Clock::now();
+            std::map<string, StoreCheck> store;
+            check_store(not_owned, store_opts, http, cache, store);
+            store_s = std::chrono::duration<double>(Clock::now() - s0).count();
+            store_checked = not_owned.size();
+            for (auto* o : todo) {
+                if (o->result != ProbeResult::NotOwned) continue;
+                auto it = store.find(o->appid);
+                if (it == store.end() || it->second == StoreCheck::Failed) {
+                    o->detail = "Store check failed";
+                }
+                else if (it->second == StoreCheck::NotFound) {
+                    o->result = ProbeResult::NotOnStore;
+                }
+            }
+        }
+    }
+
+    string results = format_probe_results(outcomes, opts.json);
+    if (to_stdout) {
+        console_write_utf8(results.data(), results.size());
+    }
+    else if (!platform_write_file_atomic(opts.out_path, results)) {
+        say("Error: could not write " + opts.out_path + ".");
+        return 1;
+    }
+
+    // Summary: counts, throughput and time per probe.
+    size_t counts[7] = {};
+    std::vector<double> ms;
+    for (const auto& o : outcomes) {
+        ++counts[static_cast<int>(o.result)];
+        if (o.ms >= 0) ms.push_back(o.ms);
+    }
+    std::sort(ms.begin(), ms.end());
+
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), "Probed %zu AppID(s) in %.2fs (%.1f probes/sec): %zu ok, %zu not owned, "
+        "%zu not on Store, %zu Steam not running, %zu invalid format, %zu timed out, %zu error(s).",
+        ms.size(), probe_s, probe_s > 0 ? ms.size() / probe_s : 0.0,
+        counts[static_cast<int>(ProbeResult::Ok)], counts[static_cast<int>(ProbeResult::NotOwned)],
+        counts[static_cast<int>(ProbeResult::NotOnStore)], counts[static_cast<int>(ProbeResult::SteamNotRunning)],
+        counts[static_cast<int>(ProbeResult::InvalidFormat)], counts[static_cast<int>(ProbeResult::Timeout)],
+        counts[static_cast<int>(ProbeResult::Error)]);
+    say("");
+    say(buf);
+    if (!ms.empty()) {
+        std::snprintf(buf, sizeof(buf), "Per probe: p50 %.0f ms, p90 %.0f ms, p99 %.0f ms, max %.0f ms.",
+            percentile(ms, 50), percentile(ms, 90), percentile(ms, 99), ms.back());
+        say(buf);
+    }
+    if (store_checked > 0) {
+        std::snprintf(buf, sizeof(buf), "Store check of %zu not-owned AppID(s): %.2fs.", store_checked, store_s);
+        say(buf);
+    }
+    if (!to_stdout) {
+        say("Results written to " + opts.out_path + ".");
+    }
+    if (!complete) {
+        say("Stopped before every AppID was probed.");
+    }
+
+    return counts[static_cast<int>(ProbeResult::Timeout)] + counts[static_cast<int>(ProbeResult::Error)] == 0 ? 0 : 1;
+}
@@ -0,0 +1,70 @@
+// ownership_probe.h
+// Bulk ownership probe (--probe): classify a list of AppIDs by what
+// SteamAPI_Init says about each of them, without idling any.
+//
+// Every AppID gets its own short-lived worker ("--worker <appid> --init-only",
+// see supervisor.h). SteamAPI_Init binds a process to one AppID, so a process
+// per AppID is the only way to ask, and a probe that hangs or crashes takes
+// nothing else down. At most `parallel` probes run at once; one that is not
+// done after timeout_ms is killed. The AppIDs Steam calls "not owned" are then
+// looked up on the Store (check_store, store_validate.h; cache first), since
+// Steam gives the same answer for an AppID that does not exist at all.
+//
+// Results go to stdout or a file as CSV ("appid,result,detail,ms") or JSON
+// (an array of objects with the same fields), in input order, followed by a
+// summary with the throughput and per-probe time percentiles. With the stub
+// steam_api (tools/steam_stub) and store_stub it runs without Steam or the
+// network.
+
+#pragma once
+
+#include "store_validate.h"
+
+#include <string>
+#include <vector>
+
+class AppDetailsCache;
+class HttpClient;
+
+enum class ProbeResult {
+    Ok,                // SteamAPI_Init succeeded: owned and playable here
+    InvalidFormat,     // not an AppID; never probed
+    NotOnStore,        // not owned, and the Store does not know the AppID
+    NotOwned,          // not owned by the logged-on account
+    SteamNotRunning,   // Steam client down or logged off
+    Timeout,           // the probe was killed after timeout_ms
+    Error,             // no steam_api library, worker crashed or could not start
+};
+
+// Machine-readable name: "ok", "invalid_format", "not_on_store", "not_owned",
+// "steam_not_running", "timeout", "error".
+const char* probe_result_name(ProbeResult result);
+
+struct ProbeOptions {
+    unsigned parallel = 4;         // probes running at once
+    unsigned timeout_ms = 15000;   // per probe, spawn to exit
+    bool json = false;             // JSON instead of CSV
+    std::string out_path;          // results file; empty: stdout
+    bool store = true;             // check not-owned AppIDs on the Store
+};
+
+struct ProbeOutcome {
+    std::string appid;
+    ProbeResult result = ProbeResult::Error;
+    std::string detail;   // e.g. the exit reason of an Error; may be empty
+    double ms = -1;       // spawn to exit; -1 if never probed
+};
+
+// What a probe worker's end means: it reported "ready" (ready), or else its
+// exit code (WorkerExitCode). Fills detail for errors.
+ProbeResult probe_result_for_exit(bool ready, int exit_code, std::string& detail);
+
+// Format outcomes as CSV (with a header line) or JSON.
+std::string format_probe_results(const std::vector<ProbeOutcome>& outcomes, bool json);
+
+// --probe: probe appids, check not-owned ones on the Store through http (cache
+// may be null), write the results and print the summary. The summary goes to
+// stderr when the results go to stdout. Returns 0 if every AppID got a
+// definite answer (no timeouts or errors), 1 otherwise.
+int run_probe(const std::vector<std::string>& appids, const ProbeOptions& opts, const ValidateOptions& store_opts,
+    HttpClient& http, AppDetailsCache* cache);
@@ -0,0 +1,128 @@
+// phase_timings.cpp
+// Startup phase timing. See phase_timings.h.
+
+#include "phase_timings.h"
+#include "util.h"
+
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+
+using std::string;
+
+// Rotate the rolling log once it grows past this size.
+static const std::streamoff MAX_LOG_BYTES = 1024 * 1024;
+
+static double to_ms(PhaseTimings::Clock::duration d)
+{
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+static void append_ms(string& out, double ms)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.3f", ms);
+    out += buf;
+}
+
+PhaseTimings::PhaseTimings()
+    : origin_(Clock::now())
+{
+}
+
+void PhaseTimings::add(const string& name, Clock::time_point start, Clock::time_point end)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    phases_.push_back(Phase{ name, to_ms(start - origin_), to_ms(end - start) });
+}
+
+void PhaseTimings::set(const string& key, const string& value)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& field : fields_) {
+        if (field.first == key) {
+            field.second = value;
+            return;
+        }
+    }
+    fields_.emplace_back(key, value);
+}
+
+string PhaseTimings::to_json() const
+{
+    double total_ms = to_ms(Clock::now() - origin_);
+
+    char stamp[32] = "";
+    std::time_t now = std::time(nullptr);
+    if (const std::tm* utc = std::gmtime(&now)) {
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", utc);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    string out = "{\"version\":1,\"time\":";
+    append_json_string(out, stamp);
+    for (const auto& field : fields_) {
+        out += ',';
+        append_json_string(out, field.first);
+        out += ':';
+        append_json_string(out, field.second);
+    }
+    out += ",\"total_ms\":";
+    append_ms(out, total_ms);
+    out += ",\"phases\":[";
+    for (size_t i = 0; i < phases_.size(); ++i) {
+        if (i) out += ',';
+        out += "{\"name\":";
+        append_json_string(out, phases_[i].name);
+        out += ",\"start_ms\":";
+        append_ms(out, phases_[i].start_ms);
+        out += ",\"ms\":";
+        append_ms(out, phases_[i].ms);
+        out += '}';
+    }
+    out += "]}";
+    return out;
+}
+
+void TimingsReport::write()
+{
+    if (!timings_ || written_) {
+        return;
+    }
+    written_ = true;
+    write_timings(timings_->to_json(), path_, log_path_);
+}
+
+static void rotate_log_if_large(const string& log_path)
+{
+    std::ifstream in(log_path, std::ios::binary | std::ios::ate);
+    if (!in || in.tellg() < MAX_LOG_BYTES) {
+        return;
+    }
+    in.close();
+    string old = log_path + ".1";
+    std::remove(old.c_str());    // rename() does not replace on Windows
+    std::rename(log_path.c_str(), old.c_str());
+}
+
+bool write_timings(const string& json, const string& path, const string& log_path)
+{
+    bool ok = true;
+    if (path.empty()) {
+        std::fprintf(stderr, "%s\n", json.c_str());
+        std::fflush(stderr);
+    }
+    else {
+        std::ofstream out(path, std::ios::trunc);
+        out << json << '\n';
+        ok = static_cast<bool>(out);
+    }
+
+    if (!log_path.empty()) {
+        rotate_log_if_large(log_path);
+        std::ofstream log(log_path, std::ios::app);
+        log << json << '\n';
+        ok = ok && static_cast<bool>(log);
+    }
+    return ok;
+}
@@ -0,0 +1,104 @@
+// phase_timings.h
+// Startup phase timing (--timings).
+//
+// Phases are measured with steady_clock relative to the moment the recorder
+// was created (process start, for all practical purposes) and may be added
+// from any thread; the Store lookup runs next to the Steam init. A finished
+// run is written as one JSON object on a single line, e.g.
+//
+//   {"version":1,"time":"2026-01-02T03:04:05Z","mode":"interactive",
+//    "appid":"440","result":"idling","total_ms":812.4,
+//    "phases":[{"name":"steam.init","start_ms":40.2,"ms":702.9},...]}
+//
+// so runs can be appended to a log and compared with ordinary tools.
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+class PhaseTimings {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    PhaseTimings();
+
+    // Record a finished phase. Thread-safe.
+    void add(const std::string& name, Clock::time_point start, Clock::time_point end);
+
+    // Attach a string field to the record ("appid", "result", ...). Setting a
+    // key again replaces its value.
+    void set(const std::string& key, const std::string& value);
+
+    // The record as one line of JSON, total_ms measured up to now.
+    std::string to_json() const;
+
+private:
+    struct Phase {
+        std::string name;
+        double start_ms;
+        double ms;
+    };
+
+    Clock::time_point origin_;
+    mutable std::mutex mutex_;
+    std::vector<Phase> phases_;
+    std::vector<std::pair<std::string, std::string>> fields_;
+};
+
+// Times the enclosing scope as one phase. Does nothing when timings is null,
+// so call sites need no "is --timings on" checks.
+class ScopedPhase {
+public:
+    ScopedPhase(PhaseTimings* timings, const char* name)
+        : timings_(timings), name_(name), start_(PhaseTimings::Clock::now())
+    {
+    }
+
+    ~ScopedPhase()
+    {
+        if (timings_) {
+            timings_->add(name_, start_, PhaseTimings::Clock::now());
+        }
+    }
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+    PhaseTimings* timings_;
+    const char* name_;
+    PhaseTimings::Clock::time_point start_;
+};
+
+// Writes a record once: explicitly with write() (e.g. when idling starts) or,
+// at the latest, on destruction, so runs that fail early are recorded too.
+// Does nothing when timings is null.
+class TimingsReport {
+public:
+    TimingsReport(PhaseTimings* timings, const std::string& path, const std::string& log_path)
+        : timings_(timings), path_(path), log_path_(log_path)
+    {
+    }
+
+    ~TimingsReport() { write(); }
+
+    TimingsReport(const TimingsReport&) = delete;
+    TimingsReport& operator=(const TimingsReport&) = delete;
+
+    void write();
+
+private:
+    PhaseTimings* timings_;
+    std::string path_;
+    std::string log_path_;
+    bool written_ = false;
+};
+
+// Write a record: to path (overwritten) or to stderr when path is empty, and
+// append it to log_path when that is not empty. The log is rotated to
+// "<log_path>.1" once it grows past 1 MiB. Returns false if a write failed.
+bool write_timings(const std::string& json, const std::string& path, const std::string& log_path);
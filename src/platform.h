@@ -0,0 +1,221 @@
+// platform.h
+// The few operating-system services the idler core needs, behind one small
+// interface: environment variables, dynamic libraries, standard stream
+// suppression, memory accounting, worker processes with pipes, waiting for a
+// stop request, file change notifications and the local control endpoint of
+// the daemon mode.
+//
+// platform_win32.cpp implements it with Win32 calls, platform_posix.cpp with
+// POSIX ones (Linux, where the core runs headless against libsteam_api.so).
+// Everything above this layer is portable C++.
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// --------------------------- Process setup ---------------------------
+
+// Call once at the start of main/WinMain, before any thread is started.
+// On POSIX this ignores SIGPIPE and blocks the stop signals (SIGINT, SIGTERM,
+// SIGHUP) so wait_for_stop_request() can collect them.
+void platform_init();
+
+// Full path of the running executable (UTF-8), empty on failure.
+std::string platform_executable_path();
+
+unsigned long platform_current_pid();
+
+// --------------------------- Environment ---------------------------
+
+// Set an environment variable of this process; a null value removes it.
+void platform_set_env(const char* name, const char* value);
+
+// --------------------------- Files ---------------------------
+
+// File, pipe end or process handle: a HANDLE on Windows, a descriptor / pid on POSIX.
+typedef std::intptr_t platform_handle;
+static const platform_handle PLATFORM_NO_HANDLE = 0;
+
+// Read a whole file (UTF-8 path) into out with one read call, if it is at most
+// max_size bytes. False if it cannot be opened or is larger. For small files
+// this is cheaper than mapping them (see mapped_file.h).
+bool platform_read_small_file(const std::string& path, std::string& out, size_t max_size);
+
+// Replace a file (UTF-8 path) with data so that a crash or power loss leaves
+// either the old or the new contents: data goes to "<path>.tmp", is flushed to
+// disk and then renamed over path. False on any failure (path is untouched).
+bool platform_write_file_atomic(const std::string& path, const std::string& data);
+
+// Open a file (UTF-8 path) for appending, creating it if needed. Close it with
+// platform_close(). PLATFORM_NO_HANDLE on failure.
+platform_handle platform_open_append(const std::string& path);
+
+// Append data with one write at the current end of the file, so appends from
+// several processes never interleave, and return once it is on disk.
+bool platform_append_durable(platform_handle file, const char* data, size_t size);
+
+// Create a folder (UTF-8 path) and any missing parents. True if it exists
+// afterwards.
+bool platform_make_directories(const std::string& path);
+
+// Make a folder (UTF-8 path) the working directory of this process.
+bool platform_change_directory(const std::string& path);
+
+// --------------------------- File change notifications ---------------------------
+
+// Watches one file through its folder (ReadDirectoryChangesW on Windows,
+// inotify elsewhere), so editors that save by writing a new file and renaming
+// it over the old one are noticed as well as in-place writes.
+struct FileWatch {
+    std::string name;                               // file name within the folder
+    platform_handle handle = PLATFORM_NO_HANDLE;    // folder handle / inotify descriptor
+    void* pending = nullptr;                        // Windows: the outstanding read
+};
+
+// Start watching path (UTF-8). False if its folder cannot be watched.
+bool platform_watch_file(const std::string& path, FileWatch& watch);
+
+// Never blocks. True if the file was written, created, replaced or removed
+// since the last call (or notifications were lost, so it may have been).
+bool platform_file_changed(FileWatch& watch);
+
+void platform_unwatch_file(FileWatch& watch);
+
+// --------------------------- Dynamic libraries ---------------------------
+
+// Load a shared library by file name or path. Returns null on failure.
+void* platform_load_library(const char* file);
+
+// Look up an exported symbol. Returns null if the library does not export it.
+void* platform_find_symbol(void* library, const char* name);
+
+void platform_free_library(void* library);
+
+// --------------------------- Standard streams ---------------------------
+
+// Redirect stdout/stderr to the null device while executing a callable.
+// This is used to suppress messages printed by steam_api during initialization.
+void suppress_console_output(const std::function<void()>& fn);
+
+// Detach from the console or terminal: FreeConsole on Windows, standard
+// streams to /dev/null elsewhere. Output is discarded from then on. On Windows
+// a hidden window is created first so taskkill without /F can still stop the
+// process through wait_for_stop_request().
+void platform_release_console();
+
+// True if stdout is an interactive terminal that takes ANSI escape sequences
+// (cursor moves, erase). On Windows this turns on virtual terminal processing
+// for the console, which needs Windows 10 or later; elsewhere it checks that
+// stdout is a tty and TERM is not "dumb".
+bool platform_enable_ansi_output();
+
+// Visible size of the terminal stdout is on. False if it is not a terminal.
+bool platform_terminal_size(unsigned& rows, unsigned& cols);
+
+// --------------------------- Memory ---------------------------
+
+struct MemoryUsage {
+    std::uint64_t private_bytes = 0;   // PrivateUsage on Windows, RssAnon on Linux
+    std::uint64_t working_set = 0;     // WorkingSetSize / VmRSS
+};
+
+// Current usage of this process. False if it cannot be read.
+bool platform_memory_usage(MemoryUsage& out);
+
+// Return free heap memory to the system and empty the working set; pages that
+// are still used come back on the next touch.
+void platform_trim_memory();
+
+// --------------------------- Stop requests ---------------------------
+
+// Block until the user asks the program to stop: ENTER in the Windows console,
+// SIGINT / SIGTERM / SIGHUP elsewhere (headless processes have no console).
+// A Windows process whose console was released waits for WM_CLOSE on its
+// hidden window (taskkill /PID without /F).
+void wait_for_stop_request();
+
+// What to tell the user, e.g. "Press ENTER to stop".
+const char* stop_request_hint();
+
+// Non-blocking check for the same stop signals, for loops that cannot sit in
+// wait_for_stop_request(). Always false on Windows, where a process without a
+// console has no equivalent.
+bool poll_stop_request();
+
+// --------------------------- Pipes and worker processes ---------------------------
+
+// A worker process started by platform_spawn_worker().
+struct ChildProcess {
+    platform_handle process = PLATFORM_NO_HANDLE;
+    unsigned long pid = 0;
+    platform_handle control_write = PLATFORM_NO_HANDLE;  // our end of the worker's control pipe
+    platform_handle status_read = PLATFORM_NO_HANDLE;    // our end of the worker's status pipe
+};
+
+// Start exe with args followed by "--control <in> <out>", where <in> and <out>
+// are the worker's inherited ends of two fresh pipes. The worker's standard
+// handles go to the null device and it gets no console window.
+bool platform_spawn_worker(const std::string& exe, const std::vector<std::string>& args, ChildProcess& child);
+
+// Wait up to timeout_ms (0 = just check) for the process to exit. Returns true
+// and sets exit_code once it has; the process handle is released then.
+bool platform_wait_child(ChildProcess& child, unsigned timeout_ms, int& exit_code);
+
+// Kill the process outright (no cleanup in the child).
+void platform_kill_child(ChildProcess& child);
+
+// Read whatever is available without blocking. Returns the byte count, 0 if
+// nothing is pending, -1 once the other end is closed or on error.
+long platform_read_nonblocking(platform_handle h, char* buf, size_t size);
+
+// Blocking read. Returns the byte count, 0 at end of file, -1 on error.
+long platform_read(platform_handle h, char* buf, size_t size);
+
+// Write all bytes. Returns false on error (e.g. the reader is gone).
+bool platform_write(platform_handle h, const char* data, size_t size);
+
+// Close a pipe end and reset it to PLATFORM_NO_HANDLE.
+void platform_close(platform_handle& h);
+
+// Turn the decimal text of an inherited handle ("--control" values) back into
+// a handle. Returns false for anything that cannot be one.
+bool platform_parse_handle(const char* text, platform_handle& out);
+
+// --------------------------- Local control endpoint ---------------------------
+
+// Where --daemon listens by default: the named pipe \\.\pipe\SimpleSteamIdler
+// on Windows, $XDG_RUNTIME_DIR/simplesteamidler.sock elsewhere (or
+// /tmp/simplesteamidler-<uid>.sock without a runtime directory).
+std::string platform_default_control_endpoint();
+
+// Listening end of a control endpoint: a Unix domain socket, or on Windows
+// the pipe instance the next client will connect to.
+struct LocalListener {
+    std::string endpoint;
+    platform_handle handle = PLATFORM_NO_HANDLE;
+};
+
+// Listen on endpoint (socket path / pipe name), for the current user only and
+// never for remote clients. Fails with a message if another process already
+// listens there; a socket file left behind by a dead process is replaced.
+bool platform_listen_local(const std::string& endpoint, LocalListener& listener, std::string& error);
+
+// Wait up to timeout_ms for a client. Returns 1 and sets client when one
+// connected, 0 on timeout, -1 on error. Close client with platform_close().
+int platform_accept_local(LocalListener& listener, unsigned timeout_ms, platform_handle& client);
+
+// Stop listening and remove the socket file.
+void platform_close_listener(LocalListener& listener);
+
+// Connect to a listening endpoint. False if nothing listens there.
+bool platform_connect_local(const std::string& endpoint, platform_handle& conn);
+
+// Read from a connection, waiting up to timeout_ms. Returns the byte count,
+// 0 on timeout, -1 once the other end is closed or on error.
+long platform_read_local(platform_handle conn, char* buf, size_t size, unsigned timeout_ms);
+
+// Write all bytes to a connection. Returns false on error.
+bool platform_write_local(platform_handle conn, const char* data, size_t size);
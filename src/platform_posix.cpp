@@ -0,0 +1,663 @@
+// platform_posix.cpp
+// POSIX implementation of platform.h (Linux headless build).
+
+#ifndef _WIN32
+
+#include "platform.h"
+#include "util.h"
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <poll.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/inotify.h>
+#include <sys/ioctl.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+using std::string;
+
+static int to_fd(platform_handle h)
+{
+    return static_cast<int>(h);
+}
+
+// Signals that mean "stop": collected by wait_for_stop_request().
+static void stop_signal_set(sigset_t& set)
+{
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    sigaddset(&set, SIGTERM);
+    sigaddset(&set, SIGHUP);
+}
+
+// --------------------------- Process setup ---------------------------
+
+void platform_init()
+{
+    // A worker whose supervisor died must see EPIPE, not be killed by SIGPIPE.
+    signal(SIGPIPE, SIG_IGN);
+
+    // Blocked in every thread (threads inherit the mask), delivered through sigwait().
+    sigset_t set;
+    stop_signal_set(set);
+    pthread_sigmask(SIG_BLOCK, &set, nullptr);
+}
+
+string platform_executable_path()
+{
+    char path[4096];
+    ssize_t len = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (len <= 0) {
+        return string();
+    }
+    return string(path, static_cast<size_t>(len));
+}
+
+unsigned long platform_current_pid()
+{
+    return static_cast<unsigned long>(getpid());
+}
+
+// --------------------------- Environment ---------------------------
+
+void platform_set_env(const char* name, const char* value)
+{
+    if (value) {
+        setenv(name, value, 1);
+    }
+    else {
+        unsetenv(name);
+    }
+}
+
+// --------------------------- Files ---------------------------
+
+bool platform_read_small_file(const string& path, string& out, size_t max_size)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat st;
+    bool ok = fstat(fd, &st) == 0 && static_cast<unsigned long long>(st.st_size) <= max_size;
+    if (ok) {
+        out.resize(static_cast<size_t>(st.st_size));
+        size_t done = 0;
+        while (done < out.size()) {
+            ssize_t n = read(fd, &out[done], out.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) break;
+            done += static_cast<size_t>(n);
+        }
+        ok = done == out.size();
+    }
+    close(fd);
+    return ok;
+}
+
+bool platform_write_file_atomic(const string& path, const string& data)
+{
+    string tmp = path + ".tmp";
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    size_t done = 0;
+    while (done < data.size()) {
+        ssize_t n = write(fd, data.data() + done, data.size() - done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        done += static_cast<size_t>(n);
+    }
+    bool ok = done == data.size() && fsync(fd) == 0;
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0) {
+        unlink(tmp.c_str());
+        return false;
+    }
+    // Make the rename itself durable.
+    size_t slash = path.rfind('/');
+    string dir = slash == string::npos ? string(".") : (slash == 0 ? string("/") : path.substr(0, slash));
+    int dir_fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dir_fd >= 0) {
+        fsync(dir_fd);
+        close(dir_fd);
+    }
+    return true;
+}
+
+platform_handle platform_open_append(const string& path)
+{
+    int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    return fd < 0 ? PLATFORM_NO_HANDLE : static_cast<platform_handle>(fd);
+}
+
+bool platform_append_durable(platform_handle file, const char* data, size_t size)
+{
+    // O_APPEND: the kernel seeks to the end and writes in one step.
+    ssize_t n;
+    do {
+        n = write(to_fd(file), data, size);
+    } while (n < 0 && errno == EINTR);
+    return n == static_cast<ssize_t>(size) && fdatasync(to_fd(file)) == 0;
+}
+
+bool platform_make_directories(const string& path)
+{
+    for (size_t slash = path.find('/', 1); ; slash = path.find('/', slash + 1)) {
+        string part = path.substr(0, slash);
+        if (mkdir(part.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == string::npos) break;
+    }
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool platform_change_directory(const string& path)
+{
+    return chdir(path.c_str()) == 0;
+}
+
+// --------------------------- File change notifications ---------------------------
+
+bool platform_watch_file(const string& path, FileWatch& watch)
+{
+    size_t slash = path.rfind('/');
+    string dir = slash == string::npos ? string(".") : (slash == 0 ? string("/") : path.substr(0, slash));
+    watch.name = slash == string::npos ? path : path.substr(slash + 1);
+
+    int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    if (inotify_add_watch(fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0) {
+        close(fd);
+        return false;
+    }
+    watch.handle = static_cast<platform_handle>(fd);
+    return true;
+}
+
+bool platform_file_changed(FileWatch& watch)
+{
+    if (!watch.handle) {
+        return false;
+    }
+    bool changed = false;
+    alignas(inotify_event) char buf[4096];
+    ssize_t got;
+    while ((got = read(to_fd(watch.handle), buf, sizeof(buf))) > 0) {
+        for (ssize_t at = 0; at < got;) {
+            const inotify_event* e = reinterpret_cast<const inotify_event*>(buf + at);
+            if ((e->mask & IN_Q_OVERFLOW) || (e->len > 0 && watch.name == e->name)) {
+                changed = true;
+            }
+            at += static_cast<ssize_t>(sizeof(inotify_event) + e->len);
+        }
+    }
+    return changed;
+}
+
+void platform_unwatch_file(FileWatch& watch)
+{
+    platform_close(watch.handle);
+}
+
+// --------------------------- Dynamic libraries ---------------------------
+
+void* platform_load_library(const char* file)
+{
+    return dlopen(file, RTLD_NOW | RTLD_LOCAL);
+}
+
+void* platform_find_symbol(void* library, const char* name)
+{
+    return dlsym(library, name);
+}
+
+void platform_free_library(void* library)
+{
+    if (library) {
+        dlclose(library);
+    }
+}
+
+// --------------------------- Standard streams ---------------------------
+
+void suppress_console_output(const std::function<void()>& fn)
+{
+    std::fflush(stdout);
+    std::fflush(stderr);
+    int stdout_backup = dup(STDOUT_FILENO);
+    int stderr_backup = dup(STDERR_FILENO);
+
+    int null_fd = open("/dev/null", O_WRONLY | O_CLOEXEC);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        close(null_fd);
+    }
+
+    fn();
+
+    std::fflush(stdout);
+    std::fflush(stderr);
+    if (stdout_backup >= 0) {
+        dup2(stdout_backup, STDOUT_FILENO);
+        close(stdout_backup);
+    }
+    if (stderr_backup >= 0) {
+        dup2(stderr_backup, STDERR_FILENO);
+        close(stderr_backup);
+    }
+}
+
+void platform_release_console()
+{
+    std::fflush(stdout);
+    std::fflush(stderr);
+    int null_fd = open("/dev/null", O_RDWR | O_CLOEXEC);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        close(null_fd);
+    }
+}
+
+bool platform_enable_ansi_output()
+{
+    const char* term = std::getenv("TERM");
+    return isatty(STDOUT_FILENO) && term && *term && std::strcmp(term, "dumb") != 0;
+}
+
+bool platform_terminal_size(unsigned& rows, unsigned& cols)
+{
+    struct winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) != 0 || ws.ws_row == 0 || ws.ws_col == 0) {
+        return false;
+    }
+    rows = ws.ws_row;
+    cols = ws.ws_col;
+    return true;
+}
+
+// --------------------------- Memory ---------------------------
+
+bool platform_memory_usage(MemoryUsage& out)
+{
+    out = MemoryUsage();
+    // procfs files report a size of 0, so no platform_read_small_file here.
+    int fd = open("/proc/self/status", O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    string status;
+    char buf[4096];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        status.append(buf, static_cast<size_t>(n));
+    }
+    close(fd);
+
+    auto field_kb = [&status](const char* key) -> unsigned long long {
+        size_t at = status.find(key);
+        return at == string::npos ? 0 : std::strtoull(status.c_str() + at + std::strlen(key), nullptr, 10);
+    };
+    out.working_set = field_kb("\nVmRSS:") * 1024;
+    out.private_bytes = field_kb("\nRssAnon:") * 1024;
+    return out.working_set != 0;
+}
+
+void platform_trim_memory()
+{
+#if defined(__GLIBC__)
+    // Linux has no "empty the working set" call for private pages; what can be
+    // given back is the allocator's free memory.
+    malloc_trim(0);
+#endif
+}
+
+// --------------------------- Stop requests ---------------------------
+
+void wait_for_stop_request()
+{
+    sigset_t set;
+    stop_signal_set(set);
+    int sig = 0;
+    while (sigwait(&set, &sig) != 0) {
+    }
+}
+
+const char* stop_request_hint()
+{
+    return "Press Ctrl+C (or send SIGTERM)";
+}
+
+bool poll_stop_request()
+{
+    sigset_t set;
+    stop_signal_set(set);
+    struct timespec zero = {};
+    return sigtimedwait(&set, nullptr, &zero) > 0;
+}
+
+// --------------------------- Pipes and worker processes ---------------------------
+
+bool platform_spawn_worker(const string& exe, const std::vector<string>& args, ChildProcess& child)
+{
+    child = ChildProcess();
+
+    // Control pipe: the worker reads, we write. Status pipe: the worker writes, we read.
+    // Everything is close-on-exec; the child clears the flag on its own ends.
+    int control[2], status[2];
+    if (pipe2(control, O_CLOEXEC) != 0) {
+        return false;
+    }
+    if (pipe2(status, O_CLOEXEC) != 0) {
+        close(control[0]);
+        close(control[1]);
+        return false;
+    }
+
+    // Build argv before fork(): the child may only make async-signal-safe calls.
+    std::vector<string> argv_strings;
+    argv_strings.push_back(exe);
+    argv_strings.insert(argv_strings.end(), args.begin(), args.end());
+    argv_strings.push_back("--control");
+    argv_strings.push_back(std::to_string(control[0]));
+    argv_strings.push_back(std::to_string(status[1]));
+    std::vector<char*> argv;
+    for (auto& s : argv_strings) {
+        argv.push_back(&s[0]);
+    }
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null_fd = open("/dev/null", O_RDWR);
+        if (null_fd >= 0) {
+            dup2(null_fd, STDIN_FILENO);
+            dup2(null_fd, STDOUT_FILENO);
+            dup2(null_fd, STDERR_FILENO);
+        }
+        fcntl(control[0], F_SETFD, 0);
+        fcntl(status[1], F_SETFD, 0);
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, nullptr);
+        execv(exe.c_str(), argv.data());
+        _exit(127);
+    }
+
+    // The worker owns its ends now (or nobody does if fork failed).
+    close(control[0]);
+    close(status[1]);
+    if (pid < 0) {
+        close(control[1]);
+        close(status[0]);
+        return false;
+    }
+
+    fcntl(status[0], F_SETFL, fcntl(status[0], F_GETFL) | O_NONBLOCK);
+    child.process = static_cast<platform_handle>(pid);
+    child.pid = static_cast<unsigned long>(pid);
+    child.control_write = static_cast<platform_handle>(control[1]);
+    child.status_read = static_cast<platform_handle>(status[0]);
+    return true;
+}
+
+bool platform_wait_child(ChildProcess& child, unsigned timeout_ms, int& exit_code)
+{
+    if (!child.process) {
+        return false;
+    }
+    pid_t pid = static_cast<pid_t>(child.process);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    for (;;) {
+        int status = 0;
+        pid_t r = waitpid(pid, &status, WNOHANG);
+        if (r == pid) {
+            // Killed by a signal: report it like a shell does (128 + signal).
+            exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+            child.process = PLATFORM_NO_HANDLE;
+            return true;
+        }
+        if (r < 0 && errno != EINTR) {
+            exit_code = -1;
+            child.process = PLATFORM_NO_HANDLE;
+            return true;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+void platform_kill_child(ChildProcess& child)
+{
+    if (child.process) {
+        kill(static_cast<pid_t>(child.process), SIGKILL);
+    }
+}
+
+long platform_read_nonblocking(platform_handle h, char* buf, size_t size)
+{
+    for (;;) {
+        ssize_t got = read(to_fd(h), buf, size);
+        if (got > 0) {
+            return static_cast<long>(got);
+        }
+        if (got == 0) {
+            return -1;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+}
+
+long platform_read(platform_handle h, char* buf, size_t size)
+{
+    for (;;) {
+        ssize_t got = read(to_fd(h), buf, size);
+        if (got >= 0) {
+            return static_cast<long>(got);
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+bool platform_write(platform_handle h, const char* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = write(to_fd(h), data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+void platform_close(platform_handle& h)
+{
+    if (h) {
+        close(to_fd(h));
+        h = PLATFORM_NO_HANDLE;
+    }
+}
+
+bool platform_parse_handle(const char* text, platform_handle& out)
+{
+    if (!text || !is_digits_only(text)) return false;
+    out = static_cast<platform_handle>(std::strtol(text, nullptr, 10));
+    // 0-2 are the standard streams, never one of our pipes.
+    return out > STDERR_FILENO;
+}
+
+// --------------------------- Local control endpoint ---------------------------
+
+string platform_default_control_endpoint()
+{
+    const char* runtime = std::getenv("XDG_RUNTIME_DIR");
+    if (runtime && *runtime) {
+        return string(runtime) + "/simplesteamidler.sock";
+    }
+    return "/tmp/simplesteamidler-" + std::to_string(static_cast<unsigned long>(getuid())) + ".sock";
+}
+
+static bool make_socket_address(const string& path, sockaddr_un& addr)
+{
+    addr = sockaddr_un();
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return false;
+    }
+    path.copy(addr.sun_path, path.size());
+    return true;
+}
+
+static int connect_socket(const sockaddr_un& addr)
+{
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+bool platform_listen_local(const string& endpoint, LocalListener& listener, string& error)
+{
+    listener = LocalListener();
+    sockaddr_un addr;
+    if (!make_socket_address(endpoint, addr)) {
+        error = "Invalid socket path \"" + endpoint + "\".";
+        return false;
+    }
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = "Cannot create a socket.";
+        return false;
+    }
+
+    bool bound = bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    if (!bound && errno == EADDRINUSE) {
+        // Someone answering there is a live daemon; a file nobody answers on
+        // was left by one that died.
+        int other = connect_socket(addr);
+        if (other >= 0) {
+            close(other);
+            close(fd);
+            error = "Another daemon is already listening on " + endpoint + ".";
+            return false;
+        }
+        unlink(endpoint.c_str());
+        bound = bind(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    }
+    // Owner only; clients cannot connect before listen(), so there is no window.
+    if (!bound || chmod(endpoint.c_str(), S_IRUSR | S_IWUSR) != 0 || listen(fd, 16) != 0) {
+        close(fd);
+        error = "Cannot listen on " + endpoint + ".";
+        return false;
+    }
+
+    listener.endpoint = endpoint;
+    listener.handle = static_cast<platform_handle>(fd);
+    return true;
+}
+
+int platform_accept_local(LocalListener& listener, unsigned timeout_ms, platform_handle& client)
+{
+    pollfd p = { to_fd(listener.handle), POLLIN, 0 };
+    int ready = poll(&p, 1, static_cast<int>(timeout_ms));
+    if (ready < 0) {
+        return errno == EINTR ? 0 : -1;
+    }
+    if (ready == 0) {
+        return 0;
+    }
+    int fd = accept4(to_fd(listener.handle), nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+        // The client may have given up between poll() and accept().
+        return (errno == EINTR || errno == EAGAIN || errno == ECONNABORTED) ? 0 : -1;
+    }
+    client = static_cast<platform_handle>(fd);
+    return 1;
+}
+
+void platform_close_listener(LocalListener& listener)
+{
+    if (listener.handle) {
+        platform_close(listener.handle);
+        unlink(listener.endpoint.c_str());
+    }
+}
+
+bool platform_connect_local(const string& endpoint, platform_handle& conn)
+{
+    sockaddr_un addr;
+    if (!make_socket_address(endpoint, addr)) {
+        return false;
+    }
+    int fd = connect_socket(addr);
+    if (fd < 0) {
+        return false;
+    }
+    conn = static_cast<platform_handle>(fd);
+    return true;
+}
+
+long platform_read_local(platform_handle conn, char* buf, size_t size, unsigned timeout_ms)
+{
+    pollfd p = { to_fd(conn), POLLIN, 0 };
+    int ready = poll(&p, 1, static_cast<int>(timeout_ms));
+    if (ready <= 0) {
+        return (ready == 0 || errno == EINTR) ? 0 : -1;
+    }
+    long got = platform_read(conn, buf, size);
+    return got > 0 ? got : -1;
+}
+
+bool platform_write_local(platform_handle conn, const char* data, size_t size)
+{
+    while (size > 0) {
+        ssize_t n = send(to_fd(conn), data, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+#endif // !_WIN32
@@ -0,0 +1,723 @@
+// platform_win32.cpp
+// Win32 implementation of platform.h.
+
+#ifdef _WIN32
+
+#define NOMINMAX
+
+#include "platform.h"
+#include "util.h"
+
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#pragma comment(lib, "user32.lib")
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <io.h>
+#include <malloc.h>
+#include <iostream>
+#include <thread>
+
+using std::string;
+
+static HANDLE to_handle(platform_handle h)
+{
+    return reinterpret_cast<HANDLE>(h);
+}
+
+static platform_handle from_handle(HANDLE h)
+{
+    return reinterpret_cast<platform_handle>(h);
+}
+
+// --------------------------- Process setup ---------------------------
+
+void platform_init()
+{
+}
+
+string platform_executable_path()
+{
+    wchar_t path[MAX_PATH];
+    DWORD len = GetModuleFileNameW(NULL, path, MAX_PATH);
+    if (len == 0 || len >= MAX_PATH) {
+        return string();
+    }
+    return wstring_to_utf8(std::wstring(path, len));
+}
+
+unsigned long platform_current_pid()
+{
+    return GetCurrentProcessId();
+}
+
+// --------------------------- Environment ---------------------------
+
+void platform_set_env(const char* name, const char* value)
+{
+    SetEnvironmentVariableA(name, value);
+}
+
+// --------------------------- Files ---------------------------
+
+bool platform_read_small_file(const string& path, string& out, size_t max_size)
+{
+    HANDLE file = CreateFileW(utf8_to_wstring(path).c_str(), GENERIC_READ,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER size;
+    bool ok = GetFileSizeEx(file, &size) && static_cast<unsigned long long>(size.QuadPart) <= max_size;
+    if (ok) {
+        out.resize(static_cast<size_t>(size.QuadPart));
+        DWORD got = 0;
+        ok = out.empty() || (ReadFile(file, &out[0], static_cast<DWORD>(out.size()), &got, NULL) && got == out.size());
+    }
+    CloseHandle(file);
+    return ok;
+}
+
+bool platform_write_file_atomic(const string& path, const string& data)
+{
+    std::wstring target = utf8_to_wstring(path);
+    std::wstring tmp = target + L".tmp";
+    HANDLE file = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    DWORD written = 0;
+    bool ok = data.empty() ||
+        (WriteFile(file, data.data(), static_cast<DWORD>(data.size()), &written, NULL) && written == data.size());
+    ok = ok && FlushFileBuffers(file);
+    CloseHandle(file);
+    if (!ok || !MoveFileExW(tmp.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH)) {
+        DeleteFileW(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+platform_handle platform_open_append(const string& path)
+{
+    // FILE_APPEND_DATA without FILE_WRITE_DATA: every write goes to the end of
+    // the file, atomically with respect to other appenders.
+    HANDLE file = CreateFileW(utf8_to_wstring(path).c_str(), FILE_APPEND_DATA,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+    return file == INVALID_HANDLE_VALUE ? PLATFORM_NO_HANDLE : from_handle(file);
+}
+
+bool platform_append_durable(platform_handle file, const char* data, size_t size)
+{
+    DWORD written = 0;
+    return WriteFile(to_handle(file), data, static_cast<DWORD>(size), &written, NULL) && written == size &&
+        FlushFileBuffers(to_handle(file));
+}
+
+bool platform_make_directories(const string& path)
+{
+    std::wstring w = utf8_to_wstring(path);
+    for (size_t sep = w.find_first_of(L"\\/", 1); ; sep = w.find_first_of(L"\\/", sep + 1)) {
+        std::wstring part = w.substr(0, sep);
+        // Skip drive roots ("C:") and the server part of UNC paths.
+        if (!part.empty() && part.back() != L':' && part.find_first_not_of(L"\\/") != std::wstring::npos &&
+            !CreateDirectoryW(part.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS &&
+            GetLastError() != ERROR_ACCESS_DENIED) {
+            return false;
+        }
+        if (sep == std::wstring::npos) break;
+    }
+    DWORD attrs = GetFileAttributesW(w.c_str());
+    return attrs != INVALID_FILE_ATTRIBUTES && (attrs & FILE_ATTRIBUTE_DIRECTORY);
+}
+
+bool platform_change_directory(const string& path)
+{
+    return SetCurrentDirectoryW(utf8_to_wstring(path).c_str()) != 0;
+}
+
+// --------------------------- File change notifications ---------------------------
+
+namespace {
+
+// The ReadDirectoryChangesW call kept outstanding on the folder.
+struct WatchRead {
+    OVERLAPPED overlapped;
+    DWORD buffer[4096 / sizeof(DWORD)];   // FILE_NOTIFY_INFORMATION records, DWORD-aligned
+    std::wstring name;
+};
+
+} // namespace
+
+static bool issue_watch_read(FileWatch& watch)
+{
+    WatchRead* read = static_cast<WatchRead*>(watch.pending);
+    HANDLE event = read->overlapped.hEvent;
+    ZeroMemory(&read->overlapped, sizeof(read->overlapped));
+    read->overlapped.hEvent = event;
+    return ReadDirectoryChangesW(to_handle(watch.handle), read->buffer, sizeof(read->buffer), FALSE,
+        FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE, NULL,
+        &read->overlapped, NULL) != 0;
+}
+
+bool platform_watch_file(const string& path, FileWatch& watch)
+{
+    size_t sep = path.find_last_of("\\/");
+    string dir = sep == string::npos ? string(".") : path.substr(0, sep + 1);
+    watch.name = sep == string::npos ? path : path.substr(sep + 1);
+
+    HANDLE folder = CreateFileW(utf8_to_wstring(dir).c_str(), FILE_LIST_DIRECTORY,
+        FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+        FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+    if (folder == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    WatchRead* read = new WatchRead();
+    read->name = utf8_to_wstring(watch.name);
+    read->overlapped.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    watch.handle = from_handle(folder);
+    watch.pending = read;
+    if (!read->overlapped.hEvent || !issue_watch_read(watch)) {
+        if (read->overlapped.hEvent) CloseHandle(read->overlapped.hEvent);
+        delete read;
+        watch.pending = nullptr;
+        platform_close(watch.handle);
+        return false;
+    }
+    return true;
+}
+
+bool platform_file_changed(FileWatch& watch)
+{
+    WatchRead* read = static_cast<WatchRead*>(watch.pending);
+    if (!read) {
+        return false;
+    }
+    bool changed = false;
+    DWORD got = 0;
+    while (GetOverlappedResult(to_handle(watch.handle), &read->overlapped, &got, FALSE)) {
+        if (got == 0) {
+            changed = true;   // the buffer overflowed; the records are lost
+        }
+        for (DWORD at = 0; at < got;) {
+            const FILE_NOTIFY_INFORMATION* info =
+                reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(reinterpret_cast<const char*>(read->buffer) + at);
+            if (CompareStringOrdinal(info->FileName, static_cast<int>(info->FileNameLength / sizeof(WCHAR)),
+                    read->name.c_str(), static_cast<int>(read->name.size()), TRUE) == CSTR_EQUAL) {
+                changed = true;
+            }
+            if (info->NextEntryOffset == 0) break;
+            at += info->NextEntryOffset;
+        }
+        if (!issue_watch_read(watch)) {
+            // The folder went away; report it once and stop watching.
+            platform_unwatch_file(watch);
+            return true;
+        }
+    }
+    return changed;
+}
+
+void platform_unwatch_file(FileWatch& watch)
+{
+    WatchRead* read = static_cast<WatchRead*>(watch.pending);
+    if (read) {
+        DWORD got = 0;
+        CancelIoEx(to_handle(watch.handle), &read->overlapped);
+        GetOverlappedResult(to_handle(watch.handle), &read->overlapped, &got, TRUE);
+        CloseHandle(read->overlapped.hEvent);
+        delete read;
+        watch.pending = nullptr;
+    }
+    platform_close(watch.handle);
+}
+
+// --------------------------- Dynamic libraries ---------------------------
+
+void* platform_load_library(const char* file)
+{
+    return LoadLibraryA(file);
+}
+
+void* platform_find_symbol(void* library, const char* name)
+{
+    return reinterpret_cast<void*>(GetProcAddress(static_cast<HMODULE>(library), name));
+}
+
+void platform_free_library(void* library)
+{
+    if (library) {
+        FreeLibrary(static_cast<HMODULE>(library));
+    }
+}
+
+// --------------------------- Standard streams ---------------------------
+
+void suppress_console_output(const std::function<void()>& fn)
+{
+    // Duplicate file descriptors for stdout/stderr
+    int stdout_backup = _dup(_fileno(stdout));
+    int stderr_backup = _dup(_fileno(stderr));
+
+    // Open NUL and redirect stdout/stderr there
+    FILE* nul = nullptr;
+    freopen_s(&nul, "NUL", "w", stdout);
+    freopen_s(&nul, "NUL", "w", stderr);
+
+    // Execute the provided callable while output is suppressed
+    fn();
+
+    // Restore original stdout/stderr (skipping descriptors that could not be
+    // duplicated, e.g. a process started without standard handles)
+    if (stdout_backup >= 0) {
+        _dup2(stdout_backup, _fileno(stdout));
+        _close(stdout_backup);
+    }
+    if (stderr_backup >= 0) {
+        _dup2(stderr_backup, _fileno(stderr));
+        _close(stderr_backup);
+    }
+}
+
+// Set once the console is gone; ENTER can no longer be read then.
+static std::atomic<bool> console_released{ false };
+
+// Signalled when the hidden stop window gets WM_CLOSE (taskkill without /F)
+// or the session ends; wait_for_stop_request() waits on it once detached.
+static HANDLE stop_event = NULL;
+
+static LRESULT CALLBACK stop_window_proc(HWND window, UINT msg, WPARAM wparam, LPARAM lparam)
+{
+    if (msg == WM_CLOSE || (msg == WM_ENDSESSION && wparam)) {
+        SetEvent(stop_event);
+        return 0;
+    }
+    return DefWindowProcW(window, msg, wparam, lparam);
+}
+
+// A hidden top-level window and its message loop, on a thread of its own.
+// False if the window could not be created.
+static bool start_stop_window()
+{
+    stop_event = CreateEventW(NULL, TRUE, FALSE, NULL);
+    HANDLE ready = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!stop_event || !ready) {
+        return false;
+    }
+    std::atomic<bool> created{ false };
+    std::thread([ready, &created]() {
+        WNDCLASSW cls = {};
+        cls.lpfnWndProc = &stop_window_proc;
+        cls.hInstance = GetModuleHandleW(NULL);
+        cls.lpszClassName = L"SimpleSteamIdlerStop";
+        HWND window = RegisterClassW(&cls)
+            ? CreateWindowExW(0, cls.lpszClassName, L"SimpleSteamIdler", WS_OVERLAPPED,
+                0, 0, 0, 0, NULL, NULL, cls.hInstance, NULL)
+            : NULL;
+        created = window != NULL;
+        SetEvent(ready);
+        if (!window) {
+            return;
+        }
+        MSG msg;
+        while (GetMessageW(&msg, NULL, 0, 0) > 0) {
+            DispatchMessageW(&msg);
+        }
+    }).detach();
+    WaitForSingleObject(ready, INFINITE);
+    CloseHandle(ready);
+    return created;
+}
+
+void platform_release_console()
+{
+    // Without a console only a window message can still ask us to stop.
+    if (!start_stop_window() && stop_event) {
+        CloseHandle(stop_event);
+        stop_event = NULL;
+    }
+    std::fflush(stdout);
+    std::fflush(stderr);
+    FILE* nul = nullptr;
+    freopen_s(&nul, "NUL", "w", stdout);
+    freopen_s(&nul, "NUL", "w", stderr);
+    freopen_s(&nul, "NUL", "r", stdin);
+    console_released = true;
+    FreeConsole();
+}
+
+#ifndef ENABLE_VIRTUAL_TERMINAL_PROCESSING
+#define ENABLE_VIRTUAL_TERMINAL_PROCESSING 0x0004   // older SDKs
+#endif
+
+bool platform_enable_ansi_output()
+{
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (console_released || out == INVALID_HANDLE_VALUE || out == NULL || !GetConsoleMode(out, &mode)) {
+        return false;
+    }
+    return (mode & ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0 ||
+        SetConsoleMode(out, mode | ENABLE_VIRTUAL_TERMINAL_PROCESSING) != 0;
+}
+
+bool platform_terminal_size(unsigned& rows, unsigned& cols)
+{
+    CONSOLE_SCREEN_BUFFER_INFO info;
+    if (console_released || !GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+        return false;
+    }
+    rows = static_cast<unsigned>(info.srWindow.Bottom - info.srWindow.Top + 1);
+    cols = static_cast<unsigned>(info.srWindow.Right - info.srWindow.Left + 1);
+    return true;
+}
+
+// --------------------------- Memory ---------------------------
+
+bool platform_memory_usage(MemoryUsage& out)
+{
+    out = MemoryUsage();
+    PROCESS_MEMORY_COUNTERS_EX mem = {};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&mem), sizeof(mem))) {
+        return false;
+    }
+    out.private_bytes = mem.PrivateUsage;
+    out.working_set = mem.WorkingSetSize;
+    return true;
+}
+
+void platform_trim_memory()
+{
+    // Decommit free heap blocks, then let the working set go (the pages the
+    // pump still touches fault back in as soft faults).
+    HeapCompact(GetProcessHeap(), 0);
+    _heapmin();
+    SetProcessWorkingSetSize(GetCurrentProcess(), static_cast<SIZE_T>(-1), static_cast<SIZE_T>(-1));
+}
+
+// --------------------------- Stop requests ---------------------------
+
+void wait_for_stop_request()
+{
+    if (console_released) {
+        // Only the stop window can ask now; without one, idle until the
+        // process is ended.
+        WaitForSingleObject(stop_event ? stop_event : GetCurrentProcess(), INFINITE);
+        return;
+    }
+    std::string dummy;
+    std::getline(std::cin, dummy);
+}
+
+const char* stop_request_hint()
+{
+    return "Press ENTER";
+}
+
+bool poll_stop_request()
+{
+    return false;
+}
+
+// --------------------------- Pipes and worker processes ---------------------------
+
+bool platform_spawn_worker(const string& exe, const std::vector<string>& args, ChildProcess& child)
+{
+    child = ChildProcess();
+
+    SECURITY_ATTRIBUTES sa = {};
+    sa.nLength = sizeof(sa);
+    sa.bInheritHandle = TRUE;
+
+    // Control pipe: the worker reads, we write. Status pipe: the worker writes, we read.
+    // Only the worker's ends are inheritable.
+    HANDLE control_read = NULL, control_write = NULL;
+    HANDLE status_read = NULL, status_write = NULL;
+    if (!CreatePipe(&control_read, &control_write, &sa, 0)) {
+        return false;
+    }
+    if (!CreatePipe(&status_read, &status_write, &sa, 0)) {
+        CloseHandle(control_read);
+        CloseHandle(control_write);
+        return false;
+    }
+    SetHandleInformation(control_write, HANDLE_FLAG_INHERIT, 0);
+    SetHandleInformation(status_read, HANDLE_FLAG_INHERIT, 0);
+
+    // Give the worker valid (but discarded) standard handles so the CRT and
+    // suppress_console_output() have real descriptors to work with.
+    HANDLE nul = CreateFileW(L"NUL", GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE, &sa, OPEN_EXISTING, 0, NULL);
+
+    std::wstring cmd = L"\"" + utf8_to_wstring(exe) + L"\"";
+    for (const auto& arg : args) {
+        cmd += L" " + utf8_to_wstring(arg);
+    }
+    cmd += L" --control " +
+        std::to_wstring(reinterpret_cast<std::uintptr_t>(control_read)) + L" " +
+        std::to_wstring(reinterpret_cast<std::uintptr_t>(status_write));
+
+    STARTUPINFOW si = {};
+    si.cb = sizeof(si);
+    if (nul != INVALID_HANDLE_VALUE) {
+        si.dwFlags = STARTF_USESTDHANDLES;
+        si.hStdInput = nul;
+        si.hStdOutput = nul;
+        si.hStdError = nul;
+    }
+    PROCESS_INFORMATION pi = {};
+
+    BOOL created = CreateProcessW(NULL, &cmd[0], NULL, NULL, TRUE,
+        CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
+
+    // The worker owns its ends now (or nobody does if creation failed).
+    CloseHandle(control_read);
+    CloseHandle(status_write);
+    if (nul != INVALID_HANDLE_VALUE) {
+        CloseHandle(nul);
+    }
+
+    if (!created) {
+        CloseHandle(control_write);
+        CloseHandle(status_read);
+        return false;
+    }
+
+    CloseHandle(pi.hThread);
+    child.process = from_handle(pi.hProcess);
+    child.pid = pi.dwProcessId;
+    child.control_write = from_handle(control_write);
+    child.status_read = from_handle(status_read);
+    return true;
+}
+
+bool platform_wait_child(ChildProcess& child, unsigned timeout_ms, int& exit_code)
+{
+    if (!child.process) {
+        return false;
+    }
+    if (WaitForSingleObject(to_handle(child.process), timeout_ms) != WAIT_OBJECT_0) {
+        return false;
+    }
+    DWORD code = 0;
+    GetExitCodeProcess(to_handle(child.process), &code);
+    exit_code = static_cast<int>(code);
+    CloseHandle(to_handle(child.process));
+    child.process = PLATFORM_NO_HANDLE;
+    return true;
+}
+
+void platform_kill_child(ChildProcess& child)
+{
+    if (child.process) {
+        TerminateProcess(to_handle(child.process), 1);
+    }
+}
+
+long platform_read_nonblocking(platform_handle h, char* buf, size_t size)
+{
+    // PeekNamedPipe also works on anonymous pipes and lets us poll without blocking.
+    DWORD avail = 0;
+    if (!PeekNamedPipe(to_handle(h), NULL, 0, NULL, &avail, NULL)) {
+        return -1;
+    }
+    if (avail == 0) {
+        return 0;
+    }
+    DWORD got = 0;
+    DWORD want = static_cast<DWORD>(std::min<size_t>(avail, size));
+    if (!ReadFile(to_handle(h), buf, want, &got, NULL)) {
+        return -1;
+    }
+    return static_cast<long>(got);
+}
+
+long platform_read(platform_handle h, char* buf, size_t size)
+{
+    DWORD got = 0;
+    if (!ReadFile(to_handle(h), buf, static_cast<DWORD>(size), &got, NULL)) {
+        // A closed write end shows up as ERROR_BROKEN_PIPE: that is EOF.
+        return GetLastError() == ERROR_BROKEN_PIPE ? 0 : -1;
+    }
+    return static_cast<long>(got);
+}
+
+bool platform_write(platform_handle h, const char* data, size_t size)
+{
+    while (size > 0) {
+        DWORD written = 0;
+        if (!WriteFile(to_handle(h), data, static_cast<DWORD>(size), &written, NULL)) {
+            return false;
+        }
+        data += written;
+        size -= written;
+    }
+    return true;
+}
+
+void platform_close(platform_handle& h)
+{
+    if (h) {
+        CloseHandle(to_handle(h));
+        h = PLATFORM_NO_HANDLE;
+    }
+}
+
+bool platform_parse_handle(const char* text, platform_handle& out)
+{
+    if (!text || !is_digits_only(text)) return false;
+    out = static_cast<platform_handle>(std::strtoull(text, nullptr, 10));
+    return out != PLATFORM_NO_HANDLE;
+}
+
+// --------------------------- Local control endpoint ---------------------------
+
+string platform_default_control_endpoint()
+{
+    return "\\\\.\\pipe\\SimpleSteamIdler";
+}
+
+// Every connection is overlapped so reads can time out (see platform_read_local).
+static HANDLE create_pipe_instance(const std::wstring& name, bool first)
+{
+    DWORD open_mode = PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | (first ? FILE_FLAG_FIRST_PIPE_INSTANCE : 0);
+    return CreateNamedPipeW(name.c_str(), open_mode,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        PIPE_UNLIMITED_INSTANCES, 4096, 4096, 0, NULL);
+}
+
+// Wait for an overlapped operation on h for up to timeout_ms, cancelling it on
+// timeout. Returns the Win32 error (ERROR_SUCCESS when done) and the byte count.
+static DWORD finish_overlapped(HANDLE h, OVERLAPPED& ov, BOOL started, unsigned timeout_ms, DWORD& bytes)
+{
+    bytes = 0;
+    DWORD err = started ? ERROR_SUCCESS : GetLastError();
+    if (err == ERROR_IO_PENDING) {
+        if (WaitForSingleObject(ov.hEvent, timeout_ms) != WAIT_OBJECT_0) {
+            CancelIoEx(h, &ov);
+        }
+        // Also covers the race where the operation completed while cancelling.
+        err = GetOverlappedResult(h, &ov, &bytes, TRUE) ? ERROR_SUCCESS : GetLastError();
+    }
+    else if (err == ERROR_SUCCESS) {
+        GetOverlappedResult(h, &ov, &bytes, FALSE);
+    }
+    return err;
+}
+
+bool platform_listen_local(const string& endpoint, LocalListener& listener, string& error)
+{
+    listener = LocalListener();
+    HANDLE pipe = create_pipe_instance(utf8_to_wstring(endpoint), true);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        error = GetLastError() == ERROR_ACCESS_DENIED
+            ? "Another daemon is already listening on " + endpoint + "."
+            : "Cannot create the pipe " + endpoint + ".";
+        return false;
+    }
+    listener.endpoint = endpoint;
+    listener.handle = from_handle(pipe);
+    return true;
+}
+
+int platform_accept_local(LocalListener& listener, unsigned timeout_ms, platform_handle& client)
+{
+    HANDLE pipe = to_handle(listener.handle);
+    OVERLAPPED ov = {};
+    ov.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!ov.hEvent) {
+        return -1;
+    }
+    DWORD bytes = 0;
+    DWORD err = finish_overlapped(pipe, ov, ConnectNamedPipe(pipe, &ov), timeout_ms, bytes);
+    CloseHandle(ov.hEvent);
+
+    if (err == ERROR_OPERATION_ABORTED) {
+        return 0;
+    }
+    if (err == ERROR_NO_DATA) {
+        // The client connected and left again before we noticed.
+        DisconnectNamedPipe(pipe);
+        return 0;
+    }
+    if (err != ERROR_SUCCESS && err != ERROR_PIPE_CONNECTED) {
+        return -1;
+    }
+
+    // This instance now belongs to the client; the next one waits for the next.
+    HANDLE next = create_pipe_instance(utf8_to_wstring(listener.endpoint), false);
+    if (next == INVALID_HANDLE_VALUE) {
+        DisconnectNamedPipe(pipe);
+        return -1;
+    }
+    client = listener.handle;
+    listener.handle = from_handle(next);
+    return 1;
+}
+
+void platform_close_listener(LocalListener& listener)
+{
+    platform_close(listener.handle);
+}
+
+bool platform_connect_local(const string& endpoint, platform_handle& conn)
+{
+    std::wstring name = utf8_to_wstring(endpoint);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        HANDLE pipe = CreateFileW(name.c_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, OPEN_EXISTING,
+            FILE_FLAG_OVERLAPPED, NULL);
+        if (pipe != INVALID_HANDLE_VALUE) {
+            conn = from_handle(pipe);
+            return true;
+        }
+        // Every instance busy: the daemon creates a new one right after each accept.
+        if (GetLastError() != ERROR_PIPE_BUSY || !WaitNamedPipeW(name.c_str(), 2000)) {
+            return false;
+        }
+    }
+    return false;
+}
+
+long platform_read_local(platform_handle conn, char* buf, size_t size, unsigned timeout_ms)
+{
+    HANDLE pipe = to_handle(conn);
+    OVERLAPPED ov = {};
+    ov.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!ov.hEvent) {
+        return -1;
+    }
+    DWORD got = 0;
+    DWORD err = finish_overlapped(pipe, ov, ReadFile(pipe, buf, static_cast<DWORD>(size), NULL, &ov), timeout_ms, got);
+    CloseHandle(ov.hEvent);
+
+    if (got > 0) {
+        return static_cast<long>(got);
+    }
+    return err == ERROR_OPERATION_ABORTED ? 0 : -1;
+}
+
+bool platform_write_local(platform_handle conn, const char* data, size_t size)
+{
+    HANDLE pipe = to_handle(conn);
+    OVERLAPPED ov = {};
+    ov.hEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+    if (!ov.hEvent) {
+        return false;
+    }
+    bool ok = true;
+    while (ok && size > 0) {
+        DWORD written = 0;
+        ok = finish_overlapped(pipe, ov, WriteFile(pipe, data, static_cast<DWORD>(size), NULL, &ov),
+            INFINITE, written) == ERROR_SUCCESS;
+        data += written;
+        size -= written;
+    }
+    CloseHandle(ov.hEvent);
+    return ok;
+}
+
+#endif // _WIN32
@@ -0,0 +1,354 @@
+// profile.cpp
+// Profile mode: per-game settings from a watched file. See profile.h.
+
+#include "profile.h"
+#include "dashboard.h"
+#include "platform.h"
+#include "rotation.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+static const size_t MAX_PROFILE_FILE = 1024 * 1024;
+static const std::chrono::milliseconds POLL_INTERVAL(250);
+static const std::chrono::seconds SAVE_INTERVAL(30);
+static const unsigned long MAX_TICK_MS = 60000;
+
+// --------------------------- Profile file ---------------------------
+
+std::vector<string> ProfileEntry::worker_args() const
+{
+    if (tick_ms == 0) {
+        return std::vector<string>();
+    }
+    return { "--tick", std::to_string(tick_ms) };
+}
+
+bool parse_profile(const string& text, std::vector<ProfileEntry>& out, string& error)
+{
+    out.clear();
+    std::istringstream in(text);
+    string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        size_t hash = line.find('#');
+        if (hash != string::npos) {
+            line.erase(hash);
+        }
+        std::istringstream fields(line);
+        string appid, field;
+        if (!(fields >> appid)) {
+            continue;
+        }
+
+        ProfileEntry e;
+        e.appid = appid;
+        bool ok = is_digits_only(appid);
+        while (ok && fields >> field) {
+            size_t eq = field.find('=');
+            string key = field.substr(0, eq);
+            string value = eq == string::npos ? string() : field.substr(eq + 1);
+            char* end = nullptr;
+            if (key == "target") {
+                ok = parse_idle_duration(value, e.target_s);
+            }
+            else if (key == "priority") {
+                e.priority = static_cast<int>(std::strtol(value.c_str(), &end, 10));
+                ok = !value.empty() && *end == '\0';
+            }
+            else if (key == "tick") {
+                unsigned long tick = std::strtoul(value.c_str(), &end, 10);
+                ok = is_digits_only(value) && tick >= 1 && tick <= MAX_TICK_MS;
+                e.tick_ms = static_cast<unsigned>(tick);
+            }
+            else {
+                ok = false;
+            }
+        }
+        if (!ok) {
+            error = "line " + std::to_string(number) +
+                ": expected \"<appid> [target=<time>] [priority=<n>] [tick=<ms>]\", e.g. \"440 target=10h\".";
+            return false;
+        }
+        for (const auto& other : out) {
+            if (other.appid == appid) {
+                error = "line " + std::to_string(number) + ": AppID " + appid + " is listed twice.";
+                return false;
+            }
+        }
+        out.push_back(e);
+    }
+    return true;
+}
+
+static const ProfileEntry* find_entry(const std::vector<ProfileEntry>& entries, const string& appid)
+{
+    for (const auto& e : entries) {
+        if (e.appid == appid) return &e;
+    }
+    return nullptr;
+}
+
+ProfileChanges diff_profiles(const std::vector<ProfileEntry>& before, const std::vector<ProfileEntry>& after)
+{
+    ProfileChanges changes;
+    for (const auto& e : after) {
+        const ProfileEntry* old = find_entry(before, e.appid);
+        if (!old) {
+            changes.added.push_back(e.appid);
+        }
+        else if (old->worker_args() != e.worker_args()) {
+            changes.restarted.push_back(e.appid);
+        }
+        else if (old->target_s != e.target_s || old->priority != e.priority) {
+            changes.updated.push_back(e.appid);
+        }
+    }
+    for (const auto& e : before) {
+        if (!find_entry(after, e.appid)) {
+            changes.removed.push_back(e.appid);
+        }
+    }
+    return changes;
+}
+
+// --------------------------- Console profile mode ---------------------------
+
+static bool read_profile(const string& path, string& text, std::vector<ProfileEntry>& out, string& error)
+{
+    if (!platform_read_small_file(path, text, MAX_PROFILE_FILE)) {
+        error = "cannot read the profile \"" + path + "\"";
+        return false;
+    }
+    if (!parse_profile(text, out, error)) {
+        error = path + ", " + error;
+        return false;
+    }
+    return true;
+}
+
+// Run state of a profile's games, in profile order. Games already known keep
+// their credited time (and their failure, unless their line changed); games
+// without a target never run out of time.
+static std::vector<RotationEntry> idle_entries(const std::vector<ProfileEntry>& profile,
+    const std::vector<RotationEntry>& known, const ProfileChanges* changes)
+{
+    std::vector<RotationEntry> out;
+    for (const auto& p : profile) {
+        RotationEntry e;
+        auto it = std::find_if(known.begin(), known.end(), [&](const RotationEntry& k) { return k.appid == p.appid; });
+        if (it != known.end()) {
+            e = *it;
+        }
+        if (changes) {
+            for (const auto* list : { &changes->added, &changes->restarted, &changes->updated }) {
+                if (std::find(list->begin(), list->end(), p.appid) != list->end()) e.failed = false;
+            }
+        }
+        e.appid = p.appid;
+        e.target_s = p.target_s > 0 ? p.target_s : std::numeric_limits<double>::infinity();
+        e.priority = p.priority;
+        out.push_back(e);
+    }
+    return out;
+}
+
+static string join_appids(const std::vector<string>& appids)
+{
+    string out;
+    for (const auto& id : appids) {
+        out += (out.empty() ? "" : ", ") + id;
+    }
+    return out;
+}
+
+static string describe_changes(const ProfileChanges& c)
+{
+    string out;
+    auto part = [&out](const char* what, const std::vector<string>& appids) {
+        if (appids.empty()) return;
+        out += (out.empty() ? "" : "; ") + string(what) + " " + join_appids(appids);
+    };
+    part("added", c.added);
+    part("removed", c.removed);
+    part("restarted", c.restarted);
+    part("updated", c.updated);
+    return out;
+}
+
+int run_profile(const ProfileOptions& opts, const WorkerOptions& workers)
+{
+    string text, error;
+    std::vector<ProfileEntry> profile;
+    if (!read_profile(opts.path, text, profile, error)) {
+        print_utf8_line("Error: " + error + ".");
+        return 1;
+    }
+
+    string progress_path = opts.progress_path.empty() ? opts.path + ".progress" : opts.progress_path;
+    std::vector<RotationEntry> queue = idle_entries(profile, std::vector<RotationEntry>(), nullptr);
+    std::vector<RotationEntry> retired;   // games taken out of the profile, kept for their progress
+    size_t resumed = load_rotation_progress(progress_path, queue);
+    if (resumed > 0) {
+        print_utf8_line("Resuming saved progress of " + std::to_string(resumed) + " game(s) from " + progress_path + ".");
+    }
+
+    string exe_path = platform_executable_path();
+    if (exe_path.empty()) {
+        print_utf8_line("Error: could not determine the executable path.");
+        return 1;
+    }
+
+    WorkerOptions worker_opts = workers;
+    if (worker_opts.appid_dir.empty()) {
+        worker_opts.appid_dir = opts.path + ".workers";
+    }
+
+    std::unique_ptr<Dashboard> dashboard;
+    if (workers.dashboard) {
+        dashboard.reset(new Dashboard("Profile " + opts.path, workers.steam_dir));
+    }
+    Dashboard* board = dashboard.get();
+    std::function<void(const string&)> say = dashboard_event_sink(board);
+    Supervisor supervisor(exe_path, say, worker_arguments(worker_opts));
+    supervisor.keep_standby(workers.standby);
+
+    FileWatch watch;
+    bool watching = platform_watch_file(opts.path, watch);
+
+    const size_t k = opts.concurrent > 0 ? std::min(opts.concurrent, Supervisor::MAX_WORKERS) : Supervisor::MAX_WORKERS;
+    const double scale = opts.clock_scale > 0 ? opts.clock_scale : 1.0;
+    print_utf8_line("Profile " + opts.path + ": " + std::to_string(profile.size()) + " game(s), up to " +
+        std::to_string(k) + " at a time. " + (watching ? "Edits apply as the file is saved. " :
+        "Warning: cannot watch the file; edits apply on the next start. ") + stop_request_hint() + " to stop.");
+
+    std::shared_ptr<StopSignal> stop = watch_stop_request();
+
+    bool dirty = false;
+    Clock::time_point last_save = Clock::now();
+    auto save = [&]() {
+        std::vector<RotationEntry> all = queue;
+        all.insert(all.end(), retired.begin(), retired.end());
+        if (dirty && !save_rotation_progress(progress_path, all)) {
+            say("Warning: could not save profile progress to " + progress_path + ".");
+        }
+        dirty = false;
+        last_save = Clock::now();
+    };
+
+    // AppID -> extra worker arguments, for every game that has a worker.
+    std::map<string, std::vector<string>> active;
+    bool idle_note = false;   // "nothing left" was said since the last change
+    auto apply = [&]() {
+        std::vector<size_t> picked = pick_rotation_slice(queue, k);
+        std::map<string, std::vector<string>> next;
+        for (size_t i : picked) {
+            next[queue[i].appid] = profile[i].worker_args();
+        }
+        for (const auto& a : active) {
+            auto it = next.find(a.first);
+            if (it == next.end() || it->second != a.second) supervisor.remove(a.first);
+        }
+        std::vector<string> ids;
+        for (size_t i : picked) {
+            const string& id = queue[i].appid;
+            auto it = active.find(id);
+            if (it == active.end() || it->second != next[id]) supervisor.add(id, next[id]);
+            ids.push_back(id);
+        }
+        if (next != active) {
+            say(ids.empty() ? string("[profile] nothing to idle") : "[profile] idling " + join_appids(ids));
+        }
+        active = next;
+        if (ids.empty() && !idle_note) {
+            say(profile.empty() ? "The profile lists no games yet." :
+                "Every game in the profile reached its target or failed.");
+            idle_note = true;
+        }
+    };
+
+    auto reload = [&]() {
+        string new_text, reload_error;
+        std::vector<ProfileEntry> updated;
+        if (!platform_read_small_file(opts.path, new_text, MAX_PROFILE_FILE) || new_text == text) {
+            return;   // gone for a moment (replaced by rename), or saved unchanged
+        }
+        text = new_text;
+        if (!parse_profile(text, updated, reload_error)) {
+            say("Profile " + opts.path + ", " + reload_error + " Keeping the previous version.");
+            return;
+        }
+        ProfileChanges changes = diff_profiles(profile, updated);
+        if (changes.empty()) {
+            return;
+        }
+        say("Profile reloaded: " + describe_changes(changes) + ".");
+
+        std::vector<RotationEntry> known = queue;
+        known.insert(known.end(), retired.begin(), retired.end());
+        for (const auto& id : changes.removed) {
+            retired.erase(std::remove_if(retired.begin(), retired.end(),
+                [&](const RotationEntry& e) { return e.appid == id; }), retired.end());
+            auto it = std::find_if(queue.begin(), queue.end(), [&](const RotationEntry& e) { return e.appid == id; });
+            retired.push_back(*it);
+        }
+        profile = updated;
+        queue = idle_entries(profile, known, &changes);
+        retired.erase(std::remove_if(retired.begin(), retired.end(),
+            [&](const RotationEntry& e) { return find_entry(profile, e.appid) != nullptr; }), retired.end());
+        idle_note = false;
+        apply();
+    };
+
+    apply();
+    Clock::time_point last_tick = Clock::now();
+    while (!stop->wait_for(POLL_INTERVAL)) {
+        if (watching && platform_file_changed(watch)) {
+            reload();
+        }
+        if (!watching && active.empty()) {
+            break;   // nothing left, and no edit can bring more
+        }
+
+        supervisor.poll();
+        Clock::time_point now = Clock::now();
+        Clock::duration real = now - last_tick;
+        last_tick = now;
+
+        std::vector<WorkerStatus> snapshot = supervisor.snapshot();
+        if (credit_rotation_progress(queue, snapshot, real, now, scale, say, "profile", dirty)) {
+            apply();
+            snapshot = supervisor.snapshot();
+        }
+        if (board) {
+            board->update(snapshot, summarize_workers(snapshot));
+        }
+        if (now - last_save >= SAVE_INTERVAL) {
+            save();
+        }
+    }
+
+    if (board) {
+        board->finish();
+    }
+    if (watching) {
+        platform_unwatch_file(watch);
+    }
+    if (!active.empty()) {
+        print_utf8_line("Stopping workers...");
+    }
+    supervisor.stop_all();
+    save();
+    print_utf8_line("Callback pumps: " + describe_pump_stats(supervisor.pump_totals()) + ".");
+    print_utf8_line("Profile stopped. Progress is in " + progress_path + ".");
+    return 0;
+}
@@ -0,0 +1,81 @@
+// profile.h
+// Profile mode (--profile <file>): idle the games a profile file lists, each
+// with its own settings, and apply edits to the file while they run.
+//
+// One game per line, '#' starts a comment:
+//
+//   <appid> [target=<time>] [priority=<n>] [tick=<ms>]
+//
+//   440 target=10h priority=5
+//   570 tick=500
+//   730
+//
+// target is the idle time wanted, as in a rotation queue (rotation.h: "h",
+// "m" or "s" suffix, a bare number is hours); a game without one idles until
+// the program stops. priority decides, highest first, which games run when
+// the profile lists more than --concurrent (default: as many as Steam allows,
+// 32). tick replaces --tick, the callback pump interval (callback_pump.h),
+// for that game's worker.
+//
+// Games run under a Supervisor (one worker each, see supervisor.h), picked
+// like rotation slices (pick_rotation_slice) but without slices: a game keeps
+// its worker until it reaches its target or fails for good. Idle time is
+// credited and saved in "<file>.progress" the same way as a rotation's, so
+// targets carry over between runs.
+//
+// The file's folder is watched (platform_watch_file: ReadDirectoryChangesW
+// on Windows, inotify elsewhere). When the file changes it is read again and
+// only the difference is applied: new games start, removed ones stop, a game
+// whose tick changed gets a new worker, and target or priority changes only
+// redo the pick. Every other worker keeps running. A file that does not parse
+// is reported and ignored until it does.
+//
+// Every worker runs in "<file>.workers/<appid>/" (WorkerOptions::appid_dir)
+// with a steam_appid.txt generated there, so Steam finds the file it expects
+// without the workers overwriting each other's.
+
+#pragma once
+
+#include "supervisor.h"
+
+#include <string>
+#include <vector>
+
+struct ProfileEntry {
+    std::string appid;
+    double target_s = 0;    // idle time wanted; 0 for none
+    int priority = 0;       // higher goes first
+    unsigned tick_ms = 0;   // callback pump interval; 0 for the command line's
+
+    // Extra worker arguments for this game (its "--tick").
+    std::vector<std::string> worker_args() const;
+};
+
+struct ProfileOptions {
+    std::string path;
+    std::string progress_path;   // empty: "<path>.progress"
+    size_t concurrent = 0;       // games idled at the same time; 0 for MAX_WORKERS
+    double clock_scale = 1;      // idle-clock seconds per real second (testing)
+};
+
+// Parse profile text into entries, in file order. False with error (naming
+// the line) on a malformed line or a repeated AppID.
+bool parse_profile(const std::string& text, std::vector<ProfileEntry>& out, std::string& error);
+
+// What changed between two versions of a profile, by AppID.
+struct ProfileChanges {
+    std::vector<std::string> added;       // new games
+    std::vector<std::string> removed;     // games no longer listed
+    std::vector<std::string> restarted;   // worker arguments changed: new worker
+    std::vector<std::string> updated;     // target or priority changed only
+
+    bool empty() const { return added.empty() && removed.empty() && restarted.empty() && updated.empty(); }
+};
+
+ProfileChanges diff_profiles(const std::vector<ProfileEntry>& before, const std::vector<ProfileEntry>& after);
+
+// Console profile mode: run the profile and follow edits to it until the user
+// asks to stop. Once every game reached its target or failed it waits for an
+// edit, unless the file cannot be watched, in which case it stops. Returns a
+// process exit code.
+int run_profile(const ProfileOptions& opts, const WorkerOptions& workers);
@@ -0,0 +1,319 @@
+// rotation.cpp
+// Time-sliced rotation across an AppID queue. See rotation.h.
+
+#include "rotation.h"
+#include "dashboard.h"
+#include "platform.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <queue>
+#include <sstream>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+static const size_t MAX_QUEUE_FILE = 1024 * 1024;
+static const std::chrono::milliseconds POLL_INTERVAL(250);
+static const std::chrono::seconds SAVE_INTERVAL(30);
+
+// --------------------------- Queue and progress files ---------------------------
+
+bool parse_idle_duration(const string& s, double& seconds)
+{
+    if (s.empty()) return false;
+    char* end = nullptr;
+    double value = std::strtod(s.c_str(), &end);
+    if (end == s.c_str() || value <= 0.0) return false;
+    string unit(end);
+    if (unit.empty() || unit == "h") seconds = value * 3600.0;
+    else if (unit == "m") seconds = value * 60.0;
+    else if (unit == "s") seconds = value;
+    else return false;
+    return true;
+}
+
+bool parse_rotation_queue(const string& text, std::vector<RotationEntry>& out, string& error)
+{
+    out.clear();
+    std::istringstream in(text);
+    string line;
+    for (int number = 1; std::getline(in, line); ++number) {
+        size_t hash = line.find('#');
+        if (hash != string::npos) {
+            line.erase(hash);
+        }
+        std::istringstream fields(line);
+        string appid, target, priority, extra;
+        if (!(fields >> appid)) {
+            continue;
+        }
+        fields >> target >> priority >> extra;
+
+        RotationEntry e;
+        e.appid = appid;
+        bool ok = is_digits_only(appid) && parse_idle_duration(target, e.target_s) && extra.empty();
+        if (ok && !priority.empty()) {
+            char* end = nullptr;
+            e.priority = static_cast<int>(std::strtol(priority.c_str(), &end, 10));
+            ok = *end == '\0';
+        }
+        if (!ok) {
+            error = "line " + std::to_string(number) + ": expected \"<appid> <target> [priority]\", e.g. \"440 10h\".";
+            return false;
+        }
+        for (const auto& other : out) {
+            if (other.appid == appid) {
+                error = "line " + std::to_string(number) + ": AppID " + appid + " is listed twice.";
+                return false;
+            }
+        }
+        out.push_back(e);
+    }
+    return true;
+}
+
+size_t load_rotation_progress(const string& path, std::vector<RotationEntry>& entries)
+{
+    string text;
+    if (!platform_read_small_file(path, text, MAX_QUEUE_FILE)) {
+        return 0;
+    }
+    size_t applied = 0;
+    std::istringstream in(text);
+    string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        string appid;
+        double done = 0;
+        if (!(fields >> appid >> done) || done < 0) continue;
+        for (auto& e : entries) {
+            if (e.appid == appid) {
+                e.done_s = done;
+                ++applied;
+                break;
+            }
+        }
+    }
+    return applied;
+}
+
+bool save_rotation_progress(const string& path, const std::vector<RotationEntry>& entries)
+{
+    string text = "# SimpleSteamIdler rotation progress: <appid> <seconds idled>\n";
+    char buf[64];
+    for (const auto& e : entries) {
+        std::snprintf(buf, sizeof(buf), " %.1f\n", e.done_s);
+        text += e.appid + buf;
+    }
+    return write_file_if_changed(path, text);
+}
+
+std::vector<size_t> pick_rotation_slice(const std::vector<RotationEntry>& entries, size_t k)
+{
+    // Ordered so the heap's top is the most urgent entry.
+    auto less_urgent = [&entries](size_t a, size_t b) {
+        const RotationEntry& x = entries[a];
+        const RotationEntry& y = entries[b];
+        if (x.priority != y.priority) return x.priority < y.priority;
+        if (x.remaining_s() != y.remaining_s()) return x.remaining_s() < y.remaining_s();
+        return a > b;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(less_urgent)> heap(less_urgent);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        if (!entries[i].failed && entries[i].remaining_s() > 0) {
+            heap.push(i);
+        }
+    }
+    std::vector<size_t> picked;
+    while (!heap.empty() && picked.size() < k) {
+        picked.push_back(heap.top());
+        heap.pop();
+    }
+    return picked;
+}
+
+static string describe_hours(double seconds)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1f h", seconds / 3600.0);
+    return buf;
+}
+
+bool credit_rotation_progress(std::vector<RotationEntry>& entries, const std::vector<WorkerStatus>& snapshot,
+    Clock::duration real, Clock::time_point now, double scale,
+    const std::function<void(const string&)>& say, const char* mode, bool& dirty)
+{
+    bool repick = false;
+    for (const auto& status : snapshot) {
+        auto it = std::find_if(entries.begin(), entries.end(),
+            [&](const RotationEntry& e) { return e.appid == status.appid; });
+        if (it == entries.end()) continue;
+        RotationEntry& e = *it;
+        if (status.state == WorkerState::Running && e.remaining_s() > 0) {
+            // Only the part of the tick the worker spent idling counts.
+            Clock::duration idled = std::min(real, now - status.since);
+            e.done_s = std::min(e.target_s, e.done_s + std::chrono::duration<double>(idled).count() * scale);
+            dirty = true;
+            if (e.remaining_s() <= 0) {
+                say("AppID " + e.appid + ": reached its target of " + describe_hours(e.target_s) + ".");
+                repick = true;
+            }
+        }
+        else if (status.state == WorkerState::Failed && !e.failed) {
+            e.failed = true;
+            say("AppID " + e.appid + ": dropped from the " + mode + ".");
+            repick = true;
+        }
+    }
+    return repick;
+}
+
+// --------------------------- Console rotation ---------------------------
+
+static bool contains(const std::vector<size_t>& v, size_t x)
+{
+    return std::find(v.begin(), v.end(), x) != v.end();
+}
+
+int run_rotation(const RotationOptions& opts, const WorkerOptions& workers)
+{
+    string text, error;
+    std::vector<RotationEntry> queue;
+    if (!platform_read_small_file(opts.queue_path, text, MAX_QUEUE_FILE)) {
+        print_utf8_line("Error: cannot read rotation queue \"" + opts.queue_path + "\".");
+        return 1;
+    }
+    if (!parse_rotation_queue(text, queue, error)) {
+        print_utf8_line("Error: " + opts.queue_path + ", " + error);
+        return 1;
+    }
+    if (queue.empty()) {
+        print_utf8_line("Error: the rotation queue \"" + opts.queue_path + "\" lists no games.");
+        return 1;
+    }
+
+    string progress_path = opts.progress_path.empty() ? opts.queue_path + ".progress" : opts.progress_path;
+    size_t resumed = load_rotation_progress(progress_path, queue);
+    if (resumed > 0) {
+        print_utf8_line("Resuming saved progress of " + std::to_string(resumed) + " game(s) from " + progress_path + ".");
+    }
+
+    string exe_path = platform_executable_path();
+    if (exe_path.empty()) {
+        print_utf8_line("Error: could not determine the executable path.");
+        return 1;
+    }
+
+    std::unique_ptr<Dashboard> dashboard;
+    if (workers.dashboard) {
+        dashboard.reset(new Dashboard("Rotating " + std::to_string(queue.size()) + " game(s), " +
+            std::to_string(opts.concurrent > 0 ? opts.concurrent : 1) + " at a time", workers.steam_dir));
+    }
+    Dashboard* board = dashboard.get();
+    std::function<void(const string&)> say = dashboard_event_sink(board);
+    Supervisor supervisor(exe_path, say, worker_arguments(workers));
+    supervisor.keep_standby(workers.standby);
+
+    const size_t k = opts.concurrent > 0 ? opts.concurrent : 1;   // at most MAX_WORKERS, see options.cpp
+    const double scale = opts.clock_scale > 0 ? opts.clock_scale : 1.0;
+    string clock_note;
+    if (scale != 1.0) {
+        char buf[48];
+        std::snprintf(buf, sizeof(buf), ", clock x%g", scale);
+        clock_note = buf;
+    }
+    print_utf8_line("Rotating " + std::to_string(queue.size()) + " game(s), " + std::to_string(k) +
+        " at a time, in slices of " + std::to_string(static_cast<long long>(opts.slice_s / 60.0)) + " min" +
+        clock_note + ". " + stop_request_hint() + " to stop.");
+
+    std::shared_ptr<StopSignal> stop = watch_stop_request();
+
+    bool dirty = false;
+    Clock::time_point last_save = Clock::now();
+    auto save = [&]() {
+        if (dirty && !save_rotation_progress(progress_path, queue)) {
+            say("Warning: could not save rotation progress to " + progress_path + ".");
+        }
+        dirty = false;
+        last_save = Clock::now();
+    };
+
+    std::vector<size_t> active;
+    bool stopped = false;
+    while (!stopped) {
+        std::vector<size_t> next = pick_rotation_slice(queue, k);
+        if (next.empty()) {
+            break;
+        }
+        for (size_t i : active) {
+            if (!contains(next, i)) supervisor.remove(queue[i].appid);
+        }
+        for (size_t i : next) {
+            if (!contains(active, i)) supervisor.add(queue[i].appid);
+        }
+        active = next;
+
+        string line = "[slice]";
+        for (size_t i : active) {
+            line += (line.size() > 7 ? ", " : " ") + queue[i].appid + " (" + describe_hours(queue[i].remaining_s()) + " left)";
+        }
+        say(line);
+
+        double slice_left = opts.slice_s;
+        Clock::time_point last_tick = Clock::now();
+        bool repick = false;
+        while (!repick) {
+            if (stop->wait_for(POLL_INTERVAL)) {
+                stopped = true;
+                break;
+            }
+            supervisor.poll();
+            Clock::time_point now = Clock::now();
+            Clock::duration real = now - last_tick;
+            last_tick = now;
+            slice_left -= std::chrono::duration<double>(real).count() * scale;
+
+            std::vector<WorkerStatus> snapshot = supervisor.snapshot();
+            if (credit_rotation_progress(queue, snapshot, real, now, scale, say, "rotation", dirty)) {
+                repick = true;
+            }
+            if (slice_left <= 0) {
+                repick = true;
+            }
+            if (board) {
+                char left[48];
+                std::snprintf(left, sizeof(left), " | slice %.0f min left", std::max(0.0, slice_left / 60.0));
+                board->update(snapshot, summarize_workers(snapshot) + left);
+            }
+            if (now - last_save >= SAVE_INTERVAL) {
+                save();
+            }
+        }
+        save();
+    }
+
+    if (board) {
+        board->finish();
+    }
+    if (!active.empty()) {
+        print_utf8_line("Stopping workers...");
+    }
+    supervisor.stop_all();
+    save();
+
+    size_t reached = 0, failed = 0;
+    for (const auto& e : queue) {
+        if (e.failed) ++failed;
+        else if (e.remaining_s() <= 0) ++reached;
+    }
+    print_utf8_line(string(stopped ? "Rotation stopped" : "Rotation finished") + ": " + std::to_string(reached) + "/" +
+        std::to_string(queue.size()) + " game(s) reached their target, " + std::to_string(failed) +
+        " failed. Progress is in " + progress_path + ".");
+    return 0;
+}
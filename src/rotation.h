@@ -0,0 +1,77 @@
+// rotation.h
+// Rotation mode (--rotate <queue>): work through a backlog of games with a
+// fixed number of workers, in time slices.
+//
+// The queue file lists one game per line, '#' starts a comment:
+//
+//   <appid> <target> [priority]      e.g.  440 10h   570 90m 5   730 2.5
+//
+// target is the idle time wanted for that game ("h", "m" or "s" suffix; a
+// bare number is hours) and priority an integer, higher first (default 0).
+// Every slice the scheduler picks the K most urgent unfinished games (highest
+// priority, then most time left) and runs them under a Supervisor (one worker
+// each, see supervisor.h); games that stay picked keep their worker. Time is
+// credited only while a worker is actually idling. A slice ends early when a
+// game reaches its target or fails for good, so its slot is handed on.
+//
+// Progress ("<appid> <seconds>" lines) is saved atomically every 30 seconds,
+// at every slice change and on exit, so a restart resumes where it stopped.
+
+#pragma once
+
+#include "supervisor.h"
+
+#include <string>
+#include <vector>
+
+struct RotationEntry {
+    std::string appid;
+    double target_s = 0;   // idle time wanted
+    int priority = 0;      // higher goes first
+    double done_s = 0;     // idle time credited so far (persisted)
+    bool failed = false;   // permanent worker failure this run; skipped
+
+    double remaining_s() const { return target_s > done_s ? target_s - done_s : 0; }
+};
+
+struct RotationOptions {
+    std::string queue_path;
+    std::string progress_path;   // empty: "<queue_path>.progress"
+    size_t concurrent = 1;       // K: games idled at the same time
+    double slice_s = 1800;       // slice length, in idle-clock seconds
+    double clock_scale = 1;      // idle-clock seconds per real second (testing)
+};
+
+// An idle time: "10h", "90m", "3600s" or a bare number of hours. False
+// unless it is positive.
+bool parse_idle_duration(const std::string& s, double& seconds);
+
+// Parse queue file text into entries, in file order. False with error (naming
+// the line) on a malformed line or a repeated AppID.
+bool parse_rotation_queue(const std::string& text, std::vector<RotationEntry>& out, std::string& error);
+
+// Apply a progress file to entries (done_s by AppID; unknown AppIDs are
+// ignored). Returns how many entries had saved progress; 0 if there is no file.
+size_t load_rotation_progress(const std::string& path, std::vector<RotationEntry>& entries);
+
+// Write the done_s of every entry to path (write_file_if_changed: atomic,
+// and skipped when nothing changed).
+bool save_rotation_progress(const std::string& path, const std::vector<RotationEntry>& entries);
+
+// Indexes of the entries for the next slice: at most k unfinished, not failed
+// entries by priority (desc), remaining time (desc), then queue order.
+std::vector<size_t> pick_rotation_slice(const std::vector<RotationEntry>& entries, size_t k);
+
+// Credit one poll interval to the entries whose worker in snapshot is idling:
+// the part of real (the time since the last poll) it spent running, times
+// scale. Entries whose worker failed for good are marked failed. Both are
+// announced through say ("dropped from the <mode>"). dirty is set when time
+// was credited. Returns true when the pick has to be redone (a game reached
+// its target or failed).
+bool credit_rotation_progress(std::vector<RotationEntry>& entries, const std::vector<WorkerStatus>& snapshot,
+    std::chrono::steady_clock::duration real, std::chrono::steady_clock::time_point now, double scale,
+    const std::function<void(const std::string&)>& say, const char* mode, bool& dirty);
+
+// Console rotation: run the queue until every game reached its target (or
+// failed) or the user stops it. Returns a process exit code.
+int run_rotation(const RotationOptions& opts, const WorkerOptions& workers);
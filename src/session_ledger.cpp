@@ -0,0 +1,288 @@
+// session_ledger.cpp
+// Session ledger writer and per-AppID totals. See session_ledger.h.
+
+#include "session_ledger.h"
+#include "mapped_file.h"
+#include "text.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+using std::string;
+
+static const uint32_t LEDGER_MAGIC = 0x4c495353u;   // "SSIL" in file order
+static const uint8_t LEDGER_VERSION = 1;
+
+// --------------------------- Records ---------------------------
+
+// FNV-1a over the first seven 32-bit words, then the Murmur3 finalizer so a
+// flipped bit anywhere changes the whole value.
+static uint32_t record_check(const LedgerRecord& r)
+{
+    uint32_t words[7];
+    std::memcpy(words, &r, sizeof(words));
+    uint32_t h = 2166136261u;
+    for (uint32_t w : words) {
+        h ^= w;
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+}
+
+void ledger_seal(LedgerRecord& r)
+{
+    r.magic = LEDGER_MAGIC;
+    r.version = LEDGER_VERSION;
+    r.check = record_check(r);
+}
+
+bool ledger_record_valid(const LedgerRecord& r)
+{
+    return r.magic == LEDGER_MAGIC && r.version == LEDGER_VERSION && r.check == record_check(r);
+}
+
+// --------------------------- Writer ---------------------------
+
+SessionLedger::~SessionLedger()
+{
+    close();
+}
+
+bool SessionLedger::open(const string& path, unsigned heartbeat_s)
+{
+    close();
+    heartbeat_ = std::chrono::seconds(std::max(1u, heartbeat_s));
+    file_ = platform_open_append(path);
+    return is_open();
+}
+
+void SessionLedger::close()
+{
+    end(LEDGER_STOP_REQUESTED);
+    platform_close(file_);
+}
+
+void SessionLedger::begin(uint32_t appid)
+{
+    end(LEDGER_STOP_REQUESTED);
+    if (!is_open() || appid == 0) {
+        return;
+    }
+    appid_ = appid;
+    Clock::time_point now = Clock::now();
+    last_ = now;
+    append(LedgerRecordType::Start, 0, now);
+}
+
+void SessionLedger::end(LedgerStopReason reason)
+{
+    if (appid_ == 0) {
+        return;
+    }
+    append(LedgerRecordType::Stop, reason, Clock::now());
+    appid_ = 0;
+}
+
+void SessionLedger::tick(Clock::time_point now)
+{
+    if (appid_ != 0 && now >= next_heartbeat_) {
+        append(LedgerRecordType::Heartbeat, 0, now);
+    }
+}
+
+void SessionLedger::append(LedgerRecordType type, uint16_t reason, Clock::time_point now)
+{
+    auto idled = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_).count();
+    LedgerRecord r;
+    std::memset(&r, 0, sizeof(r));
+    r.type = static_cast<uint8_t>(type);
+    r.reason = reason;
+    r.appid = appid_;
+    r.pid = static_cast<uint32_t>(platform_current_pid());
+    r.unix_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    r.idled_ms = static_cast<uint32_t>(std::min<long long>(std::max<long long>(idled, 0), UINT32_MAX));
+    ledger_seal(r);
+
+    platform_append_durable(file_, reinterpret_cast<const char*>(&r), sizeof(r));
+    last_ = now;
+    next_heartbeat_ = now + heartbeat_;
+}
+
+// --------------------------- Totals ---------------------------
+
+namespace {
+
+// Open-addressed AppID -> totals table. Only a few hundred distinct AppIDs
+// show up in practice, so it stays in cache while millions of records go by.
+class TotalsTable {
+public:
+    TotalsTable() : slots_(256) {}
+
+    LedgerAppTotals& at(uint32_t appid)
+    {
+        for (;;) {
+            size_t mask = slots_.size() - 1;
+            for (size_t i = hash(appid) & mask;; i = (i + 1) & mask) {
+                LedgerAppTotals& s = slots_[i];
+                if (s.appid == appid) {
+                    return s;
+                }
+                if (s.appid == 0) {
+                    if ((used_ + 1) * 2 > slots_.size()) {
+                        break;   // grow, then look again
+                    }
+                    ++used_;
+                    s.appid = appid;
+                    return s;
+                }
+            }
+            grow();
+        }
+    }
+
+    std::vector<LedgerAppTotals> take()
+    {
+        std::vector<LedgerAppTotals> out;
+        for (const auto& s : slots_) {
+            if (s.appid != 0) out.push_back(s);
+        }
+        return out;
+    }
+
+private:
+    static uint32_t hash(uint32_t x)
+    {
+        // AppIDs are mostly multiples of 10; spread them out.
+        x ^= x >> 16;
+        x *= 0x85ebca6bu;
+        x ^= x >> 13;
+        return x;
+    }
+
+    void grow()
+    {
+        std::vector<LedgerAppTotals> old;
+        old.swap(slots_);
+        slots_.assign(old.size() * 2, LedgerAppTotals());
+        size_t mask = slots_.size() - 1;
+        for (const auto& s : old) {
+            if (s.appid == 0) continue;
+            size_t i = hash(s.appid) & mask;
+            while (slots_[i].appid != 0) i = (i + 1) & mask;
+            slots_[i] = s;
+        }
+    }
+
+    std::vector<LedgerAppTotals> slots_;
+    size_t used_ = 0;
+};
+
+} // namespace
+
+void ledger_summarize(const unsigned char* data, size_t size, LedgerSummary& out)
+{
+    out = LedgerSummary();
+    TotalsTable table;
+    size_t pos = 0;
+    while (pos + sizeof(LedgerRecord) <= size) {
+        LedgerRecord r;
+        std::memcpy(&r, data + pos, sizeof(r));
+        if (!ledger_record_valid(r) || r.appid == 0) {
+            // Torn write or damage: step byte by byte to the next valid record.
+            ++pos;
+            ++out.damaged_bytes;
+            continue;
+        }
+        pos += sizeof(LedgerRecord);
+        ++out.records;
+
+        LedgerAppTotals& t = table.at(r.appid);
+        t.idled_ms += r.idled_ms;
+        t.last_unix_ms = std::max(t.last_unix_ms, r.unix_ms);
+        if (r.type == static_cast<uint8_t>(LedgerRecordType::Start)) {
+            ++t.sessions;
+            ++t.unclosed;
+        }
+        else if (r.type == static_cast<uint8_t>(LedgerRecordType::Stop) && t.unclosed > 0) {
+            --t.unclosed;
+        }
+    }
+    out.damaged_bytes += size - pos;   // a partial record at the end
+
+    out.apps = table.take();
+    std::sort(out.apps.begin(), out.apps.end(), [](const LedgerAppTotals& a, const LedgerAppTotals& b) {
+        return a.idled_ms != b.idled_ms ? a.idled_ms > b.idled_ms : a.appid < b.appid;
+    });
+}
+
+// --------------------------- Report ---------------------------
+
+static string format_duration(uint64_t ms)
+{
+    uint64_t s = ms / 1000;
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%llu:%02u:%02u", static_cast<unsigned long long>(s / 3600),
+        static_cast<unsigned>(s / 60 % 60), static_cast<unsigned>(s % 60));
+    return buf;
+}
+
+static string format_utc(int64_t unix_ms)
+{
+    std::time_t t = static_cast<std::time_t>(unix_ms / 1000);
+    char stamp[32] = "-";
+    if (const std::tm* utc = std::gmtime(&t)) {
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M", utc);
+    }
+    return stamp;
+}
+
+int run_ledger_report(const string& path)
+{
+    typedef std::chrono::steady_clock Clock;
+    Clock::time_point begin = Clock::now();
+
+    MappedFile file;
+    if (!file.open_ro(path)) {
+        print_utf8_line("No sessions recorded yet (" + path + " is missing or empty).");
+        return 0;
+    }
+    LedgerSummary summary;
+    ledger_summarize(file.data(), file.size(), summary);
+    double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+
+    TextBatch out;
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-10s %12s %9s %9s   %s", "AppID", "Idled", "Sessions", "Unclosed",
+        "Last record (UTC)");
+    out.line(line);
+    uint64_t total_ms = 0;
+    uint64_t sessions = 0;
+    for (const auto& a : summary.apps) {
+        std::snprintf(line, sizeof(line), "%-10u %12s %9u %9u   %s", a.appid, format_duration(a.idled_ms).c_str(),
+            a.sessions, a.unclosed, format_utc(a.last_unix_ms).c_str());
+        out.line(line);
+        total_ms += a.idled_ms;
+        sessions += a.sessions;
+    }
+
+    std::snprintf(line, sizeof(line), "%zu game(s), %s idled in %llu session(s).", summary.apps.size(),
+        format_duration(total_ms).c_str(), static_cast<unsigned long long>(sessions));
+    out.line(line);
+    std::snprintf(line, sizeof(line), "Read %llu records (%.1f MiB) in %.1f ms.",
+        static_cast<unsigned long long>(summary.records), file.size() / (1024.0 * 1024.0), ms);
+    string footer = line;
+    if (summary.damaged_bytes > 0) {
+        footer += " Skipped " + std::to_string(summary.damaged_bytes) + " damaged byte(s).";
+    }
+    out.line(footer);
+    return 0;
+}
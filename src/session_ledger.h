@@ -0,0 +1,124 @@
+// session_ledger.h
+// Append-only record of idle sessions (sessions.ledger): when each AppID
+// idled and for how long.
+//
+// The file is a flat sequence of 32-byte LedgerRecords. Every process that
+// idles (the front-ends and each supervisor worker) appends its own records,
+// one durable write each (platform_append_durable), so writers never
+// interleave and a record that reached the file survives a power loss:
+// - start      SteamAPI_Init succeeded (or the watchdog reconnected)
+// - heartbeat  every heartbeat interval while idling
+// - stop       idling ended (stopped, or the Steam connection was lost)
+// Each record carries the idle time since the previous record of the same
+// session, so an AppID's total is the plain sum over its records and needs
+// no start/stop matching. A crash loses at most one heartbeat interval.
+// Records are checksummed; a torn or damaged one is skipped and reading
+// resumes at the next valid record.
+//
+// --ledger-report maps the file read-only and totals it per AppID in a
+// single pass (ledger_summarize).
+
+#pragma once
+
+#include "platform.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class LedgerRecordType : uint8_t {
+    Start = 1,
+    Heartbeat = 2,
+    Stop = 3,
+};
+
+enum LedgerStopReason : uint16_t {
+    LEDGER_STOP_REQUESTED = 0,     // the session was stopped normally
+    LEDGER_STOP_STEAM_LOST = 1,    // the watchdog lost the Steam client
+};
+
+struct LedgerRecord {
+    uint32_t magic;      // "SSIL"
+    uint8_t type;        // LedgerRecordType
+    uint8_t version;
+    uint16_t reason;     // Stop: LedgerStopReason
+    uint32_t appid;
+    uint32_t pid;        // writing process
+    int64_t unix_ms;     // wall clock when written
+    uint32_t idled_ms;   // idle time since the previous record of this session
+    uint32_t check;      // checksum of everything above
+};
+static_assert(sizeof(LedgerRecord) == 32, "ledger record layout");
+
+// Fill in magic, version and check of a record whose other fields are set.
+void ledger_seal(LedgerRecord& r);
+
+// Magic, version and check are right.
+bool ledger_record_valid(const LedgerRecord& r);
+
+// Writes the records of the sessions idled by this process. Not thread-safe:
+// IdleSession calls begin() before its pump starts, tick() and the watchdog's
+// end() / begin() on the pump thread, and the final end() after the pump
+// stopped. Write failures are ignored; the ledger never stops idling.
+class SessionLedger {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    static const unsigned DEFAULT_HEARTBEAT_S = 60;
+
+    SessionLedger() = default;
+    ~SessionLedger();
+
+    SessionLedger(const SessionLedger&) = delete;
+    SessionLedger& operator=(const SessionLedger&) = delete;
+
+    // Open (creating if needed) the ledger for appending.
+    bool open(const std::string& path = "sessions.ledger", unsigned heartbeat_s = DEFAULT_HEARTBEAT_S);
+
+    // Ends an open session first.
+    void close();
+
+    bool is_open() const { return file_ != PLATFORM_NO_HANDLE; }
+
+    // appid starts idling now. Ends a session that is still open first.
+    void begin(uint32_t appid);
+
+    // The open session ends now. Does nothing without one.
+    void end(LedgerStopReason reason);
+
+    // Append a heartbeat when one is due; otherwise just a comparison, so it
+    // can run on every pump tick.
+    void tick(Clock::time_point now);
+
+private:
+    void append(LedgerRecordType type, uint16_t reason, Clock::time_point now);
+
+    platform_handle file_ = PLATFORM_NO_HANDLE;
+    std::chrono::seconds heartbeat_{ DEFAULT_HEARTBEAT_S };
+    uint32_t appid_ = 0;              // 0: no session open
+    Clock::time_point last_;          // when the open session's last record was written
+    Clock::time_point next_heartbeat_;
+};
+
+struct LedgerAppTotals {
+    uint32_t appid = 0;
+    uint64_t idled_ms = 0;
+    uint32_t sessions = 0;    // start records
+    uint32_t unclosed = 0;    // sessions without a stop record (crash, power loss, still running)
+    int64_t last_unix_ms = 0; // newest record
+};
+
+struct LedgerSummary {
+    std::vector<LedgerAppTotals> apps;   // most idled first
+    uint64_t records = 0;                // valid records read
+    uint64_t damaged_bytes = 0;          // skipped while looking for the next valid record
+};
+
+// Total the records in data (a whole ledger file) per AppID.
+void ledger_summarize(const unsigned char* data, size_t size, LedgerSummary& out);
+
+// --ledger-report: summarize the ledger at path and print a per-AppID table.
+// Returns a process exit code.
+int run_ledger_report(const std::string& path);
@@ -0,0 +1,185 @@
+// steam_api.cpp
+// Dynamic loading of steam_api. See steam_api.h.
+
+#include "steam_api.h"
+#include "phase_timings.h"
+#include "platform.h"
+
+#include <mutex>
+
+using std::string;
+
+// Library file names, in order of preference.
+#ifdef _WIN32
+static const char* const STEAM_API_LIBRARIES[] = { "steam_api64.dll", "steam_api.dll" };
+#else
+static const char* const STEAM_API_LIBRARIES[] = { "./libsteam_api.so", "libsteam_api.so" };
+#endif
+
+// ESteamAPIInitResult values returned by SteamAPI_InitFlat.
+enum {
+    STEAM_INIT_OK = 0,
+    STEAM_INIT_FAILED_GENERIC = 1,
+    STEAM_INIT_NO_STEAM_CLIENT = 2,
+    STEAM_INIT_VERSION_MISMATCH = 3,
+};
+
+template <typename T>
+static T find_export(void* library, const char* name)
+{
+    return reinterpret_cast<T>(platform_find_symbol(library, name));
+}
+
+// The process-wide table; loaded is set once the library is in.
+static std::mutex g_api_mutex;
+static SteamApi g_api;
+static bool g_api_loaded = false;
+
+const SteamApi* steam_api_load(PhaseTimings* timings)
+{
+    std::lock_guard<std::mutex> lock(g_api_mutex);
+    if (g_api_loaded) {
+        return &g_api;
+    }
+
+    // Load the steam_api library (prefer the 64-bit name first)
+    void* library = nullptr;
+    const char* library_name = nullptr;
+    {
+        ScopedPhase phase(timings, "steam.load_library");
+        for (const char* name : STEAM_API_LIBRARIES) {
+            library = platform_load_library(name);
+            if (library) {
+                library_name = name;
+                break;
+            }
+        }
+    }
+    if (!library) {
+        return nullptr;
+    }
+
+    ScopedPhase phase(timings, "steam.resolve_exports");
+    SteamApi api;
+    api.module = library;
+    api.library = library_name;
+#define STEAM_API_RESOLVE(member, symbol, ret, params)                  \
+    api.member = find_export<symbol##_t>(library, #symbol);            \
+    if (!api.member) {                                                  \
+        api.missing.push_back(#symbol);                                 \
+    }
+    STEAM_API_EXPORTS(STEAM_API_RESOLVE)
+#undef STEAM_API_RESOLVE
+
+    // Never freed: the next attempt, retry or ownership check reuses it.
+    g_api = api;
+    g_api_loaded = true;
+    return &g_api;
+}
+
+string describe_missing_exports(const SteamApi& api)
+{
+    string out;
+    for (const char* name : api.missing) {
+        if (!out.empty()) out += ", ";
+        out += name;
+    }
+    return out;
+}
+
+void set_steam_env(const std::string& appid)
+{
+    platform_set_env("SteamAppId", appid.c_str());
+    platform_set_env("SteamGameId", appid.c_str());
+}
+
+// Cleans Steam variables
+void clear_steam_env()
+{
+    platform_set_env("SteamAppId", nullptr);
+    platform_set_env("SteamGameId", nullptr);
+}
+
+const char* idle_start_result_name(IdleStartResult result)
+{
+    switch (result) {
+    case IdleStartResult::Idling: return "idling";
+    case IdleStartResult::NoLibrary: return "no_library";
+    case IdleStartResult::BadLibrary: return "bad_library";
+    case IdleStartResult::SteamNotRunning: return "steam_not_running";
+    case IdleStartResult::NotOwned: return "not_owned";
+    }
+    return "?";
+}
+
+IdleStartResult idle_start_result_for(SteamInitResult init)
+{
+    switch (init) {
+    case SteamInitResult::Ok: return IdleStartResult::Idling;
+    case SteamInitResult::NotOwned: return IdleStartResult::NotOwned;
+    case SteamInitResult::VersionMismatch: return IdleStartResult::BadLibrary;
+    case SteamInitResult::SteamNotRunning: return IdleStartResult::SteamNotRunning;
+    }
+    return IdleStartResult::SteamNotRunning;
+}
+
+SteamInitResult steam_api_init(const SteamApi& api, PhaseTimings* timings, string* detail, bool quiet)
+{
+    // Call the init entry point while suppressing any noisy internal output
+    bool init_ok = false;
+    int flat_result = STEAM_INIT_OK;
+    char message[STEAM_ERR_MSG_SIZE] = {};
+    {
+        ScopedPhase phase(timings, "steam.init");
+        auto init = [&]() {
+            if (api.InitFlat) {
+                flat_result = api.InitFlat(message);
+                init_ok = flat_result == STEAM_INIT_OK;
+            }
+            else if (api.Init) {
+                init_ok = api.Init();
+            }
+            else if (api.InitSafe) {
+                init_ok = api.InitSafe();
+            }
+        };
+        if (quiet) {
+            suppress_console_output(init);
+        }
+        else {
+            init();
+        }
+    }
+
+    if (init_ok) {
+        return SteamInitResult::Ok;
+    }
+    if (detail) {
+        message[STEAM_ERR_MSG_SIZE - 1] = '\0';
+        *detail = message;
+    }
+
+    // InitFlat already says why for these two.
+    if (flat_result == STEAM_INIT_NO_STEAM_CLIENT) {
+        return SteamInitResult::SteamNotRunning;
+    }
+    if (flat_result == STEAM_INIT_VERSION_MISMATCH) {
+        return SteamInitResult::VersionMismatch;
+    }
+
+    bool steam_running = false;
+    if (api.IsSteamRunning) {
+        steam_running = api.IsSteamRunning();
+    }
+
+    // A logged-off client reports as running; treat it like "not running" since
+    // the user has to fix the client session either way.
+    if (steam_running && api.SteamUser && api.BLoggedOn) {
+        void* user = api.SteamUser();
+        if (user && !api.BLoggedOn(user)) {
+            steam_running = false;
+        }
+    }
+
+    return steam_running ? SteamInitResult::NotOwned : SteamInitResult::SteamNotRunning;
+}
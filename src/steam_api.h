@@ -0,0 +1,111 @@
+// steam_api.h
+// Dynamic loading of steam_api (steam_api64.dll / steam_api.dll on Windows,
+// libsteam_api.so elsewhere) and the SteamAPI_Init sequence shared by the
+// front-ends and the supervisor's worker processes.
+// We don't link to the Steam SDK; every export is resolved by name at runtime,
+// once per process, and the library then stays loaded until exit.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+class PhaseTimings;
+
+// The SDK exports use the C calling convention; only 32-bit Windows spells it out.
+#ifdef _WIN32
+#define STEAM_CALL __cdecl
+#else
+#define STEAM_CALL
+#endif
+
+// Size of the buffer SteamAPI_InitFlat fills with an error message (SteamErrMsg).
+static const size_t STEAM_ERR_MSG_SIZE = 1024;
+
+// Every export we use: SteamApi member, exported symbol, return type, parameters.
+// Each entry declares <symbol>_t and a SteamApi member of that type.
+// Init entry points, newest first: SteamAPI_InitFlat (SDK 1.58+, returns an
+// ESteamAPIInitResult and a message), SteamAPI_Init, SteamAPI_InitSafe (old SDKs).
+#define STEAM_API_EXPORTS(X)                                                \
+    X(InitFlat,       SteamAPI_InitFlat,             int,   (char*))        \
+    X(Init,           SteamAPI_Init,                 bool,  ())             \
+    X(InitSafe,       SteamAPI_InitSafe,             bool,  ())             \
+    X(Shutdown,       SteamAPI_Shutdown,             void,  ())             \
+    X(RunCallbacks,   SteamAPI_RunCallbacks,         void,  ())             \
+    X(IsSteamRunning, SteamAPI_IsSteamRunning,       bool,  ())             \
+    X(SteamUser,      SteamAPI_SteamUser,            void*, ())             \
+    X(BLoggedOn,      SteamAPI_ISteamUser_BLoggedOn, bool,  (void*))
+
+#define STEAM_API_TYPEDEF(member, symbol, ret, params) typedef ret(STEAM_CALL* symbol##_t) params;
+STEAM_API_EXPORTS(STEAM_API_TYPEDEF)
+#undef STEAM_API_TYPEDEF
+
+// The loaded steam_api module plus its exports. Any pointer may be null on
+// unusual library builds; has_init() says whether Steam can be started at all.
+struct SteamApi {
+    void* module = nullptr;
+    const char* library = nullptr;        // file name that was loaded
+    std::vector<const char*> missing;     // exported symbols that did not resolve
+
+#define STEAM_API_MEMBER(member, symbol, ret, params) symbol##_t member = nullptr;
+    STEAM_API_EXPORTS(STEAM_API_MEMBER)
+#undef STEAM_API_MEMBER
+
+    bool has_init() const { return InitFlat || Init || InitSafe; }
+};
+
+// Outcome of steam_api_init().
+enum class SteamInitResult {
+    Ok,
+    SteamNotRunning,   // Steam client not running or no user session
+    NotOwned,          // Steam is up but refused this AppID
+    VersionMismatch,   // InitFlat: the library is too old for the running client
+};
+
+// Outcome of starting to idle: loading the library, then SteamAPI_Init (used
+// by IdleSession, the watchdog's reconnects and the metrics).
+enum class IdleStartResult {
+    Idling,            // SteamAPI_Init succeeded; the pump is running
+    NoLibrary,         // no steam_api library found
+    BadLibrary,        // no init entry point exported, or too old for the client
+    SteamNotRunning,   // Steam client down or logged off
+    NotOwned,          // Steam is up but refused this AppID
+};
+
+// Short machine-friendly name ("idling", "no_library", ...), e.g. for --timings.
+const char* idle_start_result_name(IdleStartResult result);
+
+// The start result a SteamAPI_Init outcome amounts to.
+IdleStartResult idle_start_result_for(SteamInitResult init);
+
+// Load steam_api64.dll (falling back to steam_api.dll), or libsteam_api.so from
+// the working directory and then the library search path, and resolve the
+// export table. Done once per process: later calls return the same table
+// without touching the library (or timings). Returns null, and retries next
+// time, if no library could be loaded. The result may still lack an init entry
+// point (has_init()); callers must check before calling steam_api_init().
+// timings, when not null, receives the steam.load_library and
+// steam.resolve_exports phases of the first, real load.
+const SteamApi* steam_api_load(PhaseTimings* timings = nullptr);
+
+// "SteamAPI_Init, SteamAPI_InitFlat" style list of api.missing, for messages.
+std::string describe_missing_exports(const SteamApi& api);
+
+// Point Steam at the given AppID for the next SteamAPI_Init call.
+void set_steam_env(const std::string& appid);
+
+// Cleans Steam variables
+void clear_steam_env();
+
+// Call the newest init entry point while suppressing any noisy internal output
+// and, on failure, tell apart "Steam is not running" from "this account cannot
+// run the AppID". detail, when not null, receives InitFlat's error message.
+// timings, when not null, receives the steam.init phase.
+//
+// The suppression redirects stdout and stderr of the whole process while the
+// call runs, so anything other threads print meanwhile is lost. Calls made
+// while other threads may be printing (the watchdog's reconnects, on the pump
+// thread, with the client already up) pass quiet = false and leave the
+// console alone.
+SteamInitResult steam_api_init(const SteamApi& api, PhaseTimings* timings = nullptr, std::string* detail = nullptr,
+    bool quiet = true);
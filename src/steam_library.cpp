@@ -0,0 +1,362 @@
+// steam_library.cpp
+// Offline discovery of installed games. See steam_library.h.
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#pragma comment(lib, "advapi32.lib")
+#endif
+
+#include "steam_library.h"
+#include "mapped_file.h"
+#include "platform.h"
+#include "text.h"
+#include "util.h"
+#include "vdf_reader.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <filesystem>
+
+using std::string;
+
+namespace fs = std::filesystem;
+
+// Leading decimal digits of a VDF value ("440", "4", "12345678901").
+static uint64_t to_u64(std::string_view text)
+{
+    uint64_t v = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') break;
+        v = v * 10 + static_cast<uint64_t>(c - '0');
+    }
+    return v;
+}
+
+static bool is_number(std::string_view text)
+{
+    return !text.empty() && std::all_of(text.begin(), text.end(), [](char c) { return c >= '0' && c <= '9'; });
+}
+
+// Open the top-level block called name. Leaves the reader inside it.
+static bool enter_root(VdfReader& reader, const char* name)
+{
+    for (;;) {
+        VdfToken t = reader.next();
+        if (t == VdfToken::ObjectBegin) {
+            if (vdf_key_is(reader.key(), name)) {
+                return true;
+            }
+            if (!reader.skip_object()) {
+                return false;
+            }
+        }
+        else if (t != VdfToken::Value) {
+            return false;
+        }
+    }
+}
+
+// --------------------------- Parsers ---------------------------
+
+bool parse_app_manifest(std::string_view vdf, InstalledApp& out)
+{
+    out = InstalledApp();
+    VdfReader reader(vdf);
+    if (!enter_root(reader, "AppState")) {
+        return false;
+    }
+
+    // Only the top level of AppState matters; UserConfig, InstalledDepots
+    // and friends are skipped whole. The client writes the fields we want
+    // first, so reading usually stops long before the end of the file.
+    enum { APPID = 1, NAME = 2, INSTALLDIR = 4, STATE = 8, SIZE = 16, ALL = 31 };
+    int seen = 0;
+    while (seen != ALL) {
+        VdfToken t = reader.next();
+        if (t == VdfToken::ObjectBegin) {
+            if (!reader.skip_object()) break;
+        }
+        else if (t == VdfToken::Value) {
+            std::string_view key = reader.key();
+            if (vdf_key_is(key, "appid")) {
+                out.appid = static_cast<uint32_t>(to_u64(reader.value()));
+                seen |= APPID;
+            }
+            else if (vdf_key_is(key, "name")) {
+                vdf_unescape(reader.value(), out.name);
+                seen |= NAME;
+            }
+            else if (vdf_key_is(key, "installdir")) {
+                vdf_unescape(reader.value(), out.install_dir);
+                seen |= INSTALLDIR;
+            }
+            else if (vdf_key_is(key, "StateFlags")) {
+                out.state_flags = static_cast<uint32_t>(to_u64(reader.value()));
+                seen |= STATE;
+            }
+            else if (vdf_key_is(key, "SizeOnDisk")) {
+                out.size_on_disk = to_u64(reader.value());
+                seen |= SIZE;
+            }
+        }
+        else {
+            break;   // end of AppState (or a truncated file: keep what was read)
+        }
+    }
+    return out.appid != 0;
+}
+
+bool parse_library_folders(std::string_view vdf, std::vector<string>& out)
+{
+    VdfReader reader(vdf);
+    if (!enter_root(reader, "libraryfolders")) {
+        return false;
+    }
+
+    string path;
+    for (;;) {
+        VdfToken t = reader.next();
+        if (t == VdfToken::Value) {
+            // Old layout: "1" "D:\\SteamLibrary" (other keys are settings).
+            if (is_number(reader.key())) {
+                vdf_unescape(reader.value(), path);
+                out.push_back(path);
+            }
+        }
+        else if (t == VdfToken::ObjectBegin) {
+            // New layout: "0" { "path" "..." "apps" { ... } ... }
+            size_t level = reader.depth();
+            while (reader.depth() >= level) {
+                VdfToken inner = reader.next();
+                if (inner == VdfToken::Value && reader.depth() == level && vdf_key_is(reader.key(), "path")) {
+                    vdf_unescape(reader.value(), path);
+                    out.push_back(path);
+                }
+                else if (inner == VdfToken::ObjectBegin) {
+                    if (!reader.skip_object()) return !out.empty();
+                }
+                else if (inner == VdfToken::Error || inner == VdfToken::End) {
+                    return !out.empty();
+                }
+            }
+        }
+        else {
+            break;
+        }
+    }
+    return true;
+}
+
+// --------------------------- Install folder ---------------------------
+
+static bool has_steamapps(const string& dir)
+{
+    std::error_code ec;
+    return !dir.empty() && fs::is_directory(fs::u8path(dir) / "steamapps", ec);
+}
+
+#ifdef _WIN32
+
+static string registry_string(HKEY root, const wchar_t* key, const wchar_t* value)
+{
+    wchar_t buf[1024];
+    DWORD size = sizeof(buf);
+    if (RegGetValueW(root, key, value, RRF_RT_REG_SZ, nullptr, buf, &size) != ERROR_SUCCESS) {
+        return string();
+    }
+    return wstring_to_utf8(buf);
+}
+
+string find_steam_install()
+{
+    const string candidates[] = {
+        registry_string(HKEY_CURRENT_USER, L"Software\\Valve\\Steam", L"SteamPath"),
+        registry_string(HKEY_LOCAL_MACHINE, L"SOFTWARE\\WOW6432Node\\Valve\\Steam", L"InstallPath"),
+        registry_string(HKEY_LOCAL_MACHINE, L"SOFTWARE\\Valve\\Steam", L"InstallPath"),
+        "C:\\Program Files (x86)\\Steam",
+    };
+    for (const string& dir : candidates) {
+        if (has_steamapps(dir)) {
+            return dir;
+        }
+    }
+    return string();
+}
+
+#else
+
+string find_steam_install()
+{
+    const char* home = std::getenv("HOME");
+    if (!home) {
+        return string();
+    }
+    // Native package (and its ~/.steam/steam link), Flatpak, Snap.
+    const char* const candidates[] = {
+        "/.steam/steam",
+        "/.local/share/Steam",
+        "/.var/app/com.valvesoftware.Steam/.local/share/Steam",
+        "/snap/steam/common/.local/share/Steam",
+    };
+    for (const char* suffix : candidates) {
+        string dir = string(home) + suffix;
+        if (has_steamapps(dir)) {
+            return dir;
+        }
+    }
+    return string();
+}
+
+#endif
+
+// --------------------------- Index ---------------------------
+
+// Comparable form of a library path, so "C:/Steam" and "c:\steam\" match.
+static string library_key(const string& path)
+{
+    string key = fs::u8path(path).lexically_normal().generic_u8string();
+    while (key.size() > 1 && key.back() == '/') key.pop_back();
+#ifdef _WIN32
+    std::transform(key.begin(), key.end(), key.begin(), [](char c) {
+        return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    });
+#endif
+    return key;
+}
+
+// Manifests are around a kilobyte. For those one read() into a reused buffer
+// is cheaper than mmap + page fault + munmap (about half the per-file cost
+// when scanning thousands); anything bigger is mapped.
+static const size_t SMALL_FILE_MAX = 64 * 1024;
+
+// Point text at the contents of path, held by buffer or file.
+static bool read_vdf_file(const string& path, string& buffer, MappedFile& file, std::string_view& text)
+{
+    if (platform_read_small_file(path, buffer, SMALL_FILE_MAX)) {
+        text = buffer;
+        return true;
+    }
+    if (!file.open_ro(path)) {
+        return false;
+    }
+    text = std::string_view(reinterpret_cast<const char*>(file.data()), file.size());
+    return true;
+}
+
+bool SteamLibraryIndex::load(const string& steam_dir)
+{
+    steam_dir_ = steam_dir.empty() ? find_steam_install() : steam_dir;
+    libraries_.clear();
+    apps_.clear();
+    if (steam_dir_.empty()) {
+        return false;
+    }
+
+    // The install folder is always a library; libraryfolders.vdf adds the rest
+    // (config/ holds it on very old clients).
+    std::vector<string> listed = { steam_dir_ };
+    string buffer;
+    for (const char* vdf : { "/steamapps/libraryfolders.vdf", "/config/libraryfolders.vdf" }) {
+        MappedFile file;
+        std::string_view text;
+        if (read_vdf_file(steam_dir_ + vdf, buffer, file, text) && parse_library_folders(text, listed)) {
+            break;
+        }
+    }
+    std::vector<string> seen;
+    for (const string& lib : listed) {
+        string key = library_key(lib);
+        if (std::find(seen.begin(), seen.end(), key) == seen.end()) {
+            seen.push_back(key);
+            libraries_.push_back(lib);
+        }
+    }
+
+    bool any = false;
+    for (const string& lib : libraries_) {
+        std::error_code ec;
+        fs::directory_iterator it(fs::u8path(lib) / "steamapps", ec), end;
+        if (ec) {
+            continue;
+        }
+        any = true;
+        for (; it != end; it.increment(ec)) {
+            if (ec) break;
+            string name = it->path().filename().u8string();
+            if (name.size() <= 16 || name.compare(0, 12, "appmanifest_") != 0 ||
+                name.compare(name.size() - 4, 4, ".acf") != 0) {
+                continue;
+            }
+            MappedFile file;
+            std::string_view text;
+            InstalledApp app;
+            if (read_vdf_file(it->path().u8string(), buffer, file, text) && parse_app_manifest(text, app)) {
+                app.library = lib;
+                apps_.push_back(std::move(app));
+            }
+        }
+    }
+
+    // The same AppID in two libraries (an interrupted move) keeps the first.
+    std::stable_sort(apps_.begin(), apps_.end(), [](const InstalledApp& a, const InstalledApp& b) {
+        return a.appid < b.appid;
+    });
+    apps_.erase(std::unique(apps_.begin(), apps_.end(), [](const InstalledApp& a, const InstalledApp& b) {
+        return a.appid == b.appid;
+    }), apps_.end());
+    return any;
+}
+
+const InstalledApp* SteamLibraryIndex::find(uint32_t appid) const
+{
+    auto it = std::lower_bound(apps_.begin(), apps_.end(), appid, [](const InstalledApp& a, uint32_t id) {
+        return a.appid < id;
+    });
+    return (it != apps_.end() && it->appid == appid) ? &*it : nullptr;
+}
+
+const InstalledApp* SteamLibraryIndex::find(const string& appid) const
+{
+    if (!is_digits_only(appid) || appid.size() > 10) {
+        return nullptr;
+    }
+    uint64_t id = to_u64(appid);
+    return id <= UINT32_MAX ? find(static_cast<uint32_t>(id)) : nullptr;
+}
+
+// --------------------------- Listing ---------------------------
+
+void print_installed_apps(const SteamLibraryIndex& index)
+{
+    std::vector<const InstalledApp*> sorted;
+    for (const InstalledApp& app : index.apps()) {
+        sorted.push_back(&app);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const InstalledApp* a, const InstalledApp* b) {
+        return std::lexicographical_compare(a->name.begin(), a->name.end(), b->name.begin(), b->name.end(),
+            [](char x, char y) { return std::tolower(static_cast<unsigned char>(x)) < std::tolower(static_cast<unsigned char>(y)); });
+    });
+    TextBatch out;
+    for (const InstalledApp* app : sorted) {
+        string line = "  " + std::to_string(app->appid) + "  " + (app->name.empty() ? "(no name)" : app->name);
+        if (!app->fully_installed()) {
+            line += "  [not fully installed]";
+        }
+        out.line(line);
+    }
+}
+
+int run_list_installed(const string& steam_dir)
+{
+    SteamLibraryIndex index;
+    if (!index.load(steam_dir)) {
+        print_utf8_line("No Steam installation found" + (steam_dir.empty() ? string(".") : " in \"" + steam_dir + "\"."));
+        return 1;
+    }
+    print_utf8_line(std::to_string(index.apps().size()) + " installed app(s) in " +
+        std::to_string(index.libraries().size()) + " Steam library folder(s):");
+    print_installed_apps(index);
+    return 0;
+}
@@ -0,0 +1,71 @@
+// steam_library.h
+// Offline discovery of installed games from the local Steam client's files:
+// the install folder (registry on Windows, the usual ~/.steam locations
+// elsewhere), its steamapps/libraryfolders.vdf and every library's
+// appmanifest_<appid>.acf. Each file is read with a single read call (large
+// ones are memory-mapped) and parsed in place, in one pass, by VdfReader, so
+// thousands of manifests index in milliseconds.
+//
+// An installed game is one the account can run (owned, or lent through
+// Family Sharing), so the index gives names and valid AppID suggestions
+// without the Store or SteamAPI_Init. It knows nothing about owned games that
+// are not installed.
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// One appmanifest_<appid>.acf.
+struct InstalledApp {
+    uint32_t appid = 0;
+    std::string name;
+    std::string install_dir;     // folder name under steamapps/common
+    std::string library;         // library folder the manifest was found in
+    uint32_t state_flags = 0;    // StateFlags; bit 2 (4) = fully installed
+    uint64_t size_on_disk = 0;
+
+    bool fully_installed() const { return (state_flags & 4) != 0; }
+};
+
+// Read an appmanifest. False if it is not one (no AppState block or appid).
+bool parse_app_manifest(std::string_view vdf, InstalledApp& out);
+
+// Library folder paths from libraryfolders.vdf, new ("0" { "path" ... }) and
+// old ("1" "D:\\SteamLibrary") layouts alike.
+bool parse_library_folders(std::string_view vdf, std::vector<std::string>& out);
+
+// The Steam install folder, or empty if none was found.
+std::string find_steam_install();
+
+class SteamLibraryIndex {
+public:
+    // Scan steam_dir (find_steam_install() when empty) and every library it
+    // lists. Returns false if no steamapps folder was found at all.
+    bool load(const std::string& steam_dir = std::string());
+
+    // The app with this AppID, or null.
+    const InstalledApp* find(uint32_t appid) const;
+    const InstalledApp* find(const std::string& appid) const;
+
+    // Every app, ordered by AppID.
+    const std::vector<InstalledApp>& apps() const { return apps_; }
+
+    const std::string& steam_dir() const { return steam_dir_; }
+    const std::vector<std::string>& libraries() const { return libraries_; }
+
+private:
+    std::string steam_dir_;
+    std::vector<std::string> libraries_;
+    std::vector<InstalledApp> apps_;
+};
+
+// Print every app of the index, by name: "  <appid>  <name>" plus a note for
+// partly installed ones.
+void print_installed_apps(const SteamLibraryIndex& index);
+
+// --list-installed: scan steam_dir (or the detected install) and print the
+// index. Returns a process exit code.
+int run_list_installed(const std::string& steam_dir);
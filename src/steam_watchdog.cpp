@@ -0,0 +1,120 @@
+// steam_watchdog.cpp
+// Steam client health checks and reconnects. See steam_watchdog.h.
+
+#include "steam_watchdog.h"
+#include "metrics.h"
+#include "platform.h"
+
+#include <algorithm>
+
+using std::string;
+
+// How often a Lost session looks for the client while it is down.
+static const std::chrono::milliseconds CLIENT_DOWN_POLL(1000);
+
+std::chrono::milliseconds watchdog_retry_delay(unsigned attempt, const WatchdogOptions& opts, std::mt19937& rng)
+{
+    std::uint64_t window = std::max(1u, opts.retry_base_ms);
+    for (unsigned i = 0; i < attempt && window < opts.retry_max_ms; ++i) {
+        window *= 2;
+    }
+    window = std::min<std::uint64_t>(window, std::max(opts.retry_max_ms, opts.retry_base_ms));
+    return std::chrono::milliseconds(std::uniform_int_distribution<std::uint64_t>(0, window)(rng));
+}
+
+// Two instances started in the same tick must not draw the same delays.
+static std::mt19937::result_type random_seed()
+{
+    std::random_device device;
+    return device() ^ static_cast<std::mt19937::result_type>(platform_current_pid()) ^
+        static_cast<std::mt19937::result_type>(SteamWatchdog::Clock::now().time_since_epoch().count());
+}
+
+SteamWatchdog::SteamWatchdog(const SteamApi& api, const WatchdogOptions& opts, Listener listener)
+    : api_(api), opts_(opts), listener_(std::move(listener)), rng_(random_seed())
+{
+    next_check_ = Clock::now() + std::chrono::milliseconds(opts_.check_ms);
+}
+
+static bool client_running(const SteamApi& api)
+{
+    return !api.IsSteamRunning || api.IsSteamRunning();
+}
+
+bool SteamWatchdog::tick(Clock::time_point now)
+{
+    if (opts_.check_ms == 0) {
+        return true;
+    }
+    if (now < next_check_) {
+        return connected_;
+    }
+
+    if (connected_) {
+        if (!client_running(api_)) {
+            lose(now, "Steam client not running");
+        }
+        else if (api_.SteamUser && api_.BLoggedOn) {
+            void* user = api_.SteamUser();
+            if (!user || !api_.BLoggedOn(user)) {
+                lose(now, "logged off");
+            }
+        }
+        if (connected_) {
+            next_check_ = now + std::chrono::milliseconds(opts_.check_ms);
+        }
+        return connected_;
+    }
+
+    reconnect(now);
+    return connected_;
+}
+
+void SteamWatchdog::lose(Clock::time_point now, const string& reason)
+{
+    if (api_.Shutdown) {
+        api_.Shutdown();
+    }
+    connected_ = false;
+    ++losses_;
+    client_down_ = !client_running(api_);
+    attempts_ = 0;
+    next_check_ = now + (client_down_ ? CLIENT_DOWN_POLL : watchdog_retry_delay(0, opts_, rng_));
+    metrics_steam_lost();
+    if (listener_) {
+        listener_(false, reason);
+    }
+}
+
+void SteamWatchdog::reconnect(Clock::time_point now)
+{
+    // Waiting for the client costs one cheap call a second; the jittered
+    // wait starts when it shows up.
+    if (!client_running(api_)) {
+        client_down_ = true;
+        next_check_ = now + CLIENT_DOWN_POLL;
+        return;
+    }
+    if (client_down_) {
+        client_down_ = false;
+        attempts_ = 0;
+        next_check_ = now + watchdog_retry_delay(0, opts_, rng_);
+        return;
+    }
+
+    // The AppID environment is still set from IdleSession::start(). This runs
+    // on the pump thread, so the console is left alone (see steam_api_init).
+    SteamInitResult init = steam_api_init(api_, nullptr, nullptr, false);
+    metrics_init_result(idle_start_result_for(init));
+    if (init != SteamInitResult::Ok) {
+        ++attempts_;
+        next_check_ = Clock::now() + watchdog_retry_delay(attempts_, opts_, rng_);
+        return;
+    }
+    connected_ = true;
+    attempts_ = 0;
+    next_check_ = Clock::now() + std::chrono::milliseconds(opts_.check_ms);
+    if (listener_) {
+        listener_(true, string());
+    }
+}
@@ -0,0 +1,70 @@
+// steam_watchdog.h
+// Keeps an idle session alive across Steam client restarts and log-offs.
+//
+// Without it a session whose client went away keeps calling
+// SteamAPI_RunCallbacks forever and idles nothing. The watchdog runs on the
+// callback pump's own thread (so every steam_api call stays on one thread) and
+// costs nothing between checks:
+// - Connected: every check_ms, SteamAPI_IsSteamRunning and
+//   ISteamUser::BLoggedOn. On failure SteamAPI_Shutdown is called and the
+//   session is Lost.
+// - Lost: while the client is down only SteamAPI_IsSteamRunning is polled,
+//   once a second. Once it is up, SteamAPI_Init is retried after a random
+//   delay in [0, retry_base_ms], then [0, 2 * retry_base_ms], ... up to
+//   retry_max_ms ("full jitter"), so instances that saw the same client
+//   restart spread their reconnects out instead of hitting it together.
+
+#pragma once
+
+#include "steam_api.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string>
+
+struct WatchdogOptions {
+    unsigned check_ms = 5000;        // health check interval while connected; 0 turns the watchdog off
+    unsigned retry_base_ms = 2000;   // first reconnect window once the client is back
+    unsigned retry_max_ms = 60000;   // cap of the doubling window
+};
+
+// Random delay before reconnect attempt number attempt (0-based).
+std::chrono::milliseconds watchdog_retry_delay(unsigned attempt, const WatchdogOptions& opts, std::mt19937& rng);
+
+class SteamWatchdog {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    // Called on the pump thread: connected false with a reason when the
+    // session is lost, true (empty detail) once SteamAPI_Init worked again.
+    typedef std::function<void(bool connected, const std::string& detail)> Listener;
+
+    // api must be initialised (SteamAPI_Init succeeded) when this is created.
+    SteamWatchdog(const SteamApi& api, const WatchdogOptions& opts, Listener listener);
+
+    // Call once per pump tick, before SteamAPI_RunCallbacks. Returns true when
+    // Steam is initialised and callbacks may run.
+    bool tick(Clock::time_point now);
+
+    // Whether Steam is initialised right now (SteamAPI_Shutdown still due).
+    bool connected() const { return connected_; }
+
+    // Sessions lost so far.
+    unsigned losses() const { return losses_; }
+
+private:
+    void lose(Clock::time_point now, const std::string& reason);
+    void reconnect(Clock::time_point now);
+
+    const SteamApi& api_;
+    WatchdogOptions opts_;
+    Listener listener_;
+    std::mt19937 rng_;
+    std::atomic<bool> connected_{ true };
+    std::atomic<unsigned> losses_{ 0 };
+    Clock::time_point next_check_;
+    bool client_down_ = false;   // Lost, and the last poll found no client
+    unsigned attempts_ = 0;      // failed SteamAPI_Init calls since the client came back
+};
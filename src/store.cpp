@@ -0,0 +1,130 @@
+// store.cpp
+// Steam Store appdetails lookups. See store.h.
+
+#include "store.h"
+#include "appdetails_cache.h"
+#include "json_reader.h"
+#include "metrics.h"
+#include "phase_timings.h"
+#include "util.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+
+using std::string;
+
+bool parse_store_url(const string& url, HttpEndpoint& out)
+{
+    HttpEndpoint e;
+    size_t host_start;
+    if (url.compare(0, 8, "https://") == 0) {
+        e.secure = true;
+        e.port = 443;
+        host_start = 8;
+    }
+    else if (url.compare(0, 7, "http://") == 0) {
+        e.secure = false;
+        e.port = 80;
+        host_start = 7;
+    }
+    else {
+        return false;
+    }
+
+    size_t slash = url.find('/', host_start);
+    string authority = url.substr(host_start, slash == string::npos ? string::npos : slash - host_start);
+    size_t colon = authority.find(':');
+    e.host = authority.substr(0, colon);
+    if (colon != string::npos) {
+        string port = authority.substr(colon + 1);
+        unsigned long value = is_digits_only(port) ? std::strtoul(port.c_str(), nullptr, 10) : 0;
+        if (value == 0 || value > 65535) {
+            return false;
+        }
+        e.port = static_cast<uint16_t>(value);
+    }
+    if (e.host.empty()) {
+        return false;
+    }
+    e.base_path = slash == string::npos ? string() : url.substr(slash);
+    while (!e.base_path.empty() && e.base_path.back() == '/') {
+        e.base_path.pop_back();
+    }
+    out = e;
+    return true;
+}
+
+std::unique_ptr<HttpClient> make_store_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts)
+{
+    return make_http_client(endpoint, timeouts);
+}
+
+// Perform a GET request to <endpoint>/api/appdetails?appids=<appid>
+// Returns true if fetch succeeded and leaves the response bytes (UTF-8) in response.
+bool http_get_appdetails(HttpClient& http, const string& appid, HttpResponse& response)
+{
+    bool got = http.get("/api/appdetails?appids=" + appid, response);
+    // Rate-limit pages (429) and server errors are not answers about the AppID.
+    return got && response.status == 200 && !response.body.empty();
+}
+
+StoreLookup store_lookup(HttpClient& http, const string& appid, AppDetailsCache* cache, bool refresh,
+    PhaseTimings* timings)
+{
+    StoreLookup result;
+    uint32_t id = static_cast<uint32_t>(std::strtoul(appid.c_str(), nullptr, 10));
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+
+    if (cache && !refresh) {
+        ScopedPhase phase(timings, "store.cache");
+        CachedAppDetails cached;
+        if (cache->lookup(id, now, cached)) {
+            result.fetched = true;
+            result.success = cached.success;
+            result.from_cache = true;
+            result.name = cached.name;
+            metrics_store_cache(true);
+            return result;
+        }
+        metrics_store_cache(false);
+    }
+
+    HttpResponse response;
+    std::chrono::steady_clock::time_point sent = std::chrono::steady_clock::now();
+    bool got = http_get_appdetails(http, appid, response);
+    metrics_store_lookup(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - sent).count()), got);
+    if (timings) {
+        PhaseTimings::Clock::time_point end = PhaseTimings::Clock::now();
+        PhaseTimings::Clock::time_point read_start = end - std::chrono::microseconds(response.read_us);
+        PhaseTimings::Clock::time_point wait_start = read_start - std::chrono::microseconds(response.wait_us);
+        PhaseTimings::Clock::time_point send_start = wait_start - std::chrono::microseconds(response.send_us);
+        timings->add("store.send", send_start, wait_start);
+        timings->add("store.wait", wait_start, read_start);
+        timings->add("store.read", read_start, end);
+    }
+    if (!got) {
+        return result;
+    }
+
+    {
+        ScopedPhase phase(timings, "store.parse");
+        AppDetailsEntry entry;
+        if (!find_appdetails(response.body, id, entry)) {
+            // Not an answer about this AppID (truncated body, error page).
+            return result;
+        }
+        result.fetched = true;
+        result.success = entry.success;
+        if (result.success) {
+            result.name = entry.name;
+        }
+    }
+
+    if (cache) {
+        ScopedPhase phase(timings, "store.cache_write");
+        cache->store(id, result.success, result.name, now);
+    }
+    return result;
+}
@@ -0,0 +1,45 @@
+// store.h
+// Steam Store appdetails lookups (store.steampowered.com/api/appdetails, or
+// the same path under another base URL given with --store-url: a mirror, or
+// tools/store_stub for offline latency and failure tests).
+
+#pragma once
+
+#include "http_client.h"
+
+#include <memory>
+#include <string>
+
+class AppDetailsCache;
+class PhaseTimings;
+
+// Parse a Store base URL, "http[s]://host[:port][/base-path]", into out.
+// False (out untouched) if it is not one.
+bool parse_store_url(const std::string& url, HttpEndpoint& out);
+
+// Long-lived client for the Store endpoint (by default store.steampowered.com
+// over HTTPS). Create it once and pass it to every lookup so the connection
+// is reused.
+std::unique_ptr<HttpClient> make_store_client(const HttpEndpoint& endpoint, const HttpTimeouts& timeouts);
+
+// Perform a GET request to <endpoint>/api/appdetails?appids=<appid>
+// Returns true if fetch succeeded (HTTP 200); the body (UTF-8) and the
+// transport timings are left in response.
+bool http_get_appdetails(HttpClient& http, const std::string& appid, HttpResponse& response);
+
+// Result of store_lookup().
+struct StoreLookup {
+    bool fetched = false;     // we have an answer (from the network or the cache)
+    bool success = false;     // the Store knows this AppID
+    bool from_cache = false;  // answer came from the on-disk cache
+    std::string name;         // game name, empty if unknown
+};
+
+// Look an AppID up, consulting the cache first unless refresh is set.
+// Fresh network answers (found or not found) are written back to the cache;
+// a 200 whose body has no entry for the AppID (e.g. cut short) is treated
+// like a network failure and not cached.
+// cache may be null to always go to the network. timings, when not null,
+// receives the store.* phases (cache, send, wait, read, parse).
+StoreLookup store_lookup(HttpClient& http, const std::string& appid, AppDetailsCache* cache, bool refresh,
+    PhaseTimings* timings = nullptr);
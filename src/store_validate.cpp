@@ -0,0 +1,332 @@
+// store_validate.cpp
+// Bulk AppID validation. See store_validate.h.
+
+#include "store_validate.h"
+#include "appdetails_cache.h"
+#include "http_client.h"
+#include "json_reader.h"
+#include "store.h"
+#include "text.h"
+#include "token_bucket.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+using std::string;
+
+// Transport errors / 5xx are retried this many times per batch.
+static const int MAX_ATTEMPTS = 3;
+// 429 answers are retried this many times per batch before giving up.
+static const int MAX_THROTTLES = 6;
+
+namespace {
+
+struct Batch {
+    std::vector<string> appids;
+    int attempts = 0;
+    int throttles = 0;
+};
+
+struct ValidateState {
+    explicit ValidateState(const ValidateOptions& o)
+        : opts(o), bucket(o.rate, o.burst)
+    {
+    }
+
+    const ValidateOptions& opts;
+    TokenBucket bucket;
+    HttpClient* http = nullptr;
+    AppDetailsCache* cache = nullptr;
+    std::map<string, StoreCheck>* results = nullptr;   // check_store(): answers instead of lines
+
+    std::mutex mutex;             // guards everything below, the cache and console output
+    std::condition_variable cv;
+    TextBatch out;                // result lines, written once per response
+    std::deque<Batch> queue;
+    unsigned active = 0;          // batches being processed
+
+    size_t found = 0;
+    size_t not_found = 0;
+    size_t failed = 0;
+    size_t requests = 0;
+    size_t throttled = 0;
+    size_t splits = 0;
+    int throttle_streak = 0;
+};
+
+} // namespace
+
+static string join_appids(const std::vector<string>& ids)
+{
+    string out;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        if (i) out += ',';
+        out += ids[i];
+    }
+    return out;
+}
+
+// Queue one result line (see st.out) and count it. Caller holds st.mutex.
+static void report_locked(ValidateState& st, const string& appid, bool success, const string& name, bool cached)
+{
+    if (st.results) {
+        (*st.results)[appid] = success ? StoreCheck::Found : StoreCheck::NotFound;
+        ++(success ? st.found : st.not_found);
+        return;
+    }
+    if (success) {
+        ++st.found;
+        string line = "AppID " + appid + ": found";
+        if (!name.empty()) line += " - " + name;
+        if (cached) line += " (cached)";
+        st.out.line(line);
+    }
+    else {
+        ++st.not_found;
+        st.out.line("AppID " + appid + ": not found" + (cached ? " (cached)" : ""));
+    }
+}
+
+static void report_failed_locked(ValidateState& st, const std::vector<string>& ids, const string& why)
+{
+    for (const auto& id : ids) {
+        ++st.failed;
+        if (st.results) {
+            (*st.results)[id] = StoreCheck::Failed;
+            continue;
+        }
+        st.out.line("AppID " + id + ": lookup failed (" + why + ")");
+    }
+}
+
+// Queue the two halves of a batch the Store refused as a whole. Caller holds st.mutex.
+static void split_locked(ValidateState& st, const Batch& b)
+{
+    size_t half = b.appids.size() / 2;
+    Batch left, right;
+    left.appids.assign(b.appids.begin(), b.appids.begin() + half);
+    right.appids.assign(b.appids.begin() + half, b.appids.end());
+    st.queue.push_front(right);
+    st.queue.push_front(left);
+    ++st.splits;
+}
+
+static uint32_t appid_number(const string& id)
+{
+    return static_cast<uint32_t>(std::strtoul(id.c_str(), nullptr, 10));
+}
+
+static const AppDetailsEntry* find_entry(const std::vector<AppDetailsEntry>& entries, uint32_t appid)
+{
+    for (const auto& e : entries) {
+        if (e.appid == appid) {
+            return &e;
+        }
+    }
+    return nullptr;
+}
+
+// True if the response has an entry for every AppID of the batch.
+static bool response_covers(const std::vector<AppDetailsEntry>& entries, const std::vector<string>& ids)
+{
+    for (const auto& id : ids) {
+        if (!find_entry(entries, appid_number(id))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void process_batch(ValidateState& st, Batch b)
+{
+    st.bucket.acquire();
+
+    // Multi-AppID requests are only answered for price_overview (see store_validate.h).
+    string path = "/api/appdetails?appids=" + join_appids(b.appids) +
+        (b.appids.size() > 1 ? "&filters=price_overview" : "&filters=basic");
+    HttpResponse response;
+    bool got = st.http->get(path, response);
+    unsigned long status = response.status;
+    const string& body = response.body;
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+
+    std::lock_guard<std::mutex> lock(st.mutex);
+    ++st.requests;
+
+    if (got && status == 429) {
+        ++st.throttled;
+        ++b.throttles;
+        // Back off harder while the Store keeps throttling; every in-flight
+        // request shares the pause.
+        int shift = std::min(st.throttle_streak++, 4);
+        st.bucket.pause_for(std::chrono::milliseconds(5000LL << shift));
+        if (b.throttles > MAX_THROTTLES) {
+            report_failed_locked(st, b.appids, "throttled");
+        }
+        else {
+            st.queue.push_back(b);
+        }
+        return;
+    }
+    st.throttle_streak = 0;
+
+    // One pass over the whole response, however many apps it holds.
+    std::vector<AppDetailsEntry> entries;
+    bool parsed = (got && status == 200) && parse_appdetails(body, entries);
+
+    bool batch_rejected = got && (status == 400 || (status == 200 &&
+        (!parsed || !response_covers(entries, b.appids))));
+    if (batch_rejected && b.appids.size() > 1) {
+        split_locked(st, b);
+        return;
+    }
+
+    // A lone AppID without an entry in a 200 (body cut short, error page) is
+    // retried like a failed request rather than recorded as not found.
+    if (!got || status != 200 || batch_rejected) {
+        if (++b.attempts < MAX_ATTEMPTS) {
+            st.queue.push_back(b);
+        }
+        else {
+            report_failed_locked(st, b.appids, !got ? "network error" :
+                status != 200 ? "HTTP " + std::to_string(status) : "unusable response");
+        }
+        return;
+    }
+
+    for (const auto& id : b.appids) {
+        const AppDetailsEntry* e = find_entry(entries, appid_number(id));
+        bool success = e && e->success;
+        string name = success ? e->name : string();
+        report_locked(st, id, success, name, false);
+        // A batch answer names nobody; caching it would leave the app nameless.
+        if (st.cache && (!success || !name.empty())) {
+            st.cache->store(appid_number(id), success, name, now);
+        }
+    }
+}
+
+static void validate_worker(ValidateState& st)
+{
+    std::unique_lock<std::mutex> lock(st.mutex);
+    for (;;) {
+        // Wait while the queue is empty but a running batch might still split
+        // or requeue itself.
+        st.cv.wait(lock, [&]() { return !st.queue.empty() || st.active == 0; });
+        if (st.queue.empty()) {
+            return;
+        }
+
+        Batch b = st.queue.front();
+        st.queue.pop_front();
+        ++st.active;
+        lock.unlock();
+
+        process_batch(st, b);
+
+        lock.lock();
+        st.out.flush();
+        --st.active;
+        st.cv.notify_all();
+    }
+}
+
+// Everything but the summary: answer from the cache, batch the rest and run
+// the requests. Returns the number of AppIDs with an invalid format.
+static size_t validate_all(ValidateState& st, const std::vector<string>& appids)
+{
+    const ValidateOptions& opts = st.opts;
+    AppDetailsCache* cache = st.cache;
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    size_t invalid = 0;
+
+    // Filter, de-duplicate and answer from the cache first; batch the rest.
+    std::vector<string> pending;
+    std::unordered_set<string> seen;
+    for (const auto& id : appids) {
+        if (!is_digits_only(id)) {
+            ++invalid;
+            if (!st.results) st.out.line("AppID " + id + ": invalid format");
+            continue;
+        }
+        if (!seen.insert(id).second) {
+            continue;
+        }
+
+        CachedAppDetails cached;
+        if (cache && !opts.refresh &&
+            cache->lookup(appid_number(id), now, cached)) {
+            report_locked(st, id, cached.success, cached.name, true);
+            continue;
+        }
+        pending.push_back(id);
+    }
+    st.out.flush();
+
+    size_t batch_size = std::max<size_t>(1, opts.batch_size);
+    for (size_t i = 0; i < pending.size(); i += batch_size) {
+        Batch b;
+        b.appids.assign(pending.begin() + i, pending.begin() + std::min(pending.size(), i + batch_size));
+        st.queue.push_back(b);
+    }
+
+    unsigned parallel = std::max(1u, opts.parallel);
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < parallel; ++i) {
+        threads.emplace_back(validate_worker, std::ref(st));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return invalid;
+}
+
+void check_store(const std::vector<string>& appids, const ValidateOptions& opts, HttpClient& http,
+    AppDetailsCache* cache, std::map<string, StoreCheck>& out)
+{
+    ValidateState st(opts);
+    st.http = &http;
+    st.cache = cache;
+    st.results = &out;
+    validate_all(st, appids);
+}
+
+int run_validate(const std::vector<string>& appids, const ValidateOptions& opts,
+    HttpClient& http, AppDetailsCache* cache)
+{
+    ValidateState st(opts);
+    st.http = &http;
+    st.cache = cache;
+
+    auto t0 = std::chrono::steady_clock::now();
+    size_t invalid = validate_all(st, appids);
+
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    size_t answered = st.found + st.not_found;
+    double rate = elapsed > 0.0 ? answered / elapsed : 0.0;
+
+    char rate_buf[32];
+    char time_buf[32];
+    std::snprintf(rate_buf, sizeof(rate_buf), "%.1f", rate);
+    std::snprintf(time_buf, sizeof(time_buf), "%.2f", elapsed);
+
+    print_utf8_line("");
+    print_utf8_line("Validated " + std::to_string(answered) + " AppID(s) in " + time_buf + "s (" +
+        rate_buf + " apps/sec): " + std::to_string(st.found) + " found, " +
+        std::to_string(st.not_found) + " not found, " + std::to_string(invalid) + " invalid, " +
+        std::to_string(st.failed) + " failed.");
+    print_utf8_line(std::to_string(st.requests) + " request(s), " + std::to_string(st.throttled) +
+        " throttled (HTTP 429), " + std::to_string(st.splits) + " batch split(s).");
+
+    return st.failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+// store_validate.h
+// Bulk AppID validation against the Store (--validate).
+//
+// AppIDs are packed several per appdetails request, a bounded number of
+// requests run in parallel, and every request first takes a token from a
+// TokenBucket. Results are printed as soon as each response arrives, followed
+// by a throughput summary.
+//
+// The Store only answers a multi-AppID request when its filter is
+// price_overview; any other filter gets a bare "null" body. Batches therefore
+// ask for price_overview, which says whether each app exists but not its name,
+// and a lone AppID asks for filters=basic, which names it. Found apps without
+// a name are not written to the cache, so a later lookup still names them.
+//
+// A batch that still comes back without an answer for every AppID (HTTP 400,
+// "null", a truncated body) is split in half and retried, down to
+// single-AppID requests, so a bad batch never loses results.
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+class AppDetailsCache;
+class HttpClient;
+
+struct ValidateOptions {
+    size_t batch_size = 20;   // AppIDs per request
+    unsigned parallel = 4;    // requests in flight
+    double rate = 2.0;        // requests per second (token refill rate; <= 0 = unlimited)
+    double burst = 4.0;       // token bucket capacity
+    bool refresh = false;     // ignore cached answers
+};
+
+// Validate appids through http, print one line per AppID plus a summary.
+// Answers are written to cache when it is not null. Returns 0 if every AppID
+// got an answer (found or not), 1 otherwise.
+int run_validate(const std::vector<std::string>& appids, const ValidateOptions& opts,
+    HttpClient& http, AppDetailsCache* cache);
+
+enum class StoreCheck { Found, NotFound, Failed };
+
+// The lookups of run_validate (cache first, then batched, parallel and rate
+// limited requests) without any output: out[appid] for every AppID with a
+// valid format. Used by the ownership probe (ownership_probe.h).
+void check_store(const std::vector<std::string>& appids, const ValidateOptions& opts, HttpClient& http,
+    AppDetailsCache* cache, std::map<std::string, StoreCheck>& out);
@@ -0,0 +1,858 @@
+// supervisor.cpp
+// Multi-app supervisor and worker entry point. See supervisor.h.
+
+#include "supervisor.h"
+#include "dashboard.h"
+#include "idle_session.h"
+#include "lean_idle.h"
+#include "metrics.h"
+#include "session_ledger.h"
+#include "steam_api.h"
+#include "platform.h"
+#include "util.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <thread>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+// A worker that stayed up this long is considered healthy again: its next
+// failure restarts the backoff sequence from the beginning.
+static const std::chrono::seconds HEALTHY_UPTIME(60);
+static const std::chrono::seconds MAX_BACKOFF(60);
+
+// How long stop requests wait for workers to call SteamAPI_Shutdown and exit
+// before they are terminated.
+static const unsigned STOP_GRACE_MS = 5000;
+
+// Wait before replacing a standby worker that died on its own.
+static const std::chrono::seconds STANDBY_RETRY(1);
+
+const char* const WORKER_STANDBY = "standby";
+
+static bool is_permanent_failure(int exit_code)
+{
+    return exit_code == WORKER_EXIT_BAD_ARGS ||
+        exit_code == WORKER_EXIT_NO_DLL ||
+        exit_code == WORKER_EXIT_BAD_DLL ||
+        exit_code == WORKER_EXIT_NOT_OWNED;
+}
+
+const char* worker_exit_reason(int code)
+{
+    switch (code) {
+    case WORKER_EXIT_STOPPED: return "stopped";
+    case WORKER_EXIT_BAD_ARGS: return "invalid arguments";
+    case WORKER_EXIT_NO_DLL: return "steam_api library not found";
+    case WORKER_EXIT_BAD_DLL: return "incompatible steam_api library";
+    case WORKER_EXIT_STEAM_NOT_RUNNING: return "Steam not running";
+    case WORKER_EXIT_NOT_OWNED: return "not owned by this account";
+    default: return "crashed";
+    }
+}
+
+const char* worker_state_name(WorkerState state)
+{
+    switch (state) {
+    case WorkerState::Starting: return "starting";
+    case WorkerState::Running: return "running";
+    case WorkerState::BackingOff: return "backing off";
+    case WorkerState::Failed: return "failed";
+    }
+    return "?";
+}
+
+// --------------------------- Supervisor ---------------------------
+
+struct Supervisor::Worker {
+    WorkerStatus status;
+    std::vector<string> extra_args;   // after worker_args_ on its command line
+    ChildProcess child;          // process and our ends of its pipes
+    string pending;              // partial status line
+    bool warm = false;           // standby only: steam_api is loaded
+    bool reconnecting = false;   // reported "lost"; the next "ready" is not a start
+    int consecutive_failures = 0;
+    Clock::time_point started_at;
+    Clock::time_point restart_at;
+    Clock::time_point stop_deadline;   // stopping only: killed when it passes
+    bool killed = false;               // stopping only: grace period over
+};
+
+Supervisor::Supervisor(const string& exe_path, std::function<void(const string&)> on_event,
+    const std::vector<string>& worker_args)
+    : exe_path_(exe_path), on_event_(std::move(on_event)), worker_args_(worker_args)
+{
+    metrics_set_provider([this](string& out) { append_metrics(out); });
+}
+
+Supervisor::~Supervisor()
+{
+    metrics_set_provider(nullptr);
+    stop_all();
+}
+
+void Supervisor::append_metrics(string& out) const
+{
+    std::vector<WorkerStatus> workers = snapshot();
+    if (workers.empty()) {
+        return;
+    }
+    Clock::time_point now = Clock::now();
+    append_metric_header(out, "ssi_worker_running", "gauge", "1 while the worker for the AppID is idling.");
+    for (const auto& w : workers) {
+        append_metric_sample(out, "ssi_worker_running", "appid", w.appid, w.state == WorkerState::Running ? 1 : 0);
+    }
+    append_metric_header(out, "ssi_worker_uptime_seconds", "gauge",
+        "Seconds the current worker process has been idling (0 when not running).");
+    for (const auto& w : workers) {
+        double up = w.state == WorkerState::Running ?
+            std::chrono::duration<double>(now - w.since).count() : 0.0;
+        append_metric_sample(out, "ssi_worker_uptime_seconds", "appid", w.appid, up);
+    }
+    append_metric_header(out, "ssi_worker_restarts_total", "counter", "Worker restarts for the AppID.");
+    for (const auto& w : workers) {
+        append_metric_sample(out, "ssi_worker_restarts_total", "appid", w.appid, w.restarts);
+    }
+    append_metric_header(out, "ssi_worker_pump_ticks_total", "counter",
+        "Callback pump ticks of the current worker process, as last reported.");
+    for (const auto& w : workers) {
+        append_metric_sample(out, "ssi_worker_pump_ticks_total", "appid", w.appid,
+            static_cast<double>(w.pump.ticks));
+    }
+}
+
+void Supervisor::emit(const string& line)
+{
+    if (on_event_) {
+        on_event_(line);
+    }
+}
+
+Supervisor::AddResult Supervisor::add(const string& appid, const std::vector<string>& extra_args)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& w : workers_) {
+        if (w->status.appid == appid) {
+            return AddResult::AlreadyAdded;
+        }
+    }
+    if (workers_.size() >= MAX_WORKERS) {
+        return AddResult::Full;
+    }
+
+    std::unique_ptr<Worker> w(new Worker());
+    w->status.appid = appid;
+    w->status.since = Clock::now();
+    w->extra_args = extra_args;
+    if (!adopt_standby(*w) && !spawn(*w)) {
+        // Could not even create the process; retry later like any other failure.
+        handle_exit(*w, -1);
+    }
+    workers_.push_back(std::move(w));
+    return AddResult::Added;
+}
+
+bool Supervisor::remove(const string& appid)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = workers_.begin(); it != workers_.end(); ++it) {
+        if ((*it)->status.appid == appid) {
+            stop_worker(std::move(*it));
+            workers_.erase(it);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Supervisor::spawn(Worker& w)
+{
+    std::vector<string> args;
+    args.push_back("--worker");
+    args.push_back(w.status.appid);
+    args.insert(args.end(), worker_args_.begin(), worker_args_.end());
+    args.insert(args.end(), w.extra_args.begin(), w.extra_args.end());
+    if (!platform_spawn_worker(exe_path_, args, w.child)) {
+        return false;
+    }
+
+    w.pending.clear();
+    w.reconnecting = false;
+    w.started_at = Clock::now();
+    w.status.pid = w.child.pid;
+    w.status.state = WorkerState::Starting;
+    w.status.since = w.started_at;
+    w.status.warm_start = false;
+    return true;
+}
+
+// Close our ends of a worker's pipes (the process handle is released by
+// platform_wait_child once it has exited).
+static void close_pipes(ChildProcess& child)
+{
+    platform_close(child.control_write);
+    platform_close(child.status_read);
+}
+
+void Supervisor::read_status_lines(Worker& w)
+{
+    if (!w.child.status_read) {
+        return;
+    }
+
+    char buf[256];
+    long got;
+    while ((got = platform_read_nonblocking(w.child.status_read, buf, sizeof(buf))) > 0) {
+        w.pending.append(buf, static_cast<size_t>(got));
+    }
+
+    size_t nl;
+    while ((nl = w.pending.find('\n')) != string::npos) {
+        string line = trim(w.pending.substr(0, nl));
+        w.pending.erase(0, nl + 1);
+
+        if (line.compare(0, 5, "lost ") == 0 && w.status.state == WorkerState::Running) {
+            // The worker's watchdog is reconnecting; "ready" follows when it has.
+            w.reconnecting = true;
+            w.status.state = WorkerState::Starting;
+            w.status.since = Clock::now();
+            w.status.error = line.substr(5);
+            emit("AppID " + w.status.appid + ": " + line.substr(5) + ", reconnecting.");
+        }
+        else if (line == "ready" && w.status.state == WorkerState::Starting) {
+            w.status.state = WorkerState::Running;
+            w.status.since = Clock::now();
+            w.status.last_tick = w.status.since;
+            w.status.error.clear();
+            metrics_init_result(IdleStartResult::Idling);
+            if (w.reconnecting) {
+                w.reconnecting = false;
+                emit("AppID " + w.status.appid + ": idling again (pid " + std::to_string(w.status.pid) + ").");
+            }
+            else {
+                w.status.start_ms = std::chrono::duration<double, std::milli>(w.status.since - w.started_at).count();
+                char took[32];
+                std::snprintf(took, sizeof(took), "%.0f ms", w.status.start_ms);
+                emit("AppID " + w.status.appid + ": idling (pid " + std::to_string(w.status.pid) + ", started in " +
+                    took + (w.status.warm_start ? " from standby" : "") + ").");
+            }
+        }
+        else if (line == "warm") {
+            w.warm = true;
+        }
+        else if (line.compare(0, 5, "pump ") == 0) {
+            // Cumulative counters of this process; the latest report wins.
+            unsigned long long v[5] = {};
+            if (std::sscanf(line.c_str() + 5, "%llu %llu %llu %llu %llu",
+                    &v[0], &v[1], &v[2], &v[3], &v[4]) == 5) {
+                if (v[0] > w.status.pump.ticks) {
+                    w.status.last_tick = Clock::now();
+                }
+                w.status.pump.ticks = v[0];
+                w.status.pump.callback_total_us = v[1];
+                w.status.pump.callback_max_us = v[2];
+                w.status.pump.drift_total_us = v[3];
+                w.status.pump.drift_max_us = v[4];
+            }
+        }
+        else if (line.compare(0, 7, "memory ") == 0) {
+            unsigned long long v[4] = {};
+            if (std::sscanf(line.c_str() + 7, "%llu %llu %llu %llu", &v[0], &v[1], &v[2], &v[3]) == 4) {
+                LeanReport lean;
+                lean.before.private_bytes = v[0];
+                lean.after.private_bytes = v[1];
+                lean.before.working_set = v[2];
+                lean.after.working_set = v[3];
+                emit("AppID " + w.status.appid + ": lean, " + describe_lean_report(lean) + ".");
+            }
+        }
+        else if (line.compare(0, 7, "failed ") == 0) {
+            // Informational; the exit code that follows is what drives the
+            // restart decision.
+            w.status.error = line.substr(7);
+        }
+    }
+}
+
+// Move a finished process's pump counters into the supervisor-wide totals.
+void Supervisor::retire_pump_stats(Worker& w)
+{
+    merge_pump_stats(retired_pump_, w.status.pump);
+    w.status.pump = PumpStats();
+}
+
+PumpStats Supervisor::pump_totals() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    PumpStats totals = retired_pump_;
+    for (const auto& w : workers_) {
+        merge_pump_stats(totals, w->status.pump);
+    }
+    for (const auto& w : stopping_) {
+        merge_pump_stats(totals, w->status.pump);
+    }
+    return totals;
+}
+
+// SteamAPI_Init runs in the worker; its exit code says how init failed.
+static void record_init_failure(int exit_code)
+{
+    switch (exit_code) {
+    case WORKER_EXIT_NO_DLL: metrics_init_result(IdleStartResult::NoLibrary); break;
+    case WORKER_EXIT_BAD_DLL: metrics_init_result(IdleStartResult::BadLibrary); break;
+    case WORKER_EXIT_STEAM_NOT_RUNNING: metrics_init_result(IdleStartResult::SteamNotRunning); break;
+    case WORKER_EXIT_NOT_OWNED: metrics_init_result(IdleStartResult::NotOwned); break;
+    default: break;
+    }
+}
+
+void Supervisor::handle_exit(Worker& w, int exit_code)
+{
+    if (w.status.state == WorkerState::Starting) {
+        record_init_failure(exit_code);
+    }
+    retire_pump_stats(w);
+    close_pipes(w.child);
+    w.status.pid = 0;
+    w.status.last_exit_code = exit_code;
+    w.status.error = string(worker_exit_reason(exit_code)) + " (code " + std::to_string(exit_code) + ")";
+
+    Clock::time_point now = Clock::now();
+    w.status.since = now;
+
+    if (is_permanent_failure(exit_code)) {
+        w.status.state = WorkerState::Failed;
+        emit("AppID " + w.status.appid + ": " + worker_exit_reason(exit_code) + " - giving up.");
+        return;
+    }
+
+    if (now - w.started_at >= HEALTHY_UPTIME) {
+        w.consecutive_failures = 0;
+    }
+    ++w.consecutive_failures;
+
+    // 1s, 2s, 4s, ... capped at MAX_BACKOFF.
+    int shift = std::min(w.consecutive_failures - 1, 6);
+    std::chrono::seconds delay = std::min(std::chrono::seconds(1LL << shift), MAX_BACKOFF);
+    w.restart_at = now + delay;
+    w.status.state = WorkerState::BackingOff;
+
+    emit("AppID " + w.status.appid + ": worker exited (" + worker_exit_reason(exit_code) +
+        ", code " + std::to_string(exit_code) + "), restarting in " +
+        std::to_string(delay.count()) + "s.");
+}
+
+void Supervisor::poll()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point now = Clock::now();
+
+    for (auto& wp : workers_) {
+        Worker& w = *wp;
+
+        if (w.child.process) {
+            read_status_lines(w);
+            int code = 0;
+            if (platform_wait_child(w.child, 0, code)) {
+                read_status_lines(w);
+                handle_exit(w, code);
+            }
+            continue;
+        }
+
+        if (w.status.state == WorkerState::BackingOff && now >= w.restart_at) {
+            ++w.status.restarts;
+            if (!adopt_standby(w) && !spawn(w)) {
+                handle_exit(w, -1);
+            }
+        }
+    }
+
+    for (auto it = standby_.begin(); it != standby_.end();) {
+        Worker& s = **it;
+        read_status_lines(s);
+        int code = 0;
+        if (!platform_wait_child(s.child, 0, code)) {
+            ++it;
+            continue;
+        }
+        close_pipes(s.child);
+        it = standby_.erase(it);
+        if (code == WORKER_EXIT_NO_DLL || code == WORKER_EXIT_BAD_DLL) {
+            // Every replacement would fail the same way.
+            standby_disabled_ = true;
+            emit(string("Standby workers disabled: ") + worker_exit_reason(code) + ".");
+        }
+        else {
+            standby_retry_at_ = now + STANDBY_RETRY;
+        }
+    }
+    top_up_standby(now);
+    reap_stopping(now);
+}
+
+std::vector<WorkerStatus> Supervisor::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<WorkerStatus> out;
+    out.reserve(workers_.size());
+    for (const auto& w : workers_) {
+        out.push_back(w->status);
+    }
+    return out;
+}
+
+// Wait for a worker that was told to stop; kill it once the grace period is over.
+static void reap_or_kill(ChildProcess& child, unsigned wait_ms)
+{
+    int code = 0;
+    if (!platform_wait_child(child, wait_ms, code)) {
+        platform_kill_child(child);
+        platform_wait_child(child, STOP_GRACE_MS, code);
+    }
+}
+
+void Supervisor::stop_worker(std::unique_ptr<Worker> w)
+{
+    if (!w->child.process) {
+        return;
+    }
+    // Closing the control pipe makes the worker read EOF, shut Steam down and
+    // exit. poll() collects it, so the caller does not wait for SteamAPI_Shutdown.
+    platform_close(w->child.control_write);
+    w->stop_deadline = Clock::now() + std::chrono::milliseconds(STOP_GRACE_MS);
+    stopping_.push_back(std::move(w));
+}
+
+void Supervisor::reap_stopping(Clock::time_point now)
+{
+    for (auto it = stopping_.begin(); it != stopping_.end();) {
+        Worker& w = **it;
+        read_status_lines(w);
+        int code = 0;
+        if (platform_wait_child(w.child, 0, code)) {
+            read_status_lines(w);
+            retire_pump_stats(w);
+            close_pipes(w.child);
+            it = stopping_.erase(it);
+            continue;
+        }
+        if (!w.killed && now >= w.stop_deadline) {
+            platform_kill_child(w.child);
+            w.killed = true;
+        }
+        ++it;
+    }
+}
+
+// Hand w's AppID to a standby worker, warm ones first. False if none is left.
+bool Supervisor::adopt_standby(Worker& w)
+{
+    if (!w.extra_args.empty()) {
+        return false;   // standby workers were started without them
+    }
+    std::stable_partition(standby_.begin(), standby_.end(), [](const std::unique_ptr<Worker>& s) {
+        return s->warm;
+    });
+    while (!standby_.empty()) {
+        std::unique_ptr<Worker> s = std::move(standby_.front());
+        standby_.erase(standby_.begin());
+
+        string command = "start " + w.status.appid + "\n";
+        if (!platform_write(s->child.control_write, command.data(), command.size())) {
+            // Died while waiting; try the next one.
+            stop_worker(std::move(s));
+            continue;
+        }
+        w.child = s->child;
+        w.pending = s->pending;
+        w.reconnecting = false;
+        w.started_at = Clock::now();
+        w.status.pid = w.child.pid;
+        w.status.state = WorkerState::Starting;
+        w.status.since = w.started_at;
+        w.status.warm_start = true;
+        return true;
+    }
+    return false;
+}
+
+void Supervisor::top_up_standby(Clock::time_point now)
+{
+    if (standby_disabled_ || now < standby_retry_at_) {
+        return;
+    }
+    while (standby_.size() < standby_target_) {
+        std::unique_ptr<Worker> s(new Worker());
+        std::vector<string> args;
+        args.push_back("--worker");
+        args.push_back(WORKER_STANDBY);
+        args.insert(args.end(), worker_args_.begin(), worker_args_.end());
+        if (!platform_spawn_worker(exe_path_, args, s->child)) {
+            standby_retry_at_ = now + STANDBY_RETRY;
+            return;
+        }
+        s->status.pid = s->child.pid;
+        s->started_at = now;
+        standby_.push_back(std::move(s));
+    }
+}
+
+void Supervisor::keep_standby(size_t count)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    standby_target_ = count;
+    while (standby_.size() > count) {
+        stop_worker(std::move(standby_.back()));
+        standby_.pop_back();
+    }
+    top_up_standby(Clock::now());
+}
+
+size_t Supervisor::standby_count() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return standby_.size();
+}
+
+void Supervisor::stop_all()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    standby_target_ = 0;
+    for (auto& s : standby_) {
+        workers_.push_back(std::move(s));
+    }
+    standby_.clear();
+    for (auto& s : stopping_) {
+        workers_.push_back(std::move(s));   // already told to stop
+    }
+    stopping_.clear();
+
+    // Signal everyone first so workers shut down in parallel, then collect them.
+    for (auto& w : workers_) {
+        platform_close(w->child.control_write);
+    }
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(STOP_GRACE_MS);
+    for (auto& w : workers_) {
+        if (!w->child.process) {
+            continue;
+        }
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        reap_or_kill(w->child, left > 0 ? static_cast<unsigned>(left) : 0);
+        read_status_lines(*w);
+        retire_pump_stats(*w);
+        close_pipes(w->child);
+    }
+    workers_.clear();
+}
+
+string summarize_workers(const std::vector<WorkerStatus>& workers)
+{
+    int running = 0, starting = 0, backing_off = 0, failed = 0, restarts = 0;
+    for (const auto& w : workers) {
+        switch (w.state) {
+        case WorkerState::Running: ++running; break;
+        case WorkerState::Starting: ++starting; break;
+        case WorkerState::BackingOff: ++backing_off; break;
+        case WorkerState::Failed: ++failed; break;
+        }
+        restarts += w.restarts;
+    }
+    return "running " + std::to_string(running) + "/" + std::to_string(workers.size()) +
+        " | starting " + std::to_string(starting) +
+        " | backing off " + std::to_string(backing_off) +
+        " | failed " + std::to_string(failed) +
+        " | restarts " + std::to_string(restarts);
+}
+
+// --------------------------- Console supervisor ---------------------------
+
+std::vector<string> worker_arguments(const WorkerOptions& opts)
+{
+    std::vector<string> args = {
+        "--tick", std::to_string(opts.pump.idle_tick_ms),
+        "--fast-tick", std::to_string(opts.pump.fast_tick_ms),
+        "--health-interval", std::to_string(opts.watchdog.check_ms),
+        "--pump-report", std::to_string(opts.pump_report_s),
+    };
+    if (opts.ledger_path.empty()) {
+        args.push_back("--no-ledger");
+    }
+    else {
+        args.insert(args.end(), { "--ledger", opts.ledger_path, "--heartbeat", std::to_string(opts.ledger_heartbeat_s) });
+    }
+    if (!opts.appid_dir.empty()) {
+        args.insert(args.end(), { "--appid-dir", opts.appid_dir });
+    }
+    if (opts.lean) {
+        args.push_back("--lean");
+    }
+    return args;
+}
+
+std::shared_ptr<StopSignal> watch_stop_request()
+{
+    auto stop = std::make_shared<StopSignal>();
+    std::thread([stop]() {
+        wait_for_stop_request();
+        {
+            std::lock_guard<std::mutex> lock(stop->mutex);
+            stop->requested = true;
+        }
+        stop->cv.notify_all();
+        }).detach();
+    return stop;
+}
+
+int run_supervisor(const std::vector<string>& appids, const WorkerOptions& opts)
+{
+    // Validate and de-duplicate the requested list up front.
+    std::vector<string> valid;
+    for (const auto& id : appids) {
+        if (!is_digits_only(id)) {
+            print_utf8_line("Skipping \"" + id + "\": AppID must contain digits only.");
+            continue;
+        }
+        if (std::find(valid.begin(), valid.end(), id) != valid.end()) {
+            continue;
+        }
+        if (valid.size() >= Supervisor::MAX_WORKERS) {
+            print_utf8_line("Skipping AppID " + id + ": Steam allows at most " +
+                std::to_string(Supervisor::MAX_WORKERS) + " games at once.");
+            continue;
+        }
+        valid.push_back(id);
+    }
+
+    if (valid.empty()) {
+        print_utf8_line("Error: no valid AppIDs to supervise.");
+        return 1;
+    }
+
+    string exe_path = platform_executable_path();
+    if (exe_path.empty()) {
+        print_utf8_line("Error: could not determine the executable path.");
+        return 1;
+    }
+
+    std::unique_ptr<Dashboard> dashboard;
+    if (opts.dashboard) {
+        dashboard.reset(new Dashboard("Supervising " + std::to_string(valid.size()) + " game(s)", opts.steam_dir));
+    }
+    Dashboard* board = dashboard.get();
+    Supervisor supervisor(exe_path, dashboard_event_sink(board), worker_arguments(opts));
+    supervisor.keep_standby(opts.standby);
+
+    print_utf8_line("Starting " + std::to_string(valid.size()) + " worker(s)...");
+    for (const auto& id : valid) {
+        supervisor.add(id);
+    }
+    print_utf8_line(string(stop_request_hint()) + " to stop all workers and exit.");
+
+    // Monitor thread: poll workers and print the aggregate status whenever it
+    // changes, plus a periodic reminder; or keep the dashboard up to date.
+    std::mutex stop_mutex;
+    std::condition_variable stop_cv;
+    bool stop_requested = false;
+
+    std::thread monitor([&]() {
+        const std::chrono::milliseconds poll_interval(250);
+        const std::chrono::seconds reminder_interval(60);
+        string last_summary;
+        Clock::time_point last_print = Clock::now();
+
+        std::unique_lock<std::mutex> lock(stop_mutex);
+        while (!stop_requested) {
+            lock.unlock();
+            supervisor.poll();
+            std::vector<WorkerStatus> workers = supervisor.snapshot();
+            string summary = summarize_workers(workers);
+            Clock::time_point now = Clock::now();
+            if (board) {
+                board->update(workers, summary);
+            }
+            else if (summary != last_summary || now - last_print >= reminder_interval) {
+                print_utf8_line("[status] " + summary);
+                last_summary = summary;
+                last_print = now;
+            }
+            lock.lock();
+            stop_cv.wait_for(lock, poll_interval, [&]() { return stop_requested; });
+        }
+        });
+
+    wait_for_stop_request();
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stop_requested = true;
+    }
+    stop_cv.notify_all();
+    monitor.join();
+    if (board) {
+        board->finish();
+    }
+
+    print_utf8_line("Stopping workers...");
+    supervisor.stop_all();
+    print_utf8_line("Callback pumps: " + describe_pump_stats(supervisor.pump_totals()) + ".");
+    print_utf8_line("All workers stopped. Exiting.");
+    return 0;
+}
+
+// --------------------------- Worker ---------------------------
+
+// Next line from the control pipe (trimmed), reading more as needed. pending
+// keeps what was read past it. False once the pipe is closed.
+static bool read_control_line(platform_handle control_in, string& pending, string& line)
+{
+    char buf[64];
+    long got;
+    size_t nl;
+    while ((nl = pending.find('\n')) == string::npos) {
+        if ((got = platform_read(control_in, buf, sizeof(buf))) <= 0) {
+            return false;
+        }
+        pending.append(buf, static_cast<size_t>(got));
+    }
+    line = trim(pending.substr(0, nl));
+    pending.erase(0, nl + 1);
+    return true;
+}
+
+int run_worker(const string& worker_appid, platform_handle control_in, platform_handle control_out,
+    const WorkerOptions& opts)
+{
+    bool standby = worker_appid == WORKER_STANDBY;
+    if ((!standby && !is_digits_only(worker_appid)) || !control_in || !control_out) {
+        return WORKER_EXIT_BAD_ARGS;
+    }
+
+    std::mutex report_mutex;
+    auto report = [&](const string& line) {
+        string msg = line + "\n";
+        std::lock_guard<std::mutex> lock(report_mutex);
+        platform_write(control_out, msg.data(), msg.size());
+    };
+
+    // Standby: do the expensive part of startup now, then wait for the AppID.
+    string appid = worker_appid;
+    string control;
+    string line;
+    if (standby) {
+        const SteamApi* api = steam_api_load();
+        if (!api) {
+            report("failed no-dll");
+            return WORKER_EXIT_NO_DLL;
+        }
+        if (!api->has_init()) {
+            report("failed bad-dll");
+            return WORKER_EXIT_BAD_DLL;
+        }
+        report("warm");
+        do {
+            if (!read_control_line(control_in, control, line) || line == "stop") {
+                return WORKER_EXIT_STOPPED;
+            }
+        } while (line.compare(0, 6, "start ") != 0);
+        appid = trim(line.substr(6));
+        if (!is_digits_only(appid)) {
+            return WORKER_EXIT_BAD_ARGS;
+        }
+    }
+
+    // Same startup as the interactive path, minus the Store lookup: the
+    // supervisor has no use for names. Every worker appends its own records;
+    // see session_ledger.h.
+    SessionLedger ledger;
+    IdleSessionConfig config;
+    config.pump = opts.pump;
+    config.watchdog = opts.watchdog;
+    config.ledger = !opts.ledger_path.empty() && ledger.open(opts.ledger_path, opts.ledger_heartbeat_s) ? &ledger : nullptr;
+
+    // Several workers share one folder, so by default they rely on the
+    // environment variables only. With an appid_dir each one moves to a
+    // folder of its own holding a generated steam_appid.txt; steam_api is
+    // loaded first, from the folder the worker was started in.
+    if (!opts.appid_dir.empty() && steam_api_load()) {
+        string dir = opts.appid_dir + "/" + appid;
+        if (!platform_make_directories(dir) || !save_appid_to_file(appid, dir + "/steam_appid.txt") ||
+            !platform_change_directory(dir)) {
+            report("failed appid-dir");
+            return WORKER_EXIT_BAD_ARGS;
+        }
+    }
+    config.on_steam_change = [&report](bool connected, const string& detail) {
+        report(connected ? string("ready") : "lost " + detail);
+    };
+    IdleSession session(config);
+
+    switch (session.start(appid)) {
+    case IdleStartResult::Idling:
+        break;
+    case IdleStartResult::NoLibrary:
+        report("failed no-dll");
+        return WORKER_EXIT_NO_DLL;
+    case IdleStartResult::BadLibrary:
+        report("failed bad-dll");
+        return WORKER_EXIT_BAD_DLL;
+    case IdleStartResult::NotOwned:
+        report("failed not-owned");
+        return WORKER_EXIT_NOT_OWNED;
+    case IdleStartResult::SteamNotRunning:
+        report("failed steam-not-running");
+        return WORKER_EXIT_STEAM_NOT_RUNNING;
+    }
+
+    report("ready");
+
+    // An ownership probe only wanted to know whether SteamAPI_Init succeeds.
+    if (opts.init_only) {
+        session.stop();
+        return WORKER_EXIT_STOPPED;
+    }
+
+    // Workers never had a console or a Store client; lean is just the trim.
+    if (opts.lean) {
+        LeanReport mem = enter_lean_idle(nullptr, false);
+        report("memory " + std::to_string(mem.before.private_bytes) + " " + std::to_string(mem.after.private_bytes) +
+            " " + std::to_string(mem.before.working_set) + " " + std::to_string(mem.after.working_set));
+    }
+
+    auto report_pump = [&report](const PumpStats& s) {
+        report("pump " + std::to_string(s.ticks) + " " + std::to_string(s.callback_total_us) + " " +
+            std::to_string(s.callback_max_us) + " " + std::to_string(s.drift_total_us) + " " +
+            std::to_string(s.drift_max_us));
+    };
+
+    // Pump counters go to the supervisor every pump_report_s and on exit.
+    std::mutex stop_mutex;
+    std::condition_variable stop_cv;
+    bool stopping = false;
+    std::thread reporter([&]() {
+        std::unique_lock<std::mutex> lock(stop_mutex);
+        const std::chrono::seconds interval(std::max(1u, opts.pump_report_s));
+        while (!stop_cv.wait_for(lock, interval, [&]() { return stopping; })) {
+            report_pump(session.pump_stats());
+        }
+        });
+
+    // Idle until the supervisor closes the control pipe (or dies) or sends "stop".
+    while (read_control_line(control_in, control, line) && line != "stop") {
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stop_mutex);
+        stopping = true;
+    }
+    stop_cv.notify_all();
+    reporter.join();
+
+    session.stop();
+    report_pump(session.pump_stats());
+    return WORKER_EXIT_STOPPED;
+}
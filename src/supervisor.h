@@ -0,0 +1,219 @@
+// supervisor.h
+// Multi-app mode: one minimal worker process per AppID, watched and restarted
+// by a supervisor running in the console process.
+//
+// SteamAPI_Init binds a process to a single AppID (SteamAppId / steam_appid.txt),
+// so idling several games at once needs one process each. Workers are this same
+// executable started with "--worker <appid> --control <in> <out>" (process
+// and pipe handling is in platform.h):
+// - <in>  is an inherited pipe handle; the worker idles until it reads EOF (or a
+//         "stop" line), so workers never outlive a crashed supervisor.
+// - <out> is an inherited pipe handle the worker writes status lines to
+//         ("ready", "failed <reason>", "lost <reason>").
+// The worker's own stdout/stderr are not used, so steam_api noise goes nowhere.
+// Workers share the supervisor's folder and rely on the SteamAppId variable,
+// unless WorkerOptions::appid_dir gives each one a folder of its own with a
+// generated steam_appid.txt (profile mode, see profile.h).
+// Workers also send "pump <ticks> <cb_total_us> <cb_max_us> <drift_total_us>
+// <drift_max_us>" every minute (WorkerOptions::pump_report_s) and on exit, so
+// the supervisor can report what the callback pumps cost across every
+// process. Lean workers (--lean) send "memory <private_before> <private_after>
+// <ws_before> <ws_after>" (bytes) once they have trimmed themselves after
+// "ready".
+//
+// Standby workers ("--worker standby") make switching games cheap: they are
+// spawned ahead of time, load steam_api, report "warm" and wait for a
+// "start <appid>" line on <in>. From there on they are ordinary workers, so
+// a new AppID only pays for SteamAPI_Init instead of process creation and
+// the library load. Supervisor::keep_standby() sets how many are kept ready.
+
+#pragma once
+
+#include "callback_pump.h"
+#include "platform.h"
+#include "steam_watchdog.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Worker process exit codes. The supervisor uses them to decide whether a
+// restart can help.
+enum WorkerExitCode {
+    WORKER_EXIT_STOPPED = 0,            // stopped on request
+    WORKER_EXIT_BAD_ARGS = 2,           // invalid AppID / control handles
+    WORKER_EXIT_NO_DLL = 10,            // no steam_api library (dll / so) found
+    WORKER_EXIT_BAD_DLL = 11,           // SteamAPI_Init not exported
+    WORKER_EXIT_STEAM_NOT_RUNNING = 12, // Steam client down or logged off
+    WORKER_EXIT_NOT_OWNED = 13,         // account cannot run this AppID
+};
+
+// Short human-readable description of a worker exit code.
+const char* worker_exit_reason(int code);
+
+enum class WorkerState {
+    Starting,    // process spawned, SteamAPI_Init not confirmed yet
+    Running,     // worker reported "ready"
+    BackingOff,  // died; waiting before the next restart
+    Failed,      // permanent failure (not owned, no DLL); not restarted
+};
+
+const char* worker_state_name(WorkerState state);
+
+// --worker argument that starts a standby worker instead of an AppID.
+extern const char* const WORKER_STANDBY;
+
+// What every worker process is started with (and the supervisor's pool size).
+struct WorkerOptions {
+    PumpOptions pump;
+    WatchdogOptions watchdog;
+    bool lean = false;
+    std::string ledger_path;    // session ledger (session_ledger.h); empty: none
+    unsigned ledger_heartbeat_s = 60;
+    unsigned pump_report_s = 60;   // how often workers send "pump" lines
+    bool init_only = false;        // exit right after "ready" (ownership_probe.h)
+    std::string appid_dir;         // generate <appid_dir>/<appid>/steam_appid.txt and run there
+
+    // Supervisor side only.
+    size_t standby = 0;        // standby workers kept ready
+    bool dashboard = false;    // console supervisor: live table (dashboard.h)
+    std::string steam_dir;     // where the dashboard looks up installed games' names
+};
+
+struct WorkerStatus {
+    std::string appid;
+    WorkerState state = WorkerState::Starting;
+    unsigned long pid = 0;
+    int restarts = 0;
+    int last_exit_code = -1;
+    std::chrono::steady_clock::time_point since; // when the current state was entered
+    PumpStats pump;                               // latest report of the current process
+    double start_ms = -1;      // spawn (or standby hand-over) to "ready" of the last start; -1 if none yet
+    bool warm_start = false;   // the last start went through a standby worker
+    std::chrono::steady_clock::time_point last_tick;   // when the pump was last seen ticking
+    std::string error;         // why it last failed, exited or lost Steam; cleared on "ready"
+};
+
+class Supervisor {
+public:
+    // Steam refuses to run more than 32 games at the same time per account.
+    static const size_t MAX_WORKERS = 32;
+
+    // exe_path: executable started for each worker (normally this program).
+    // on_event: receives one UTF-8 line per noteworthy change (may be empty).
+    // worker_args: extra arguments appended to every worker command line.
+    Supervisor(const std::string& exe_path, std::function<void(const std::string&)> on_event,
+        const std::vector<std::string>& worker_args = std::vector<std::string>());
+    ~Supervisor();
+
+    Supervisor(const Supervisor&) = delete;
+    Supervisor& operator=(const Supervisor&) = delete;
+
+    enum class AddResult { Added, AlreadyAdded, Full };
+
+    // Start idling an AppID; extra_args go after worker_args on its command
+    // line (later options win, e.g. its own "--tick"). Workers with extra
+    // arguments never take over a standby worker. Refuses, saying why, if it
+    // is already supervised or the 32-worker limit is reached; the check and
+    // the start are one step, so concurrent callers cannot both add it.
+    AddResult add(const std::string& appid, const std::vector<std::string>& extra_args = std::vector<std::string>());
+
+    // Stop the worker for an AppID and forget it. Returns false if unknown.
+    // Does not wait: the worker is told to stop and poll() collects it (or
+    // kills it once the grace period is over), so several removals shut down
+    // in parallel and nobody waits on the lock meanwhile.
+    bool remove(const std::string& appid);
+
+    // Reap exited workers, pick up status lines and restart workers whose
+    // backoff expired. Call periodically (a few times per second is plenty).
+    void poll();
+
+    // Copy of every worker's status, in insertion order.
+    std::vector<WorkerStatus> snapshot() const;
+
+    // Stop every worker (graceful first, then forcefully) and forget them.
+    void stop_all();
+
+    // Callback pump counters of every worker process so far, live and exited.
+    PumpStats pump_totals() const;
+
+    // Keep count standby workers spawned and waiting; add() and restarts hand
+    // their AppID to one of them when there is one. 0 (the default) disables
+    // the pool. Spawning happens here and in poll().
+    void keep_standby(size_t count);
+
+    // Standby workers currently waiting (warm or still loading).
+    size_t standby_count() const;
+
+private:
+    struct Worker;
+
+    bool spawn(Worker& w);
+    bool adopt_standby(Worker& w);
+    void top_up_standby(std::chrono::steady_clock::time_point now);
+    void stop_worker(std::unique_ptr<Worker> w);
+    void reap_stopping(std::chrono::steady_clock::time_point now);
+    void handle_exit(Worker& w, int exit_code);
+    void read_status_lines(Worker& w);
+    void retire_pump_stats(Worker& w);
+    void emit(const std::string& line);
+    void append_metrics(std::string& out) const;   // ssi_worker_* series, see metrics.h
+
+    std::string exe_path_;
+    std::function<void(const std::string&)> on_event_;
+    std::vector<std::string> worker_args_;
+    PumpStats retired_pump_;   // totals of worker processes that have exited
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::unique_ptr<Worker>> standby_;
+    std::vector<std::unique_ptr<Worker>> stopping_;   // told to stop, not yet exited
+    size_t standby_target_ = 0;
+    bool standby_disabled_ = false;          // standby workers cannot load steam_api
+    std::chrono::steady_clock::time_point standby_retry_at_;   // after a standby died unexpectedly
+    mutable std::mutex mutex_;
+};
+
+// Aggregate one-line summary of a snapshot, e.g.
+// "running 30/32 | starting 1 | backing off 1 | failed 0 | restarts 4".
+std::string summarize_workers(const std::vector<WorkerStatus>& workers);
+
+// Supervisor worker_args for these options: "--tick", "--fast-tick",
+// "--health-interval", "--pump-report", "--ledger" and "--heartbeat" (or
+// "--no-ledger"), "--appid-dir" when set and, when lean, "--lean".
+std::vector<std::string> worker_arguments(const WorkerOptions& opts);
+
+// Set by a detached thread blocked in wait_for_stop_request(), for console
+// modes that may also finish on their own: that thread cannot be woken up
+// portably.
+struct StopSignal {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool requested = false;
+
+    // Waits up to timeout; true once a stop was requested.
+    bool wait_for(std::chrono::milliseconds timeout)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        return cv.wait_for(lock, timeout, [this]() { return requested; });
+    }
+};
+
+// Start that thread.
+std::shared_ptr<StopSignal> watch_stop_request();
+
+// Console supervisor: start one worker per AppID, print events and a periodic
+// aggregate status line (or, with opts.dashboard, show the live table of
+// dashboard.h), and stop everything when the user presses ENTER.
+int run_supervisor(const std::vector<std::string>& appids, const WorkerOptions& opts);
+
+// Worker entry point ("--worker <appid|standby> --control <in> <out>"). Never
+// touches the console. With lean it trims itself once idling (see lean_idle.h). When
+// the watchdog loses the Steam session it reports "lost <reason>", then
+// "ready" again once reconnected. With init_only ("--init-only") it shuts
+// down right after "ready". Returns one of WorkerExitCode.
+int run_worker(const std::string& appid, platform_handle control_in, platform_handle control_out,
+    const WorkerOptions& opts);
@@ -0,0 +1,323 @@
+// text.cpp
+// UTF-8 / UTF-16 conversion and console writes. See text.h.
+
+#define NOMINMAX
+
+#include "text.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <cwchar>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SSI_TEXT_SSE2 1
+#include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define SSI_TEXT_NEON 1
+#include <arm_neon.h>
+#endif
+
+using std::string;
+
+static const uint64_t HIGH_BITS = 0x8080808080808080ull;
+
+// --------------------------- ASCII runs ---------------------------
+
+size_t ascii_prefix_length(const char* s, size_t n)
+{
+    size_t i = 0;
+#if defined(SSI_TEXT_SSE2)
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        if (_mm_movemask_epi8(v) != 0) break;
+    }
+#elif defined(SSI_TEXT_NEON)
+    for (; i + 16 <= n; i += 16) {
+        if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(s + i))) >= 0x80) break;
+    }
+#endif
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, s + i, sizeof(w));
+        if (w & HIGH_BITS) break;
+    }
+    while (i < n && static_cast<unsigned char>(s[i]) < 0x80) {
+        ++i;
+    }
+    return i;
+}
+
+// Copy the leading ASCII bytes of s[0..n) to out as UTF-16; returns how many.
+template <typename Unit>
+static size_t widen_ascii(const char* s, size_t n, Unit* out)
+{
+    size_t i = 0;
+#if defined(SSI_TEXT_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        if (_mm_movemask_epi8(v) != 0) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8), _mm_unpackhi_epi8(v, zero));
+    }
+#elif defined(SSI_TEXT_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(s + i));
+        if (vmaxvq_u8(v) >= 0x80) break;
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + i), vmovl_u8(vget_low_u8(v)));
+        vst1q_u16(reinterpret_cast<uint16_t*>(out + i + 8), vmovl_high_u8(v));
+    }
+#else
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, s + i, sizeof(w));
+        if (w & HIGH_BITS) break;
+        for (size_t k = 0; k < 8; ++k) out[i + k] = static_cast<Unit>(s[i + k]);
+    }
+#endif
+    for (; i < n && static_cast<unsigned char>(s[i]) < 0x80; ++i) {
+        out[i] = static_cast<Unit>(s[i]);
+    }
+    return i;
+}
+
+// Copy the leading units of s[0..n) below 0x80 to out as bytes; returns how many.
+template <typename Unit>
+static size_t narrow_ascii(const Unit* s, size_t n, char* out)
+{
+    size_t i = 0;
+#if defined(SSI_TEXT_SSE2)
+    const __m128i high = _mm_set1_epi16(static_cast<short>(0xff80));
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 16 <= n; i += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 8));
+        __m128i any_high = _mm_and_si128(_mm_or_si128(a, b), high);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(any_high, zero)) != 0xffff) break;
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(a, b));
+    }
+#elif defined(SSI_TEXT_NEON)
+    for (; i + 16 <= n; i += 16) {
+        uint16x8_t a = vld1q_u16(reinterpret_cast<const uint16_t*>(s + i));
+        uint16x8_t b = vld1q_u16(reinterpret_cast<const uint16_t*>(s + i + 8));
+        if (vmaxvq_u16(vorrq_u16(a, b)) >= 0x80) break;
+        vst1q_u8(reinterpret_cast<uint8_t*>(out + i), vcombine_u8(vmovn_u16(a), vmovn_u16(b)));
+    }
+#endif
+    for (; i < n && static_cast<uint16_t>(s[i]) < 0x80; ++i) {
+        out[i] = static_cast<char>(s[i]);
+    }
+    return i;
+}
+
+// --------------------------- Conversion ---------------------------
+
+template <typename Unit>
+void append_utf8_as_utf16(const char* s, size_t n, std::basic_string<Unit>& out)
+{
+    static_assert(sizeof(Unit) == 2, "UTF-16 needs 16-bit units");
+    if (n == 0) {
+        return;
+    }
+    size_t base = out.size();
+    out.resize(base + n);   // never more units than bytes
+    Unit* start = &out[0];
+    Unit* d = start + base;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s);
+
+    size_t i = 0;
+    while (i < n) {
+        size_t run = widen_ascii(s + i, n - i, d);
+        i += run;
+        d += run;
+        if (i >= n) {
+            break;
+        }
+
+        // One multi-byte sequence. lo/hi bound the second byte so overlong
+        // forms, surrogates and code points past U+10FFFF are rejected.
+        unsigned c = p[i];
+        size_t len;
+        uint32_t cp;
+        unsigned lo = 0x80, hi = 0xbf;
+        if (c >= 0xc2 && c <= 0xdf) {
+            len = 2;
+            cp = c & 0x1f;
+        }
+        else if (c >= 0xe0 && c <= 0xef) {
+            len = 3;
+            cp = c & 0x0f;
+            if (c == 0xe0) lo = 0xa0;
+            if (c == 0xed) hi = 0x9f;
+        }
+        else if (c >= 0xf0 && c <= 0xf4) {
+            len = 4;
+            cp = c & 0x07;
+            if (c == 0xf0) lo = 0x90;
+            if (c == 0xf4) hi = 0x8f;
+        }
+        else {
+            *d++ = static_cast<Unit>(0xfffd);
+            ++i;
+            continue;
+        }
+
+        size_t k = 1;
+        for (; k < len && i + k < n; ++k) {
+            unsigned b = p[i + k];
+            if (b < lo || b > hi) break;
+            lo = 0x80;
+            hi = 0xbf;
+            cp = (cp << 6) | (b & 0x3f);
+        }
+        i += k;
+        if (k < len) {
+            *d++ = static_cast<Unit>(0xfffd);
+        }
+        else if (cp >= 0x10000) {
+            cp -= 0x10000;
+            *d++ = static_cast<Unit>(0xd800 + (cp >> 10));
+            *d++ = static_cast<Unit>(0xdc00 + (cp & 0x3ff));
+        }
+        else {
+            *d++ = static_cast<Unit>(cp);
+        }
+    }
+    out.resize(static_cast<size_t>(d - start));
+}
+
+template <typename Unit>
+void append_utf16_as_utf8(const Unit* s, size_t n, string& out)
+{
+    static_assert(sizeof(Unit) == 2, "UTF-16 needs 16-bit units");
+    if (n == 0) {
+        return;
+    }
+    size_t base = out.size();
+    out.resize(base + 3 * n);   // a unit needs at most 3 bytes, a pair 4
+    char* start = &out[0];
+    char* d = start + base;
+
+    size_t i = 0;
+    while (i < n) {
+        size_t run = narrow_ascii(s + i, n - i, d);
+        i += run;
+        d += run;
+        if (i >= n) {
+            break;
+        }
+
+        uint32_t c = static_cast<uint16_t>(s[i++]);
+        if (c < 0x800) {
+            *d++ = static_cast<char>(0xc0 | (c >> 6));
+            *d++ = static_cast<char>(0x80 | (c & 0x3f));
+            continue;
+        }
+        if (c >= 0xd800 && c <= 0xdfff) {
+            uint32_t next = i < n ? static_cast<uint16_t>(s[i]) : 0;
+            if (c <= 0xdbff && next >= 0xdc00 && next <= 0xdfff) {
+                ++i;
+                c = 0x10000 + ((c - 0xd800) << 10) + (next - 0xdc00);
+                *d++ = static_cast<char>(0xf0 | (c >> 18));
+                *d++ = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+                *d++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+                *d++ = static_cast<char>(0x80 | (c & 0x3f));
+                continue;
+            }
+            c = 0xfffd;
+        }
+        *d++ = static_cast<char>(0xe0 | (c >> 12));
+        *d++ = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+        *d++ = static_cast<char>(0x80 | (c & 0x3f));
+    }
+    out.resize(static_cast<size_t>(d - start));
+}
+
+template void append_utf8_as_utf16<char16_t>(const char*, size_t, std::u16string&);
+template void append_utf16_as_utf8<char16_t>(const char16_t*, size_t, string&);
+#if WCHAR_MAX <= 0xffff
+template void append_utf8_as_utf16<wchar_t>(const char*, size_t, std::wstring&);
+template void append_utf16_as_utf8<wchar_t>(const wchar_t*, size_t, string&);
+#endif
+
+// --------------------------- Console ---------------------------
+
+#ifdef _WIN32
+
+// Older consoles refuse very large writes; batches go out in slices of this
+// many units (not splitting a surrogate pair).
+static const size_t CONSOLE_SLICE = 8192;
+
+static bool write_console(HANDLE out, const std::wstring& w)
+{
+    size_t pos = 0;
+    while (pos < w.size()) {
+        size_t len = std::min(CONSOLE_SLICE, w.size() - pos);
+        if (pos + len < w.size() && w[pos + len - 1] >= 0xd800 && w[pos + len - 1] <= 0xdbff) {
+            --len;
+        }
+        DWORD written = 0;
+        if (!WriteConsoleW(out, w.data() + pos, static_cast<DWORD>(len), &written, NULL)) {
+            return pos != 0;   // part of it is on screen already; do not repeat it
+        }
+        pos += len;
+    }
+    return true;
+}
+
+// Held across every slice of one call, so another thread's text cannot land
+// between them.
+static std::mutex console_mutex;
+
+void console_write_utf8(const char* s, size_t n)
+{
+    HANDLE out = GetStdHandle(STD_OUTPUT_HANDLE);
+    DWORD mode = 0;
+    if (out != INVALID_HANDLE_VALUE && out != NULL && GetConsoleMode(out, &mode)) {
+        thread_local std::wstring wide;
+        wide.clear();
+        append_utf8_as_utf16(s, n, wide);
+        std::lock_guard<std::mutex> lock(console_mutex);
+        if (write_console(out, wide)) {
+            return;
+        }
+    }
+    // Redirected (or no console at all): the UTF-8 bytes as they are.
+    std::fwrite(s, 1, n, stdout);
+    std::fflush(stdout);
+}
+
+#else
+
+// No console API to go through: the bytes are UTF-8 already. Flushed per
+// call so output stays in order when it goes to a log or a pipe.
+void console_write_utf8(const char* s, size_t n)
+{
+    std::fwrite(s, 1, n, stdout);
+    std::fflush(stdout);
+}
+
+#endif // _WIN32
+
+// --------------------------- Batches ---------------------------
+
+void TextBatch::line(const string& utf8)
+{
+    buf_ += utf8;
+    buf_ += '\n';
+}
+
+void TextBatch::flush()
+{
+    if (!buf_.empty()) {
+        console_write_utf8(buf_.data(), buf_.size());
+        buf_.clear();
+    }
+}
@@ -0,0 +1,59 @@
+// text.h
+// Text output layer: UTF-8 <-> UTF-16 conversion and console writes.
+//
+// The converters are portable (no MultiByteToWideChar) and copy runs of
+// ASCII 16 bytes at a time (SSE2 / NEON, 8 at a time elsewhere), which is
+// what almost every message and most game names are. Malformed input becomes
+// U+FFFD, one per maximal invalid subsequence, like the Win32 converters.
+//
+// console_write_utf8() puts text on stdout in a single call: one
+// WriteConsoleW on a Windows console (converted in a reused per-thread
+// buffer), one fwrite + fflush otherwise. TextBatch collects many lines and
+// writes them with one such call.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// Number of leading bytes of s[0..n) below 0x80.
+size_t ascii_prefix_length(const char* s, size_t n);
+
+// Append the UTF-16 form of UTF-8 text to out. Unit is char16_t, or wchar_t
+// where it is 16 bits wide (Windows).
+template <typename Unit>
+void append_utf8_as_utf16(const char* s, size_t n, std::basic_string<Unit>& out);
+
+// Append the UTF-8 form of UTF-16 text to out. Unpaired surrogates become
+// U+FFFD.
+template <typename Unit>
+void append_utf16_as_utf8(const Unit* s, size_t n, std::string& out);
+
+// Write UTF-8 text to stdout in one call (see above). Safe to call from
+// several threads: each call's text comes out in one piece with respect to
+// other calls (a large write that a Windows console takes in slices holds a
+// lock across all of them).
+void console_write_utf8(const char* s, size_t n);
+
+// Lines collected and written by flush() (or the destructor) in one call.
+class TextBatch {
+public:
+    TextBatch() = default;
+    ~TextBatch() { flush(); }
+
+    TextBatch(const TextBatch&) = delete;
+    TextBatch& operator=(const TextBatch&) = delete;
+
+    // Add text followed by a newline.
+    void line(const std::string& utf8);
+    // Add text as is (e.g. the start of a line finished later).
+    void text(const std::string& utf8) { buf_ += utf8; }
+
+    // Write everything added so far and start over (keeping the buffer).
+    void flush();
+
+    bool empty() const { return buf_.empty(); }
+
+private:
+    std::string buf_;
+};
@@ -0,0 +1,58 @@
+// token_bucket.cpp
+// Token-bucket rate limiter. See token_bucket.h.
+
+#include "token_bucket.h"
+
+#include <algorithm>
+#include <thread>
+
+TokenBucket::TokenBucket(double rate, double burst)
+    : rate_(rate), burst_(std::max(1.0, burst)), tokens_(std::max(1.0, burst)),
+    last_refill_(Clock::now()), paused_until_(Clock::now())
+{
+}
+
+void TokenBucket::acquire()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        Clock::time_point now = Clock::now();
+        Clock::duration wait;
+
+        if (now < paused_until_) {
+            // Pauses apply even without a rate limit: they are the server's.
+            wait = paused_until_ - now;
+        }
+        else if (rate_ <= 0.0) {
+            return;
+        }
+        else {
+            double elapsed = std::chrono::duration<double>(now - last_refill_).count();
+            tokens_ = std::min(burst_, tokens_ + elapsed * rate_);
+            last_refill_ = now;
+            if (tokens_ >= 1.0) {
+                tokens_ -= 1.0;
+                return;
+            }
+            wait = std::chrono::duration_cast<Clock::duration>(
+                std::chrono::duration<double>((1.0 - tokens_) / rate_));
+        }
+
+        // Sleep without holding the lock; whoever wakes first gets the token.
+        lock.unlock();
+        std::this_thread::sleep_for(wait);
+        lock.lock();
+    }
+}
+
+void TokenBucket::pause_for(std::chrono::milliseconds duration)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    Clock::time_point until = Clock::now() + duration;
+    if (until > paused_until_) {
+        paused_until_ = until;
+    }
+    // Resume slowly: no saved-up burst right after a pause.
+    tokens_ = 0.0;
+    last_refill_ = paused_until_;
+}
@@ -0,0 +1,31 @@
+// token_bucket.h
+// Thread-safe token-bucket rate limiter.
+
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+class TokenBucket {
+public:
+    // rate: tokens added per second (<= 0 disables limiting, but not pauses).
+    // burst: bucket capacity, i.e. how many tokens can be taken back to back.
+    TokenBucket(double rate, double burst);
+
+    // Block until a token is available, then take it.
+    void acquire();
+
+    // Hand out no tokens for the given time (e.g. the server answered 429).
+    // Extends, never shortens, an existing pause.
+    void pause_for(std::chrono::milliseconds duration);
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    std::mutex mutex_;
+    double rate_;
+    double burst_;
+    double tokens_;
+    Clock::time_point last_refill_;
+    Clock::time_point paused_until_;
+};
@@ -0,0 +1,146 @@
+// util.cpp
+// Console / string helpers. See util.h.
+
+#include "util.h"
+#include "platform.h"
+#include "text.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+
+using std::string;
+
+#ifdef _WIN32
+
+// Convert UTF-8 string to wstring (UTF-16). Malformed bytes become U+FFFD.
+std::wstring utf8_to_wstring(const std::string& utf8)
+{
+    std::wstring w;
+    append_utf8_as_utf16(utf8.data(), utf8.size(), w);
+    return w;
+}
+
+// Convert wstring (UTF-16) to UTF-8. Unpaired surrogates become U+FFFD.
+std::string wstring_to_utf8(const std::wstring& w)
+{
+    std::string utf8;
+    append_utf16_as_utf8(w.data(), w.size(), utf8);
+    return utf8;
+}
+
+// Print a wide string (UTF-16) followed by newline.
+// This avoids encoding issues for literals containing non-ASCII characters.
+void print_wline(const std::wstring& w)
+{
+    thread_local string line;
+    line.clear();
+    append_utf16_as_utf8(w.data(), w.size(), line);
+    line += '\n';
+    console_write_utf8(line.data(), line.size());
+}
+
+#endif // _WIN32
+
+// Print a UTF-8 string followed by newline, text and newline in one write
+// (see console_write_utf8). The line is built in a per-thread buffer.
+void print_utf8_line(const std::string& utf8)
+{
+    thread_local string line;
+    line.assign(utf8);
+    line += '\n';
+    console_write_utf8(line.data(), line.size());
+}
+
+// Print without newline (for prompts).
+void print_utf8(const std::string& utf8)
+{
+    console_write_utf8(utf8.data(), utf8.size());
+}
+
+// Read the single-line steam_appid.txt file if present, trim and return contents.
+// Returns empty string if file not present or empty.
+string read_appid_from_file(const char* filename)
+{
+    std::ifstream ifs(filename);
+    if (!ifs) return "";
+    string tmp;
+    std::getline(ifs, tmp);
+    return trim(tmp);
+}
+
+// Save AppID to steam_appid.txt, only when it changed.
+bool save_appid_to_file(const string& appid, const string& filename)
+{
+    return write_file_if_changed(filename, appid + "\n");
+}
+
+bool write_file_if_changed(const string& path, const string& data)
+{
+    string current;
+    if (platform_read_small_file(path, current, data.size()) && current == data) {
+        return true;
+    }
+    return platform_write_file_atomic(path, data);
+}
+
+// Trim whitespace (space, tab, CR, LF) from both ends.
+string trim(const string& s)
+{
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == string::npos) {
+        return "";
+    }
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+// Check whether the provided string contains only digits (0-9).
+bool is_digits_only(const string& s)
+{
+    if (s.empty()) return false;
+    return std::all_of(s.begin(), s.end(), [](unsigned char c) { return std::isdigit(c); });
+}
+
+// Split a list of AppIDs separated by commas, spaces or newlines.
+std::vector<string> split_appid_list(const string& text)
+{
+    std::vector<string> out;
+    string token;
+    for (char c : text) {
+        if (c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            if (!token.empty()) {
+                out.push_back(token);
+                token.clear();
+            }
+            continue;
+        }
+        token.push_back(c);
+    }
+    if (!token.empty()) {
+        out.push_back(token);
+    }
+    return out;
+}
+
+// Append s as a quoted JSON string (UTF-8 passes through, controls are \u-escaped).
+void append_json_string(string& out, const string& s)
+{
+    out += '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        }
+        else if (c < 0x20) {
+            char buf[8];
+            std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+            out += buf;
+        }
+        else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
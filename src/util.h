@@ -0,0 +1,55 @@
+// util.h
+// Small console / string helpers shared by the interactive front-end, the
+// supervisor and the worker processes.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+// Convert UTF-8 string to wstring (UTF-16), see text.h.
+// Malformed bytes become U+FFFD.
+std::wstring utf8_to_wstring(const std::string& utf8);
+
+// Convert wstring (UTF-16) to UTF-8, see text.h.
+// Unpaired surrogates become U+FFFD.
+std::string wstring_to_utf8(const std::wstring& w);
+
+// Print a wide string (UTF-16) followed by newline.
+void print_wline(const std::wstring& w);
+#endif
+
+// Print a UTF-8 string followed by newline to console robustly, in one
+// write (see console_write_utf8 in text.h; TextBatch for many lines).
+void print_utf8_line(const std::string& utf8);
+
+// Print without newline (for prompts).
+void print_utf8(const std::string& utf8);
+
+// Read the single-line steam_appid.txt file if present, trim and return contents.
+// Returns empty string if file not present or empty.
+std::string read_appid_from_file(const char* filename = "steam_appid.txt");
+
+// Save AppID to steam_appid.txt, atomically and only if it holds something
+// else (see write_file_if_changed). False if it could not be written.
+bool save_appid_to_file(const std::string& appid, const std::string& filename = "steam_appid.txt");
+
+// Replace a small file with data (platform_write_file_atomic) unless it
+// already holds exactly that, so unchanged settings cost a read and no write.
+// True if the file holds data afterwards.
+bool write_file_if_changed(const std::string& path, const std::string& data);
+
+// Trim whitespace (space, tab, CR, LF) from both ends.
+std::string trim(const std::string& s);
+
+// Check whether the provided string contains only digits (0-9).
+bool is_digits_only(const std::string& s);
+
+// Split a list of AppIDs separated by commas, spaces or newlines.
+// Empty tokens are dropped; tokens are returned trimmed but otherwise unvalidated.
+std::vector<std::string> split_appid_list(const std::string& text);
+
+// Append s to out as a quoted JSON string (escapes quotes, backslashes and
+// control characters; UTF-8 passes through).
+void append_json_string(std::string& out, const std::string& s);
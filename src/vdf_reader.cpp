@@ -0,0 +1,178 @@
+// vdf_reader.cpp
+// Single-pass KeyValues (VDF) reader. See vdf_reader.h.
+
+#include "vdf_reader.h"
+
+#include <cstring>
+
+VdfReader::VdfReader(std::string_view input)
+    : in_(input)
+{
+    // UTF-8 byte order mark, written by some tools that rewrite these files.
+    if (in_.size() >= 3 && in_.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        pos_ = 3;
+    }
+}
+
+VdfToken VdfReader::fail()
+{
+    error_ = true;
+    key_ = value_ = std::string_view();
+    return VdfToken::Error;
+}
+
+// Skip whitespace, // comments and [$CONDITION] markers.
+void VdfReader::skip_space()
+{
+    while (pos_ < in_.size()) {
+        char c = in_[pos_];
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+            ++pos_;
+        }
+        else if (c == '/' && pos_ + 1 < in_.size() && in_[pos_ + 1] == '/') {
+            const char* nl = static_cast<const char*>(std::memchr(in_.data() + pos_, '\n', in_.size() - pos_));
+            pos_ = nl ? static_cast<size_t>(nl - in_.data()) + 1 : in_.size();
+        }
+        else if (c == '[') {
+            const char* close = static_cast<const char*>(std::memchr(in_.data() + pos_, ']', in_.size() - pos_));
+            pos_ = close ? static_cast<size_t>(close - in_.data()) + 1 : in_.size();
+        }
+        else {
+            break;
+        }
+    }
+}
+
+// Read one quoted or bare string at pos_.
+bool VdfReader::scan(std::string_view& out)
+{
+    const char* base = in_.data();
+    size_t n = in_.size();
+
+    if (in_[pos_] == '"') {
+        // Find the closing quote with memchr; only look closer when a
+        // backslash shows up before it.
+        size_t start = pos_ + 1;
+        size_t i = start;
+        for (;;) {
+            const char* quote = i < n ? static_cast<const char*>(std::memchr(base + i, '"', n - i)) : nullptr;
+            if (!quote) {
+                return false;
+            }
+            size_t qi = static_cast<size_t>(quote - base);
+            const char* bs = static_cast<const char*>(std::memchr(base + i, '\\', qi - i));
+            if (!bs) {
+                i = qi;
+                break;
+            }
+            i = static_cast<size_t>(bs - base) + 2;
+        }
+        out = in_.substr(start, i - start);
+        pos_ = i + 1;
+        return true;
+    }
+
+    size_t start = pos_;
+    while (pos_ < n) {
+        char c = in_[pos_];
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '"' || c == '{' || c == '}') {
+            break;
+        }
+        ++pos_;
+    }
+    out = in_.substr(start, pos_ - start);
+    return pos_ > start;
+}
+
+VdfToken VdfReader::next()
+{
+    if (error_) {
+        return VdfToken::Error;
+    }
+
+    skip_space();
+    if (pos_ >= in_.size()) {
+        return depth_ == 0 ? VdfToken::End : fail();
+    }
+
+    if (in_[pos_] == '}') {
+        if (depth_ == 0) {
+            return fail();
+        }
+        ++pos_;
+        --depth_;
+        return VdfToken::ObjectEnd;
+    }
+    if (in_[pos_] == '{' || !scan(key_)) {
+        return fail();
+    }
+
+    skip_space();
+    if (pos_ >= in_.size()) {
+        return fail();
+    }
+    if (in_[pos_] == '{') {
+        ++pos_;
+        ++depth_;
+        value_ = std::string_view();
+        return VdfToken::ObjectBegin;
+    }
+    if (in_[pos_] == '}' || !scan(value_)) {
+        return fail();
+    }
+    return VdfToken::Value;
+}
+
+bool VdfReader::skip_object()
+{
+    size_t target = depth_ - 1;
+    while (depth_ > target) {
+        VdfToken t = next();
+        if (t == VdfToken::Error || t == VdfToken::End) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void vdf_unescape(std::string_view raw, std::string& out)
+{
+    out.clear();
+    out.reserve(raw.size());
+    size_t i = 0;
+    while (i < raw.size()) {
+        const char* bs = static_cast<const char*>(std::memchr(raw.data() + i, '\\', raw.size() - i));
+        size_t run_end = bs ? static_cast<size_t>(bs - raw.data()) : raw.size();
+        out.append(raw.data() + i, run_end - i);
+        i = run_end;
+        if (i + 1 >= raw.size()) {
+            if (i < raw.size()) out.push_back('\\');   // trailing lone backslash
+            break;
+        }
+        char e = raw[i + 1];
+        switch (e) {
+        case 'n': out.push_back('\n'); break;
+        case 't': out.push_back('\t'); break;
+        case 'r': out.push_back('\r'); break;
+        default: out.push_back(e); break;   // \\ \" and anything unknown
+        }
+        i += 2;
+    }
+}
+
+bool vdf_key_is(std::string_view key, const char* name)
+{
+    size_t len = std::strlen(name);
+    if (key.size() != len) {
+        return false;
+    }
+    for (size_t i = 0; i < len; ++i) {
+        char a = key[i], b = name[i];
+        if (a >= 'A' && a <= 'Z') a = static_cast<char>(a - 'A' + 'a');
+        if (b >= 'A' && b <= 'Z') b = static_cast<char>(b - 'A' + 'a');
+        if (a != b) {
+            return false;
+        }
+    }
+    return true;
+}
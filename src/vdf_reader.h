@@ -0,0 +1,65 @@
+// vdf_reader.h
+// Single-pass, zero-copy reader for Valve's text KeyValues format (VDF), as
+// used by libraryfolders.vdf and appmanifest_*.acf:
+//
+//   "AppState"
+//   {
+//       "appid"     "440"
+//       "name"      "Team Fortress 2"
+//   }
+//
+// Same shape as JsonReader: VdfReader walks the input once and hands out
+// tokens whose key/value text is a view into the input (typically a mapped
+// file). Escapes (\" \\ \n \t) are only decoded when the caller asks.
+// Unquoted tokens, // comments and [$PLATFORM] conditionals are accepted;
+// conditionals are skipped rather than evaluated.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+
+enum class VdfToken {
+    ObjectBegin,   // key() opened a block: "key" {
+    ObjectEnd,     // }
+    Value,         // "key" "value"
+    End,           // end of input with every block closed
+    Error,         // malformed input; every later call returns Error too
+};
+
+class VdfReader {
+public:
+    explicit VdfReader(std::string_view input);
+
+    // Advance to the next token.
+    VdfToken next();
+
+    // Raw text of the current ObjectBegin / Value key, and of the Value.
+    std::string_view key() const { return key_; }
+    std::string_view value() const { return value_; }
+
+    // Skip the rest of the block whose ObjectBegin was just returned.
+    bool skip_object();
+
+    // Number of open blocks.
+    size_t depth() const { return depth_; }
+
+private:
+    VdfToken fail();
+    void skip_space();
+    bool scan(std::string_view& out);
+
+    std::string_view in_;
+    size_t pos_ = 0;
+    std::string_view key_;
+    std::string_view value_;
+    size_t depth_ = 0;
+    bool error_ = false;
+};
+
+// Decode a raw VDF string (as returned by key() / value()) into out.
+void vdf_unescape(std::string_view raw, std::string& out);
+
+// Case-insensitive ASCII comparison; VDF keys are not case-sensitive
+// ("LibraryFolders" in old files, "libraryfolders" in new ones).
+bool vdf_key_is(std::string_view key, const char* name);
@@ -0,0 +1,255 @@
+// catalog_bench.cpp
+// Benchmark: the app catalog (app_catalog.h) against the obvious alternative:
+// parse the app list JSON on every start and scan it, lower-casing as it goes.
+//
+// Usage: catalog_bench [--apps N] [--json <app list export>] [--queries Q] [--keep]
+//
+// Without --json, writes a synthetic GetAppList export of N apps (accented,
+// punctuated and trademarked names, like the real list) under the temp
+// directory. Prints the build time and file size, the time to open the
+// catalog against the time to load the JSON, and the latency percentiles of
+// exact, prefix and substring queries.
+//
+// Build: CMake target catalog_bench.
+
+#include "app_catalog.h"
+#include "json_reader.h"
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::string;
+
+namespace fs = std::filesystem;
+
+typedef std::chrono::steady_clock Clock;
+
+// --------------------------- Synthetic app list ---------------------------
+
+static const char* const WORDS[] = {
+    "Counter", "Strike", "Half", "Life", "Portal", "Dota", "Team", "Fortress", "Pok\xc3\xa9mon", "Stra\xc3\x9f" "e",
+    "Caf\xc3\xa9", "\xc3\x85land", "Dark", "Souls", "Witcher", "Hollow", "Knight", "Stardew", "Valley", "Terraria",
+    "Factorio", "Rocket", "League", "Civilization", "Total", "War", "Age", "Empires", "Soundtrack", "Deluxe",
+    "Edition", "Demo", "Pack", "Season", "Pass", "Legends", "Chronicles", "Simulator", "Tycoon", "Quest",
+    "\xc5\x81\xc3\xb3" "d\xc5\xba", "\xc3\x98resund", "Na\xc3\xafve", "Cr\xc3\xa8me", "Br\xc3\xbbl\xc3\xa9" "e",
+};
+static const size_t WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+
+static string synthetic_name(unsigned i)
+{
+    unsigned x = i * 2654435761u;
+    string name = WORDS[x % WORD_COUNT];
+    unsigned words = 1 + (x >> 8) % 4;
+    for (unsigned w = 1; w < words; ++w) {
+        name += (x >> (12 + w)) % 5 == 0 ? ": " : (x >> (12 + w)) % 7 == 0 ? " - " : " ";
+        name += WORDS[(x >> (4 * w)) % WORD_COUNT];
+    }
+    if (x % 11 == 0) name += "\xe2\x84\xa2";
+    if (x % 3 == 0) name += " " + std::to_string(x % 1000);
+    return name;
+}
+
+static string synthetic_app_list(unsigned apps)
+{
+    string json = "{\"applist\":{\"apps\":[";
+    for (unsigned i = 0; i < apps; ++i) {
+        if (i) json += ',';
+        json += "{\"appid\":" + std::to_string(10 + i * 10) + ",\"name\":\"" + synthetic_name(i) + "\"}";
+    }
+    json += "]}}";
+    return json;
+}
+
+// --------------------------- Baseline ---------------------------
+
+struct PlainApp {
+    uint32_t appid;
+    string name;
+};
+
+static void baseline_load(std::string_view json, std::vector<PlainApp>& apps)
+{
+    apps.clear();
+    JsonReader reader(json);
+    PlainApp app{ 0, string() };
+    string key;
+    for (JsonToken t = reader.next(); t != JsonToken::End && t != JsonToken::Error; t = reader.next()) {
+        if (t == JsonToken::Key) key = string(reader.text());
+        else if (t == JsonToken::Number && key == "appid") app.appid = static_cast<uint32_t>(std::atol(string(reader.text()).c_str()));
+        else if (t == JsonToken::String && key == "name") reader.decode(app.name);
+        else if (t == JsonToken::ObjectEnd && app.appid) {
+            apps.push_back(app);
+            app = PlainApp{ 0, string() };
+        }
+    }
+}
+
+static string ascii_lower(const string& s)
+{
+    string out = s;
+    for (char& c : out) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return out;
+}
+
+static size_t baseline_search(const std::vector<PlainApp>& apps, const string& query, size_t limit)
+{
+    string q = ascii_lower(query);
+    size_t found = 0;
+    for (const auto& app : apps) {
+        if (ascii_lower(app.name).find(q) != string::npos && ++found >= limit) break;
+    }
+    return found;
+}
+
+// --------------------------- Runner ---------------------------
+
+template <typename F>
+static double time_ms(F&& f)
+{
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static double percentile(std::vector<double> v, double p)
+{
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p / 100.0 * (v.size() - 1) + 0.5))];
+}
+
+static void report(const char* what, const std::vector<double>& us, size_t hits)
+{
+    std::printf("  %-22s p50 %8.2f us  p99 %8.2f us  max %8.2f us  (%zu hits)\n", what, percentile(us, 50),
+        percentile(us, 99), *std::max_element(us.begin(), us.end()), hits);
+}
+
+int main(int argc, char** argv)
+{
+    unsigned apps = 200000, queries = 200;
+    string json_path;
+    bool keep = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--apps") == 0 && i + 1 < argc) apps = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) json_path = argv[++i];
+        else if (std::strcmp(argv[i], "--queries") == 0 && i + 1 < argc) queries = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--keep") == 0) keep = true;
+        else {
+            std::fprintf(stderr, "Usage: catalog_bench [--apps N] [--json <app list export>] [--queries Q] [--keep]\n");
+            return 2;
+        }
+    }
+
+    fs::path root = fs::temp_directory_path() / "ssi_catalog_bench";
+    std::error_code ec;
+    fs::create_directories(root, ec);
+    string catalog_path = (root / "apps.catalog").u8string();
+    if (json_path.empty()) {
+        json_path = (root / "applist.json").u8string();
+        std::printf("Writing a synthetic app list of %u apps to %s...\n", apps, json_path.c_str());
+        std::ofstream out(json_path, std::ios::binary);
+        out << synthetic_app_list(apps);
+        if (!out) {
+            std::fprintf(stderr, "Cannot write %s.\n", json_path.c_str());
+            return 1;
+        }
+    }
+
+    MappedFile json;
+    if (!json.open_ro(json_path)) {
+        std::fprintf(stderr, "Cannot read %s.\n", json_path.c_str());
+        return 1;
+    }
+    std::string_view text(reinterpret_cast<const char*>(json.data()), json.size());
+
+    CatalogBuildStats stats;
+    string error;
+    bool built = false;
+    double build = time_ms([&] { built = build_app_catalog(text, catalog_path, stats, error); });
+    if (!built) {
+        std::fprintf(stderr, "Build failed: %s.\n", error.c_str());
+        return 1;
+    }
+    std::printf("build: %zu apps read, %zu indexed, %.1f ms; catalog %.2f MB (app list %.2f MB)\n", stats.apps_read,
+        stats.apps_indexed, build, stats.file_size / 1048576.0, json.size() / 1048576.0);
+
+    // Start-up cost: map the catalog, or load the whole list.
+    std::vector<double> open_ms, load_ms;
+    std::vector<PlainApp> plain;
+    for (int i = 0; i < 5; ++i) {
+        AppCatalog c;
+        open_ms.push_back(time_ms([&] { c.open(catalog_path); }));
+        load_ms.push_back(time_ms([&] { baseline_load(text, plain); }));
+    }
+    std::printf("start-up (median of 5):\n");
+    std::printf("  AppCatalog::open       %9.3f ms\n", percentile(open_ms, 50));
+    std::printf("  parse app list JSON    %9.3f ms  (%zu apps)\n", percentile(load_ms, 50), plain.size());
+
+    AppCatalog catalog;
+    if (!catalog.open(catalog_path)) {
+        std::fprintf(stderr, "Cannot open %s.\n", catalog_path.c_str());
+        return 1;
+    }
+
+    // Queries: whole names, their first letters, and words from the middle.
+    std::vector<string> exact, prefix, infix;
+    for (unsigned q = 0; q < queries; ++q) {
+        const PlainApp& app = plain[(q * 7919u) % plain.size()];
+        exact.push_back(app.name);
+        prefix.push_back(app.name.substr(0, std::min<size_t>(app.name.size(), 4)));
+        size_t space = app.name.find(' ');
+        infix.push_back(space == string::npos ? app.name : app.name.substr(space + 1, 6));
+    }
+
+    std::vector<double> us;
+    std::vector<AppCatalog::Match> out;
+    auto run = [&](const char* what, const std::vector<string>& qs, AppCatalog::MatchKind kind) {
+        us.clear();
+        size_t hits = 0;
+        for (const auto& q : qs) {
+            out.clear();
+            us.push_back(time_ms([&] { hits += catalog.find(q, kind, out, 10); }) * 1000);
+        }
+        report(what, us, hits);
+    };
+    std::printf("queries (%u each, up to 10 matches):\n", queries);
+    run("exact", exact, AppCatalog::MatchKind::Exact);
+    run("prefix", prefix, AppCatalog::MatchKind::Prefix);
+    run("substring", infix, AppCatalog::MatchKind::Substring);
+
+    us.clear();
+    size_t hits = 0;
+    for (const auto& q : infix) {
+        us.push_back(time_ms([&] { hits += catalog.search(q, 10).size(); }) * 1000);
+    }
+    report("search (all three)", us, hits);
+
+    us.clear();
+    hits = 0;
+    for (const auto& q : infix) {
+        us.push_back(time_ms([&] { hits += baseline_search(plain, q, 10); }) * 1000);
+    }
+    report("baseline substring", us, hits);
+
+    // Worst case: a substring nothing contains, so the whole section is read.
+    us.clear();
+    for (int i = 0; i < 20; ++i) {
+        out.clear();
+        us.push_back(time_ms([&] { catalog.find("zzqx", AppCatalog::MatchKind::Substring, out, 10); }) * 1000);
+    }
+    report("substring, no match", us, out.size());
+
+    if (!keep) {
+        catalog.close();
+        fs::remove_all(root, ec);
+    }
+    return 0;
+}
@@ -0,0 +1,276 @@
+// json_bench.cpp
+// Microbenchmark: the single-pass JsonReader against the find/substr sniffers
+// it replaced (copied below as the baseline).
+//
+// Usage: json_bench [--iterations N] [payload.json ...]
+//
+// Every payload is answered for each of its AppIDs, the way --validate reads a
+// batched response (parse_appdetails, one pass) and the way single lookups
+// read it (find_appdetails, once per AppID). Without arguments a synthetic batch of 20 apps with
+// description-sized fields is generated, so the numbers are repeatable on any
+// machine.
+//
+// Build (from the repository root):
+//   cl.exe /EHsc /std:c++17 /O2 /Isrc tools\bench\json_bench.cpp src\json_reader.cpp
+//   g++ -std=c++17 -O2 -Isrc tools/bench/json_bench.cpp src/json_reader.cpp -o json_bench
+
+#include "json_reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using std::string;
+
+// --------------------------- Baseline ---------------------------
+
+// Quick JSON sniff: return true if the appdetails response contains "success": true for given appid.
+static bool legacy_success(const string& resp, const string& appid)
+{
+    if (resp.empty() || appid.empty()) return false;
+    string key = "\"" + appid + "\"";
+    size_t pos = resp.find(key);
+    if (pos == string::npos) return false;
+
+    size_t successPos = resp.find("\"success\"", pos);
+    if (successPos == string::npos) return false;
+
+    size_t colonPos = resp.find(':', successPos);
+    if (colonPos == string::npos) return false;
+
+    size_t checkEnd = (resp.size() < colonPos + 50) ? resp.size() : (colonPos + 50);
+    string snippet = resp.substr(colonPos, checkEnd - colonPos);
+    return (snippet.find("true") != string::npos);
+}
+
+// Extract the game name from the appdetails JSON response (basic, not full JSON parser).
+// Returns empty string on failure.
+static string legacy_name(const string& resp, const string& appid)
+{
+    if (resp.empty() || appid.empty()) return "";
+
+    string key = "\"" + appid + "\"";
+    size_t pos = resp.find(key);
+    if (pos == string::npos) return "";
+
+    size_t successPos = resp.find("\"success\"", pos);
+    if (successPos == string::npos) return "";
+
+    size_t colonPos = resp.find(':', successPos);
+    if (colonPos == string::npos) return "";
+
+    size_t checkEnd = (resp.size() < colonPos + 200) ? resp.size() : (colonPos + 200);
+    string snippet = resp.substr(colonPos, checkEnd - colonPos);
+    if (snippet.find("true") == string::npos) return "";
+
+    size_t dataPos = resp.find("\"data\"", successPos);
+    if (dataPos == string::npos) return "";
+
+    size_t namePos = resp.find("\"name\"", dataPos);
+    if (namePos == string::npos) return "";
+
+    size_t colonAfterName = resp.find(':', namePos);
+    if (colonAfterName == string::npos) return "";
+
+    size_t startQuote = resp.find('"', colonAfterName + 1);
+    if (startQuote == string::npos) return "";
+
+    // Extract the quoted string (handle basic escapes)
+    size_t i = startQuote + 1;
+    std::string name;
+    for (; i < resp.size(); ++i) {
+        char c = resp[i];
+        if (c == '"' && resp[i - 1] != '\\') {
+            break;
+        }
+        if (c == '\\' && i + 1 < resp.size()) {
+            char next = resp[i + 1];
+            if (next == '"' || next == '\\' || next == '/') {
+                name.push_back(next);
+                ++i;
+                continue;
+            }
+            else if (next == 'n') {
+                name.push_back('\n');
+                ++i;
+                continue;
+            }
+            else if (next == 't') {
+                name.push_back('\t');
+                ++i;
+                continue;
+            }
+            // other escapes: skip the backslash and take the next char
+        }
+        else {
+            name.push_back(c);
+        }
+    }
+
+    return name;
+}
+
+// --------------------------- Payloads ---------------------------
+
+struct Payload {
+    string label;
+    string json;
+    std::vector<string> appids;
+};
+
+static string filler(size_t bytes, unsigned seed)
+{
+    // Text with the escapes real descriptions carry (HTML, quotes, \u).
+    static const char* parts[] = {
+        "<p>Explore a hand-crafted world.</p>", " \\\"Quoted\\\" words", "<br>\\r\\n",
+        " caf\\u00e9", " \\/ slashes", " plain words and more plain words",
+    };
+    string out;
+    while (out.size() < bytes) {
+        out += parts[seed++ % (sizeof(parts) / sizeof(parts[0]))];
+    }
+    return out;
+}
+
+static Payload synthetic_payload(size_t apps)
+{
+    Payload p;
+    p.label = "synthetic (" + std::to_string(apps) + " apps)";
+    p.json = "{";
+    for (size_t i = 0; i < apps; ++i) {
+        string id = std::to_string(400 + i * 10);
+        p.appids.push_back(id);
+        if (i) p.json += ",";
+        if (i % 5 == 4) {
+            p.json += "\"" + id + "\":{\"success\":false}";
+            continue;
+        }
+        p.json += "\"" + id + "\":{\"success\":true,\"data\":{"
+            "\"type\":\"game\",\"name\":\"Game " + id + " \\u2122 Edition\","
+            "\"steam_appid\":" + id + ",\"required_age\":0,\"is_free\":false,"
+            "\"detailed_description\":\"" + filler(6000, static_cast<unsigned>(i)) + "\","
+            "\"about_the_game\":\"" + filler(4000, static_cast<unsigned>(i) + 1) + "\","
+            "\"short_description\":\"" + filler(300, static_cast<unsigned>(i) + 2) + "\","
+            "\"supported_languages\":\"English, French, German\","
+            "\"developers\":[\"Studio\"],\"publishers\":[\"Studio\"],"
+            "\"platforms\":{\"windows\":true,\"mac\":false,\"linux\":false},"
+            "\"categories\":[{\"id\":2,\"description\":\"Single-player\"},{\"id\":22,\"description\":\"Steam Achievements\"}]"
+            "}}";
+    }
+    p.json += "}";
+    return p;
+}
+
+static bool load_payload(const char* path, Payload& p)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    p.label = path;
+    p.json = ss.str();
+
+    // Take the AppIDs from the payload itself.
+    std::vector<AppDetailsEntry> entries;
+    parse_appdetails(p.json, entries);
+    for (const auto& e : entries) {
+        p.appids.push_back(std::to_string(e.appid));
+    }
+    return !p.appids.empty();
+}
+
+// --------------------------- Runner ---------------------------
+
+// Keeps the compiler from discarding the work being timed.
+static volatile size_t g_sink = 0;
+
+template <typename F>
+static double time_ns_per_payload(int iterations, F&& f)
+{
+    f(); // warm-up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        f();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+static void run(const Payload& p, int iterations)
+{
+    double legacy = time_ns_per_payload(iterations, [&] {
+        size_t n = 0;
+        for (const auto& id : p.appids) {
+            if (legacy_success(p.json, id)) {
+                n += legacy_name(p.json, id).size();
+            }
+        }
+        g_sink = g_sink + n;
+    });
+
+    double reader = time_ns_per_payload(iterations, [&] {
+        std::vector<AppDetailsEntry> entries;
+        parse_appdetails(p.json, entries);
+        size_t n = 0;
+        for (const auto& e : entries) {
+            if (e.success) {
+                n += e.name.size();
+            }
+        }
+        g_sink = g_sink + n;
+    });
+
+    // The interactive lookup: one AppID looked up with find_appdetails.
+    double find = time_ns_per_payload(iterations, [&] {
+        size_t n = 0;
+        for (const auto& id : p.appids) {
+            AppDetailsEntry e;
+            if (find_appdetails(p.json, static_cast<uint32_t>(std::strtoul(id.c_str(), nullptr, 10)), e) && e.success) {
+                n += e.name.size();
+            }
+        }
+        g_sink = g_sink + n;
+    });
+
+    double mb = p.json.size() / (1024.0 * 1024.0);
+    std::printf("%s: %zu bytes, %zu apps, %d iterations\n", p.label.c_str(), p.json.size(), p.appids.size(), iterations);
+    std::printf("  legacy sniffers   %10.1f us/payload  %8.1f MB/s\n", legacy / 1000.0, mb / (legacy / 1e9));
+    std::printf("  parse_appdetails  %10.1f us/payload  %8.1f MB/s  (%.1fx)\n", reader / 1000.0, mb / (reader / 1e9), legacy / reader);
+    std::printf("  find_appdetails   %10.1f us/payload  %8.1f MB/s  (%.1fx)\n", find / 1000.0, mb / (find / 1e9), legacy / find);
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 200;
+    std::vector<Payload> payloads;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+            continue;
+        }
+        Payload p;
+        if (!load_payload(argv[i], p)) {
+            std::fprintf(stderr, "Cannot read an appdetails payload from %s\n", argv[i]);
+            return 1;
+        }
+        payloads.push_back(std::move(p));
+    }
+    if (payloads.empty()) {
+        payloads.push_back(synthetic_payload(1));
+        payloads.push_back(synthetic_payload(20));
+    }
+
+    for (const auto& p : payloads) {
+        run(p, iterations);
+    }
+    return 0;
+}
@@ -0,0 +1,174 @@
+// ledger_bench.cpp
+// Benchmark: per-AppID totals of a large session ledger with ledger_summarize
+// over a memory-mapped file (what --ledger-report does) against the obvious
+// alternative: std::ifstream reading one record at a time into a std::map.
+//
+// Usage: ledger_bench [--records N] [--apps A] [--iterations I] [--keep]
+//
+// Writes a synthetic ledger of N records (5 million by default: sessions of A
+// AppIDs from several interleaved workers, mostly heartbeats) to the temp
+// directory, checks both readers agree, times them warm, then removes the file
+// unless --keep.
+//
+// Build: CMake target ledger_bench.
+
+#include "mapped_file.h"
+#include "session_ledger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::string;
+
+namespace fs = std::filesystem;
+
+typedef std::chrono::steady_clock Clock;
+
+// --------------------------- Synthetic ledger ---------------------------
+
+// 8 workers idling in turns: a start, heartbeats a minute apart, a stop.
+static bool write_ledger(const fs::path& path, uint64_t records, unsigned apps)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    struct Worker { uint32_t appid = 0; uint32_t pid = 0; unsigned left = 0; };
+    std::vector<Worker> workers(8);
+    std::mt19937 rng(42);
+    int64_t now_ms = 1700000000000;
+    uint32_t next_pid = 1000;
+
+    std::vector<LedgerRecord> batch;
+    batch.reserve(4096);
+    for (uint64_t i = 0; i < records; ++i) {
+        Worker& w = workers[i % workers.size()];
+        LedgerRecord r;
+        std::memset(&r, 0, sizeof(r));
+        if (w.left == 0) {
+            w.appid = 10 + 10 * (rng() % apps);
+            w.pid = next_pid++;
+            w.left = 20 + rng() % 400;
+            r.type = static_cast<uint8_t>(LedgerRecordType::Start);
+        }
+        else {
+            r.type = static_cast<uint8_t>(--w.left == 0 ? LedgerRecordType::Stop : LedgerRecordType::Heartbeat);
+            r.idled_ms = 60000;
+        }
+        r.appid = w.appid;
+        r.pid = w.pid;
+        now_ms += 7500;
+        r.unix_ms = now_ms;
+        ledger_seal(r);
+        batch.push_back(r);
+        if (batch.size() == batch.capacity() || i + 1 == records) {
+            out.write(reinterpret_cast<const char*>(batch.data()), batch.size() * sizeof(LedgerRecord));
+            batch.clear();
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+// --------------------------- Baseline ---------------------------
+
+// ifstream, one record per read, std::map of totals.
+static std::map<uint32_t, uint64_t> baseline_totals(const fs::path& path, uint64_t& records)
+{
+    std::map<uint32_t, uint64_t> totals;
+    records = 0;
+    std::ifstream in(path, std::ios::binary);
+    LedgerRecord r;
+    while (in.read(reinterpret_cast<char*>(&r), sizeof(r))) {
+        if (!ledger_record_valid(r)) continue;
+        totals[r.appid] += r.idled_ms;
+        ++records;
+    }
+    return totals;
+}
+
+// --------------------------- Runner ---------------------------
+
+template <typename F>
+static double time_ms(F&& f)
+{
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    uint64_t records = 5000000;
+    unsigned apps = 300, iterations = 5;
+    bool keep = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--records") == 0 && i + 1 < argc) records = std::max(1ll, std::atoll(argv[++i]));
+        else if (std::strcmp(argv[i], "--apps") == 0 && i + 1 < argc) apps = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--keep") == 0) keep = true;
+        else {
+            std::fprintf(stderr, "Usage: ledger_bench [--records N] [--apps A] [--iterations I] [--keep]\n");
+            return 2;
+        }
+    }
+
+    fs::path path = fs::temp_directory_path() / "ssi_ledger_bench.ledger";
+    std::printf("Writing %llu records (%.1f MiB) to %s...\n", static_cast<unsigned long long>(records),
+        records * sizeof(LedgerRecord) / (1024.0 * 1024.0), path.u8string().c_str());
+    if (!write_ledger(path, records, apps)) {
+        std::fprintf(stderr, "Cannot write the synthetic ledger.\n");
+        return 1;
+    }
+
+    // Both readers must agree before their times mean anything.
+    LedgerSummary summary;
+    {
+        MappedFile file;
+        if (!file.open_ro(path.u8string())) {
+            std::fprintf(stderr, "Cannot map the ledger.\n");
+            return 1;
+        }
+        ledger_summarize(file.data(), file.size(), summary);
+    }
+    uint64_t base_records = 0;
+    std::map<uint32_t, uint64_t> base = baseline_totals(path, base_records);
+    bool same = base.size() == summary.apps.size() && base_records == summary.records;
+    for (const auto& a : summary.apps) {
+        same = same && base.count(a.appid) && base[a.appid] == a.idled_ms;
+    }
+    if (!same) {
+        std::fprintf(stderr, "The readers disagree (%zu vs %zu apps).\n", base.size(), summary.apps.size());
+        return 1;
+    }
+
+    std::vector<double> base_ms, mapped_ms;
+    for (unsigned i = 0; i < iterations; ++i) {
+        base_ms.push_back(time_ms([&] { baseline_totals(path, base_records); }));
+        mapped_ms.push_back(time_ms([&] {
+            MappedFile file;
+            if (file.open_ro(path.u8string())) ledger_summarize(file.data(), file.size(), summary);
+        }));
+    }
+    std::sort(base_ms.begin(), base_ms.end());
+    std::sort(mapped_ms.begin(), mapped_ms.end());
+    double b = base_ms[base_ms.size() / 2], m = mapped_ms[mapped_ms.size() / 2];
+
+    std::printf("median of %u warm passes over %llu records, %zu apps:\n", iterations,
+        static_cast<unsigned long long>(summary.records), summary.apps.size());
+    std::printf("  ifstream + std::map   %9.1f ms  %6.1f M records/s\n", b, records / b / 1000.0);
+    std::printf("  mapped + summarize    %9.1f ms  %6.1f M records/s  (%.1fx)\n", m, records / m / 1000.0, b / m);
+
+    if (!keep) {
+        std::error_code ec;
+        fs::remove(path, ec);
+    }
+    return 0;
+}
@@ -0,0 +1,196 @@
+// store_bench.cpp
+// Benchmark: Store lookup latency through the real HTTP client and cache
+// against the local stand-in (tools/store_stub), healthy and under each
+// failure mode it can inject, with a check of what the console idler would
+// print for each answer.
+//
+// Usage: store_bench [--lookups N] [--keep]
+//
+// For every scenario the stand-in is reconfigured, N AppIDs are looked up
+// with store_lookup() (a fresh cache each time, one keep-alive client) and the
+// p50/p90/p99/max latencies are printed. A scenario FAILs when:
+// - a healthy answer is not fetched, not named, or not served from the cache
+//   on the second lookup;
+// - a failed request is reported as an answer, or gets written to the cache;
+// - the outcome the console idler derives from it (see WinMain step 5: the
+//   lookup is joined for IdleSession::STORE_JOIN_WAIT) is not one of those
+//   expected: "named", "not found", "warning" (Could not contact Steam Store)
+//   or "pending" (the name may be printed later).
+// Exits 1 if any scenario failed. The temp cache is removed unless --keep.
+//
+// Build: CMake target store_bench.
+
+#include "appdetails_cache.h"
+#include "idle_session.h"
+#include "platform.h"
+#include "store.h"
+#include "store_stub_server.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using std::string;
+
+namespace fs = std::filesystem;
+
+typedef std::chrono::steady_clock Clock;
+
+// What the console idler prints for a lookup that took ms milliseconds.
+enum class Outcome { Named, NotFound, Warning, Pending };
+
+static const char* outcome_name(Outcome o)
+{
+    switch (o) {
+    case Outcome::Named: return "named";
+    case Outcome::NotFound: return "not found";
+    case Outcome::Warning: return "warning";
+    case Outcome::Pending: return "pending";
+    }
+    return "?";
+}
+
+static Outcome classify(const StoreLookup& r, double ms)
+{
+    if (ms > IdleSession::STORE_JOIN_WAIT.count()) return Outcome::Pending;
+    if (!r.fetched) return Outcome::Warning;
+    return r.success && !r.name.empty() ? Outcome::Named : Outcome::NotFound;
+}
+
+struct Scenario {
+    const char* name;
+    StoreFault fault;
+    unsigned latency_ms;
+    unsigned jitter_ms;
+    bool answered;                 // lookups are expected to get an answer
+    std::vector<Outcome> allowed;  // acceptable console outcomes
+};
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    size_t i = static_cast<size_t>(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(i, sorted.size() - 1)];
+}
+
+// Run one scenario; false if anything was unexpected.
+static bool run_scenario(StoreStubServer& server, const HttpEndpoint& endpoint, const Scenario& s, unsigned lookups,
+    const fs::path& cache_path)
+{
+    StoreStubOptions opts;
+    opts.latency_ms = s.latency_ms;
+    opts.jitter_ms = s.jitter_ms;
+    opts.hang_ms = 3000;
+    opts.fault_pct[static_cast<int>(s.fault)] = s.fault == StoreFault::None ? 0.0 : 100.0;
+    server.set_options(opts);
+
+    std::error_code ec;
+    fs::remove(cache_path, ec);
+    AppDetailsCache cache;
+    cache.open(cache_path.u8string());
+
+    // A short receive timeout so "timeout" does not take the default 10 s.
+    HttpTimeouts timeouts;
+    timeouts.receive_ms = 2000;
+    std::unique_ptr<HttpClient> http = make_store_client(endpoint, timeouts);
+
+    std::vector<double> ms;
+    unsigned counts[4] = {};
+    string problem;
+    for (unsigned i = 0; i < lookups; ++i) {
+        string appid = std::to_string(10 + 10 * i);
+        Clock::time_point start = Clock::now();
+        StoreLookup r = store_lookup(*http, appid, &cache, false);
+        double took = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        ms.push_back(took);
+
+        Outcome o = classify(r, took);
+        ++counts[static_cast<int>(o)];
+        if (problem.empty() && std::find(s.allowed.begin(), s.allowed.end(), o) == s.allowed.end()) {
+            problem = "AppID " + appid + " ended as \"" + outcome_name(o) + "\"";
+        }
+        if (problem.empty() && r.fetched != s.answered) {
+            problem = "AppID " + appid + (r.fetched ? " got an answer" : " got no answer");
+        }
+        if (problem.empty() && s.answered && r.name != "Stub Game " + appid) {
+            problem = "AppID " + appid + " came back as \"" + r.name + "\"";
+        }
+
+        // Answers must be cached; failures must not be.
+        StoreLookup again = store_lookup(*http, appid, &cache, false);
+        if (problem.empty() && s.answered && !again.from_cache) {
+            problem = "AppID " + appid + " was not cached";
+        }
+        if (problem.empty() && !s.answered && again.from_cache) {
+            problem = "a failed lookup of AppID " + appid + " was cached";
+        }
+    }
+    std::sort(ms.begin(), ms.end());
+
+    std::printf("  %-16s %8.2f %8.2f %8.2f %8.2f   %3u %3u %3u %3u   %s\n", s.name, percentile(ms, 50),
+        percentile(ms, 90), percentile(ms, 99), ms.back(), counts[0], counts[1], counts[2], counts[3],
+        problem.empty() ? "ok" : ("FAIL: " + problem).c_str());
+    return problem.empty();
+}
+
+int main(int argc, char** argv)
+{
+    platform_init();
+
+    unsigned lookups = 200;
+    bool keep = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--lookups") == 0 && i + 1 < argc) lookups = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--keep") == 0) keep = true;
+        else {
+            std::fprintf(stderr, "Usage: store_bench [--lookups N] [--keep]\n");
+            return 2;
+        }
+    }
+
+    StoreStubServer server;
+    if (!server.start(0, StoreStubOptions())) {
+        std::fprintf(stderr, "Cannot start the Store stand-in.\n");
+        return 1;
+    }
+    HttpEndpoint endpoint;
+    parse_store_url("http://127.0.0.1:" + std::to_string(server.port()), endpoint);
+
+    const std::vector<Outcome> named = { Outcome::Named };
+    const std::vector<Outcome> warned = { Outcome::Warning };
+    const std::vector<Scenario> scenarios = {
+        { "healthy", StoreFault::None, 0, 0, true, named },
+        { "latency 50+50", StoreFault::None, 50, 50, true, named },
+        { "latency 1200+600", StoreFault::None, 1200, 600, true, { Outcome::Named, Outcome::Pending } },
+        { "429", StoreFault::TooManyRequests, 0, 0, false, warned },
+        { "500", StoreFault::ServerError, 0, 0, false, warned },
+        { "truncated body", StoreFault::Truncate, 0, 0, false, warned },
+        { "reset", StoreFault::Reset, 0, 0, false, warned },
+        { "timeout", StoreFault::Timeout, 0, 0, false, { Outcome::Pending } },
+    };
+
+    fs::path cache_path = fs::temp_directory_path() / "ssi_store_bench.cache";
+    std::printf("Store stand-in on port %u; %u lookups per scenario (slow ones fewer).\n", server.port(), lookups);
+    std::printf("  %-16s %8s %8s %8s %8s   %s\n", "scenario", "p50 ms", "p90 ms", "p99 ms", "max ms",
+        "named/not found/warning/pending");
+    bool all_ok = true;
+    for (const auto& s : scenarios) {
+        bool slow = s.latency_ms >= 1000 || s.fault == StoreFault::Timeout;
+        all_ok = run_scenario(server, endpoint, s, slow ? std::min(lookups, 3u) : lookups, cache_path) && all_ok;
+    }
+    uint64_t requests = server.requests();
+    server.stop();
+
+    if (!keep) {
+        std::error_code ec;
+        fs::remove(cache_path, ec);
+    }
+    std::printf("%llu request(s) reached the stand-in. %s\n", static_cast<unsigned long long>(requests),
+        all_ok ? "All scenarios behaved as expected." : "Some scenarios FAILED.");
+    return all_ok ? 0 : 1;
+}
@@ -0,0 +1,336 @@
+// text_bench.cpp
+// Benchmark: the text layer (src/text.h) on game-name-heavy status output,
+// against what the print helpers did before it:
+// - UTF-8 -> UTF-16: a per-code-point decoder run twice (size, then convert)
+//   into a fresh heap buffer copied into the result, like the old
+//   MultiByteToWideChar wrapper; on Windows MultiByteToWideChar itself too.
+// - UTF-16 -> UTF-8: the same, the other way.
+// - Output: two writes per line (text, then the newline), one write per line
+//   (print_utf8_line), and TextBatch flushed every --batch lines.
+//
+// Usage: text_bench [--lines N] [--output-lines M] [--batch B] [--iterations I]
+//
+// The lines are made-up status lines ("[status] AppID 730 \"<name>\" ...")
+// with a mix of ASCII names and accented, Cyrillic and CJK ones. Output goes
+// to stdout and the results to stderr: run "text_bench > /dev/null" (NUL on
+// Windows) to time the writes themselves, or without redirection to time the
+// console. Exits 1 if the converters disagree with the reference.
+//
+// Build: CMake target text_bench.
+
+#define NOMINMAX
+
+#include "text.h"
+#include "util.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+// --------------------------- Reference converters ---------------------------
+
+// One code point at a time, no fast path; same replacement rules as text.cpp.
+static size_t reference_utf8_to_utf16(const string& s, char16_t* out)
+{
+    size_t n = 0;
+    size_t i = 0;
+    const unsigned char* p = reinterpret_cast<const unsigned char*>(s.data());
+    while (i < s.size()) {
+        unsigned c = p[i];
+        size_t len = c < 0x80 ? 1 : (c >= 0xc2 && c <= 0xdf) ? 2 : (c >= 0xe0 && c <= 0xef) ? 3 :
+            (c >= 0xf0 && c <= 0xf4) ? 4 : 0;
+        if (len == 0) {
+            if (out) out[n] = 0xfffd;
+            ++n;
+            ++i;
+            continue;
+        }
+        uint32_t cp = len == 1 ? c : c & (0x7f >> len);
+        size_t k = 1;
+        for (; k < len && i + k < s.size(); ++k) {
+            unsigned b = p[i + k];
+            unsigned lo = 0x80, hi = 0xbf;
+            if (k == 1 && c == 0xe0) lo = 0xa0;
+            if (k == 1 && c == 0xed) hi = 0x9f;
+            if (k == 1 && c == 0xf0) lo = 0x90;
+            if (k == 1 && c == 0xf4) hi = 0x8f;
+            if (b < lo || b > hi) break;
+            cp = (cp << 6) | (b & 0x3f);
+        }
+        i += k;
+        if (k < len) {
+            if (out) out[n] = 0xfffd;
+            ++n;
+        }
+        else if (cp >= 0x10000) {
+            if (out) {
+                out[n] = static_cast<char16_t>(0xd800 + ((cp - 0x10000) >> 10));
+                out[n + 1] = static_cast<char16_t>(0xdc00 + ((cp - 0x10000) & 0x3ff));
+            }
+            n += 2;
+        }
+        else {
+            if (out) out[n] = static_cast<char16_t>(cp);
+            ++n;
+        }
+    }
+    return n;
+}
+
+static size_t reference_utf16_to_utf8(const std::u16string& s, char* out)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < s.size(); ++i) {
+        uint32_t c = s[i];
+        if (c >= 0xd800 && c <= 0xdbff && i + 1 < s.size() && s[i + 1] >= 0xdc00 && s[i + 1] <= 0xdfff) {
+            c = 0x10000 + ((c - 0xd800) << 10) + (s[++i] - 0xdc00);
+        }
+        else if (c >= 0xd800 && c <= 0xdfff) {
+            c = 0xfffd;
+        }
+        char buf[4];
+        size_t len;
+        if (c < 0x80) { buf[0] = static_cast<char>(c); len = 1; }
+        else if (c < 0x800) { buf[0] = static_cast<char>(0xc0 | (c >> 6)); buf[1] = static_cast<char>(0x80 | (c & 0x3f)); len = 2; }
+        else if (c < 0x10000) {
+            buf[0] = static_cast<char>(0xe0 | (c >> 12));
+            buf[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            buf[2] = static_cast<char>(0x80 | (c & 0x3f));
+            len = 3;
+        }
+        else {
+            buf[0] = static_cast<char>(0xf0 | (c >> 18));
+            buf[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3f));
+            buf[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+            buf[3] = static_cast<char>(0x80 | (c & 0x3f));
+            len = 4;
+        }
+        if (out) std::memcpy(out + n, buf, len);
+        n += len;
+    }
+    return n;
+}
+
+// The old wrapper's shape: measure, allocate, convert, copy out.
+static std::u16string old_to_utf16(const string& s)
+{
+    size_t needed = reference_utf8_to_utf16(s, nullptr);
+    std::vector<char16_t> buf(needed + 1);
+    size_t converted = reference_utf8_to_utf16(s, buf.data());
+    return std::u16string(buf.data(), converted);
+}
+
+static string old_to_utf8(const std::u16string& w)
+{
+    size_t needed = reference_utf16_to_utf8(w, nullptr);
+    string buf(needed, 0);
+    reference_utf16_to_utf8(w, &buf[0]);
+    return buf;
+}
+
+// --------------------------- Synthetic output ---------------------------
+
+static const char* const NAMES[] = {
+    "Counter-Strike 2",
+    "Dota 2",
+    "Team Fortress 2",
+    "Stardew Valley",
+    "Hollow Knight",
+    "The Elder Scrolls V: Skyrim Special Edition",
+    "Sid Meier's Civilization VI",
+    "Baldur's Gate 3",
+    "Terraria",
+    "Factorio",
+    "NieR:Automata\xe2\x84\xa2",                                           // TM sign
+    "\xc5\x8ckami HD",                                                     // Okami with macron
+    "Caf\xc3\xa9 Otter Mysteries",
+    "\xd0\x92\xd0\xb5\xd0\xb4\xd1\x8c\xd0\xbc\xd0\xb0\xd0\xba 3",          // Cyrillic
+    "\xe3\x83\x95\xe3\x82\xa1\xe3\x82\xa4\xe3\x83\x8a\xe3\x83\xab "
+    "\xe3\x83\x95\xe3\x82\xa1\xe3\x83\xb3\xe3\x82\xbf\xe3\x82\xb8\xe3\x83\xbc XIV",  // katakana
+    "Celeste \xf0\x9f\x8d\x93",                                            // emoji (surrogate pair)
+};
+
+static std::vector<string> make_lines(size_t count)
+{
+    const size_t names = sizeof(NAMES) / sizeof(NAMES[0]);
+    std::vector<string> lines;
+    lines.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        unsigned appid = 10 + 10 * static_cast<unsigned>(i % 5000);
+        char tail[64];
+        std::snprintf(tail, sizeof(tail), "\" idling, %u:%02u:%02u so far, pid %u", static_cast<unsigned>(i % 97),
+            static_cast<unsigned>(i % 60), static_cast<unsigned>((i * 7) % 60), 4000 + static_cast<unsigned>(i % 900));
+        lines.push_back("[status] AppID " + std::to_string(appid) + " \"" + NAMES[(i * 7) % names] + tail);
+    }
+    return lines;
+}
+
+// --------------------------- Runner ---------------------------
+
+template <typename F>
+static double best_ms(unsigned iterations, F&& f)
+{
+    double best = 1e300;
+    for (unsigned i = 0; i < iterations; ++i) {
+        Clock::time_point start = Clock::now();
+        f();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+static void report(const char* what, double ms, double bytes, double base_ms)
+{
+    std::fprintf(stderr, "  %-34s %9.2f ms  %8.1f MB/s", what, ms, bytes / ms / 1000.0);
+    if (base_ms > 0) std::fprintf(stderr, "  (%.1fx)", base_ms / ms);
+    std::fprintf(stderr, "\n");
+}
+
+// Malformed and edge-case input against the reference.
+static bool self_check()
+{
+    const char* cases[] = {
+        "plain ascii", "\xc3\x28", "\xe2\x82", "\xf0\x9f\x98\x80", "\xed\xa0\x80", "\xc0\xaf", "\xf4\x90\x80\x80",
+        "\xe0\x80\x80x", "abcdefghijklmnopqrstuvwxyz0123456789\xc3\xa9", "\xff\xfe", "\xf0\x9f\x98",
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        string s = cases[i];
+        std::u16string fast;
+        append_utf8_as_utf16(s.data(), s.size(), fast);
+        if (fast != old_to_utf16(s)) {
+            std::fprintf(stderr, "UTF-8 -> UTF-16 disagrees on case %zu.\n", i);
+            return false;
+        }
+    }
+    const std::u16string wide[] = { u"ok", std::u16string(1, char16_t(0xd800)), std::u16string(1, char16_t(0xdc00)) + u"x",
+        u"\u00e9\u4e2d" + std::u16string(1, char16_t(0xd83d)) + std::u16string(1, char16_t(0xde00)) };
+    for (const auto& w : wide) {
+        string fast;
+        append_utf16_as_utf8(w.data(), w.size(), fast);
+        if (fast != old_to_utf8(w)) {
+            std::fprintf(stderr, "UTF-16 -> UTF-8 disagrees.\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    size_t count = 200000;
+    size_t output_count = 20000;
+    size_t batch = 64;
+    unsigned iterations = 5;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--lines") == 0 && i + 1 < argc) count = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--output-lines") == 0 && i + 1 < argc) output_count = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--batch") == 0 && i + 1 < argc) batch = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::fprintf(stderr, "Usage: text_bench [--lines N] [--output-lines M] [--batch B] [--iterations I]\n");
+            return 2;
+        }
+    }
+
+    if (!self_check()) {
+        return 1;
+    }
+    std::vector<string> lines = make_lines(count);
+    std::vector<std::u16string> wide(lines.size());
+    double bytes = 0;
+    size_t ascii_lines = 0;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        wide[i] = old_to_utf16(lines[i]);
+        bytes += lines[i].size();
+        ascii_lines += ascii_prefix_length(lines[i].data(), lines[i].size()) == lines[i].size();
+
+        std::u16string fast;
+        append_utf8_as_utf16(lines[i].data(), lines[i].size(), fast);
+        string back;
+        append_utf16_as_utf8(fast.data(), fast.size(), back);
+        if (fast != wide[i] || back != lines[i]) {
+            std::fprintf(stderr, "The converters disagree on line %zu.\n", i);
+            return 1;
+        }
+    }
+    std::fprintf(stderr, "%zu status lines, %.1f MiB, %.0f%% pure ASCII; best of %u passes:\n", lines.size(),
+        bytes / (1024.0 * 1024.0), 100.0 * ascii_lines / lines.size(), iterations);
+
+    size_t sink = 0;
+    std::fprintf(stderr, "UTF-8 -> UTF-16\n");
+    double base = best_ms(iterations, [&] {
+        for (const auto& l : lines) sink += old_to_utf16(l).size();
+    });
+    report("two passes + fresh buffer", base, bytes, 0);
+#ifdef _WIN32
+    report("MultiByteToWideChar wrapper", best_ms(iterations, [&] {
+        for (const auto& l : lines) {
+            int needed = MultiByteToWideChar(CP_UTF8, 0, l.data(), static_cast<int>(l.size()), NULL, 0);
+            std::vector<wchar_t> buf(static_cast<size_t>(needed) + 1);
+            int converted = MultiByteToWideChar(CP_UTF8, 0, l.data(), static_cast<int>(l.size()), buf.data(), needed);
+            sink += std::wstring(buf.data(), converted).size();
+        }
+    }), bytes, base);
+#endif
+    report("append_utf8_as_utf16, reused buffer", best_ms(iterations, [&] {
+        std::u16string out;
+        for (const auto& l : lines) {
+            out.clear();
+            append_utf8_as_utf16(l.data(), l.size(), out);
+            sink += out.size();
+        }
+    }), bytes, base);
+
+    std::fprintf(stderr, "UTF-16 -> UTF-8\n");
+    base = best_ms(iterations, [&] {
+        for (const auto& w : wide) sink += old_to_utf8(w).size();
+    });
+    report("two passes + fresh buffer", base, bytes, 0);
+    report("append_utf16_as_utf8, reused buffer", best_ms(iterations, [&] {
+        string out;
+        for (const auto& w : wide) {
+            out.clear();
+            append_utf16_as_utf8(w.data(), w.size(), out);
+            sink += out.size();
+        }
+    }), bytes, base);
+
+    // Output: one pass each, they are slow enough to be stable.
+    size_t n = std::min(output_count, lines.size());
+    double out_bytes = 0;
+    for (size_t i = 0; i < n; ++i) out_bytes += lines[i].size() + 1;
+    std::fprintf(stderr, "Writing %zu lines to stdout\n", n);
+    base = best_ms(1, [&] {
+        for (size_t i = 0; i < n; ++i) {
+            console_write_utf8(lines[i].data(), lines[i].size());
+            console_write_utf8("\n", 1);
+        }
+    });
+    report("text, then newline", base, out_bytes, 0);
+    report("print_utf8_line", best_ms(1, [&] {
+        for (size_t i = 0; i < n; ++i) print_utf8_line(lines[i]);
+    }), out_bytes, base);
+    char label[64];
+    std::snprintf(label, sizeof(label), "TextBatch, %zu lines per write", batch);
+    report(label, best_ms(1, [&] {
+        TextBatch out;
+        for (size_t i = 0; i < n; ++i) {
+            out.line(lines[i]);
+            if ((i + 1) % batch == 0) out.flush();
+        }
+    }), out_bytes, base);
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,245 @@
+// vdf_bench.cpp
+// Benchmark: indexing a synthetic Steam library with SteamLibraryIndex
+// (memory-mapped files, single-pass VdfReader) against the obvious
+// alternative: std::ifstream + std::getline, splitting every line on quotes.
+//
+// Usage: vdf_bench [--manifests N] [--libraries K] [--iterations I] [--keep]
+//
+// Writes a fake Steam folder with K library folders and N appmanifest files
+// (realistic size: depots, user config, mounted config) under the temp
+// directory, times both ways of reading it, then removes it unless --keep.
+// Both numbers are warm-cache; the first, cold scan is printed separately.
+//
+// Build: CMake target vdf_bench.
+
+#include "steam_library.h"
+#include "vdf_reader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using std::string;
+
+namespace fs = std::filesystem;
+
+typedef std::chrono::steady_clock Clock;
+
+// --------------------------- Synthetic library ---------------------------
+
+static string manifest_text(uint32_t appid, unsigned salt)
+{
+    string id = std::to_string(appid);
+    string t =
+        "\"AppState\"\n{\n"
+        "\t\"appid\"\t\t\"" + id + "\"\n"
+        "\t\"universe\"\t\t\"1\"\n"
+        "\t\"LauncherPath\"\t\t\"C:\\\\Program Files (x86)\\\\Steam\\\\steam.exe\"\n"
+        "\t\"name\"\t\t\"Synthetic Game " + id + " \\\"Deluxe\\\" Edition\"\n"
+        "\t\"StateFlags\"\t\t\"" + string(salt % 7 == 0 ? "1026" : "4") + "\"\n"
+        "\t\"installdir\"\t\t\"Synthetic Game " + id + "\"\n"
+        "\t\"LastUpdated\"\t\t\"1700000000\"\n"
+        "\t\"SizeOnDisk\"\t\t\"" + std::to_string(1000000ull * (salt % 900 + 1)) + "\"\n"
+        "\t\"StagingSize\"\t\t\"0\"\n"
+        "\t\"buildid\"\t\t\"" + std::to_string(10000000 + salt) + "\"\n"
+        "\t\"LastOwner\"\t\t\"76561197960287930\"\n"
+        "\t\"AutoUpdateBehavior\"\t\t\"0\"\n"
+        "\t\"AllowOtherDownloadsWhileRunning\"\t\t\"0\"\n"
+        "\t\"ScheduledAutoUpdate\"\t\t\"0\"\n"
+        "\t\"InstalledDepots\"\n\t{\n";
+    for (unsigned d = 1; d <= 4; ++d) {
+        t += "\t\t\"" + std::to_string(appid + d) + "\"\n\t\t{\n"
+            "\t\t\t\"manifest\"\t\t\"" + std::to_string(7000000000000000000ull + salt * 31 + d) + "\"\n"
+            "\t\t\t\"size\"\t\t\"" + std::to_string(250000000ull * d) + "\"\n\t\t}\n";
+    }
+    t += "\t}\n"
+        "\t\"SharedDepots\"\n\t{\n\t\t\"228988\"\t\t\"228980\"\n\t\t\"228990\"\t\t\"228980\"\n\t}\n"
+        "\t\"UserConfig\"\n\t{\n\t\t\"language\"\t\t\"english\"\n\t}\n"
+        "\t\"MountedConfig\"\n\t{\n\t\t\"language\"\t\t\"english\"\n\t}\n"
+        "}\n";
+    return t;
+}
+
+static bool write_file(const fs::path& path, const string& text)
+{
+    std::ofstream out(path, std::ios::binary);
+    out << text;
+    return static_cast<bool>(out);
+}
+
+static bool make_library(const fs::path& root, unsigned manifests, unsigned libraries)
+{
+    std::error_code ec;
+    fs::remove_all(root, ec);
+
+    std::vector<fs::path> libs = { root / "Steam" };
+    for (unsigned k = 1; k < libraries; ++k) {
+        libs.push_back(root / ("Library" + std::to_string(k)));
+    }
+
+    string folders = "\"libraryfolders\"\n{\n";
+    for (size_t k = 0; k < libs.size(); ++k) {
+        fs::create_directories(libs[k] / "steamapps" / "common", ec);
+        if (ec) return false;
+        string escaped;
+        for (char c : libs[k].u8string()) {
+            if (c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        folders += "\t\"" + std::to_string(k) + "\"\n\t{\n\t\t\"path\"\t\t\"" + escaped + "\"\n"
+            "\t\t\"label\"\t\t\"\"\n\t\t\"contentid\"\t\t\"123456789\"\n\t\t\"apps\"\n\t\t{\n";
+        for (unsigned i = static_cast<unsigned>(k); i < manifests; i += libraries) {
+            folders += "\t\t\t\"" + std::to_string(10 + i * 10) + "\"\t\t\"1000000\"\n";
+        }
+        folders += "\t\t}\n\t}\n";
+    }
+    folders += "}\n";
+    if (!write_file(libs[0] / "steamapps" / "libraryfolders.vdf", folders)) return false;
+
+    for (unsigned i = 0; i < manifests; ++i) {
+        uint32_t appid = 10 + i * 10;
+        fs::path file = libs[i % libraries] / "steamapps" / ("appmanifest_" + std::to_string(appid) + ".acf");
+        if (!write_file(file, manifest_text(appid, i))) return false;
+    }
+    return true;
+}
+
+// --------------------------- Baseline ---------------------------
+
+// Quoted tokens of one line: "key" "value" -> {key, value}.
+static std::vector<string> quoted_tokens(const string& line)
+{
+    std::vector<string> out;
+    size_t pos = 0;
+    while ((pos = line.find('"', pos)) != string::npos) {
+        size_t end = line.find('"', pos + 1);
+        while (end != string::npos && line[end - 1] == '\\') {
+            end = line.find('"', end + 1);
+        }
+        if (end == string::npos) break;
+        out.push_back(line.substr(pos + 1, end - pos - 1));
+        pos = end + 1;
+    }
+    return out;
+}
+
+// ifstream + getline over every manifest, keeping appid and name.
+static size_t baseline_scan(const fs::path& steam_dir, std::vector<std::pair<uint32_t, string>>& apps)
+{
+    apps.clear();
+    std::vector<fs::path> libs;
+    std::ifstream folders(steam_dir / "steamapps" / "libraryfolders.vdf");
+    string line;
+    while (std::getline(folders, line)) {
+        std::vector<string> tok = quoted_tokens(line);
+        if (tok.size() == 2 && tok[0] == "path") {
+            string path;
+            for (size_t i = 0; i < tok[1].size(); ++i) {
+                if (tok[1][i] == '\\' && i + 1 < tok[1].size()) ++i;
+                path += tok[1][i];
+            }
+            libs.push_back(fs::u8path(path));
+        }
+    }
+
+    for (const fs::path& lib : libs) {
+        std::error_code ec;
+        for (fs::directory_iterator it(lib / "steamapps", ec), end; !ec && it != end; it.increment(ec)) {
+            string name = it->path().filename().u8string();
+            if (name.compare(0, 12, "appmanifest_") != 0) continue;
+            std::ifstream in(it->path());
+            uint32_t appid = 0;
+            string app_name;
+            int depth = 0;
+            while (std::getline(in, line)) {
+                if (line.find('{') != string::npos) ++depth;
+                if (line.find('}') != string::npos) --depth;
+                if (depth != 1) continue;
+                std::vector<string> tok = quoted_tokens(line);
+                if (tok.size() != 2) continue;
+                if (tok[0] == "appid") appid = static_cast<uint32_t>(std::strtoul(tok[1].c_str(), nullptr, 10));
+                else if (tok[0] == "name") app_name = tok[1];
+            }
+            if (appid) apps.emplace_back(appid, app_name);
+        }
+    }
+    return apps.size();
+}
+
+// --------------------------- Runner ---------------------------
+
+template <typename F>
+static double time_ms(F&& f)
+{
+    auto start = Clock::now();
+    f();
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+int main(int argc, char** argv)
+{
+    unsigned manifests = 5000, libraries = 4, iterations = 5;
+    bool keep = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--manifests") == 0 && i + 1 < argc) manifests = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--libraries") == 0 && i + 1 < argc) libraries = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc) iterations = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--keep") == 0) keep = true;
+        else {
+            std::fprintf(stderr, "Usage: vdf_bench [--manifests N] [--libraries K] [--iterations I] [--keep]\n");
+            return 2;
+        }
+    }
+
+    fs::path root = fs::temp_directory_path() / "ssi_vdf_bench";
+    std::printf("Writing %u manifests in %u library folder(s) under %s...\n", manifests, libraries, root.u8string().c_str());
+    if (!make_library(root, manifests, libraries)) {
+        std::fprintf(stderr, "Cannot write the synthetic library.\n");
+        return 1;
+    }
+    string steam_dir = (root / "Steam").u8string();
+
+    SteamLibraryIndex index;
+    double cold = time_ms([&] { index.load(steam_dir); });
+    std::printf("first scan (cold-ish): %zu apps, %zu libraries, %.1f ms\n", index.apps().size(),
+        index.libraries().size(), cold);
+    if (index.apps().size() != manifests) {
+        std::fprintf(stderr, "Index found %zu apps, expected %u.\n", index.apps().size(), manifests);
+        return 1;
+    }
+
+    std::vector<double> base_ms, index_ms;
+    std::vector<std::pair<uint32_t, string>> base_apps;
+    for (unsigned i = 0; i < iterations; ++i) {
+        base_ms.push_back(time_ms([&] { baseline_scan(root / "Steam", base_apps); }));
+        index_ms.push_back(time_ms([&] { index.load(steam_dir); }));
+    }
+    std::sort(base_ms.begin(), base_ms.end());
+    std::sort(index_ms.begin(), index_ms.end());
+    double base = base_ms[base_ms.size() / 2], idx = index_ms[index_ms.size() / 2];
+
+    std::printf("median of %u warm scans:\n", iterations);
+    std::printf("  ifstream + getline   %9.1f ms  %6.2f us/manifest  (%zu apps)\n", base, base * 1000 / manifests, base_apps.size());
+    std::printf("  SteamLibraryIndex    %9.1f ms  %6.2f us/manifest  (%.1fx)\n", idx, idx * 1000 / manifests, base / idx);
+
+    // Parsing alone, files already in memory: what the reader itself costs.
+    string text = manifest_text(440, 1);
+    const unsigned PARSES = 100000;
+    InstalledApp app;
+    double parse = time_ms([&] {
+        for (unsigned i = 0; i < PARSES; ++i) parse_app_manifest(text, app);
+    });
+    std::printf("  parse_app_manifest   %9.3f us per %zu-byte manifest (in memory)\n", parse * 1000 / PARSES, text.size());
+
+    if (!keep) {
+        std::error_code ec;
+        fs::remove_all(root, ec);
+    }
+    return 0;
+}
@@ -0,0 +1,454 @@
+// idler_loadtest.cpp
+// Load test for idler density: starts N worker processes of the idler (the
+// same "--worker" processes --supervise runs), usually against the stub
+// library from tools/steam_stub, and reports what each one costs.
+//
+// Usage: idler_loadtest --idler <path> [--instances N] [--appid A[,B...]]
+//                       [--hold S] [--spawn-gap MS] [--tick MS] [--fast-tick MS]
+//                       [--csv <path>] [--lean] [--standby] [stub options]
+//
+// --lean starts the workers with --lean (trimmed after init, see lean_idle.h),
+// to compare footprints with and without it.
+//
+// --standby starts them as standby workers ("--worker standby", see
+// supervisor.h), waits until all of them report "warm" and only then hands
+// out the AppIDs, so startup latency is the warm switch path (AppID sent to
+// "ready") rather than the cold one (process spawn to "ready"). Run it with
+// and without to compare the two.
+//
+// Stub options set the SSI_STUB_* variables the workers inherit (see
+// steam_api_stub.cpp): --init-ms, --init-jitter-ms, --callback-us,
+// --shutdown-ms, --memory-kb, --steam <mode>, --owned <appids>, and
+// --stub-dir <dir> (put on the library search path).
+//
+// Per instance: startup latency (spawn to "ready"), resident and private
+// memory and CPU time after the hold period, CPU use while idling, and
+// shutdown latency ("stop" to process exit). Then percentiles over all of them.
+//
+// Built by CMake as the idler_loadtest target.
+
+#include "platform.h"
+#include "util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+static const unsigned STARTUP_TIMEOUT_MS = 60000;
+static const unsigned SHUTDOWN_TIMEOUT_MS = 10000;
+
+static double ms_between(Clock::time_point from, Clock::time_point to)
+{
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+// --------------------------- Process usage ---------------------------
+
+struct ProcessUsage {
+    bool valid = false;
+    uint64_t rss_kb = 0;        // resident set / working set
+    uint64_t private_kb = 0;    // anonymous resident memory / private bytes
+    double cpu_ms = 0;          // user + kernel time since start
+};
+
+#ifdef _WIN32
+
+static ProcessUsage sample_usage(const ChildProcess& child)
+{
+    ProcessUsage u;
+    HANDLE process = reinterpret_cast<HANDLE>(child.process);
+    PROCESS_MEMORY_COUNTERS_EX mem = {};
+    FILETIME created, exited, kernel, user;
+    if (!process ||
+        !GetProcessMemoryInfo(process, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&mem), sizeof(mem)) ||
+        !GetProcessTimes(process, &created, &exited, &kernel, &user)) {
+        return u;
+    }
+    auto ticks = [](const FILETIME& ft) {
+        return (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    };
+    u.valid = true;
+    u.rss_kb = mem.WorkingSetSize / 1024;
+    u.private_kb = mem.PrivateUsage / 1024;
+    u.cpu_ms = (ticks(kernel) + ticks(user)) / 10000.0;   // 100 ns units
+    return u;
+}
+
+#else
+
+static ProcessUsage sample_usage(const ChildProcess& child)
+{
+    ProcessUsage u;
+    if (!child.process) {
+        return u;
+    }
+    string dir = "/proc/" + std::to_string(child.pid);
+
+    std::ifstream status(dir + "/status");
+    string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmRSS:") == 0) {
+            u.rss_kb = std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+        else if (line.compare(0, 8, "RssAnon:") == 0) {
+            u.private_kb = std::strtoull(line.c_str() + 8, nullptr, 10);
+        }
+    }
+
+    // utime and stime are fields 14 and 15; the command name (field 2) may
+    // contain spaces, so count from its closing parenthesis.
+    std::ifstream stat(dir + "/stat");
+    string text((std::istreambuf_iterator<char>(stat)), std::istreambuf_iterator<char>());
+    size_t paren = text.rfind(')');
+    if (paren == string::npos) {
+        return u;
+    }
+    std::istringstream fields(text.substr(paren + 2));
+    string field;
+    unsigned long long utime = 0, stime = 0;
+    for (int i = 3; i <= 15 && fields >> field; ++i) {
+        if (i == 14) utime = std::strtoull(field.c_str(), nullptr, 10);
+        if (i == 15) stime = std::strtoull(field.c_str(), nullptr, 10);
+    }
+    u.valid = u.rss_kb > 0;
+    u.cpu_ms = (utime + stime) * 1000.0 / sysconf(_SC_CLK_TCK);
+    return u;
+}
+
+#endif
+
+// --------------------------- Instances ---------------------------
+
+struct Instance {
+    string appid;
+    ChildProcess child;
+    string pending;              // partial status line
+    string outcome;              // "ready", "failed <reason>", "exited <code>", "timeout", "spawn failed"
+    bool started = false;        // outcome is known
+    bool exited = false;
+    int exit_code = 0;
+    bool warm = false;           // --standby: reported "warm"
+
+    Clock::time_point spawned;   // or, with --standby, when the AppID was sent
+    Clock::time_point stop_sent;
+    double warm_ms = -1;         // --standby: spawn to "warm"
+    double startup_ms = -1;      // -1: not measured
+    double shutdown_ms = -1;
+    ProcessUsage hold_start;
+    ProcessUsage hold_end;
+};
+
+// Read the worker's status pipe until "ready"/"failed" or EOF.
+static void poll_startup(Instance& inst)
+{
+    char buf[512];
+    long got;
+    while ((got = platform_read_nonblocking(inst.child.status_read, buf, sizeof(buf))) > 0) {
+        inst.pending.append(buf, static_cast<size_t>(got));
+        size_t nl;
+        while (!inst.started && (nl = inst.pending.find('\n')) != string::npos) {
+            string line = trim(inst.pending.substr(0, nl));
+            inst.pending.erase(0, nl + 1);
+            if (line == "warm" && !inst.warm) {
+                inst.warm = true;
+                inst.warm_ms = ms_between(inst.spawned, Clock::now());
+            }
+            else if (line == "ready" || line.compare(0, 7, "failed ") == 0) {
+                inst.outcome = line;
+                inst.started = true;
+                inst.startup_ms = ms_between(inst.spawned, Clock::now());
+            }
+        }
+    }
+    if (!inst.started && got < 0) {
+        // Pipe closed without a verdict: the worker exited early.
+        int code = 0;
+        platform_wait_child(inst.child, 1000, code);
+        inst.outcome = "exited " + std::to_string(code);
+        inst.started = true;
+        inst.exited = true;
+        inst.exit_code = code;
+    }
+}
+
+// --------------------------- Report ---------------------------
+
+// Nearest-rank percentile of an already sorted list.
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty()) return 0;
+    size_t rank = static_cast<size_t>(p / 100.0 * sorted.size() + 0.999999);
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+static void print_distribution(const char* name, std::vector<double> values, const char* unit)
+{
+    if (values.empty()) {
+        std::printf("  %-18s n/a\n", name);
+        return;
+    }
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (double v : values) sum += v;
+    std::printf("  %-18s p50 %9.2f  p90 %9.2f  p99 %9.2f  max %9.2f  mean %9.2f %s\n", name,
+        percentile(values, 50), percentile(values, 90), percentile(values, 99), values.back(),
+        sum / values.size(), unit);
+}
+
+// --------------------------- Main ---------------------------
+
+static void usage()
+{
+    std::fprintf(stderr,
+        "Usage: idler_loadtest --idler <path> [--instances N] [--appid A[,B...]] [--hold S]\n"
+        "                      [--spawn-gap MS] [--tick MS] [--fast-tick MS] [--csv <path>]\n"
+        "                      [--stub-dir <dir>] [--init-ms N] [--init-jitter-ms N] [--callback-us N]\n"
+        "                      [--shutdown-ms N] [--memory-kb N] [--steam running|not_running|logged_off]\n"
+        "                      [--owned A[,B...]] [--lean] [--standby]\n");
+}
+
+int main(int argc, char** argv)
+{
+#ifndef _WIN32
+    // A worker that died must show up as EPIPE on "stop", not kill us.
+    signal(SIGPIPE, SIG_IGN);
+#endif
+
+    string idler, csv_path, tick, fast_tick;
+    std::vector<string> appids = { "480" };
+    unsigned instances = 10, hold_s = 10, spawn_gap_ms = 0;
+
+    bool lean = false, standby = false;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--lean" || arg == "--standby") {
+            (arg == "--lean" ? lean : standby) = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage();
+            return 2;
+        }
+        string value = argv[++i];
+        if (arg == "--idler") idler = value;
+        else if (arg == "--instances") instances = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--appid") appids = split_appid_list(value);
+        else if (arg == "--hold") hold_s = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--spawn-gap") spawn_gap_ms = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--tick") tick = value;
+        else if (arg == "--fast-tick") fast_tick = value;
+        else if (arg == "--csv") csv_path = value;
+        else if (arg == "--stub-dir") {
+#ifdef _WIN32
+            const char* var = "PATH";
+            const char sep = ';';
+#else
+            const char* var = "LD_LIBRARY_PATH";
+            const char sep = ':';
+#endif
+            const char* old = std::getenv(var);
+            string path = (old && *old) ? value + sep + old : value;
+            platform_set_env(var, path.c_str());
+        }
+        else if (arg == "--init-ms") platform_set_env("SSI_STUB_INIT_MS", value.c_str());
+        else if (arg == "--init-jitter-ms") platform_set_env("SSI_STUB_INIT_JITTER_MS", value.c_str());
+        else if (arg == "--callback-us") platform_set_env("SSI_STUB_CALLBACK_US", value.c_str());
+        else if (arg == "--shutdown-ms") platform_set_env("SSI_STUB_SHUTDOWN_MS", value.c_str());
+        else if (arg == "--memory-kb") platform_set_env("SSI_STUB_MEMORY_KB", value.c_str());
+        else if (arg == "--steam") platform_set_env("SSI_STUB_STEAM", value.c_str());
+        else if (arg == "--owned") platform_set_env("SSI_STUB_OWNED", value.c_str());
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (idler.empty() || instances == 0 || appids.empty()) {
+        usage();
+        return 2;
+    }
+
+    std::vector<string> base_args;
+    if (!tick.empty()) { base_args.push_back("--tick"); base_args.push_back(tick); }
+    if (!fast_tick.empty()) { base_args.push_back("--fast-tick"); base_args.push_back(fast_tick); }
+    if (lean) base_args.push_back("--lean");
+
+    // Start everything, then wait for every verdict.
+    std::vector<Instance> all(instances);
+    std::printf("Starting %u instance(s) of %s...\n", instances, idler.c_str());
+    for (unsigned i = 0; i < instances; ++i) {
+        Instance& inst = all[i];
+        inst.appid = appids[i % appids.size()];
+        std::vector<string> args = { "--worker", standby ? "standby" : inst.appid };
+        args.insert(args.end(), base_args.begin(), base_args.end());
+        inst.spawned = Clock::now();
+        if (!platform_spawn_worker(idler, args, inst.child)) {
+            inst.outcome = "spawn failed";
+            inst.started = true;
+            inst.exited = true;
+        }
+        if (spawn_gap_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(spawn_gap_ms));
+        }
+    }
+
+    auto startup_deadline = Clock::now() + std::chrono::milliseconds(STARTUP_TIMEOUT_MS);
+    if (standby) {
+        // Everyone warm first (or out), then the AppIDs go out back to back.
+        for (;;) {
+            bool waiting = false;
+            for (Instance& inst : all) {
+                if (!inst.started && !inst.warm) {
+                    poll_startup(inst);
+                    waiting = waiting || (!inst.started && !inst.warm);
+                }
+            }
+            if (!waiting || Clock::now() >= startup_deadline) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        std::printf("Standby workers warm; sending AppIDs...\n");
+        for (Instance& inst : all) {
+            if (inst.started || !inst.warm) continue;
+            string command = "start " + inst.appid + "\n";
+            inst.spawned = Clock::now();
+            platform_write(inst.child.control_write, command.data(), command.size());
+        }
+    }
+    for (;;) {
+        bool waiting = false;
+        for (Instance& inst : all) {
+            if (!inst.started) {
+                poll_startup(inst);
+                waiting = waiting || !inst.started;
+            }
+        }
+        if (!waiting) break;
+        if (Clock::now() >= startup_deadline) {
+            for (Instance& inst : all) {
+                if (!inst.started) {
+                    inst.outcome = "timeout";
+                    inst.started = true;
+                }
+            }
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    // Steady state: what an idling instance costs.
+    std::printf("Holding for %u s...\n", hold_s);
+    auto hold_begin = Clock::now();
+    for (Instance& inst : all) inst.hold_start = sample_usage(inst.child);
+    std::this_thread::sleep_for(std::chrono::seconds(hold_s));
+    for (Instance& inst : all) inst.hold_end = sample_usage(inst.child);
+    double hold_ms = ms_between(hold_begin, Clock::now());
+
+    // Stop everything at once and time each exit.
+    for (Instance& inst : all) {
+        if (inst.exited) continue;
+        inst.stop_sent = Clock::now();
+        platform_write(inst.child.control_write, "stop\n", 5);
+        platform_close(inst.child.control_write);
+    }
+    auto shutdown_deadline = Clock::now() + std::chrono::milliseconds(SHUTDOWN_TIMEOUT_MS);
+    for (;;) {
+        bool waiting = false;
+        for (Instance& inst : all) {
+            if (inst.exited) continue;
+            if (platform_wait_child(inst.child, 0, inst.exit_code)) {
+                inst.exited = true;
+                // Workers that failed to start exit on their own; only time real stops.
+                if (inst.outcome == "ready") {
+                    inst.shutdown_ms = ms_between(inst.stop_sent, Clock::now());
+                }
+            }
+            else {
+                waiting = true;
+            }
+        }
+        if (!waiting || Clock::now() >= shutdown_deadline) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    for (Instance& inst : all) {
+        if (!inst.exited) {
+            platform_kill_child(inst.child);
+            platform_wait_child(inst.child, 1000, inst.exit_code);
+            inst.outcome += " (killed)";
+        }
+        platform_close(inst.child.control_write);
+        platform_close(inst.child.status_read);
+    }
+
+    // Per instance.
+    std::vector<double> warm, startup, shutdown, rss, priv, cpu_pct;
+    size_t ready = 0;
+    std::ofstream csv;
+    if (!csv_path.empty()) {
+        csv.open(csv_path);
+        csv << "instance,pid,appid,outcome,startup_ms,rss_kb,private_kb,cpu_ms,idle_cpu_pct,shutdown_ms,exit_code\n";
+    }
+    std::printf("\n%4s %8s %8s  %-24s %10s %9s %9s %9s %7s %11s\n", "#", "pid", "appid", "outcome",
+        "start ms", "rss KB", "priv KB", "cpu ms", "idle %", "shutdown ms");
+    for (size_t i = 0; i < all.size(); ++i) {
+        const Instance& inst = all[i];
+        bool measured = inst.hold_start.valid && inst.hold_end.valid;
+        double pct = measured ? (inst.hold_end.cpu_ms - inst.hold_start.cpu_ms) * 100.0 / hold_ms : 0;
+        std::printf("%4zu %8lu %8s  %-24s %10.2f %9llu %9llu %9.1f %7.3f %11.2f\n", i, inst.child.pid,
+            inst.appid.c_str(), inst.outcome.c_str(), inst.startup_ms,
+            static_cast<unsigned long long>(inst.hold_end.rss_kb), static_cast<unsigned long long>(inst.hold_end.private_kb),
+            inst.hold_end.cpu_ms, pct, inst.shutdown_ms);
+        if (inst.warm_ms >= 0) {
+            warm.push_back(inst.warm_ms);
+        }
+        if (csv.is_open()) {
+            csv << i << ',' << inst.child.pid << ',' << inst.appid << ',' << inst.outcome << ','
+                << inst.startup_ms << ',' << inst.hold_end.rss_kb << ',' << inst.hold_end.private_kb << ','
+                << inst.hold_end.cpu_ms << ',' << pct << ',' << inst.shutdown_ms << ',' << inst.exit_code << '\n';
+        }
+
+        if (inst.outcome == "ready") {
+            ++ready;
+            startup.push_back(inst.startup_ms);
+            if (inst.shutdown_ms >= 0) shutdown.push_back(inst.shutdown_ms);
+            if (measured) {
+                rss.push_back(static_cast<double>(inst.hold_end.rss_kb));
+                priv.push_back(static_cast<double>(inst.hold_end.private_kb));
+                cpu_pct.push_back(pct);
+            }
+        }
+    }
+
+    // Summary over the instances that reached "ready".
+    double rss_total = 0;
+    for (double v : rss) rss_total += v;
+    std::printf("\n%zu of %u instance(s) ready.\n", ready, instances);
+    if (standby) {
+        print_distribution("spawn to warm", warm, "ms");
+    }
+    print_distribution(standby ? "AppID to ready" : "startup", startup, "ms");
+    print_distribution("shutdown", shutdown, "ms");
+    print_distribution("resident", rss, "KB");
+    print_distribution("private", priv, "KB");
+    print_distribution("idle cpu", cpu_pct, "% of one core");
+    std::printf("  %-18s %.1f MB resident in total\n", "memory", rss_total / 1024.0);
+    return ready == instances ? 0 : 1;
+}
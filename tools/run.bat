@@ -28,8 +28,6 @@ if "%INPUT_APPID%"=="" (
     )
 )
 
-echo %INPUT_APPID%>steam_appid.txt
-
 echo.
 echo Lanzando SimpleSteamIdler para el juego con AppID %INPUT_APPID%...
 echo.
@@ -0,0 +1,194 @@
+// steam_api_stub.cpp
+// Stand-in for steam_api (libsteam_api.so / steam_api64.dll) for load tests:
+// exports the functions steam_api.cpp resolves (SteamAPI_InitFlat included,
+// like current SDKs), with behaviour set through environment variables so one
+// build covers every scenario.
+//
+//   SSI_STUB_STEAM          running (default) | not_running | logged_off
+//   SSI_STUB_STATE_FILE     file holding one of those words; re-read on every
+//                           call, overriding SSI_STUB_STEAM, so a test can take
+//                           the "client" down and bring it back mid-session
+//   SSI_STUB_OWNED          comma-separated AppIDs the "account" owns; unset = all
+//   SSI_STUB_INIT_MS        time SteamAPI_Init takes (default 0)
+//   SSI_STUB_INIT_JITTER_MS extra random 0..N ms on top of SSI_STUB_INIT_MS
+//   SSI_STUB_CALLBACK_US    CPU burnt by every SteamAPI_RunCallbacks (busy wait)
+//   SSI_STUB_SHUTDOWN_MS    time SteamAPI_Shutdown takes
+//   SSI_STUB_MEMORY_KB      memory allocated and touched by a successful init,
+//                           standing in for steamclient's footprint
+//
+// The AppID is read from SteamAppId, exactly as the real library does.
+// Built by CMake as the steam_api_stub target (into <build>/stub/); see the
+// README's load-testing section.
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#define STUB_EXPORT extern "C" __declspec(dllexport)
+#define STUB_CALL __cdecl
+#else
+#define STUB_EXPORT extern "C" __attribute__((visibility("default")))
+#define STUB_CALL
+#endif
+
+using std::string;
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+struct StubConfig {
+    string steam = "running";
+    string owned;                 // empty: every AppID is owned
+    string state_file;
+    unsigned init_ms = 0;
+    unsigned init_jitter_ms = 0;
+    unsigned callback_us = 0;
+    unsigned shutdown_ms = 0;
+    size_t memory_kb = 0;
+};
+
+unsigned env_number(const char* name)
+{
+    const char* v = std::getenv(name);
+    return v ? static_cast<unsigned>(std::strtoul(v, nullptr, 10)) : 0;
+}
+
+// Read once, on first use: the environment is set before the library is loaded.
+const StubConfig& config()
+{
+    static const StubConfig c = []() {
+        StubConfig c;
+        if (const char* v = std::getenv("SSI_STUB_STEAM")) c.steam = v;
+        if (const char* v = std::getenv("SSI_STUB_OWNED")) c.owned = v;
+        if (const char* v = std::getenv("SSI_STUB_STATE_FILE")) c.state_file = v;
+        c.init_ms = env_number("SSI_STUB_INIT_MS");
+        c.init_jitter_ms = env_number("SSI_STUB_INIT_JITTER_MS");
+        c.callback_us = env_number("SSI_STUB_CALLBACK_US");
+        c.shutdown_ms = env_number("SSI_STUB_SHUTDOWN_MS");
+        c.memory_kb = env_number("SSI_STUB_MEMORY_KB");
+        return c;
+    }();
+    return c;
+}
+
+// "running", "not_running" or "logged_off", as of now.
+string steam_state()
+{
+    const StubConfig& c = config();
+    if (!c.state_file.empty()) {
+        std::ifstream in(c.state_file);
+        string state;
+        if (in >> state) {
+            return state;
+        }
+    }
+    return c.steam;
+}
+
+bool owns(const string& appid)
+{
+    const string& list = config().owned;
+    if (list.empty()) {
+        return true;
+    }
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == string::npos) end = list.size();
+        if (list.compare(start, end - start, appid) == 0) {
+            return true;
+        }
+        start = end + 1;
+    }
+    return false;
+}
+
+std::vector<char> g_footprint;
+int g_user;   // its address is the ISteamUser* handed out
+
+} // namespace
+
+// Shared by both init entry points; returns an ESteamAPIInitResult.
+static int stub_init(char* message)
+{
+    const StubConfig& c = config();
+    unsigned delay = c.init_ms;
+    if (c.init_jitter_ms > 0) {
+        std::random_device seed;
+        delay += std::uniform_int_distribution<unsigned>(0, c.init_jitter_ms)(seed);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+
+    auto fail = [message](int result, const char* text) {
+        if (message) std::strncpy(message, text, 1023);
+        return result;
+    };
+    string state = steam_state();
+    if (state == "not_running") {
+        return fail(2, "Steam is not running (stub)");
+    }
+    if (state != "running") {
+        return fail(1, "No user logged in (stub)");
+    }
+    const char* appid = std::getenv("SteamAppId");
+    if (!appid || !owns(appid)) {
+        return fail(1, "AppID not owned (stub)");
+    }
+
+    // Touch every page so it counts towards the resident set.
+    g_footprint.assign(c.memory_kb * 1024, 0);
+    for (size_t i = 0; i < g_footprint.size(); i += 4096) {
+        g_footprint[i] = 1;
+    }
+    return 0;
+}
+
+// SDK 1.58+ entry point: message is a SteamErrMsg (char[1024]).
+STUB_EXPORT int STUB_CALL SteamAPI_InitFlat(char* message)
+{
+    return stub_init(message);
+}
+
+STUB_EXPORT bool STUB_CALL SteamAPI_Init()
+{
+    return stub_init(nullptr) == 0;
+}
+
+STUB_EXPORT void STUB_CALL SteamAPI_Shutdown()
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(config().shutdown_ms));
+    std::vector<char>().swap(g_footprint);
+}
+
+STUB_EXPORT void STUB_CALL SteamAPI_RunCallbacks()
+{
+    unsigned us = config().callback_us;
+    if (us == 0) {
+        return;
+    }
+    auto until = Clock::now() + std::chrono::microseconds(us);
+    while (Clock::now() < until) {
+    }
+}
+
+STUB_EXPORT bool STUB_CALL SteamAPI_IsSteamRunning()
+{
+    return steam_state() != "not_running";
+}
+
+STUB_EXPORT void* STUB_CALL SteamAPI_SteamUser()
+{
+    return &g_user;
+}
+
+STUB_EXPORT bool STUB_CALL SteamAPI_ISteamUser_BLoggedOn(void*)
+{
+    return steam_state() == "running";
+}
@@ -0,0 +1,91 @@
+// store_stub.cpp
+// Local Steam Store stand-in (see store_stub_server.h), for running the idler
+// or --validate offline against recorded answers and injected failures:
+//
+//   store_stub [--port N] [--dir <recordings>] [--record <upstream URL>]
+//              [--latency MS] [--jitter MS] [--fault <kind>[:PERCENT]]...
+//              [--hang MS]
+//
+//   store_stub --dir rec --record https://store.steampowered.com   record
+//   store_stub --dir rec --latency 80 --jitter 40                  replay
+//   store_stub --fault 429:20 --fault truncate:5                   failures
+//
+// <kind> is truncate, 429, 500, timeout or reset; PERCENT defaults to 100.
+// Then run e.g. "simplesteamidler 440 --store-url http://127.0.0.1:27080".
+// Stops on Ctrl+C / SIGTERM (ENTER on Windows).
+//
+// Built by CMake as the store_stub target.
+
+#include "platform.h"
+#include "store_stub_server.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using std::string;
+
+static const uint16_t DEFAULT_PORT = 27080;
+
+static void usage()
+{
+    std::fprintf(stderr,
+        "Usage: store_stub [--port N] [--dir <recordings>] [--record <upstream URL>]\n"
+        "                  [--latency MS] [--jitter MS] [--fault <kind>[:PERCENT]]... [--hang MS]\n"
+        "  <kind>: truncate, 429, 500, timeout, reset\n");
+}
+
+int main(int argc, char** argv)
+{
+    platform_init();
+
+    StoreStubOptions opts;
+    unsigned long port = DEFAULT_PORT;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--port" && has_value) port = std::strtoul(argv[++i], nullptr, 10);
+        else if (arg == "--dir" && has_value) opts.dir = argv[++i];
+        else if (arg == "--record" && has_value) opts.upstream = argv[++i];
+        else if (arg == "--latency" && has_value) opts.latency_ms = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--jitter" && has_value) opts.jitter_ms = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--hang" && has_value) opts.hang_ms = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        else if (arg == "--fault" && has_value) {
+            string spec = argv[++i];
+            size_t colon = spec.find(':');
+            StoreFault fault;
+            if (!parse_store_fault(spec.substr(0, colon), fault)) {
+                usage();
+                return 2;
+            }
+            opts.fault_pct[static_cast<int>(fault)] = colon == string::npos ? 100.0 : std::atof(spec.c_str() + colon + 1);
+        }
+        else {
+            usage();
+            return 2;
+        }
+    }
+    if (!opts.upstream.empty() && opts.dir.empty()) {
+        std::fprintf(stderr, "--record needs --dir to save the recordings in.\n");
+        return 2;
+    }
+    if (port > 65535) {
+        usage();
+        return 2;
+    }
+
+    StoreStubServer server;
+    if (!server.start(static_cast<uint16_t>(port), opts)) {
+        std::fprintf(stderr, "Cannot listen on 127.0.0.1:%lu.\n", port);
+        return 1;
+    }
+    std::printf("Store stand-in on http://127.0.0.1:%u (--store-url http://127.0.0.1:%u). %s to stop.\n",
+        server.port(), server.port(), stop_request_hint());
+    std::fflush(stdout);
+
+    wait_for_stop_request();
+    server.stop();
+    std::printf("%llu request(s) answered.\n", static_cast<unsigned long long>(server.requests()));
+    return 0;
+}
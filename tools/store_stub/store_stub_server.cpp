@@ -0,0 +1,316 @@
+// store_stub_server.cpp
+// Local Store stand-in. See store_stub_server.h.
+
+#include "store_stub_server.h"
+#include "http_client.h"
+#include "net.h"
+#include "platform.h"
+#include "store.h"
+#include "util.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+
+using std::string;
+
+static const size_t MAX_REQUEST_HEAD = 16 * 1024;
+static const size_t MAX_RECORDING = 4 * 1024 * 1024;
+static const int POLL_MS = 250;
+static const unsigned IDLE_CLOSE_MS = 30000;   // keep-alive connections idle this long are closed
+
+const char* store_fault_name(StoreFault fault)
+{
+    switch (fault) {
+    case StoreFault::None: return "none";
+    case StoreFault::Truncate: return "truncate";
+    case StoreFault::TooManyRequests: return "429";
+    case StoreFault::ServerError: return "500";
+    case StoreFault::Timeout: return "timeout";
+    case StoreFault::Reset: return "reset";
+    }
+    return "?";
+}
+
+bool parse_store_fault(const string& name, StoreFault& out)
+{
+    for (int i = 1; i <= static_cast<int>(StoreFault::Reset); ++i) {
+        if (name == store_fault_name(static_cast<StoreFault>(i))) {
+            out = static_cast<StoreFault>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Sleep up to ms, in short steps so stop() is not held up.
+static void interruptible_sleep(unsigned ms, const std::atomic<bool>& stopping)
+{
+    auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(ms);
+    for (auto now = std::chrono::steady_clock::now(); !stopping && now < until; now = std::chrono::steady_clock::now()) {
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(until - now, std::chrono::milliseconds(50)));
+    }
+}
+
+// --------------------------- Server ---------------------------
+
+StoreStubServer::~StoreStubServer()
+{
+    stop();
+}
+
+bool StoreStubServer::start(uint16_t port, const StoreStubOptions& opts)
+{
+    stop();
+    net_socket listener = net_listen_loopback(port);
+    if (listener == NET_INVALID_SOCKET) {
+        return false;
+    }
+    listener_ = listener;
+    port_ = net_local_port(listener);
+    stopping_ = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        opts_ = opts;
+        rng_.seed(std::random_device()());
+    }
+    acceptor_ = std::thread([this]() { accept_loop(); });
+    return true;
+}
+
+void StoreStubServer::stop()
+{
+    if (listener_ == NET_INVALID_SOCKET) {
+        return;
+    }
+    stopping_ = true;
+    acceptor_.join();
+    net_close(listener_);
+    listener_ = NET_INVALID_SOCKET;
+
+    std::vector<std::thread> connections;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections.swap(connections_);
+    }
+    for (auto& t : connections) {
+        t.join();
+    }
+}
+
+void StoreStubServer::set_options(const StoreStubOptions& opts)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    opts_ = opts;
+}
+
+void StoreStubServer::accept_loop()
+{
+    while (!stopping_) {
+        net_socket client = net_accept(listener_, POLL_MS);
+        if (client == NET_INVALID_SOCKET) {
+            continue;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        connections_.emplace_back([this, client]() { serve(client); });
+    }
+}
+
+StoreFault StoreStubServer::draw_fault(const StoreStubOptions& opts, unsigned& delay_ms)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    delay_ms = opts.latency_ms;
+    if (opts.jitter_ms > 0) {
+        delay_ms += std::uniform_int_distribution<unsigned>(0, opts.jitter_ms)(rng_);
+    }
+    double roll = std::uniform_real_distribution<double>(0.0, 100.0)(rng_);
+    for (int i = 1; i <= static_cast<int>(StoreFault::Reset); ++i) {
+        roll -= opts.fault_pct[i];
+        if (roll < 0) {
+            return static_cast<StoreFault>(i);
+        }
+    }
+    return StoreFault::None;
+}
+
+void StoreStubServer::serve(std::intptr_t client)
+{
+    net_set_timeouts(client, 5000, POLL_MS);
+    string pending;
+    char buf[4096];
+    unsigned idle_ms = 0;
+
+    while (!stopping_) {
+        size_t head_end = pending.find("\r\n\r\n");
+        if (head_end == string::npos) {
+            if (pending.size() > MAX_REQUEST_HEAD || idle_ms >= IDLE_CLOSE_MS) {
+                break;
+            }
+            long got = net_recv(client, buf, sizeof(buf));
+            if (got == 0) {
+                break;
+            }
+            if (got < 0) {
+                idle_ms += POLL_MS;   // timeout (or an error, which ends the same way)
+                continue;
+            }
+            idle_ms = 0;
+            pending.append(buf, static_cast<size_t>(got));
+            continue;
+        }
+
+        string head = pending.substr(0, head_end);
+        pending.erase(0, head_end + 4);
+        string request_line = head.substr(0, head.find("\r\n"));
+        size_t sp1 = request_line.find(' ');
+        size_t sp2 = request_line.rfind(' ');
+        string target = sp1 != string::npos && sp2 > sp1 ? request_line.substr(sp1 + 1, sp2 - sp1 - 1) : string();
+        bool keep_alive = request_line.size() < 8 ||
+            request_line.compare(request_line.size() - 8, 8, "HTTP/1.0") != 0;
+        for (char& c : head) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (head.find("\r\nconnection: close") != string::npos) {
+            keep_alive = false;
+        }
+        ++requests_;
+
+        StoreStubOptions opts;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            opts = opts_;
+        }
+        unsigned delay_ms = 0;
+        StoreFault fault = draw_fault(opts, delay_ms);
+        if (fault == StoreFault::Reset) {
+            break;
+        }
+        if (fault == StoreFault::Timeout) {
+            interruptible_sleep(opts.hang_ms, stopping_);
+            break;
+        }
+        interruptible_sleep(delay_ms, stopping_);
+
+        string status = "200 OK";
+        string body;
+        string extra;
+        if (fault == StoreFault::TooManyRequests) {
+            status = "429 Too Many Requests";
+            extra = "Retry-After: 60\r\n";
+        }
+        else if (fault == StoreFault::ServerError) {
+            status = "500 Internal Server Error";
+        }
+        else if (target.find("/api/appdetails") == string::npos) {
+            status = "404 Not Found";
+        }
+        else {
+            body = answer_body(target, opts);
+        }
+
+        string response = "HTTP/1.1 " + status + "\r\n"
+            "Content-Type: application/json; charset=utf-8\r\n" + extra +
+            "Content-Length: " + std::to_string(body.size()) + "\r\n" +
+            (keep_alive ? "Connection: keep-alive\r\n" : "Connection: close\r\n") + "\r\n";
+        if (fault == StoreFault::Truncate) {
+            response += body.substr(0, body.size() / 2);
+            net_send_all(client, response.data(), response.size());
+            break;
+        }
+        response += body;
+        if (!net_send_all(client, response.data(), response.size()) || !keep_alive) {
+            break;
+        }
+    }
+    net_close(client);
+}
+
+// --------------------------- Answers ---------------------------
+
+// The inside of a recorded {"<appid>":{...}} response, i.e. "<appid>":{...}.
+static bool recorded_entry(const string& dir, const string& appid, string& entry)
+{
+    string text;
+    if (!platform_read_small_file(dir + "/" + appid + ".json", text, MAX_RECORDING)) {
+        return false;
+    }
+    size_t open = text.find('{');
+    size_t close = text.rfind('}');
+    if (open == string::npos || close == string::npos || close <= open) {
+        return false;
+    }
+    entry = trim(text.substr(open + 1, close - open - 1));
+    return !entry.empty();
+}
+
+// Value of a query parameter of target, empty if it has none.
+static string query_value(const string& target, const char* name)
+{
+    string key = string(name) + "=";
+    size_t at = target.find('?');
+    while (at != string::npos) {
+        if (target.compare(at + 1, key.size(), key) == 0) {
+            string value = target.substr(at + 1 + key.size());
+            value.erase(std::min(value.find('&'), value.size()));
+            return value;
+        }
+        at = target.find('&', at + 1);
+    }
+    return string();
+}
+
+// What a filters=price_overview request gets for one app: its success and,
+// for a game that is not free, a price. Never a name.
+static string price_overview_entry(const string& appid, const string& entry)
+{
+    bool success = entry.find("\"success\":true") != string::npos;
+    bool free = entry.find("\"is_free\":true") != string::npos;
+    string body = "\"" + appid + "\":{\"success\":" + (success ? "true" : "false");
+    if (success) {
+        body += free ? ",\"data\":[]" :
+            ",\"data\":{\"price_overview\":{\"currency\":\"USD\",\"initial\":999,\"final\":999,"
+            "\"discount_percent\":0,\"initial_formatted\":\"\",\"final_formatted\":\"$9.99\"}}";
+    }
+    return body + "}";
+}
+
+string StoreStubServer::answer_body(const string& target, const StoreStubOptions& opts)
+{
+    string list = query_value(target, "appids");
+    if (list.empty()) {
+        return "null";
+    }
+    std::vector<string> appids = split_appid_list(list);
+    bool price_overview = query_value(target, "filters") == "price_overview";
+    if (appids.size() > 1 && !price_overview) {
+        return "null";
+    }
+
+    string body = "{";
+    for (const auto& appid : appids) {
+        if (!is_digits_only(appid)) {
+            continue;
+        }
+        string entry;
+        if (!opts.dir.empty() && !recorded_entry(opts.dir, appid, entry) && !opts.upstream.empty()) {
+            // Record: one upstream request per missing AppID, saved as is.
+            HttpEndpoint upstream;
+            HttpResponse response;
+            if (parse_store_url(opts.upstream, upstream) &&
+                make_store_client(upstream, HttpTimeouts())->get("/api/appdetails?appids=" + appid, response) &&
+                response.status == 200) {
+                platform_write_file_atomic(opts.dir + "/" + appid + ".json", response.body);
+                recorded_entry(opts.dir, appid, entry);
+            }
+        }
+        if (entry.empty()) {
+            entry = opts.dir.empty() ?
+                "\"" + appid + "\":{\"success\":true,\"data\":{\"type\":\"game\",\"name\":\"Stub Game " + appid +
+                "\",\"steam_appid\":" + appid + ",\"is_free\":false}}" :
+                "\"" + appid + "\":{\"success\":false}";
+        }
+        if (price_overview) {
+            entry = price_overview_entry(appid, entry);
+        }
+        body += (body.size() > 1 ? "," : "") + entry;
+    }
+    return body + "}";
+}
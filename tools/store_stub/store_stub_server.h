@@ -0,0 +1,97 @@
+// store_stub_server.h
+// Local stand-in for the Steam Store's appdetails API, for offline latency
+// and failure testing of the lookup path (--store-url http://127.0.0.1:<port>).
+//
+// Answers GET .../api/appdetails?appids=<id>[,<id>...] over plain HTTP/1.1
+// with keep-alive, on 127.0.0.1 only:
+// - Replay: <dir>/<appid>.json holds a recorded response ({"440":{...}}).
+//   Batched requests get the recorded entries merged into one object. AppIDs
+//   without a recording get {"success":false} when a directory is set, and a
+//   made-up "Stub Game <appid>" otherwise.
+// - Filters, as the real Store: a request for several AppIDs is answered with
+//   a bare "null" unless it asks for filters=price_overview, and a
+//   price_overview answer holds each app's success and price, no name.
+// - Record: with an upstream URL, AppIDs without a recording are fetched
+//   from there first (one request each) and saved to <dir>.
+// - Latency: every answer waits latency_ms plus a random 0..jitter_ms.
+// - Faults: each request draws at most one, by percentage: a body cut off
+//   after half its Content-Length, 429 Too Many Requests, 500, no answer
+//   at all for hang_ms ("timeout"), or the connection closed unanswered.
+//
+// Used by the store_stub tool and by store_bench.
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class StoreFault {
+    None,
+    Truncate,          // full Content-Length, half the body, then close
+    TooManyRequests,   // 429 with Retry-After
+    ServerError,       // 500
+    Timeout,           // read the request, answer nothing for hang_ms
+    Reset,             // close right after reading the request
+};
+
+const char* store_fault_name(StoreFault fault);
+
+// "truncate", "429", "500", "timeout", "reset"; false for anything else.
+bool parse_store_fault(const std::string& name, StoreFault& out);
+
+struct StoreStubOptions {
+    std::string dir;           // recorded responses; empty: made-up answers
+    std::string upstream;      // record misses from this base URL into dir
+    unsigned latency_ms = 0;
+    unsigned jitter_ms = 0;
+    unsigned hang_ms = 30000;  // how long a Timeout fault holds the request
+
+    // Percentage of requests that get each fault (indexes: StoreFault).
+    double fault_pct[6] = {};
+};
+
+class StoreStubServer {
+public:
+    StoreStubServer() = default;
+    ~StoreStubServer();
+
+    StoreStubServer(const StoreStubServer&) = delete;
+    StoreStubServer& operator=(const StoreStubServer&) = delete;
+
+    // Listen on 127.0.0.1:port (0 picks a free port) and serve from a
+    // background thread. False if the port cannot be bound.
+    bool start(uint16_t port, const StoreStubOptions& opts);
+
+    // Close the listener and every connection, and wait for their threads.
+    void stop();
+
+    uint16_t port() const { return port_; }
+
+    // Replace the options; requests already being answered keep the old ones.
+    void set_options(const StoreStubOptions& opts);
+
+    // Requests answered so far (faults included).
+    uint64_t requests() const { return requests_; }
+
+private:
+    void accept_loop();
+    void serve(std::intptr_t client);
+    std::string answer_body(const std::string& target, const StoreStubOptions& opts);
+    StoreFault draw_fault(const StoreStubOptions& opts, unsigned& delay_ms);
+
+    std::intptr_t listener_ = -1;
+    uint16_t port_ = 0;
+    std::atomic<bool> stopping_{ false };
+    std::atomic<uint64_t> requests_{ 0 };
+    std::thread acceptor_;
+
+    mutable std::mutex mutex_;   // guards everything below
+    StoreStubOptions opts_;
+    std::mt19937 rng_;
+    std::vector<std::thread> connections_;
+};